@@ -30,6 +30,7 @@ qtcAddDeployment()
 
 HEADERS += \
     $$PRJ_DIR/Affine2D.h \
+    $$PRJ_DIR/BinaryToEmber.h \
     $$PRJ_DIR/CarToRas.h \
     $$PRJ_DIR/Curves.h \
     $$PRJ_DIR/DensityFilter.h \
@@ -37,13 +38,18 @@ HEADERS += \
     $$PRJ_DIR/Ember.h \
     $$PRJ_DIR/EmberMotion.h \
     $$PRJ_DIR/EmberPch.h \
+    $$PRJ_DIR/EmberToBinary.h \
     $$PRJ_DIR/EmberToXml.h \
+    $$PRJ_DIR/FilterCache.h \
     $$PRJ_DIR/Interpolate.h \
     $$PRJ_DIR/Isaac.h \
     $$PRJ_DIR/Iterator.h \
+    $$PRJ_DIR/MappedBuffer.h \
+    $$PRJ_DIR/PackedHistogram.h \
     $$PRJ_DIR/Palette.h \
     $$PRJ_DIR/PaletteList.h \
     $$PRJ_DIR/Point.h \
+    $$PRJ_DIR/RenderCheckpoint.h \
     $$PRJ_DIR/RendererBase.h \
     $$PRJ_DIR/Renderer.h \
     $$PRJ_DIR/SheepTools.h \
@@ -101,6 +101,7 @@ HEADERS += \
     $$PRJ_DIR/SpinBox.h \
     $$PRJ_DIR/StealthComboBox.h \
     $$PRJ_DIR/TableWidget.h \
+    $$PRJ_DIR/ThumbnailCache.h \
     $$PRJ_DIR/TwoButtonComboWidget.h \
     $$PRJ_DIR/VariationsDialog.h \
     $$PRJ_DIR/VariationTreeWidgetItem.h
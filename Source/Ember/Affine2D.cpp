@@ -172,6 +172,22 @@ bool Affine2D<T>::IsEmpty() const
 		   (IsClose<T>(F(), EMPTYFIELD));
 }
 
+/// <summary>
+/// Continue a content hash with the six values of this affine transform.
+/// </summary>
+/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+/// <returns>The hash</returns>
+template <typename T>
+uint64_t Affine2D<T>::Hash(uint64_t hash) const
+{
+	hash = HashVal(A(), hash);
+	hash = HashVal(B(), hash);
+	hash = HashVal(C(), hash);
+	hash = HashVal(D(), hash);
+	hash = HashVal(E(), hash);
+	return HashVal(F(), hash);
+}
+
 /// <summary>
 /// Rotate this affine transform around its origin by the specified angle in degrees.
 /// </summary>
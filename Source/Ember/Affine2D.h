@@ -75,6 +75,7 @@ public:
 	bool IsID() const;
 	bool IsZero() const;
 	bool IsEmpty() const;
+	uint64_t Hash(uint64_t hash = HASH_SEED) const;
 	void Rotate(T angle);
 	void Translate(const v2T& v);
 	void RotateScaleXTo(const v2T& v);
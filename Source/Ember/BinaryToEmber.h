@@ -0,0 +1,427 @@
+#pragma once
+
+#include "Utils.h"
+#include "PaletteList.h"
+#include "VariationList.h"
+#include "EmberToBinary.h"
+
+/// <summary>
+/// BinaryToEmber class.
+/// </summary>
+
+namespace EmberNs
+{
+/// <summary>
+/// Class for reading embers from the binary format written by EmberToBinary.
+/// Files are memory mapped and the records decoded directly from the mapping, so nothing is copied
+/// other than the values which end up in the embers, and only the pages being decoded need to be resident.
+/// Embers are passed to a callback one at a time as they are decoded, the same way XmlToEmber streams them.
+/// Template argument expected to be float or double.
+/// </summary>
+template <typename T>
+class EMBER_API BinaryToEmber : public EmberReport
+{
+public:
+	/// <summary>
+	/// Empty constructor.
+	/// </summary>
+	BinaryToEmber()
+	{
+	}
+
+	/// <summary>
+	/// Parse the specified file and place the results in the vector of embers passed in.
+	/// </summary>
+	/// <param name="filename">Full path and filename</param>
+	/// <param name="embers">The newly constructed embers based on what was parsed</param>
+	/// <returns>True if there were no errors, else false.</returns>
+	bool Parse(const char* filename, vector<Ember<T>>& embers)
+	{
+		return Parse(filename, [&](Ember<T>& ember) { embers.push_back(ember); return true; });
+	}
+
+	/// <summary>
+	/// Memory map the specified file and pass each ember in it to the callback as soon as it has been decoded.
+	/// </summary>
+	/// <param name="filename">Full path and filename</param>
+	/// <param name="callback">Function called with each ember, in file order. Return false from it to stop parsing.</param>
+	/// <returns>True if there were no errors, else false.</returns>
+	bool Parse(const char* filename, std::function<bool(Ember<T>& ember)> callback)
+	{
+		bool b = false;
+		size_t size = 0;
+		const byte* data = nullptr;
+		const char* loc = __FUNCTION__;
+		ClearErrorReport();
+#ifdef _WIN32
+		HANDLE mapping = nullptr;
+		HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		LARGE_INTEGER fileSize;
+
+		if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			size = size_t(fileSize.QuadPart);
+
+			if ((mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)))
+				data = static_cast<const byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		}
+
+#else
+		struct stat statBuf;
+		int file = open(filename, O_RDONLY);
+
+		if (file != -1 && fstat(file, &statBuf) == 0 && statBuf.st_size > 0)
+		{
+			size = size_t(statBuf.st_size);
+			void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+			if (p != MAP_FAILED)
+			{
+				madvise(p, size, MADV_SEQUENTIAL);
+				data = static_cast<const byte*>(p);
+			}
+		}
+
+#endif
+
+		if (data)
+			b = Parse(data, size, filename, callback);
+		else
+			AddToReport(string(loc) + " : Error mapping flame file " + string(filename));
+
+#ifdef _WIN32
+
+		if (data)
+			UnmapViewOfFile(data);
+
+		if (mapping)
+			CloseHandle(mapping);
+
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+
+#else
+
+		if (data)
+			munmap(const_cast<byte*>(data), size);
+
+		if (file != -1)
+			close(file);
+
+#endif
+		return b;
+	}
+
+	/// <summary>
+	/// Decode the embers in a buffer holding the contents of a binary flame file, and pass each one to the callback.
+	/// </summary>
+	/// <param name="buf">The buffer to decode</param>
+	/// <param name="size">The size of the buffer in bytes</param>
+	/// <param name="filename">Full path and filename, optionally empty</param>
+	/// <param name="callback">Function called with each ember, in file order. Return false from it to stop parsing.</param>
+	/// <returns>True if there were no errors, else false.</returns>
+	bool Parse(const byte* buf, size_t size, const char* filename, std::function<bool(Ember<T>& ember)> callback)
+	{
+		size_t index = 0;
+		const char* loc = __FUNCTION__;
+		string parentFileString = string(basename(const_cast<char*>(filename)));
+		Cursor header(buf, buf + size);
+		uint32_t version, endian;
+
+		if (size < 16 || memcmp(buf, BINARY_EMBER_MAGIC, 8))
+		{
+			AddToReport(string(loc) + " : " + string(filename) + " is not a binary flame file");
+			return false;
+		}
+
+		header.Skip(8);
+		version = header.Get<uint32_t>();
+		endian = header.Get<uint32_t>();
+
+		if (endian != BINARY_EMBER_ENDIAN || version > BINARY_EMBER_VERSION)
+		{
+			AddToReport(string(loc) + " : " + string(filename) + " was written with version " + std::to_string(version) + " or a different byte order, which is unsupported");
+			return false;
+		}
+
+		while (header.Remaining() > 0)
+		{
+			uint64_t len = header.Get<uint64_t>();
+
+			if (!header.m_Ok || len > header.Remaining())
+			{
+				AddToReport(string(loc) + " : Truncated record " + std::to_string(index) + " in " + string(filename));
+				return false;
+			}
+
+			Ember<T> ember;
+			Cursor record(header.m_Pos, header.m_Pos + len);
+			header.Skip(size_t(len));//Trailing fields added by later versions are skipped.
+
+			if (!GetEmber(record, ember))
+			{
+				AddToReport(string(loc) + " : Error decoding record " + std::to_string(index) + " in " + string(filename));
+				return false;
+			}
+
+			ember.m_Index = index++;
+			ember.m_ParentFilename = parentFileString;
+
+			if (!callback(ember))
+				break;
+		}
+
+		return true;
+	}
+
+private:
+	/// <summary>
+	/// Bounds checked reader of values from a buffer.
+	/// Reading past the end yields zeroes and clears m_Ok rather than reading out of bounds.
+	/// </summary>
+	struct Cursor
+	{
+		Cursor(const byte* pos, const byte* end) : m_Pos(pos), m_End(end), m_Ok(true) { }
+
+		template <typename valT>
+		valT Get()
+		{
+			valT val = valT();
+
+			if (Remaining() >= sizeof(valT))
+				memcpy(&val, m_Pos, sizeof(valT));//Values aren't aligned, so copy rather than dereference.
+
+			Skip(sizeof(valT));
+			return val;
+		}
+
+		T GetT() { return T(Get<double>()); }
+
+		string GetStr()
+		{
+			size_t len = Get<uint32_t>();
+			string s;
+
+			if (Remaining() >= len)
+				s.assign(reinterpret_cast<const char*>(m_Pos), len);
+
+			Skip(len);
+			return s;
+		}
+
+		void Skip(size_t bytes)
+		{
+			if (Remaining() >= bytes)
+				m_Pos += bytes;
+			else
+			{
+				m_Pos = m_End;
+				m_Ok = false;
+			}
+		}
+
+		size_t Remaining() const { return size_t(m_End - m_Pos); }
+
+		const byte* m_Pos;
+		const byte* m_End;
+		bool m_Ok;
+	};
+
+	/// <summary>
+	/// Decode an ember record.
+	/// </summary>
+	/// <param name="c">The cursor positioned at the start of the record</param>
+	/// <param name="ember">The ember to decode into</param>
+	/// <returns>True if the record was complete, else false.</returns>
+	bool GetEmber(Cursor& c, Ember<T>& ember)
+	{
+		size_t i, j;
+		ember.m_Name = c.GetStr();
+		ember.m_Time = c.GetT();
+		ember.m_FinalRasW = ember.m_OrigFinalRasW = size_t(c.Get<uint64_t>());
+		ember.m_FinalRasH = ember.m_OrigFinalRasH = size_t(c.Get<uint64_t>());
+		ember.m_CenterX = c.GetT();
+		ember.m_CenterY = ember.m_RotCenterY = c.GetT();
+		ember.m_PixelsPerUnit = ember.m_OrigPixPerUnit = c.GetT();
+		ember.m_Zoom = c.GetT();
+		ember.m_Rotate = c.GetT();
+		ember.m_Supersample = size_t(c.Get<uint64_t>());
+		ember.m_SpatialFilterRadius = c.GetT();
+		ember.m_SpatialFilterType = eSpatialFilterType(c.Get<uint32_t>());
+		ember.m_TemporalFilterType = eTemporalFilterType(c.Get<uint32_t>());
+		ember.m_TemporalFilterExp = c.GetT();
+		ember.m_TemporalFilterWidth = c.GetT();
+		ember.m_Quality = c.GetT();
+		ember.m_TemporalSamples = size_t(c.Get<uint64_t>());
+		ember.m_SubBatchSize = size_t(c.Get<uint64_t>());
+		ember.m_FuseCount = size_t(c.Get<uint64_t>());
+		ember.m_Background.r = c.GetT();
+		ember.m_Background.g = c.GetT();
+		ember.m_Background.b = c.GetT();
+		ember.m_Brightness = c.GetT();
+		ember.m_Gamma = c.GetT();
+		ember.m_HighlightPower = c.GetT();
+		ember.m_Vibrancy = c.GetT();
+		ember.m_MaxRadDE = c.GetT();
+		ember.m_MinRadDE = c.GetT();
+		ember.m_CurveDE = c.GetT();
+		ember.m_GammaThresh = c.GetT();
+		ember.m_CamZPos = c.GetT();
+		ember.m_CamPerspective = c.GetT();
+		ember.m_CamYaw = c.GetT();
+		ember.m_CamPitch = c.GetT();
+		ember.m_CamDepthBlur = c.GetT();
+		ember.m_PaletteMode = ePaletteMode(c.Get<uint32_t>());
+		ember.m_Interp = eInterp(c.Get<uint32_t>());
+		ember.m_AffineInterp = eAffineInterp(c.Get<uint32_t>());
+		ember.m_PaletteInterp = ePaletteInterp(c.Get<uint32_t>());
+
+		for (glm::length_t ci = 0; ci < 4; ci++)
+		{
+			for (glm::length_t cj = 0; cj < 4; cj++)
+			{
+				ember.m_Curves.m_Points[ci][cj].x = c.GetT();
+				ember.m_Curves.m_Points[ci][cj].y = c.GetT();
+				ember.m_Curves.m_Weights[ci][cj] = c.GetT();
+			}
+		}
+
+		size_t motionCount = c.Get<uint32_t>();
+
+		for (i = 0; i < motionCount && c.m_Ok; i++)
+		{
+			EmberMotion<T> motion;
+			motion.m_MotionFreq = c.GetT();
+			motion.m_MotionOffset = c.GetT();
+			motion.m_MotionFunc = eMotion(c.Get<uint32_t>());
+			size_t paramCount = c.Get<uint32_t>();
+
+			for (j = 0; j < paramCount && c.m_Ok; j++)
+			{
+				eEmberMotionParam param = eEmberMotionParam(c.Get<uint32_t>());
+				motion.m_MotionParams.push_back(MotionParam<T>(param, c.GetT()));
+			}
+
+			ember.m_EmberMotionElements.push_back(motion);
+		}
+
+		size_t xformCount = c.Get<uint32_t>();
+		bool hasFinal = c.Get<uint8_t>() != 0;
+
+		if (xformCount > c.Remaining())
+			return false;
+
+		ember.AddXforms(xformCount);//Decode in place rather than copying each xform and its variations into the ember.
+
+		for (i = 0; i < xformCount && c.m_Ok; i++)
+		{
+			GetXform(c, *ember.GetXform(i), 0);
+			ember.GetXform(i)->CacheColorVals();
+		}
+
+		if (hasFinal && c.m_Ok)
+		{
+			GetXform(c, *ember.NonConstFinalXform(), 0);
+			ember.NonConstFinalXform()->CacheColorVals();
+		}
+
+		size_t paletteSize = c.Get<uint32_t>();
+
+		if (paletteSize > c.Remaining())
+			return false;
+
+		ember.m_Palette.m_Index = -1;
+		ember.m_Palette.m_Entries.resize(paletteSize);
+
+		for (i = 0; i < paletteSize; i++)
+			for (j = 0; j < 4; j++)
+				ember.m_Palette[i][glm::length_t(j)] = T(c.Get<float>());
+
+		string edits = c.GetStr();
+
+		if (!edits.empty())
+			ember.m_Edits = xmlReadMemory(edits.data(), int(edits.size()), nullptr, "ISO-8859-1", XML_PARSE_NONET);
+
+		ember.CacheXforms();
+		ember.SetProjFunc();
+		return c.m_Ok;
+	}
+
+	/// <summary>
+	/// Decode an xform.
+	/// </summary>
+	/// <param name="c">The cursor positioned at the start of the xform</param>
+	/// <param name="xform">The xform to decode into</param>
+	/// <param name="depth">The depth of motion xforms, which can't be nested.</param>
+	void GetXform(Cursor& c, Xform<T>& xform, size_t depth)
+	{
+		size_t i, j;
+		xform.m_Name = c.GetStr();
+		xform.m_Weight = c.GetT();
+		xform.m_ColorX = c.GetT();
+		xform.m_ColorY = c.GetT();
+		xform.m_DirectColor = c.GetT();
+		xform.m_ColorSpeed = c.GetT();
+		xform.m_Opacity = c.GetT();
+		xform.m_Animate = c.GetT();
+		xform.m_MotionFunc = eMotion(c.Get<uint32_t>());
+		xform.m_MotionFreq = c.GetT();
+		xform.m_MotionOffset = c.GetT();
+		xform.m_Affine.A(c.GetT());
+		xform.m_Affine.B(c.GetT());
+		xform.m_Affine.C(c.GetT());
+		xform.m_Affine.D(c.GetT());
+		xform.m_Affine.E(c.GetT());
+		xform.m_Affine.F(c.GetT());
+		xform.m_Post.A(c.GetT());
+		xform.m_Post.B(c.GetT());
+		xform.m_Post.C(c.GetT());
+		xform.m_Post.D(c.GetT());
+		xform.m_Post.E(c.GetT());
+		xform.m_Post.F(c.GetT());
+		size_t xaosCount = c.Get<uint32_t>();
+
+		for (i = 0; i < xaosCount && c.m_Ok; i++)
+			xform.SetXaos(i, c.GetT());
+
+		size_t varCount = c.Get<uint32_t>();
+
+		for (i = 0; i < varCount && c.m_Ok; i++)
+		{
+			string name = c.GetStr();
+			T weight = c.GetT();
+			size_t paramCount = c.Get<uint32_t>();
+			Variation<T>* var = m_VariationList.GetVariationCopy(name, weight);
+			ParametricVariation<T>* parVar = dynamic_cast<ParametricVariation<T>*>(var);
+
+			if (!var)
+				AddToReport("Unsupported variation: " + name);
+
+			for (j = 0; j < paramCount && c.m_Ok; j++)
+			{
+				size_t paramIndex = 0;
+				string paramName = c.GetStr();
+				T val = c.GetT();
+				auto owner = m_VariationList.GetParametricVariationByParam(paramName, paramIndex);
+
+				if (parVar && owner && owner->VariationId() == parVar->VariationId())
+					parVar->SetParamVal(paramName.c_str(), val);//By name, so overrides which normalize the value are called.
+			}
+
+			if (var && !xform.AddVariation(var))
+				delete var;
+		}
+
+		size_t motionCount = c.Get<uint32_t>();
+
+		for (i = 0; i < motionCount && c.m_Ok && depth == 0; i++)
+		{
+			Xform<T> motion(false);//Will only have valid values in fields stored for motion, all others will be EMPTYFIELD.
+			GetXform(c, motion, depth + 1);
+			xform.m_Motion.push_back(motion);
+		}
+	}
+
+	VariationList<T> m_VariationList;//The variation list used to make copies of variations to populate the embers with.
+};
+}
@@ -188,6 +188,28 @@ public:
 		return set;
 	}
 
+	/// <summary>
+	/// Continue a content hash with the points and weights of each curve.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	uint64_t Hash(uint64_t hash = HASH_SEED) const
+	{
+		for (size_t i = 0; i < 4; i++)
+		{
+			for (size_t j = 0; j < 4; j++)
+			{
+				hash = HashVal(m_Points[i][j].x, hash);
+				hash = HashVal(m_Points[i][j].y, hash);
+			}
+
+			for (glm::length_t j = 0; j < 4; j++)
+				hash = HashVal(m_Weights[i][j], hash);
+		}
+
+		return hash;
+	}
+
 	/// <summary>
 	/// Wrapper around calling BezierSolve() on each of the 4 weight and point vectors.
 	/// </summary>
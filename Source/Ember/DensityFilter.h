@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SpatialFilter.h"
+#include "MappedBuffer.h"
 
 /// <summary>
 /// DensityFilter class.
@@ -344,4 +345,125 @@ private:
 	vector<T> m_Widths;
 	vector<uint> m_CoefIndices;
 };
+/// <summary>
+/// Summed-area table of the hit counts in a band of rows of a histogram, used to count the hits in the
+/// supersample sized box around each bucket during density filtering in constant time.
+/// Each element is the sum of the alpha channel of all buckets in the band above and to the left of it, inclusive.
+/// The table has an extra leading row and column of zeroes so lookups need no special cases at the edges.
+/// Sums are kept as 32-bit fixed point with SAT_FRAC_BITS fractional bits and are allowed to wrap around.
+/// Because the table is only ever used to take differences, the sum of any box is still exact, as long as
+/// the box itself holds less than 2^(32 - SAT_FRAC_BITS) hits. Each bucket is clamped to a caller supplied
+/// maximum to guarantee that, which is chosen so any box containing a clamped bucket selects the last kernel regardless.
+/// </summary>
+class EMBER_API SummedAreaTable
+{
+public:
+	/// <summary>
+	/// Default constructor which creates an empty table.
+	/// </summary>
+	SummedAreaTable()
+	{
+		m_Width = m_RowStart = m_RowEnd = 0;
+	}
+
+	/// <summary>
+	/// Build the table from the hit counts returned by a function, for the rows in the range [rowStart, rowEnd).
+	/// Rows are summed horizontally in parallel, then blocks of columns are summed vertically in parallel.
+	/// </summary>
+	/// <param name="hits">A function which takes the index of a bucket and returns its hit count</param>
+	/// <param name="width">The width of the histogram</param>
+	/// <param name="rowStart">The first row of the histogram to include</param>
+	/// <param name="rowEnd">One past the last row of the histogram to include</param>
+	/// <param name="maxHits">The value to clamp the hit count of each bucket to</param>
+	template <typename hitsFunc>
+	void Build(hitsFunc hits, size_t width, size_t rowStart, size_t rowEnd, double maxHits)
+	{
+		size_t stride = width + 1;
+		size_t height = rowEnd - rowStart;
+		size_t blockCount = (stride + 63) / 64;
+		double scale = double(1 << SAT_FRAC_BITS);
+		double maxFixed = std::min(maxHits * scale, double(std::numeric_limits<uint>::max()));
+		m_Width = width;
+		m_RowStart = rowStart;
+		m_RowEnd = rowEnd;
+		m_Sums.resize(stride * (height + 1));
+		std::fill(m_Sums.data(), m_Sums.data() + stride, 0u);
+		parallel_for(size_t(0), height, [&] (size_t j)
+		{
+			uint sum = 0;
+			uint* row = m_Sums.data() + ((j + 1) * stride);
+			size_t bucketRowStart = (rowStart + j) * width;
+			row[0] = 0;
+
+			for (size_t i = 0; i < width; i++)
+				row[i + 1] = (sum += uint(Clamp<double>(double(hits(bucketRowStart + i)) * scale, 0, maxFixed) + 0.5));
+		});
+		parallel_for(size_t(0), blockCount, [&] (size_t block)
+		{
+			size_t start = block * 64;
+			size_t end = std::min(start + 64, stride);
+
+			for (size_t j = 2; j <= height; j++)
+			{
+				uint* row = m_Sums.data() + (j * stride);
+				const uint* prevRow = row - stride;
+
+				for (size_t i = start; i < end; i++)
+					row[i] += prevRow[i];
+			}
+		});
+	}
+
+	/// <summary>
+	/// Return the sum of the hits in the box with the specified inclusive bounds.
+	/// The rows are rows of the histogram and must be within the band the table was built for.
+	/// </summary>
+	/// <param name="left">The leftmost column of the box</param>
+	/// <param name="top">The topmost row of the box</param>
+	/// <param name="right">The rightmost column of the box</param>
+	/// <param name="bottom">The bottommost row of the box</param>
+	/// <returns>The sum of the hits in the box</returns>
+	inline double Sum(size_t left, size_t top, size_t right, size_t bottom) const
+	{
+		size_t stride = m_Width + 1;
+		const uint* topRow = m_Sums.data() + ((top - m_RowStart) * stride);
+		const uint* bottomRow = m_Sums.data() + ((bottom + 1 - m_RowStart) * stride);
+		uint sum = (bottomRow[right + 1] - bottomRow[left]) - (topRow[right + 1] - topRow[left]);//Unsigned wraparound cancels out.
+		return double(sum) * (1.0 / double(1 << SAT_FRAC_BITS));
+	}
+
+	/// <summary>
+	/// Free the table.
+	/// </summary>
+	void Clear()
+	{
+		m_Sums.resize(0);
+		m_Sums.shrink_to_fit();
+		m_Width = m_RowStart = m_RowEnd = 0;
+	}
+
+	/// <summary>
+	/// Set whether the table is stored in a temporary memory mapped file.
+	/// </summary>
+	/// <param name="fileBacked">True to store the table in a memory mapped file, false to store it on the heap.</param>
+	/// <param name="path">The folder to create the file in. If empty, the system temporary folder is used.</param>
+	void Backing(bool fileBacked, const string& path)
+	{
+		m_Sums.Backing(fileBacked, path);
+	}
+
+	/// <summary>
+	/// Accessors.
+	/// </summary>
+	inline size_t Width() const { return m_Width; }
+	inline size_t RowStart() const { return m_RowStart; }
+	inline size_t RowEnd() const { return m_RowEnd; }
+	inline size_t SizeBytes() const { return m_Sums.SizeBytes(); }
+
+private:
+	size_t m_Width;
+	size_t m_RowStart;
+	size_t m_RowEnd;
+	MappedBuffer<uint> m_Sums;
+};
 }
@@ -30,6 +30,8 @@ template<> CriticalSection QTIsaac<ISAAC_SIZE, ISAAC_INT>::m_CS = CriticalSectio
 #include "EmberMotion.h"
 #include "EmberToXml.h"
 #include "XmlToEmber.h"
+#include "EmberToBinary.h"
+#include "BinaryToEmber.h"
 #include "SpatialFilter.h"
 #include "DensityFilter.h"
 #include "TemporalFilter.h"
@@ -416,7 +418,9 @@ uint Timing::m_ProcessorCount;
 	template EMBER_API class CarToRas<T>; \
 	template EMBER_API class Curves<T>; \
 	template EMBER_API class XmlToEmber<T>; \
-	template EMBER_API class EmberToXml<T>;
+	template EMBER_API class EmberToXml<T>; \
+	template EMBER_API class EmberToBinary<T>; \
+	template EMBER_API class BinaryToEmber<T>;
 
 EXPORT_SINGLE_TYPE_EMBER(float)
 
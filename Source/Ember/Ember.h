@@ -715,6 +715,9 @@ public:
 		T bgAlphaSave = m_Background.a;
 		T coefSave[2] {0, 0};
 		vector<Xform<T>*> xformVec;
+		vector<v2T> cxMag(embers[0].m_AffineInterp == eAffineInterp::AFFINE_INTERP_LOG ? size : 0);//Only needed for log interpolation, and shared by all xforms.
+		vector<v2T> cxAng(cxMag.size());
+		vector<v2T> cxTrn(cxMag.size());
 
 		//Palette and others
 		if (embers[0].m_PaletteInterp == ePaletteInterp::INTERP_HSV)
@@ -793,31 +796,55 @@ public:
 		SetProjFunc();
 		//An extra step needed here due to the OOD that was not needed in the original.
 		//A small price to pay for the conveniences it affords us elsewhere.
-		//First clear the xforms, and find out the max number of xforms in all of the embers in the list.
-		m_Xforms.clear();
+		//First find out the max number of xforms in all of the embers in the list.
 		maxXformCount = Interpolater<T>::MaxXformCount(embers, size);//Max number of standard transforms in embers, excluding final.
-		//m_Xforms.reserve(maxXformCount);
 		final = Interpolater<T>::AnyFinalPresent(embers, size);//Did any embers have a final xform?
 		totalXformCount = maxXformCount + (final ? 1 : 0);
-		xformVec.reserve(size);
 
-		//Populate the xform list member such that each element is a merge of all of the xforms at that position in all of the embers.
-		for (size_t i = 0; i < totalXformCount; i++)//For each xform to populate.
+		//When interpolating many times between the same embers, such as for each temporal sample of a motion blurred frame,
+		//this ember will already hold the merged xforms from the last call. Reuse them and their variations
+		//rather than deleting and copying them again, since every value in them is overwritten below.
+		if (MergedXformsMatch(embers, size, totalXformCount))
+		{
+			for (size_t i = 0; i < totalXformCount; i++)
+			{
+				Xform<T>* xform = GetTotalXform(i);
+				xform->m_ColorY = 0;//Reset the values which a newly merged xform would have as defaults.
+				xform->m_DirectColor = 1;
+				xform->m_Wind[0] = 0;
+				xform->m_Wind[1] = 0;
+				xform->m_MotionFunc = eMotion::MOTION_SIN;
+				xform->m_MotionFreq = 0;
+				xform->m_MotionOffset = 0;
+				xform->m_Motion.clear();
+				xform->m_Name.clear();
+				xform->ClearXaos();
+			}
+		}
+		else
 		{
-			for (size_t j = 0; j < size; j++)//For each ember in the list.
+			//Clear the xforms and rebuild them.
+			m_Xforms.clear();
+			xformVec.reserve(size);
+
+			//Populate the xform list member such that each element is a merge of all of the xforms at that position in all of the embers.
+			for (size_t i = 0; i < totalXformCount; i++)//For each xform to populate.
 			{
-				if (i < embers[j].TotalXformCount())//Xform in this position in this ember.
+				for (size_t j = 0; j < size; j++)//For each ember in the list.
 				{
-					xformVec.push_back(embers[j].GetTotalXform(i));//Temporary list to pass to MergeXforms().
+					if (i < embers[j].TotalXformCount())//Xform in this position in this ember.
+					{
+						xformVec.push_back(embers[j].GetTotalXform(i));//Temporary list to pass to MergeXforms().
+					}
 				}
-			}
 
-			if (i < maxXformCount)//Working with standard xforms?
-				AddXform(Interpolater<T>::MergeXforms(xformVec, true));//Merge, set weights to zero, and add to the xform list.
-			else if (final)//Or is it the final xform (i will be == maxXformCount)?
-				m_FinalXform = Interpolater<T>::MergeXforms(xformVec, true);
+				if (i < maxXformCount)//Working with standard xforms?
+					AddXform(Interpolater<T>::MergeXforms(xformVec, true));//Merge, set weights to zero, and add to the xform list.
+				else if (final)//Or is it the final xform (i will be == maxXformCount)?
+					m_FinalXform = Interpolater<T>::MergeXforms(xformVec, true);
 
-			xformVec.clear();
+				xformVec.clear();
+			}
 		}
 
 		//Now have a merged list, so interpolate the weight values.
@@ -890,9 +917,6 @@ public:
 			//Interp affine and post.
 			if (m_AffineInterp == eAffineInterp::AFFINE_INTERP_LOG)
 			{
-				vector<v2T> cxMag(size);
-				vector<v2T> cxAng(size);
-				vector<v2T> cxTrn(size);
 				thisXform->m_Affine.m_Mat = m23T(0);
 				//Affine part.
 				Interpolater<T>::ConvertLinearToPolar(embers, size, i, 0, cxAng, cxMag, cxTrn);
@@ -1450,6 +1474,138 @@ public:
 		m_Edits = nullptr;
 	}
 
+	/// <summary>
+	/// Compute a content hash of everything in this ember which affects where points land:
+	/// the geometry of all xforms including the final one.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	uint64_t GeometryHash(uint64_t hash = HASH_SEED) const
+	{
+		hash = HashVal(m_Xforms.size(), hash);
+
+		for (auto& xform : m_Xforms)
+			hash = xform.GeometryHash(hash);
+
+		hash = HashVal(UseFinalXform(), hash);
+
+		if (UseFinalXform())
+			hash = m_FinalXform.GeometryHash(hash);
+
+		return hash;
+	}
+
+	/// <summary>
+	/// Compute a content hash of everything in this ember which affects color:
+	/// the palette, color curves, the color values of all xforms, and the parameters used in final accumulation.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <param name="palette">Whether to include the palette and palette mode, which an index histogram does not depend on. Default: true.</param>
+	/// <returns>The hash</returns>
+	uint64_t ColorHash(uint64_t hash = HASH_SEED, bool palette = true) const
+	{
+		for (auto& xform : m_Xforms)
+			hash = xform.ColorHash(hash);
+
+		if (UseFinalXform())
+			hash = m_FinalXform.ColorHash(hash);
+
+		if (palette)
+		{
+			hash = m_Palette.Hash(hash);
+			hash = HashVal(m_PaletteMode, hash);
+		}
+
+		hash = m_Curves.Hash(hash);
+		hash = HashVal(m_Brightness, hash);
+		hash = HashVal(m_Gamma, hash);
+		hash = HashVal(m_GammaThresh, hash);
+		hash = HashVal(m_Vibrancy, hash);
+		hash = HashVal(m_HighlightPower, hash);
+
+		for (glm::length_t i = 0; i < 4; i++)
+			hash = HashVal(m_Background[i], hash);
+
+		return hash;
+	}
+
+	/// <summary>
+	/// Compute a content hash of the size of the output image and the camera which maps points to it.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	uint64_t CameraHash(uint64_t hash = HASH_SEED) const
+	{
+		hash = HashVal(m_FinalRasW, hash);
+		hash = HashVal(m_FinalRasH, hash);
+		hash = HashVal(m_CenterX, hash);
+		hash = HashVal(m_CenterY, hash);
+		hash = HashVal(m_RotCenterY, hash);
+		hash = HashVal(m_PixelsPerUnit, hash);
+		hash = HashVal(m_Zoom, hash);
+		hash = HashVal(m_Rotate, hash);
+		hash = HashVal(m_CamZPos, hash);
+		hash = HashVal(m_CamPerspective, hash);
+		hash = HashVal(m_CamYaw, hash);
+		hash = HashVal(m_CamPitch, hash);
+		return HashVal(m_CamDepthBlur, hash);
+	}
+
+	/// <summary>
+	/// Compute a content hash of the filtering and sampling parameters:
+	/// the spatial, temporal and density estimation filters, along with the quality and number of samples.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	uint64_t FilterHash(uint64_t hash = HASH_SEED) const
+	{
+		hash = HashVal(m_SpatialFilterType, hash);
+		hash = HashVal(m_SpatialFilterRadius, hash);
+		hash = HashVal(m_TemporalFilterType, hash);
+		hash = HashVal(m_TemporalFilterWidth, hash);
+		hash = HashVal(m_TemporalFilterExp, hash);
+		hash = HashVal(m_MinRadDE, hash);
+		hash = HashVal(m_MaxRadDE, hash);
+		hash = HashVal(m_CurveDE, hash);
+		hash = HashVal(m_Supersample, hash);
+		hash = HashVal(m_TemporalSamples, hash);
+		hash = HashVal(m_Quality, hash);
+		hash = HashVal(m_SubBatchSize, hash);
+		return HashVal(m_FuseCount, hash);
+	}
+
+	/// <summary>
+	/// Compute a content hash of everything in this ember which affects rendering.
+	/// This is the combination of the geometry, color, camera and filter hashes, along with the time and motion elements.
+	/// The name, index, parent filename and edits are not included, nor are the interpolation types since they only apply
+	/// when interpolating between embers.
+	/// Values are hashed as their exact bits, so the result is stable across runs, but differs between float and double embers.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <param name="palette">Whether to include the palette and palette mode. Default: true.</param>
+	/// <returns>The hash</returns>
+	uint64_t Hash(uint64_t hash = HASH_SEED, bool palette = true) const
+	{
+		hash = FilterHash(CameraHash(ColorHash(GeometryHash(hash), palette)));
+		hash = HashVal(m_Time, hash);
+		hash = HashVal(m_EmberMotionElements.size(), hash);
+
+		for (auto& motion : m_EmberMotionElements)
+		{
+			hash = HashVal(motion.m_MotionFunc, hash);
+			hash = HashVal(motion.m_MotionFreq, hash);
+			hash = HashVal(motion.m_MotionOffset, hash);
+
+			for (auto& param : motion.m_MotionParams)
+			{
+				hash = HashVal(param.first, hash);
+				hash = HashVal(param.second, hash);
+			}
+		}
+
+		return hash;
+	}
+
 	/// <summary>
 	/// Return a string representation of this ember.
 	/// </summary>
@@ -1749,6 +1905,73 @@ private:
 	//Xml field: "finalxform".
 	Xform<T> m_FinalXform;
 
+	/// <summary>
+	/// Determine whether the xforms of this ember already have exactly the variations, in the same order,
+	/// that Interpolate() would give them by merging the xforms in the same positions in the specified embers.
+	/// This is the case when this ember is the result of a previous interpolation between embers with the same structure.
+	/// The merge is simulated using only variation IDs, so nothing is allocated.
+	/// </summary>
+	/// <param name="embers">The list of embers being interpolated</param>
+	/// <param name="size">The size of the list</param>
+	/// <param name="totalXformCount">The number of merged xforms, including final</param>
+	/// <returns>True if the xforms of this ember can be reused as the merged xforms, else false.</returns>
+	bool MergedXformsMatch(Ember<T>* embers, size_t size, size_t totalXformCount) const
+	{
+		if (TotalXformCount() != totalXformCount)
+			return false;
+
+		for (size_t i = 0; i < totalXformCount; i++)
+		{
+			eVariationId ids[3][MAX_VARS_PER_XFORM];//Pre, regular and post.
+			size_t counts[3] = { 0, 0, 0 };
+			Xform<T>* xform = GetTotalXform(i);
+
+			for (size_t j = 0; j < size; j++)
+			{
+				if (i >= embers[j].TotalXformCount())
+					continue;
+
+				Xform<T>* tempXform = embers[j].GetTotalXform(i);
+
+				for (size_t k = 0; k < tempXform->TotalVariationCount(); k++)
+				{
+					Variation<T>* var = tempXform->GetVariation(k);
+					eVariationId id = var->VariationId();
+					size_t type = var->VarType() == VARTYPE_PRE ? 0 : (var->VarType() == VARTYPE_POST ? 2 : 1);
+					bool found = false;
+
+					for (size_t t = 0; t < 3 && !found; t++)
+						found = std::find(ids[t], ids[t] + counts[t], id) != ids[t] + counts[t];
+
+					//Mirror Xform::AddVariation(), which ignores duplicates and anything past the max, and keeps flatten last.
+					if (found || counts[type] == MAX_VARS_PER_XFORM)
+						continue;
+
+					ids[type][counts[type]++] = id;
+
+					for (size_t l = 0; l < counts[type] - 1; l++)
+					{
+						if (ids[type][l] == VAR_FLATTEN || ids[type][l] == VAR_PRE_FLATTEN || ids[type][l] == VAR_POST_FLATTEN)
+						{
+							std::swap(ids[type][l], ids[type][counts[type] - 1]);
+							break;
+						}
+					}
+				}
+			}
+
+			if (xform->PreVariationCount() != counts[0] || xform->VariationCount() != counts[1] || xform->PostVariationCount() != counts[2])
+				return false;
+
+			for (size_t t = 0, k = 0; t < 3; t++)
+				for (size_t l = 0; l < counts[t]; l++, k++)
+					if (xform->GetVariation(k)->VariationId() != ids[t][l])
+						return false;
+		}
+
+		return true;
+	}
+
 	/// <summary>
 	/// Interpolation function that takes the address of a member variable of type T as a template parameter.
 	/// This is an alternative to using macros.
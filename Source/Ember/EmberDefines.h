@@ -59,6 +59,17 @@ namespace EmberNs
 #define COLORMAP_LENGTH_MINUS_1 255
 #define WHITE 255
 #define DEFAULT_SBS (1024 * 10)
+#define HIST_BLOCK_SIZE 4096//The number of buckets per block when tracking which parts of a per-thread histogram have been written to.
+#define ITER_BATCH_SIZE 32//The number of trajectories the batch iterator advances in lockstep.
+#define DE_TILE_SIZE 64//The minimum width and height of the tiles used by the tiled density filter.
+#define SPATIAL_BAND_ROWS 64//The minimum number of output rows the separable spatial filter resolves at a time.
+#define SAT_FRAC_BITS 8//The number of fractional bits in the fixed point sums of the summed-area table used by density filtering.
+#define SPATIAL_TILE_SIZE 32//The width and height in output pixels of the tiles used by the non-separable spatial filter resolve.
+#define HIST_HIT_BUFFER_SIZE (1024 * 64)//The number of hits each thread collects before sorting them and adding them to an out of core histogram.
+#define PACKED_HIST_SCALE 256//The number of mantissa steps per full hit in a packed histogram bucket whose exponent is zero.
+#define PACKED_HIST_MANT_BITS 14//The number of bits in each of the four channel mantissas of a packed histogram bucket.
+#define PACKED_HIST_MANT_MAX 0x3FFFu
+#define PACKED_HIST_EXP_COUNT 64//The number of exponents a packed histogram bucket can have, stored in the 6 bits above the mantissas.
 //#define XC(c) ((const xmlChar*)(c))
 #define XC(c) (reinterpret_cast<const xmlChar*>(c))
 #define CX(c) (reinterpret_cast<char*>(c))
@@ -128,6 +139,7 @@ enum class eProcessAction : uint { NOTHING = 0, ACCUM_ONLY = 1, FILTER_AND_ACCUM
 enum class eProcessState : uint { NONE = 0, ITER_STARTED = 1, ITER_DONE = 2, FILTER_DONE = 3, ACCUM_DONE = 4 };
 enum class eInteractiveFilter : uint { FILTER_LOG = 0, FILTER_DE = 1 };
 enum class eScaleType : uint { SCALE_NONE = 0, SCALE_WIDTH = 1, SCALE_HEIGHT = 2 };
+enum class eBufferAdvice : uint { NORMAL = 0, RANDOM = 1, SEQUENTIAL = 2 };
 enum class eRenderStatus : uint { RENDER_OK = 0, RENDER_ERROR = 1, RENDER_ABORT = 2 };
 enum class eEmberMotionParam : uint//These must remain in this order forever.
 {
@@ -26,14 +26,24 @@
 	#define EMBER_OS "LNX"
 #endif
 
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
 //Standard headers.
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <complex>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <inttypes.h>
 #include <iostream>
 #include <iomanip>
@@ -46,6 +56,7 @@
 #include <map>
 #include <math.h>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <ostream>
 #include <sstream>
@@ -59,8 +70,10 @@
 //Third party headers.
 #ifdef _WIN32
 	#include "libxml/parser.h"
+	#include "libxml/xmlreader.h"
 #else
 	#include "libxml2/libxml/parser.h"
+	#include "libxml2/libxml/xmlreader.h"
 #endif
 
 //Intel's Threading Building Blocks is what's used for all threading.
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "Utils.h"
+#include "VariationList.h"
+#include "Ember.h"
+
+/// <summary>
+/// EmberToBinary class.
+/// </summary>
+
+namespace EmberNs
+{
+#define BINARY_EMBER_MAGIC "EMBRFLAM"
+#define BINARY_EMBER_VERSION 1
+#define BINARY_EMBER_ENDIAN 0x01020304u
+#define BINARY_EMBER_EXTENSION ".bflame"
+
+/// <summary>
+/// Class for converting ember objects to a compact binary format which is much faster to write and read than Xml.
+/// The file is a header followed by one record per ember. Each record is prefixed with its length, so a reader can skip
+/// records, and fields added to the end of a record by later versions are ignored by earlier readers.
+/// All floating point values are stored as doubles regardless of the template type, and all values are stored in the
+/// native byte order, which the header records so files aren't misread on a machine of the other order.
+/// Variations and their params are stored by name so the files survive variations being added or renumbered.
+/// Everything an Xml file holds is stored, and palettes keep full precision rather than being quantized to hex.
+/// Files with the extension given by BINARY_EMBER_EXTENSION are read by the command line programs in place of Xml.
+/// Read with BinaryToEmber.
+/// Template argument expected to be float or double.
+/// </summary>
+template <typename T>
+class EMBER_API EmberToBinary : public EmberReport
+{
+public:
+	/// <summary>
+	/// Empty constructor.
+	/// </summary>
+	EmberToBinary()
+	{
+	}
+
+	/// <summary>
+	/// Determine whether a filename has the binary ember extension.
+	/// </summary>
+	/// <param name="filename">The filename to check</param>
+	/// <returns>True if the filename ends with BINARY_EMBER_EXTENSION, ignoring case, else false.</returns>
+	static bool IsBinaryFilename(const string& filename)
+	{
+		size_t len = strlen(BINARY_EMBER_EXTENSION);
+		return filename.size() > len && !_stricmp(filename.c_str() + filename.size() - len, BINARY_EMBER_EXTENSION);
+	}
+
+	/// <summary>
+	/// Save a vector of embers to the specified file.
+	/// </summary>
+	/// <param name="filename">Full path and filename</param>
+	/// <param name="embers">The vector of embers to save</param>
+	/// <param name="doEdits">If true include the edit docs, else don't.</param>
+	/// <param name="append">If true, append to the file if it already exists, else create a new file. Default: false.</param>
+	/// <returns>True if successful, else false</returns>
+	bool Save(const string& filename, vector<Ember<T>>& embers, bool doEdits, bool append = false)
+	{
+		bool b = false;
+		string buf;
+		ofstream f;
+		const char* loc = __FUNCTION__;
+		ClearErrorReport();
+
+		try
+		{
+			ifstream existing(filename, ios::binary | ios::ate);
+			bool writeHeader = !append || !existing.is_open() || existing.tellg() <= 0;
+			existing.close();
+			f.open(filename, ios::binary | (writeHeader ? ios::trunc : ios::app));
+
+			if (f.is_open())
+			{
+				if (writeHeader)
+					Header(buf);
+
+				for (auto& ember : embers)
+				{
+					Record(ember, buf, doEdits);
+
+					if (buf.size() > (1 << 20))//Write in large blocks rather than holding the whole file in memory.
+					{
+						f.write(buf.data(), buf.size());
+						buf.clear();
+					}
+				}
+
+				f.write(buf.data(), buf.size());
+				b = !f.fail();
+				f.close();
+			}
+
+			if (!b)
+				AddToReport(string(loc) + " : Error writing flame file " + filename);
+		}
+		catch (const std::exception& e)
+		{
+			AddToReport(string(loc) + " : Error writing flame file " + filename + ": " + e.what());
+			b = false;
+		}
+
+		return b;
+	}
+
+	/// <summary>
+	/// Append the file header to a buffer.
+	/// </summary>
+	/// <param name="buf">The buffer to append to</param>
+	static void Header(string& buf)
+	{
+		buf.append(BINARY_EMBER_MAGIC, 8);
+		Put<uint32_t>(buf, BINARY_EMBER_VERSION);
+		Put<uint32_t>(buf, BINARY_EMBER_ENDIAN);
+	}
+
+	/// <summary>
+	/// Append the length prefixed binary record of an ember to a buffer.
+	/// </summary>
+	/// <param name="ember">The ember to write</param>
+	/// <param name="buf">The buffer to append to</param>
+	/// <param name="doEdits">If true include the edit doc, else don't.</param>
+	void Record(Ember<T>& ember, string& buf, bool doEdits)
+	{
+		size_t i, j, start = buf.size();
+		Put<uint64_t>(buf, 0);//Length, filled in at the end.
+		PutStr(buf, ember.m_Name);
+		Put<double>(buf, ember.m_Time);
+		Put<uint64_t>(buf, ember.m_FinalRasW);
+		Put<uint64_t>(buf, ember.m_FinalRasH);
+		Put<double>(buf, ember.m_CenterX);
+		Put<double>(buf, ember.m_CenterY);
+		Put<double>(buf, ember.m_PixelsPerUnit);
+		Put<double>(buf, ember.m_Zoom);
+		Put<double>(buf, ember.m_Rotate);
+		Put<uint64_t>(buf, ember.m_Supersample);
+		Put<double>(buf, ember.m_SpatialFilterRadius);
+		Put<uint32_t>(buf, uint32_t(ember.m_SpatialFilterType));
+		Put<uint32_t>(buf, uint32_t(ember.m_TemporalFilterType));
+		Put<double>(buf, ember.m_TemporalFilterExp);
+		Put<double>(buf, ember.m_TemporalFilterWidth);
+		Put<double>(buf, ember.m_Quality);
+		Put<uint64_t>(buf, ember.m_TemporalSamples);
+		Put<uint64_t>(buf, ember.m_SubBatchSize);
+		Put<uint64_t>(buf, ember.m_FuseCount);
+		Put<double>(buf, ember.m_Background.r);
+		Put<double>(buf, ember.m_Background.g);
+		Put<double>(buf, ember.m_Background.b);
+		Put<double>(buf, ember.m_Brightness);
+		Put<double>(buf, ember.m_Gamma);
+		Put<double>(buf, ember.m_HighlightPower);
+		Put<double>(buf, ember.m_Vibrancy);
+		Put<double>(buf, ember.m_MaxRadDE);
+		Put<double>(buf, ember.m_MinRadDE);
+		Put<double>(buf, ember.m_CurveDE);
+		Put<double>(buf, ember.m_GammaThresh);
+		Put<double>(buf, ember.m_CamZPos);
+		Put<double>(buf, ember.m_CamPerspective);
+		Put<double>(buf, ember.m_CamYaw);
+		Put<double>(buf, ember.m_CamPitch);
+		Put<double>(buf, ember.m_CamDepthBlur);
+		Put<uint32_t>(buf, uint32_t(ember.m_PaletteMode));
+		Put<uint32_t>(buf, uint32_t(ember.m_Interp));
+		Put<uint32_t>(buf, uint32_t(ember.m_AffineInterp));
+		Put<uint32_t>(buf, uint32_t(ember.m_PaletteInterp));
+
+		for (glm::length_t ci = 0; ci < 4; ci++)
+		{
+			for (glm::length_t cj = 0; cj < 4; cj++)
+			{
+				Put<double>(buf, ember.m_Curves.m_Points[ci][cj].x);
+				Put<double>(buf, ember.m_Curves.m_Points[ci][cj].y);
+				Put<double>(buf, ember.m_Curves.m_Weights[ci][cj]);
+			}
+		}
+
+		Put<uint32_t>(buf, uint32_t(ember.m_EmberMotionElements.size()));
+
+		for (auto& motion : ember.m_EmberMotionElements)
+		{
+			Put<double>(buf, motion.m_MotionFreq);
+			Put<double>(buf, motion.m_MotionOffset);
+			Put<uint32_t>(buf, uint32_t(motion.m_MotionFunc));
+			Put<uint32_t>(buf, uint32_t(motion.m_MotionParams.size()));
+
+			for (auto& param : motion.m_MotionParams)
+			{
+				Put<uint32_t>(buf, uint32_t(param.first));
+				Put<double>(buf, param.second);
+			}
+		}
+
+		Put<uint32_t>(buf, uint32_t(ember.XformCount()));
+		Put<uint8_t>(buf, ember.UseFinalXform() ? 1 : 0);
+
+		for (i = 0; i < ember.XformCount(); i++)
+			PutXform(buf, *ember.GetXform(i), ember.XformCount(), false);
+
+		if (ember.UseFinalXform())
+			PutXform(buf, *ember.NonConstFinalXform(), ember.XformCount(), true);
+
+		//Like Xml, only embedded palettes are stored. Floats keep far more precision than the 8-bit Xml palettes.
+		Put<uint32_t>(buf, uint32_t(ember.m_Palette.Size()));
+
+		for (i = 0; i < ember.m_Palette.Size(); i++)
+			for (j = 0; j < 4; j++)
+				Put<float>(buf, float(ember.m_Palette[i][glm::length_t(j)]));
+
+		if (doEdits && ember.m_Edits)
+		{
+			xmlChar* mem = nullptr;
+			int size = 0;
+			xmlDocDumpMemory(ember.m_Edits, &mem, &size);
+			PutStr(buf, mem ? string(CCX(mem), size) : string());
+
+			if (mem)
+				xmlFree(mem);
+		}
+		else
+			PutStr(buf, string());
+
+		uint64_t len = uint64_t(buf.size() - start - sizeof(uint64_t));
+		memcpy(&buf[start], &len, sizeof(len));
+	}
+
+private:
+	/// <summary>
+	/// Append the binary form of an xform to a buffer.
+	/// </summary>
+	/// <param name="buf">The buffer to append to</param>
+	/// <param name="xform">The xform to write</param>
+	/// <param name="xformCount">The number of non-final xforms in the ember to which this xform belongs. Used for xaos.</param>
+	/// <param name="isFinal">True if the xform is the final xform in the ember, else false.</param>
+	void PutXform(string& buf, Xform<T>& xform, size_t xformCount, bool isFinal)
+	{
+		size_t i, j;
+		PutStr(buf, xform.m_Name);
+		Put<double>(buf, xform.m_Weight);
+		Put<double>(buf, xform.m_ColorX);
+		Put<double>(buf, xform.m_ColorY);
+		Put<double>(buf, xform.m_DirectColor);
+		Put<double>(buf, xform.m_ColorSpeed);
+		Put<double>(buf, xform.m_Opacity);
+		Put<double>(buf, xform.m_Animate);
+		Put<uint32_t>(buf, uint32_t(xform.m_MotionFunc));
+		Put<double>(buf, xform.m_MotionFreq);
+		Put<double>(buf, xform.m_MotionOffset);
+		Put<double>(buf, xform.m_Affine.A());
+		Put<double>(buf, xform.m_Affine.B());
+		Put<double>(buf, xform.m_Affine.C());
+		Put<double>(buf, xform.m_Affine.D());
+		Put<double>(buf, xform.m_Affine.E());
+		Put<double>(buf, xform.m_Affine.F());
+		Put<double>(buf, xform.m_Post.A());
+		Put<double>(buf, xform.m_Post.B());
+		Put<double>(buf, xform.m_Post.C());
+		Put<double>(buf, xform.m_Post.D());
+		Put<double>(buf, xform.m_Post.E());
+		Put<double>(buf, xform.m_Post.F());
+		size_t xaosCount = !isFinal && xform.XaosPresent() ? xformCount : 0;
+		Put<uint32_t>(buf, uint32_t(xaosCount));
+
+		for (i = 0; i < xaosCount; i++)
+			Put<double>(buf, xform.Xaos(i));
+
+		Put<uint32_t>(buf, uint32_t(xform.TotalVariationCount()));
+
+		for (i = 0; i < xform.TotalVariationCount(); i++)
+		{
+			Variation<T>* var = xform.GetVariation(i);
+			PutStr(buf, var->Name());
+			Put<double>(buf, var->m_Weight);
+
+			if (ParametricVariation<T>* parVar = dynamic_cast<ParametricVariation<T>*>(var))
+			{
+				auto params = parVar->Params();
+				uint32_t count = 0;
+
+				for (j = 0; j < parVar->ParamCount(); j++)
+					if (!params[j].IsPrecalc())
+						count++;
+
+				Put<uint32_t>(buf, count);
+
+				for (j = 0; j < parVar->ParamCount(); j++)
+				{
+					if (!params[j].IsPrecalc())
+					{
+						PutStr(buf, params[j].Name());
+						Put<double>(buf, params[j].ParamVal());
+					}
+				}
+			}
+			else
+				Put<uint32_t>(buf, 0);
+		}
+
+		Put<uint32_t>(buf, uint32_t(xform.m_Motion.size()));
+
+		for (auto& motion : xform.m_Motion)
+			PutXform(buf, motion, 0, false);
+	}
+
+	/// <summary>
+	/// Append the raw bytes of a value to a buffer.
+	/// </summary>
+	/// <param name="buf">The buffer to append to</param>
+	/// <param name="val">The value to append</param>
+	template <typename valT>
+	static void Put(string& buf, valT val)
+	{
+		buf.append(reinterpret_cast<const char*>(&val), sizeof(val));
+	}
+
+	/// <summary>
+	/// Append a length prefixed string to a buffer.
+	/// </summary>
+	/// <param name="buf">The buffer to append to</param>
+	/// <param name="s">The string to append</param>
+	static void PutStr(string& buf, const string& s)
+	{
+		Put<uint32_t>(buf, uint32_t(s.size()));
+		buf.append(s);
+	}
+};
+}
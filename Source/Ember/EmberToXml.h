@@ -39,12 +39,13 @@ public:
 	/// <param name="append">If true, append to the file if it already exists, else create a new file.</param>
 	/// <param name="start">Whether a new file is to be started</param>
 	/// <param name="finish">Whether an existing file is to be ended</param>
+	/// <param name="extraAttributes">Any extra attributes to add to each ember's Xml tag. Default: none.</param>
 	/// <returns>True if successful, else false</returns>
-	bool Save(const string& filename, Ember<T>& ember, size_t printEditDepth, bool doEdits, bool intPalette, bool hexPalette, bool append = false, bool start = false, bool finish = false)
+	bool Save(const string& filename, Ember<T>& ember, size_t printEditDepth, bool doEdits, bool intPalette, bool hexPalette, bool append = false, bool start = false, bool finish = false, const string& extraAttributes = "")
 	{
 		vector<Ember<T>> vec;
 		vec.push_back(ember);
-		return Save(filename, vec, printEditDepth, doEdits, intPalette, hexPalette, append, start, finish);
+		return Save(filename, vec, printEditDepth, doEdits, intPalette, hexPalette, append, start, finish, extraAttributes);
 	}
 
 	/// <summary>
@@ -59,8 +60,9 @@ public:
 	/// <param name="append">If true, append to the file if it already exists, else create a new file.</param>
 	/// <param name="start">Whether a new file is to be started</param>
 	/// <param name="finish">Whether an existing file is to be ended</param>
+	/// <param name="extraAttributes">Any extra attributes to add to each ember's Xml tag. Default: none.</param>
 	/// <returns>True if successful, else false</returns>
-	bool Save(const string& filename, vector<Ember<T>>& embers, size_t printEditDepth, bool doEdits, bool intPalette, bool hexPalette, bool append = false, bool start = false, bool finish = false)
+	bool Save(const string& filename, vector<Ember<T>>& embers, size_t printEditDepth, bool doEdits, bool intPalette, bool hexPalette, bool append = false, bool start = false, bool finish = false, const string& extraAttributes = "")
 	{
 		bool b = false;
 		bool hasTimes = false;
@@ -101,7 +103,7 @@ public:
 
 				for (auto& ember : embers)
 				{
-					string s = ToString(ember, "", printEditDepth, doEdits, intPalette, hexPalette);
+					string s = ToString(ember, extraAttributes, printEditDepth, doEdits, intPalette, hexPalette);
 					f.write(s.c_str(), s.size());
 				}
 
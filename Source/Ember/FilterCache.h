@@ -0,0 +1,182 @@
+#pragma once
+
+#include "DensityFilter.h"
+
+/// <summary>
+/// FilterCache class.
+/// </summary>
+
+namespace EmberNs
+{
+/// <summary>
+/// A thread safe cache of spatial and density filters which can be shared between renderers.
+/// A renderer only keeps the last filter it created, and rebuilds it whenever the next ember's filter
+/// parameters differ. When many renderers run at once over a batch of embers, each would rebuild the
+/// same handful of filters over and over. Instead, they can all draw from a single cache, which creates a filter
+/// the first time its parameters are requested and hands out the same instance every time after.
+/// Filters are created outside of the lock, so a slow one only holds up the renderers which asked for it.
+/// Those which ask for it while it's being created wait for it rather than creating it again.
+/// Filters are never modified once created, so it's safe for multiple renderers to use one simultaneously.
+/// The least recently created filters are released once the cache holds more than MAX_CACHED_FILTERS of a type.
+/// Template argument expected to be float or double.
+/// </summary>
+template <typename bucketT>
+class EMBER_API FilterCache
+{
+public:
+	static const size_t MAX_CACHED_FILTERS = 32;
+
+	/// <summary>
+	/// Empty constructor.
+	/// </summary>
+	FilterCache()
+	{
+	}
+
+	/// <summary>
+	/// Get a density filter with the specified parameters, creating it if it doesn't already exist.
+	/// </summary>
+	/// <param name="minRad">The minimum filter radius</param>
+	/// <param name="maxRad">The maximum filter radius</param>
+	/// <param name="curve">The curve of the filter</param>
+	/// <param name="supersample">The supersample value of the ember being rendered</param>
+	/// <returns>The filter if it was found or successfully created, else nullptr.</returns>
+	shared_ptr<DensityFilter<bucketT>> GetDensityFilter(bucketT minRad, bucketT maxRad, bucketT curve, size_t supersample)
+	{
+		return Get(m_DensityFilters, std::make_tuple(minRad, maxRad, curve, supersample), [&]
+		{
+			auto filter = std::make_shared<DensityFilter<bucketT>>(minRad, maxRad, curve, supersample);
+			return filter->Create() ? filter : nullptr;
+		});
+	}
+
+	/// <summary>
+	/// Get a spatial filter with the specified parameters, creating it if it doesn't already exist.
+	/// The lookup is done on the requested radius, since the radius of the created filter may have been increased
+	/// if the requested one was too small.
+	/// </summary>
+	/// <param name="filterType">The type of filter to create</param>
+	/// <param name="filterRadius">The requested filter radius</param>
+	/// <param name="supersample">The supersample value of the ember being rendered</param>
+	/// <param name="pixelAspectRatio">The aspect ratio of the pixels</param>
+	/// <returns>The filter if it was found or successfully created, else nullptr.</returns>
+	shared_ptr<SpatialFilter<bucketT>> GetSpatialFilter(eSpatialFilterType filterType, bucketT filterRadius, size_t supersample, bucketT pixelAspectRatio)
+	{
+		return Get(m_SpatialFilters, std::make_tuple(filterType, filterRadius, supersample, pixelAspectRatio), [&]
+		{
+			return shared_ptr<SpatialFilter<bucketT>>(SpatialFilterCreator<bucketT>::Create(filterType, filterRadius, supersample, pixelAspectRatio));
+		});
+	}
+
+	/// <summary>
+	/// Release all cached filters. Renderers still using one keep it until they no longer need it.
+	/// </summary>
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_DensityFilters.clear();
+		m_SpatialFilters.clear();
+	}
+
+	/// <summary>
+	/// The total number of filters in the cache, including any still being created.
+	/// </summary>
+	/// <returns>The number of density filters plus the number of spatial filters</returns>
+	size_t Size()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_DensityFilters.size() + m_SpatialFilters.size();
+	}
+
+private:
+	/// <summary>
+	/// A cached filter along with the parameters it was requested with.
+	/// The filter is a future, so the entry can be added as a placeholder before the filter is created.
+	/// </summary>
+	template <typename filterT, typename keyT>
+	struct Entry
+	{
+		keyT m_Key;
+		std::shared_future<shared_ptr<filterT>> m_Filter;
+	};
+
+	typedef std::tuple<bucketT, bucketT, bucketT, size_t> DensityKey;
+	typedef std::tuple<eSpatialFilterType, bucketT, size_t, bucketT> SpatialKey;
+
+	/// <summary>
+	/// Get a filter from a list of entries, creating it if no entry matches.
+	/// Only the lookup and adding the placeholder entry are done under the lock. The first caller to request a filter
+	/// creates it, and any others requesting it in the meantime wait on its future.
+	/// If creation fails, its entry is removed so a later request tries again.
+	/// </summary>
+	/// <param name="entries">The entries of the type of filter to get</param>
+	/// <param name="key">The parameters of the filter</param>
+	/// <param name="create">Function which creates the filter, returning nullptr on failure</param>
+	/// <returns>The filter if it was found or successfully created, else nullptr.</returns>
+	template <typename filterT, typename keyT, typename createT>
+	shared_ptr<filterT> Get(std::deque<Entry<filterT, keyT>>& entries, const keyT& key, createT create)
+	{
+		std::promise<shared_ptr<filterT>> promise;
+		std::shared_future<shared_ptr<filterT>> future;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			for (auto& entry : entries)
+			{
+				if (entry.m_Key == key)
+				{
+					future = entry.m_Filter;
+					break;
+				}
+			}
+
+			if (!future.valid())
+			{
+				future = promise.get_future().share();
+				entries.push_back(Entry<filterT, keyT> { key, future });
+
+				if (entries.size() > MAX_CACHED_FILTERS)
+					entries.pop_front();
+
+				future = std::shared_future<shared_ptr<filterT>>();//Mark this caller as the one creating it.
+			}
+		}
+
+		if (future.valid())
+			return future.get();//Waits outside of the lock if another caller is still creating it.
+
+		shared_ptr<filterT> filter;
+
+		try
+		{
+			filter = create();
+		}
+		catch (...)
+		{
+		}
+
+		promise.set_value(filter);
+
+		if (!filter.get())
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			for (auto it = entries.begin(); it != entries.end(); ++it)
+			{
+				if (it->m_Key == key)
+				{
+					entries.erase(it);
+					break;
+				}
+			}
+		}
+
+		return filter;
+	}
+
+	std::mutex m_Mutex;
+	std::deque<Entry<DensityFilter<bucketT>, DensityKey>> m_DensityFilters;
+	std::deque<Entry<SpatialFilter<bucketT>, SpatialKey>> m_SpatialFilters;
+};
+}
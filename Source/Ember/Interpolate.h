@@ -22,6 +22,16 @@ template <typename T>
 class EMBER_API Interpolater
 {
 public:
+	/// <summary>
+	/// Default constructor which creates an interpolater with no aligned embers kept for InterpolateInPlace().
+	/// Instances are only needed for InterpolateInPlace(), everything else is static.
+	/// </summary>
+	Interpolater()
+		: m_Coefs(2)
+	{
+		Reset();
+	}
+
 	/// <summary>
 	/// Aligns the specified array of embers and stores in the output array.
 	/// This is used to prepare embers before interpolating them.
@@ -368,6 +378,8 @@ public:
 
 	/// <summary>
 	/// Interpolates the array of embers at a specified time and stores the result.
+	/// This aligns copies of the embers on every call. When interpolating the same embers
+	/// many times, use InterpolateInPlace() on an instance instead.
 	/// </summary>
 	/// <param name="embers">The embers array</param>
 	/// <param name="size">The size of the embers array</param>
@@ -382,10 +394,90 @@ public:
 			return;
 		}
 
-		size_t i1, i2;
+		size_t start;
 		vector<T> c(2);
 		Ember<T> localEmbers[4];
-		bool smoothFlag = false;
+		bool smoothFlag = Segment(embers, size, time, start, c);
+		//To interpolate the xforms, make copies of the source embers
+		//and ensure that they all have the same number of xforms before progressing.
+		Align(&embers[start], &localEmbers[0], smoothFlag ? 4 : 2);
+		InterpolateAligned(localEmbers, smoothFlag, embers[0].m_AffineInterp, time, stagger, c, result);
+	}
+
+	/// <summary>
+	/// Thin wrapper around InterpolateInPlace().
+	/// </summary>
+	/// <param name="embers">The vector of embers to interpolate</param>
+	/// <param name="time">The time position in the vector specifying the point of interpolation</param>
+	/// <param name="stagger">Stagger if > 0</param>
+	/// <param name="result">The interpolated result</param>
+	void InterpolateInPlace(vector<Ember<T>>& embers, T time, T stagger, Ember<T>& result)
+	{
+		InterpolateInPlace(embers.data(), embers.size(), time, stagger, result);
+	}
+
+	/// <summary>
+	/// Interpolates the array of embers at a specified time and stores the result, the same as Interpolate(),
+	/// but without allocating when called repeatedly with the same embers and result.
+	/// The aligned copies of the segment of embers being interpolated are kept and only
+	/// made again when time moves into a different segment, and the xforms and variations of result are
+	/// reused from the last call, so only the parameters, affines and palette of result are written.
+	/// This is intended for the many nearby times interpolated for the temporal samples of a frame, and the frames of an animation.
+	/// Reset() must be called if the contents of embers change between calls.
+	/// </summary>
+	/// <param name="embers">The embers array</param>
+	/// <param name="size">The size of the embers array</param>
+	/// <param name="time">The time position in the vector specifying the point of interpolation</param>
+	/// <param name="stagger">Stagger if > 0</param>
+	/// <param name="result">The interpolated result</param>
+	void InterpolateInPlace(Ember<T>* embers, size_t size, T time, T stagger, Ember<T>& result)
+	{
+		if (size == 1)
+		{
+			result = embers[0];//Deep copy.
+			return;
+		}
+
+		size_t start;
+		bool smoothFlag = Segment(embers, size, time, start, m_Coefs);
+
+		if (embers != m_Embers || size != m_Size || start != m_Start || smoothFlag != m_Smooth)
+		{
+			Align(&embers[start], &m_Aligned[0], smoothFlag ? 4 : 2);
+			m_Embers = embers;
+			m_Size = size;
+			m_Start = start;
+			m_Smooth = smoothFlag;
+		}
+
+		InterpolateAligned(m_Aligned, smoothFlag, embers[0].m_AffineInterp, time, stagger, m_Coefs, result);
+	}
+
+	/// <summary>
+	/// Discard the aligned embers kept by InterpolateInPlace() so that the next call aligns them again.
+	/// This must be called whenever the contents of the embers being interpolated change.
+	/// </summary>
+	void Reset()
+	{
+		m_Embers = nullptr;
+		m_Size = 0;
+		m_Start = 0;
+		m_Smooth = false;
+	}
+
+	/// <summary>
+	/// Find the segment of the embers array which contains the specified time, and the linear coefficients for interpolating within it.
+	/// Smooth interpolation is only used for a segment which has an ember on either side of it, else linear is used.
+	/// </summary>
+	/// <param name="embers">The embers array, which must have at least two elements</param>
+	/// <param name="size">The size of the embers array</param>
+	/// <param name="time">The time position in the array specifying the point of interpolation</param>
+	/// <param name="start">The index of the first ember to align and interpolate</param>
+	/// <param name="c">The vector to store the two linear coefficients in. Must have a size of 2.</param>
+	/// <returns>True if the four embers starting at start should be interpolated with Catmull-Rom, else false for linear interpolation of the two starting at start.</returns>
+	static bool Segment(Ember<T>* embers, size_t size, T time, size_t& start, vector<T>& c)
+	{
+		size_t i1, i2;
 
 		if (embers[0].m_Time >= time)
 		{
@@ -411,44 +503,39 @@ public:
 		c[0] = (embers[i2].m_Time - time) / (embers[i2].m_Time - embers[i1].m_Time);
 		c[1] = 1 - c[0];
 
-		//To interpolate the xforms, make copies of the source embers
-		//and ensure that they both have the same number of xforms before progressing.
-		if (embers[i1].m_Interp == eInterp::EMBER_INTERP_LINEAR)
+		//Smooth interpolation needs the embers before and after the segment.
+		//Revert to linear on the first and last segments.
+		if (embers[i1].m_Interp == eInterp::EMBER_INTERP_LINEAR || i1 == 0 || i2 == size - 1)
 		{
-			Align(&embers[i1], &localEmbers[0], 2);
-			smoothFlag = false;
+			start = i1;
+			return false;
 		}
-		else
-		{
-			if (i1 == 0)
-			{
-				//fprintf(stderr, "error: cannot use smooth interpolation on first segment.\n");
-				//fprintf(stderr, "reverting to linear interpolation.\n");
-				Align(&embers[i1], &localEmbers[0], 2);
-				smoothFlag = false;
-			}
 
-			if (i2 == size - 1)
-			{
-				//fprintf(stderr, "error: cannot use smooth interpolation on last segment.\n");
-				//fprintf(stderr, "reverting to linear interpolation.\n");
-				Align(&embers[i1], &localEmbers[0], 2);
-				smoothFlag = false;
-			}
-
-			Align(&embers[i1 - 1], &localEmbers[0], 4);//Should really be doing some sort of checking here to ensure the ember vectors have 4 elements.
-			smoothFlag = true;
-		}
+		start = i1 - 1;
+		return true;
+	}
 
+	/// <summary>
+	/// Interpolate a segment of aligned embers found with Segment() and store the result.
+	/// </summary>
+	/// <param name="aligned">The aligned embers, which must have four elements if smoothFlag is true, else two</param>
+	/// <param name="smoothFlag">True to use Catmull-Rom interpolation, else linear</param>
+	/// <param name="affineInterp">The affine interpolation type to store in the result</param>
+	/// <param name="time">The time position of the interpolation</param>
+	/// <param name="stagger">Stagger if > 0</param>
+	/// <param name="c">The linear coefficients returned by Segment()</param>
+	/// <param name="result">The interpolated result</param>
+	static void InterpolateAligned(Ember<T>* aligned, bool smoothFlag, eAffineInterp affineInterp, T time, T stagger, vector<T>& c, Ember<T>& result)
+	{
 		result.m_Time = time;
 		result.m_Interp = eInterp::EMBER_INTERP_LINEAR;
-		result.m_AffineInterp = embers[0].m_AffineInterp;
+		result.m_AffineInterp = affineInterp;
 		result.m_PaletteInterp = ePaletteInterp::INTERP_HSV;
 
 		if (!smoothFlag)
-			result.Interpolate(&localEmbers[0], 2, c, stagger);
+			result.Interpolate(aligned, 2, c, stagger);
 		else
-			result.InterpolateCatmullRom(&localEmbers[0], 4, c[1]);
+			result.InterpolateCatmullRom(aligned, 4, c[1]);
 	}
 
 	/// <summary>
@@ -1023,5 +1110,13 @@ public:
 
 		return ad > bd;
 	}
+
+private:
+	bool m_Smooth;//Whether m_Aligned holds four embers for smooth interpolation, else two for linear.
+	size_t m_Start;//The index of the first ember aligned in m_Aligned.
+	size_t m_Size;
+	Ember<T>* m_Embers;//The embers last passed to InterpolateInPlace(), nullptr if none.
+	vector<T> m_Coefs;
+	Ember<T> m_Aligned[4];
 };
 }
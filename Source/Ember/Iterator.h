@@ -6,9 +6,6 @@
 /// Iterator and derived classes.
 /// </summary>
 
-#define CHOOSE_XFORM_GRAIN 16384//The size of xform random selection buffer. Multiply by the (number of non-final xforms present + 1) if xaos is used.
-#define CHOOSE_XFORM_GRAIN_M1 16383//All 1s, so it's logically and-able.
-
 namespace EmberNs
 {
 #define ITERATORUSINGS \
@@ -18,6 +15,18 @@ namespace EmberNs
 
 template <typename T, typename bucketT> class Renderer;
 
+/// <summary>
+/// An entry in the alias table used to randomly select xforms.
+/// Each entry corresponds to one xform. A random number selects an entry uniformly, and a second
+/// random number then picks either the xform of the entry itself, or its alias.
+/// This must match the uint2 the OpenCL kernel reads it as.
+/// </summary>
+struct EMBER_API XformAlias
+{
+	uint m_Threshold;//The probability of picking this entry's own xform rather than its alias, scaled to the full range of a uint.
+	uint m_Alias;//The index of the xform to pick otherwise.
+};
+
 template <typename T>
 struct IterParams
 {
@@ -52,10 +61,11 @@ class EMBER_API Iterator
 {
 public:
 	/// <summary>
-	/// Empty constructor.
+	/// Default constructor.
 	/// </summary>
 	Iterator()
 	{
+		m_XformCount = 1;
 	}
 
 	/// <summary>
@@ -68,8 +78,8 @@ public:
 	/// <summary>
 	/// Accessors.
 	/// </summary>
-	const byte* XformDistributions() const { return m_XformDistributions.empty() ? nullptr : &m_XformDistributions[0]; }
-	size_t      XformDistributionsSize() const { return m_XformDistributions.size(); }
+	const byte* XformDistributions() const { return m_XformDistributions.empty() ? nullptr : reinterpret_cast<const byte*>(m_XformDistributions.data()); }
+	size_t      XformDistributionsSize() const { return m_XformDistributions.size() * sizeof(XformAlias); }
 
 	/// <summary>
 	/// Virtual empty iteration function that will be overidden in derived iterator classes.
@@ -83,116 +93,102 @@ public:
 	virtual size_t Iterate(Ember<T>& ember, IterParams<T>& params, Point<T>* samples, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) { return 0; }
 
 	/// <summary>
-	/// Initialize the xform selection vector by normalizing the weights of all xforms and
-	/// setting the corresponding percentage of elements in the vector to each xform's index in its
-	/// parent ember.
-	/// Note that this method of looking up and index in a vector is how flam3 did it and is about 10%
-	/// faster than using a while loop to check a random number against a normalized weight.
+	/// Initialize the xform selection alias tables using Vose's alias method.
+	/// There is one table when xaos is not present. When it is, there is an additional table for each xform,
+	/// whose weights are scaled by that xform's xaos values and which is used when it was the previous xform applied.
+	/// Each table has one XformAlias entry per xform, so selecting an xform is constant time, the weights are exact
+	/// rather than being quantized to a fixed number of lookup elements, and any number of xforms can be used.
 	/// Also, the ember used to initialize this must be the same ember, unchanged, used to iterate.
 	/// If one is passed to this function, its parameters are changed and then it's passed to Iterate(),
 	/// the behavior is undefined.
 	/// </summary>
-	/// <param name="ember">The ember whose xforms will be used to populate the distribution vector</param>
+	/// <param name="ember">The ember whose xforms will be used to populate the alias tables</param>
 	/// <returns>True if success, else false.</returns>
 	bool InitDistributions(Ember<T>& ember)
 	{
 		size_t i;
-		size_t distribCount = ember.XaosPresent() ? ember.XformCount() + 1 : 1;
+		size_t xformCount = ember.XformCount();
+		size_t distribCount = ember.XaosPresent() ? xformCount + 1 : 1;
 		const Xform<T>* xforms = ember.Xforms();
+		vector<double> probs(xformCount);
+		vector<size_t> small, large;
+		m_XformCount = std::max<size_t>(xformCount, 1);
 
-		if (m_XformDistributions.size() < CHOOSE_XFORM_GRAIN * distribCount)
-			m_XformDistributions.resize(CHOOSE_XFORM_GRAIN * distribCount);
+		if (m_XformDistributions.size() != m_XformCount * distribCount)
+			m_XformDistributions.resize(m_XformCount * distribCount);
 
-		if (m_XformDistributions.size() < CHOOSE_XFORM_GRAIN * distribCount)
+		if (m_XformDistributions.size() != m_XformCount * distribCount)
 			return false;
 
+		small.reserve(xformCount);
+		large.reserve(xformCount);
+
 		for (size_t distrib = 0; distrib < distribCount; distrib++)
 		{
 			double totalDensity = 0;
+			XformAlias* table = m_XformDistributions.data() + (distrib * m_XformCount);
 
 			//First find the total densities of all xforms.
-			for (i = 0; i < ember.XformCount(); i++)
+			for (i = 0; i < xformCount; i++)
 			{
-				double d = xforms[i].m_Weight;
+				double d = std::max(0.0, double(xforms[i].m_Weight));
 
 				if (distrib > 0)
 					d *= xforms[distrib - 1].Xaos(i);
 
+				probs[i] = d;
 				totalDensity += d;
 			}
 
 			//Original returned false if all were 0, but it's allowed here
-			//which will just end up setting all elements to 0 which means
+			//which will just end up aliasing every entry to 0 which means
 			//only the first xform will get used.
-			//Calculate how much of a fraction of a the total density each element represents.
-			size_t j = 0;
-			//These must be double, else roundoff error will prevent the last element of m_XformDistributions from being set.
-			double tempDensity = 0, currentDensityLimit = 0, densityPerElement = totalDensity / CHOOSE_XFORM_GRAIN;
-
-			//Assign xform indices in order to each element of m_XformDistributions.
-			//The number of elements assigned a given index is proportional to that xform's
-			//density relative to the sum of all densities.
-			for (i = 0; i < ember.XformCount(); i++)
+			if (totalDensity <= 0)
 			{
-				double temp = xforms[i].m_Weight;
+				for (i = 0; i < m_XformCount; i++)
+				{
+					table[i].m_Threshold = 0;
+					table[i].m_Alias = 0;
+				}
 
-				if (distrib > 0)
-					temp *= xforms[distrib - 1].Xaos(i);
+				continue;
+			}
 
-				currentDensityLimit += temp;
+			//Scale so the average is 1, then split into the entries which are under and over full.
+			for (i = 0; i < xformCount; i++)
+			{
+				probs[i] *= xformCount / totalDensity;
+				(probs[i] < 1 ? small : large).push_back(i);
+			}
 
-				//Populate points corresponding to this xform's weight/density.
-				//Also check that j is within the bounds of the distribution array just to be safe in the case of a rounding error.
-				while (tempDensity < currentDensityLimit && j < CHOOSE_XFORM_GRAIN)
+			//Fill each under full entry with the remainder of an over full one, which becomes its alias.
+			while (!small.empty() && !large.empty())
+			{
+				size_t s = small.back();
+				size_t l = large.back();
+				small.pop_back();
+				table[s].m_Threshold = AliasThreshold(probs[s]);
+				table[s].m_Alias = uint(l);
+				probs[l] = (probs[l] + probs[s]) - 1;
+
+				if (probs[l] < 1)
 				{
-#ifdef _DEBUG
-
-					//Ensure distribution contains no out of bounds indices.
-					if (byte(i) >= ember.XformCount())
-						throw "Out of bounds xform index in selection distribution.";
-
-#endif
-					//printf("offset = %d, xform = %d, running sum = %f\n", j, i, tempDensity);
-					m_XformDistributions[(distrib * CHOOSE_XFORM_GRAIN) + j] = byte(i);
-					tempDensity += densityPerElement;
-					j++;
+					large.pop_back();
+					small.push_back(l);
 				}
 			}
 
-#ifdef _DEBUG
-
-			//Ensure every element of the distribution was populated.
-			if (j < CHOOSE_XFORM_GRAIN)
-				throw "Not all distribution elements set, undefined behavior.";
-
-#endif
-
-			for (; j < CHOOSE_XFORM_GRAIN; j++)//Make absolutely sure they are set to a valid value.
-				m_XformDistributions[(distrib * CHOOSE_XFORM_GRAIN) + j] = byte(i - 1);
-
-			//Flam3 did this, which gives the same result.
-			//T t = xforms[0].m_Weight;
-			//
-			//if (distrib > 0)
-			//	t *= xforms[distrib - 1].Xaos(0);
-			//
-			//T r = 0;
-			//
-			//for (i = 0; i < CHOOSE_XFORM_GRAIN; i++)
-			//{
-			//	while (r >= t)
-			//	{
-			//		j++;
-			//
-			//		if (distrib > 0)
-			//			t += xforms[j].m_Weight * xforms[distrib - 1].Xaos(j);
-			//		else
-			//			t += xforms[j].m_Weight;
-			//	}
-			//
-			//	m_XformDistributions[(distrib * CHOOSE_XFORM_GRAIN) + i] = j;
-			//	r += densityPerElement;
-			//}
+			//Whatever is left over is full, give or take roundoff error, so always picks itself.
+			for (auto& list : { &small, &large })
+			{
+				for (auto index : *list)
+				{
+					table[index].m_Threshold = std::numeric_limits<uint>::max();
+					table[index].m_Alias = uint(index);
+				}
+
+				list->clear();
+			}
 		}
 
 		return true;
@@ -266,19 +262,34 @@ protected:
 	}
 
 	/// <summary>
-	/// Retrieve an element in the distributions vector between 0 and CHOOSE_XFORM_GRAIN which will
-	/// contain the index of the next xform to use. When xaos is prsent, the offset is the index in
-	/// the ember of the previous xform used when.
+	/// Use a random number to select the index of the next xform to use from an alias table.
+	/// Multiplying the low 32 bits of the random number by the number of xforms gives the entry in the
+	/// high 32 bits of the product, and a uniformly distributed value to compare to its threshold in the low 32 bits.
+	/// When xaos is prsent, the offset is the index in the ember of the previous xform used plus 1.
 	/// </summary>
-	/// <param name="index">The index to retrieve</param>
-	/// <param name="distribOffset">When xaos is prsent, the index of the previous xform used. Default: 0 (xaos not present).</param>
-	/// <returns></returns>
+	/// <param name="index">The random number to select with</param>
+	/// <param name="distribOffset">When xaos is prsent, the index of the previous xform used plus 1. Default: 0 (xaos not present).</param>
+	/// <returns>The index of the selected xform</returns>
 	size_t NextXformFromIndex(size_t index, size_t distribOffset = 0)
 	{
-		return size_t(m_XformDistributions[(index & CHOOSE_XFORM_GRAIN_M1) + (CHOOSE_XFORM_GRAIN * distribOffset)]);
+		uint64_t scaled = uint64_t(uint(index)) * m_XformCount;
+		size_t entry = size_t(scaled >> 32);
+		const XformAlias& alias = m_XformDistributions[(distribOffset * m_XformCount) + entry];
+		return uint(scaled) < alias.m_Threshold ? entry : size_t(alias.m_Alias);
+	}
+
+	/// <summary>
+	/// Convert a probability between 0 and 1 to the threshold stored in an alias table entry.
+	/// </summary>
+	/// <param name="prob">The probability</param>
+	/// <returns>The probability scaled to the full range of a uint</returns>
+	static uint AliasThreshold(double prob)
+	{
+		return prob >= 1 ? std::numeric_limits<uint>::max() : uint(std::max(0.0, prob) * 4294967296.0);
 	}
 
-	vector<byte> m_XformDistributions;
+	size_t m_XformCount;//The number of entries in each alias table.
+	vector<XformAlias> m_XformDistributions;
 };
 
 /// <summary>
@@ -599,4 +610,190 @@ public:
 		return badVals;
 	}
 };
+/// <summary>
+/// Derived iterator class for embers whose xforms do not use xaos, which advances ITER_BATCH_SIZE
+/// independent trajectories in lockstep rather than a single one.
+/// On each step, an xform is chosen for every trajectory, then the trajectories are bucketed by
+/// the xform chosen and each xform is applied to all of its trajectories at once with Xform::ApplyBatch().
+/// This amortizes the cost of the virtual variation calls over the whole bucket and lets the compiler
+/// vectorize the affine, precalc and color stages.
+/// The trajectory state is kept in structure of arrays form, and the output samples are interleaved such that
+/// each group of ITER_BATCH_SIZE consecutive samples holds one step of every trajectory.
+/// The tradeoff is that every trajectory must be fused separately, so this is only used when the sub batch size
+/// is large enough relative to the fuse count that the extra fusing is negligible. See Qualifies().
+/// Template argument expected to be float or double.
+/// </summary>
+template <typename T>
+class EMBER_API BatchIterator : public Iterator<T>
+{
+	ITERATORUSINGS
+public:
+	/// <summary>
+	/// Empty constructor.
+	/// </summary>
+	BatchIterator()
+	{
+	}
+
+	/// <summary>
+	/// Determine whether an ember can be iterated with this class.
+	/// Xaos is not supported because each trajectory's distribution would then depend on its
+	/// last xform, which would defeat bucketing. The number of iterations per sub batch must also be
+	/// at least 16 times the number of fuse iterations that all trajectories will incur.
+	/// </summary>
+	/// <param name="ember">The ember to examine</param>
+	/// <param name="count">The number of iterations per sub batch</param>
+	/// <param name="skip">The number of times to fuse</param>
+	/// <returns>True if this iterator can be used, else false.</returns>
+	static bool Qualifies(const Ember<T>& ember, size_t count, size_t skip)
+	{
+		return !ember.XaosPresent() && ember.XformCount() > 0 && count >= ITER_BATCH_SIZE * (skip + 1) * 16;
+	}
+
+	/// <summary>
+	/// Overridden virtual function which iterates an ember a given number of times, ITER_BATCH_SIZE trajectories at a time.
+	/// The first trajectory starts at the point passed in samples[0], the rest start at random points.
+	/// </summary>
+	/// <param name="ember">The ember whose xforms will be applied</param>
+	/// <param name="count">The number of iterations to do</param>
+	/// <param name="skip">The number of times to fuse</param>
+	/// <param name="samples">The buffer to store the output points</param>
+	/// <param name="rand">The random context to use</param>
+	/// <returns>The number of bad values</returns>
+	virtual size_t Iterate(Ember<T>& ember, IterParams<T>& params, Point<T>* samples, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		size_t i, j, badVals = 0;
+		size_t laneCount = std::min<size_t>(ITER_BATCH_SIZE, params.m_Count);
+		size_t xformCount = ember.XformCount();
+		Xform<T>* xforms = ember.NonConstXforms();
+		vector<size_t> starts(xformCount + 1);
+		Lanes lanes;
+		IteratorHelperBatch<T> helper;
+		Point<T> tempPoint;
+
+		for (j = 0; j < laneCount; j++)
+		{
+			lanes.m_X[j] = j ? rand.Frand11<T>() : samples[0].m_X;
+			lanes.m_Y[j] = j ? rand.Frand11<T>() : samples[0].m_Y;
+			lanes.m_Z[j] = j ? 0 : samples[0].m_Z;
+			lanes.m_ColorX[j] = j ? rand.Frand01<T>() : samples[0].m_ColorX;
+			lanes.m_VizAdjusted[j] = samples[0].m_VizAdjusted;
+		}
+
+		for (i = 0; i < params.m_Skip; i++)//Fuse.
+			Step(xforms, xformCount, starts, lanes, laneCount, helper, badVals, rand);
+
+		for (i = 0; i < params.m_Count; i += laneCount)//Real loop.
+		{
+			size_t active = std::min(laneCount, params.m_Count - i);
+			Step(xforms, xformCount, starts, lanes, active, helper, badVals, rand);
+
+			for (j = 0; j < active; j++)
+			{
+				Point<T>* sample = samples + i + j;
+				tempPoint.m_X = lanes.m_X[j];
+				tempPoint.m_Y = lanes.m_Y[j];
+				tempPoint.m_Z = lanes.m_Z[j];
+				tempPoint.m_ColorX = lanes.m_ColorX[j];
+				tempPoint.m_VizAdjusted = lanes.m_VizAdjusted[j];
+
+				if (ember.UseFinalXform())
+					DoFinalXform(ember, tempPoint, sample, rand);
+				else
+					*sample = tempPoint;
+
+				if (ember.ProjBits())
+					ember.Proj(*sample, rand);
+			}
+		}
+
+		return badVals;
+	}
+
+private:
+	/// <summary>
+	/// The state of each trajectory being iterated, in structure of arrays form.
+	/// </summary>
+	struct Lanes
+	{
+		T m_X[ITER_BATCH_SIZE];
+		T m_Y[ITER_BATCH_SIZE];
+		T m_Z[ITER_BATCH_SIZE];
+		T m_ColorX[ITER_BATCH_SIZE];
+		T m_VizAdjusted[ITER_BATCH_SIZE];
+	};
+
+	/// <summary>
+	/// Advance the first count trajectories by one iteration.
+	/// An xform is chosen for each, then the trajectories are grouped by xform with a counting sort
+	/// and each group is gathered into the helper, applied, and scattered back.
+	/// Bad values are handled one point at a time since they are rare.
+	/// </summary>
+	/// <param name="xforms">The xforms array</param>
+	/// <param name="xformCount">The number of xforms in the array</param>
+	/// <param name="starts">Scratch space of size xformCount + 1 used for the counting sort</param>
+	/// <param name="lanes">The trajectories to advance</param>
+	/// <param name="count">The number of trajectories to advance</param>
+	/// <param name="helper">The batch helper to use</param>
+	/// <param name="badVals">The counter for the total number of bad values this sub batch</param>
+	/// <param name="rand">The random context to use</param>
+	inline void Step(Xform<T>* xforms, size_t xformCount, vector<size_t>& starts, Lanes& lanes, size_t count, IteratorHelperBatch<T>& helper, size_t& badVals, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand)
+	{
+		size_t j, k, laneXforms[ITER_BATCH_SIZE], order[ITER_BATCH_SIZE];
+		std::fill(starts.begin(), starts.end(), 0);
+
+		for (j = 0; j < count; j++)
+		{
+			laneXforms[j] = NextXformFromIndex(rand.Rand());
+			starts[laneXforms[j] + 1]++;
+		}
+
+		for (k = 0; k < xformCount; k++)
+			starts[k + 1] += starts[k];
+
+		for (j = 0; j < count; j++)
+			order[starts[laneXforms[j]]++] = j;//Each start is advanced to the end of its group here...
+
+		for (k = 0, j = 0; k < xformCount; k++)
+		{
+			size_t t, end = starts[k];//...so the groups are now [previous end, starts[k]).
+
+			if (end == j)
+				continue;
+
+			helper.m_Count = end - j;
+
+			for (t = 0; t < helper.m_Count; t++)
+			{
+				size_t lane = order[j + t];
+				Point<T>& point = helper.m_Points[t];
+				point.m_X = helper.m_X[t] = lanes.m_X[lane];
+				point.m_Y = helper.m_Y[t] = lanes.m_Y[lane];
+				point.m_Z = helper.m_Z[t] = lanes.m_Z[lane];
+				point.m_ColorX = helper.m_ColorX[t] = lanes.m_ColorX[lane];
+				point.m_VizAdjusted = lanes.m_VizAdjusted[lane];
+			}
+
+			if (xforms[k].ApplyBatch(helper, rand))
+			{
+				for (t = 0; t < helper.m_Count; t++)
+					if (helper.m_Bad[t])
+						DoBadVals(xforms, badVals, helper.m_Points + t, rand);
+			}
+
+			for (t = 0; t < helper.m_Count; t++)
+			{
+				size_t lane = order[j + t];
+				Point<T>& point = helper.m_Points[t];
+				lanes.m_X[lane] = point.m_X;
+				lanes.m_Y[lane] = point.m_Y;
+				lanes.m_Z[lane] = point.m_Z;
+				lanes.m_ColorX[lane] = point.m_ColorX;
+				lanes.m_VizAdjusted[lane] = point.m_VizAdjusted;
+			}
+
+			j = end;
+		}
+	}
+};
 }
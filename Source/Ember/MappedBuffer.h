@@ -0,0 +1,335 @@
+#pragma once
+
+#include "Utils.h"
+
+/// <summary>
+/// MappedBuffer class.
+/// </summary>
+
+namespace EmberNs
+{
+/// <summary>
+/// A resizable buffer of trivially copyable elements which is either held on the heap,
+/// or stored in a temporary memory mapped file so it can be larger than physical memory.
+/// It exposes the subset of the std::vector interface used by the renderer, so it can be used in its place
+/// for the histogram and density filtering buffers.
+/// When file backed, the operating system pages the buffer in and out as it's accessed. The caller can
+/// pass hints about how it's about to be accessed with Advise() and Prefetch(), which are ignored when on the heap.
+/// Unlike std::vector, the contents are unspecified after a resize and must be cleared before use.
+/// The temporary file is deleted when the buffer is released.
+/// Template argument expected to be a tvec4.
+/// </summary>
+template <typename T>
+class EMBER_API MappedBuffer
+{
+public:
+	/// <summary>
+	/// Default constructor which creates an empty heap buffer.
+	/// </summary>
+	MappedBuffer()
+	{
+		m_Data = nullptr;
+		m_Size = 0;
+		m_FileBacked = false;
+		m_MappedBytes = 0;
+#ifdef _WIN32
+		m_File = INVALID_HANDLE_VALUE;
+		m_Mapping = nullptr;
+#else
+		m_File = -1;
+#endif
+	}
+
+	MappedBuffer(const MappedBuffer<T>& buffer) = delete;
+	MappedBuffer<T>& operator = (const MappedBuffer<T>& buffer) = delete;
+
+	/// <summary>
+	/// Destructor which unmaps and deletes the file if file backed.
+	/// </summary>
+	~MappedBuffer()
+	{
+		Release();
+	}
+
+	/// <summary>
+	/// Set whether the buffer is stored in a temporary memory mapped file.
+	/// If this differs from the current setting, the buffer is released, so the next call
+	/// to resize() will allocate it with the new backing.
+	/// </summary>
+	/// <param name="fileBacked">True to store the buffer in a memory mapped file, false to store it on the heap.</param>
+	/// <param name="path">The folder to create the file in. If empty, the system temporary folder is used.</param>
+	void Backing(bool fileBacked, const string& path)
+	{
+		if (fileBacked != m_FileBacked || path != m_Path)
+		{
+			Release();
+			m_FileBacked = fileBacked;
+			m_Path = path;
+		}
+	}
+
+	/// <summary>
+	/// Resize the buffer to hold the specified number of elements.
+	/// When file backed, this creates a new file and maps it, and the previous contents are lost.
+	/// On failure, the buffer is left empty.
+	/// </summary>
+	/// <param name="size">The number of elements</param>
+	void resize(size_t size)
+	{
+		if (size == m_Size)
+			return;
+
+		if (!m_FileBacked)
+		{
+			m_Heap.resize(size);
+			m_Data = m_Heap.data();
+			m_Size = m_Heap.size();
+			return;
+		}
+
+		Release();
+
+		if (size && Map(size * sizeof(T)))
+			m_Size = size;
+	}
+
+	/// <summary>
+	/// Return unused heap memory to the system. No effect when file backed since the mapping always matches the size.
+	/// </summary>
+	void shrink_to_fit()
+	{
+		if (!m_FileBacked)
+		{
+			m_Heap.shrink_to_fit();
+			m_Data = m_Heap.data();
+		}
+	}
+
+	/// <summary>
+	/// Set every byte in the buffer to zero.
+	/// For a file backed buffer, this truncates and re-extends the file rather than writing to it,
+	/// which discards its pages without reading them back in.
+	/// </summary>
+	void Clear()
+	{
+		if (!m_FileBacked || !m_Data)
+		{
+			if (m_Size)
+				memset(static_cast<void*>(m_Data), 0, SizeBytes());
+
+			return;
+		}
+
+#ifdef _WIN32
+		memset(static_cast<void*>(m_Data), 0, SizeBytes());
+#else
+
+		if (ftruncate(m_File, 0) != 0 || ftruncate(m_File, off_t(m_MappedBytes)) != 0)
+			memset(static_cast<void*>(m_Data), 0, SizeBytes());
+
+#endif
+	}
+
+	/// <summary>
+	/// Tell the operating system how the entire buffer is about to be accessed.
+	/// Random access disables read ahead, which is what iteration wants. Sequential access
+	/// increases it, which is what filtering and accumulation want.
+	/// Ignored for heap buffers.
+	/// </summary>
+	/// <param name="advice">The expected access pattern</param>
+	void Advise(eBufferAdvice advice)
+	{
+#ifndef _WIN32
+
+		if (m_FileBacked && m_Data)
+		{
+			int flag = advice == eBufferAdvice::RANDOM ? MADV_RANDOM : advice == eBufferAdvice::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_NORMAL;
+			madvise(static_cast<void*>(m_Data), m_MappedBytes, flag);
+		}
+
+#endif
+	}
+
+	/// <summary>
+	/// Ask the operating system to start reading a range of elements in, so it's resident by the time it's accessed.
+	/// Ignored for heap buffers.
+	/// </summary>
+	/// <param name="start">The index of the first element to prefetch</param>
+	/// <param name="count">The number of elements to prefetch</param>
+	void Prefetch(size_t start, size_t count)
+	{
+		if (!m_FileBacked || !m_Data || start >= m_Size)
+			return;
+
+		size_t pageSize = PageSize();
+		size_t begin = ((start * sizeof(T)) / pageSize) * pageSize;//Must be page aligned.
+		size_t end = std::min(m_Size, start + count) * sizeof(T);
+		char* p = reinterpret_cast<char*>(m_Data) + begin;
+#ifdef _WIN32
+#if _WIN32_WINNT >= 0x0602//Only available on Windows 8 and later.
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = p;
+		range.NumberOfBytes = end - begin;
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+		madvise(static_cast<void*>(p), end - begin, MADV_WILLNEED);
+#endif
+	}
+
+	/// <summary>
+	/// Get the size of a page of virtual memory.
+	/// </summary>
+	/// <returns>The page size in bytes</returns>
+	static size_t PageSize()
+	{
+#ifdef _WIN32
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return size_t(info.dwPageSize);
+#else
+		return size_t(sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+	/// <summary>
+	/// Accessors.
+	/// </summary>
+	inline T* data() { return m_Data; }
+	inline const T* data() const { return m_Data; }
+	inline size_t size() const { return m_Size; }
+	inline bool empty() const { return m_Size == 0; }
+	inline size_t SizeBytes() const { return m_Size * sizeof(T); }
+	inline bool FileBacked() const { return m_FileBacked; }
+	inline T& operator[] (size_t i) { return m_Data[i]; }
+	inline const T& operator[] (size_t i) const { return m_Data[i]; }
+
+private:
+	/// <summary>
+	/// Create a temporary file of the specified size and map the whole thing into memory.
+	/// The file is deleted as soon as it's closed, so nothing is left behind if the process exits early.
+	/// </summary>
+	/// <param name="bytes">The size of the file in bytes</param>
+	/// <returns>True if successful, else false.</returns>
+	bool Map(size_t bytes)
+	{
+#ifdef _WIN32
+		char folder[MAX_PATH], filename[MAX_PATH];
+
+		if (m_Path.empty())
+			GetTempPathA(MAX_PATH, folder);
+		else
+			strncpy_s(folder, m_Path.c_str(), _TRUNCATE);
+
+		if (!GetTempFileNameA(folder, "emb", 0, filename))
+			return false;
+
+		m_File = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+							 FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+
+		if (m_File == INVALID_HANDLE_VALUE)
+			return false;
+
+		m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READWRITE, DWORD(uint64_t(bytes) >> 32), DWORD(bytes & 0xFFFFFFFF), nullptr);
+
+		if (m_Mapping)
+			m_Data = reinterpret_cast<T*>(MapViewOfFile(m_Mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes));
+
+#else
+		string filename = (m_Path.empty() ? string(P_tmpdir) : m_Path) + "/emberXXXXXX";
+		vector<char> name(filename.begin(), filename.end());
+		name.push_back(0);
+		m_File = mkstemp(name.data());
+
+		if (m_File == -1)
+			return false;
+
+		unlink(name.data());//Deleted once closed.
+
+		if (ftruncate(m_File, off_t(bytes)) == 0)//The file is sparse, so this takes no disk space until written to, and reads as zeroes.
+		{
+			void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_File, 0);
+
+			if (p != MAP_FAILED)
+				m_Data = reinterpret_cast<T*>(p);
+		}
+
+#endif
+
+		if (!m_Data)
+		{
+			Release();
+			return false;
+		}
+
+		m_MappedBytes = bytes;
+		return true;
+	}
+
+	/// <summary>
+	/// Free the heap memory, or unmap and delete the file.
+	/// </summary>
+	void Release()
+	{
+		if (m_FileBacked)
+		{
+#ifdef _WIN32
+
+			if (m_Data)
+				UnmapViewOfFile(m_Data);
+
+			if (m_Mapping)
+				CloseHandle(m_Mapping);
+
+			if (m_File != INVALID_HANDLE_VALUE)
+				CloseHandle(m_File);
+
+			m_File = INVALID_HANDLE_VALUE;
+			m_Mapping = nullptr;
+#else
+
+			if (m_Data)
+				munmap(static_cast<void*>(m_Data), m_MappedBytes);
+
+			if (m_File != -1)
+				close(m_File);
+
+			m_File = -1;
+#endif
+		}
+		else
+		{
+			m_Heap.clear();
+			m_Heap.shrink_to_fit();
+		}
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_MappedBytes = 0;
+	}
+
+	T* m_Data;//Points to either the heap vector or the mapped file.
+	size_t m_Size;//The number of elements.
+	size_t m_MappedBytes;//The size of the mapped file in bytes.
+	bool m_FileBacked;//Whether the buffer is stored in a memory mapped file rather than on the heap.
+	string m_Path;//The folder the file is created in.
+	vector<T> m_Heap;//The storage used when not file backed.
+#ifdef _WIN32
+	HANDLE m_File;
+	HANDLE m_Mapping;
+#else
+	int m_File;
+#endif
+};
+
+/// <summary>
+/// Thin wrapper around MappedBuffer::Clear() which allows it to be cleared the same way as a vector.
+/// Only a value of 0 is supported.
+/// </summary>
+/// <param name="buffer">The buffer to clear</param>
+template <typename T>
+static inline void Memset(MappedBuffer<T>& buffer)
+{
+	buffer.Clear();
+}
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "MappedBuffer.h"
+#include "Timing.h"
+
+/// <summary>
+/// PackedHistogram class.
+/// </summary>
+
+namespace EmberNs
+{
+/// <summary>
+/// A histogram which stores each bucket in 64 bits rather than as a vec4 of float or double, which halves or quarters
+/// the memory used by the histogram and the bandwidth used by iteration.
+/// Each bucket holds its red, green, blue and hit count channels as 14-bit mantissas which share a 6-bit exponent,
+/// so the memory used is exactly 8 bytes per bucket regardless of the image or how many hits a bucket receives.
+/// At an exponent of zero the channels are fixed point with 8 fractional bits. When adding a hit would overflow any
+/// channel, the exponent is incremented and all four mantissas are halved, so a bucket keeps between 13 and 14 bits
+/// of precision relative to its largest channel no matter how many hits it receives.
+/// A hit is added by rounding each channel up or down at random, weighted by its fractional part, and halving rounds the same way,
+/// so the expected value of every bucket is exactly the same as it would have been in a floating point histogram.
+/// The rounding threshold comes from a dither value passed by the caller, which must be uniformly distributed and differ from one hit to the next.
+/// Reading while another thread is adding is allowed, with the same caveats as reading and writing a floating point histogram.
+/// Template argument bucketT expected to be float or double.
+/// </summary>
+template <typename bucketT>
+class EMBER_API PackedHistogram
+{
+public:
+	typedef tvec4<bucketT, glm::defaultp> bucket;
+
+	/// <summary>
+	/// Default constructor which creates an empty histogram.
+	/// </summary>
+	PackedHistogram()
+	{
+		for (size_t i = 0; i < PACKED_HIST_EXP_COUNT; i++)
+		{
+			m_Scales[i] = std::ldexp(bucketT(PACKED_HIST_SCALE), -int(i));
+			m_InvScales[i] = std::ldexp(bucketT(1) / PACKED_HIST_SCALE, int(i));
+		}
+	}
+
+	PackedHistogram(const PackedHistogram<bucketT>& histogram) = delete;
+	PackedHistogram<bucketT>& operator = (const PackedHistogram<bucketT>& histogram) = delete;
+
+	/// <summary>
+	/// Set whether the buckets are stored in a temporary memory mapped file.
+	/// </summary>
+	/// <param name="fileBacked">True to store the buckets in a memory mapped file, false to store them on the heap.</param>
+	/// <param name="path">The folder to create the file in. If empty, the system temporary folder is used.</param>
+	void Backing(bool fileBacked, const string& path)
+	{
+		m_Packed.Backing(fileBacked, path);
+	}
+
+	/// <summary>
+	/// Resize the histogram to hold the specified number of buckets.
+	/// The contents are unspecified, so it must be cleared before use.
+	/// </summary>
+	/// <param name="size">The number of buckets</param>
+	void resize(size_t size)
+	{
+		if (size != m_Packed.size())
+			m_Packed.resize(size);
+	}
+
+	/// <summary>
+	/// Thin wrappers around the same functions in MappedBuffer.
+	/// </summary>
+	void shrink_to_fit() { m_Packed.shrink_to_fit(); }
+	void Clear() { m_Packed.Clear(); }
+	void Advise(eBufferAdvice advice) { m_Packed.Advise(advice); }
+	void Prefetch(size_t start, size_t count) { m_Packed.Prefetch(start, count); }
+
+	/// <summary>
+	/// Add a hit to a bucket.
+	/// </summary>
+	/// <param name="i">The index of the bucket</param>
+	/// <param name="color">The color of the hit, with the hit count in the alpha channel</param>
+	/// <param name="dither">A value which differs for every hit, such as one returned by Dither(), whose bits are used for rounding</param>
+	inline void Add(size_t i, const bucket& color, uint dither)
+	{
+		uint64_t p = m_Packed[i];
+		uint e = Exponent(p);
+		uint maxMant = std::max(std::max(Mantissa(p, 0), Mantissa(p, 1)), std::max(Mantissa(p, 2), Mantissa(p, 3)));
+		bucketT maxVal = std::max(std::max(color.r, color.g), std::max(color.b, color.a));
+
+		//Halve until the largest channel plus the hit is below the largest mantissa, so rounding up can't overflow.
+		//A single very large hit, such as a bucket restored from a checkpoint, may need several steps.
+		while (bucketT(maxMant) + (maxVal * m_Scales[e]) >= bucketT(PACKED_HIST_MANT_MAX) && e < PACKED_HIST_EXP_COUNT - 1)
+		{
+			dither = Remix(dither);
+			p = Halve(p, dither);
+			maxMant = (maxMant + 1) >> 1;
+			e++;
+		}
+
+		bucketT scale = m_Scales[e];
+		//All four channels share one threshold. Each stays unbiased, and rounding them together keeps the color of the bucket steadier.
+		uint r = Mantissa(p, 0) + Quantize(color.r * scale, dither);
+		uint g = Mantissa(p, 1) + Quantize(color.g * scale, dither);
+		uint b = Mantissa(p, 2) + Quantize(color.b * scale, dither);
+		uint a = Mantissa(p, 3) + Quantize(color.a * scale, dither);
+		//Only a bucket at the largest exponent can saturate.
+		m_Packed[i] = Pack(std::min(r, PACKED_HIST_MANT_MAX), std::min(g, PACKED_HIST_MANT_MAX), std::min(b, PACKED_HIST_MANT_MAX), std::min(a, PACKED_HIST_MANT_MAX), e);
+	}
+
+	/// <summary>
+	/// Get the value of a bucket.
+	/// </summary>
+	/// <param name="i">The index of the bucket</param>
+	/// <returns>The value of the bucket as floating point</returns>
+	inline bucket operator[] (size_t i) const
+	{
+		uint64_t p = m_Packed[i];
+		return bucket(bucketT(Mantissa(p, 0)), bucketT(Mantissa(p, 1)), bucketT(Mantissa(p, 2)), bucketT(Mantissa(p, 3))) * m_InvScales[Exponent(p)];
+	}
+
+	/// <summary>
+	/// Get a dither value for the next hit from a seed and a counter, so callers only need to draw
+	/// one random number per batch of hits rather than one per hit.
+	/// </summary>
+	/// <param name="seed">A random value drawn once for the batch of hits</param>
+	/// <param name="index">The index of the hit within the batch</param>
+	/// <returns>The dither value to pass to Add()</returns>
+	static inline uint Dither(uint seed, size_t index)
+	{
+		return Remix(seed + uint(index) * 0x9E3779B9u);
+	}
+
+	/// <summary>
+	/// Accessors.
+	/// </summary>
+	inline size_t size() const { return m_Packed.size(); }
+	inline bool empty() const { return m_Packed.empty(); }
+	inline size_t SizeBytes() const { return m_Packed.SizeBytes(); }
+
+private:
+	/// <summary>
+	/// Scramble the bits of a value, the finalizer of MurmurHash3.
+	/// </summary>
+	/// <param name="x">The value to scramble</param>
+	/// <returns>The scrambled value</returns>
+	static inline uint Remix(uint x)
+	{
+		x ^= x >> 16;
+		x *= 0x85EBCA6Bu;
+		x ^= x >> 13;
+		x *= 0xC2B2AE35u;
+		x ^= x >> 16;
+		return x;
+	}
+
+	/// <summary>
+	/// Extract fields from, and assemble, a packed bucket.
+	/// The mantissas of red, green, blue and the hit count occupy the lowest 56 bits in that order, and the exponent the next 6 bits.
+	/// </summary>
+	static inline uint Mantissa(uint64_t p, uint channel) { return uint(p >> (channel * PACKED_HIST_MANT_BITS)) & PACKED_HIST_MANT_MAX; }
+	static inline uint Exponent(uint64_t p) { return uint(p >> (4 * PACKED_HIST_MANT_BITS)) & (PACKED_HIST_EXP_COUNT - 1); }
+	static inline uint64_t Pack(uint r, uint g, uint b, uint a, uint e)
+	{
+		return uint64_t(r) |
+			   (uint64_t(g) << PACKED_HIST_MANT_BITS) |
+			   (uint64_t(b) << (2 * PACKED_HIST_MANT_BITS)) |
+			   (uint64_t(a) << (3 * PACKED_HIST_MANT_BITS)) |
+			   (uint64_t(e) << (4 * PACKED_HIST_MANT_BITS));
+	}
+
+	/// <summary>
+	/// Halve all four mantissas of a packed bucket, rounding odd values up or down at random, and increment its exponent.
+	/// </summary>
+	/// <param name="p">The packed bucket</param>
+	/// <param name="dither">A random value whose lowest four bits are used for the rounding</param>
+	/// <returns>The halved bucket</returns>
+	static inline uint64_t Halve(uint64_t p, uint dither)
+	{
+		return Pack((Mantissa(p, 0) + (dither & 1)) >> 1,
+					(Mantissa(p, 1) + ((dither >> 1) & 1)) >> 1,
+					(Mantissa(p, 2) + ((dither >> 2) & 1)) >> 1,
+					(Mantissa(p, 3) + ((dither >> 3) & 1)) >> 1,
+					Exponent(p) + 1);
+	}
+
+	/// <summary>
+	/// Convert a scaled channel of a hit to an integer, rounding up with a probability equal to its fractional part.
+	/// The full 32 bits of the dither are used as the threshold because the fractional part of a hit to a bucket
+	/// with a large exponent is tiny, and a coarser threshold would bias it toward zero.
+	/// </summary>
+	/// <param name="scaled">The value to convert, already multiplied by the scale of the bucket's exponent</param>
+	/// <param name="dither">A random value used as the rounding threshold</param>
+	/// <returns>The integer value, saturated to the largest mantissa</returns>
+	static inline uint Quantize(bucketT scaled, uint dither)
+	{
+		scaled = Clamp<bucketT>(scaled, 0, bucketT(PACKED_HIST_MANT_MAX));
+		bucketT whole = std::floor(scaled);
+		return uint(whole) + ((scaled - whole) > bucketT(dither) * bucketT(2.3283064365386963e-10) ? 1 : 0);//2^-32.
+	}
+
+	bucketT m_Scales[PACKED_HIST_EXP_COUNT];//The number of mantissa steps per full hit at each exponent.
+	bucketT m_InvScales[PACKED_HIST_EXP_COUNT];//The value of one mantissa step at each exponent.
+	MappedBuffer<uint64_t> m_Packed;
+};
+}
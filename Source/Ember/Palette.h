@@ -194,6 +194,23 @@ public:
 		}
 	}
 
+	/// <summary>
+	/// Continue a content hash with the color entries of this palette.
+	/// The index, name and filename are not included since they don't affect the colors.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	uint64_t Hash(uint64_t hash = HASH_SEED) const
+	{
+		hash = HashVal(m_Entries.size(), hash);
+
+		for (auto& entry : m_Entries)
+			for (glm::length_t j = 0; j < 4; j++)
+				hash = HashVal(entry[j], hash);
+
+		return hash;
+	}
+
 	/// <summary>
 	/// Make a copy of this palette, adjust for hue and store in the passed in palette.
 	/// This is used because one way an ember Xml can specify color is with an index in the
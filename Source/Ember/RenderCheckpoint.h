@@ -0,0 +1,559 @@
+#pragma once
+
+#include "RendererBase.h"
+#include "MappedBuffer.h"
+
+/// <summary>
+/// RenderCheckpoint and CheckpointWriter classes.
+/// </summary>
+
+namespace EmberNs
+{
+#define CHECKPOINT_MAGIC "EMBRCKPT"
+#define CHECKPOINT_VERSION 4
+
+/// <summary>
+/// The state of a render in progress, which is enough to continue it exactly where it left off
+/// in a later process.
+/// It holds the histogram, the random contexts of each thread, the stats and the position within
+/// the temporal samples, along with a hash of the embers and the time being rendered so it can't be
+/// resumed with a different render.
+/// Filled in by RendererBase::SaveCheckpoint() and restored by passing it to RendererBase::ResumeCheckpoint().
+/// The file format stores runs of empty buckets as a count, which greatly shrinks the sparse histograms typical
+/// of most renders. Since the random contexts are stored as raw bytes, a checkpoint can only be resumed by a build
+/// with the same size of ISAAC_INT.
+/// An index histogram holds statistics of the color indices rather than colors, which can't simply be summed,
+/// so the mode is stored in the header and its buckets are merged with AddIndexBucket().
+/// </summary>
+class EMBER_API RenderCheckpoint
+{
+public:
+	typedef tvec4<float, glm::defaultp> bucket;
+
+	/// <summary>
+	/// Default constructor which creates an empty checkpoint.
+	/// </summary>
+	RenderCheckpoint()
+	{
+		Clear();
+	}
+
+	/// <summary>
+	/// Reset all values to zero and free the histogram and random contexts.
+	/// </summary>
+	void Clear()
+	{
+		m_Hash = 0;
+		m_IndexHist = false;
+		m_Time = 0;
+		m_SuperRasW = 0;
+		m_SuperRasH = 0;
+		m_LastTemporalSample = 0;
+		m_LastIter = 0;
+		m_VibGamCount = 0;
+		m_Vibrancy = 0;
+		m_Gamma = 0;
+		m_Background.Clear();
+		m_Stats.Clear();
+		m_Rand.clear();
+		m_Hist.resize(0);
+		m_Hist.shrink_to_fit();
+	}
+
+	/// <summary>
+	/// Write the checkpoint to a file.
+	/// It's first written to a temporary file next to it, which then replaces the existing one,
+	/// so a process killed while writing never leaves a truncated checkpoint behind.
+	/// </summary>
+	/// <param name="filename">The full path and filename</param>
+	/// <returns>True if success, else false.</returns>
+	bool Write(const string& filename) const
+	{
+		string tempFilename = filename + ".tmp";
+		ofstream file(tempFilename, ios::binary | ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		WriteHeader(file);
+		WriteVal(file, m_Rand.size());
+
+		if (!m_Rand.empty())
+			file.write(reinterpret_cast<const char*>(m_Rand.data()), m_Rand.size() * sizeof(m_Rand[0]));
+
+		WriteVal(file, m_Hist.size());
+
+		//Runs of empty buckets are written as a count, followed by the count and values of the non-empty buckets after them.
+		for (size_t i = 0; i < m_Hist.size();)
+		{
+			size_t start = i;
+
+			while (i < m_Hist.size() && m_Hist[i] == bucket(0))
+				i++;
+
+			size_t zeros = i - start;
+			start = i;
+
+			while (i < m_Hist.size() && m_Hist[i] != bucket(0))
+				i++;
+
+			WriteVal(file, zeros);
+			WriteVal(file, i - start);
+
+			if (i > start)
+				file.write(reinterpret_cast<const char*>(&m_Hist[start]), (i - start) * sizeof(bucket));
+		}
+
+		file.close();
+
+		if (file.fail())
+		{
+			remove(tempFilename.c_str());
+			return false;
+		}
+
+#ifdef _WIN32
+		//Rename fails on Windows if the destination exists, so replace it in a single call rather than removing it first.
+		return MoveFileExA(tempFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		return rename(tempFilename.c_str(), filename.c_str()) == 0;//Atomically replaces the destination.
+#endif
+	}
+
+	/// <summary>
+	/// Read a checkpoint previously written with Write().
+	/// </summary>
+	/// <param name="filename">The full path and filename</param>
+	/// <returns>True if the file existed and was a valid checkpoint written by a compatible build, else false.</returns>
+	bool Read(const string& filename)
+	{
+		ifstream file(filename, ios::binary);
+		Clear();
+
+		if (file.is_open() && ReadHeader(file, *this) && ReadRand(file, &m_Rand) && ReadHist(file, false))
+			return true;
+
+		Clear();
+		return false;
+	}
+
+	/// <summary>
+	/// Add the histogram and stats of another checkpoint file to this one.
+	/// This is used to combine shards: checkpoints of the same render where each was iterated separately with different seeds.
+	/// The file is streamed in pieces which are added by all cores, so only this checkpoint's histogram is ever held
+	/// in full. Back it with a file to merge histograms larger than memory.
+	/// Everything else in this checkpoint is left as is.
+	/// </summary>
+	/// <param name="filename">The full path and filename of the checkpoint to add</param>
+	/// <returns>True if the file was a valid checkpoint of the same render as this one and was added, else false, in which case this checkpoint is left partially merged.</returns>
+	bool Merge(const string& filename)
+	{
+		ifstream file(filename, ios::binary);
+		RenderCheckpoint header;
+
+		if (!file.is_open() || !ReadHeader(file, header) ||
+				header.m_Hash != m_Hash ||
+				header.m_IndexHist != m_IndexHist ||
+				header.m_Time != m_Time ||
+				header.m_SuperRasW != m_SuperRasW ||
+				header.m_SuperRasH != m_SuperRasH ||
+				!ReadRand(file, nullptr) || !ReadHist(file, true))
+			return false;
+
+		m_Stats += header.m_Stats;
+		return true;
+	}
+
+	/// <summary>
+	/// Add the hits in one bucket of an index histogram to another.
+	/// The buckets hold the weighted mean of the indices and the weighted sum of their squared distances from it,
+	/// rather than the raw sums of the indices and their squares, and are combined the way Chan et al. combine
+	/// the variances of two sets. Subtracting the squared mean from the mean square instead loses most of the precision
+	/// of a float once a bucket has a few thousand hits, because both are large and nearly equal when the indices are close together.
+	/// Used both by the renderer while iterating and when merging the shards of an index histogram.
+	/// </summary>
+	/// <param name="dest">The bucket to add to</param>
+	/// <param name="src">The bucket to add</param>
+	template <typename bucketT>
+	static void AddIndexBucket(tvec4<bucketT, glm::defaultp>& dest, const tvec4<bucketT, glm::defaultp>& src)
+	{
+		if (src.r > 0)
+		{
+			if (dest.r > 0)
+			{
+				bucketT weight = dest.r + src.r;
+				bucketT delta = src.g - dest.g;
+				bucketT frac = src.r / weight;
+				dest.b += src.b + (delta * delta * dest.r * frac);
+				dest.g += delta * frac;
+				dest.r = weight;
+			}
+			else
+			{
+				dest.r = src.r;
+				dest.g = src.g;
+				dest.b = src.b;
+			}
+		}
+
+		dest.a += src.a;
+	}
+
+	/// <summary>
+	/// Hash a string with 64-bit FNV-1a.
+	/// Used to identify the embers a checkpoint was made from.
+	/// </summary>
+	/// <param name="s">The string to hash</param>
+	/// <param name="hash">The hash of any preceding strings to continue from. Default: the FNV-1a offset basis.</param>
+	/// <returns>The hash</returns>
+	static uint64_t Hash(const string& s, uint64_t hash = 14695981039346656037ULL)
+	{
+		for (auto c : s)
+		{
+			hash ^= uint64_t(byte(c));
+			hash *= 1099511628211ULL;
+		}
+
+		return hash;
+	}
+
+	uint64_t m_Hash;//The hash of the embers being rendered.
+	bool m_IndexHist;//Whether the histogram is an index histogram.
+	double m_Time;//The time passed to Run().
+	size_t m_SuperRasW;
+	size_t m_SuperRasH;
+	size_t m_LastTemporalSample;
+	size_t m_LastIter;
+	size_t m_VibGamCount;
+	float m_Vibrancy;//The sums of these over the finished temporal samples.
+	float m_Gamma;
+	Color<float> m_Background;
+	EmberStats m_Stats;
+	vector<QTIsaac<ISAAC_SIZE, ISAAC_INT>> m_Rand;
+	MappedBuffer<bucket> m_Hist;//Can be backed by a file to hold histograms larger than memory.
+
+private:
+	/// <summary>
+	/// Write or read a single value as raw bytes.
+	/// </summary>
+	template <typename valT> static void WriteVal(ofstream& file, const valT& val) { file.write(reinterpret_cast<const char*>(&val), sizeof(val)); }
+	template <typename valT> static void ReadVal(ifstream& file, valT& val) { file.read(reinterpret_cast<char*>(&val), sizeof(val)); }
+
+	/// <summary>
+	/// Write everything but the random contexts and histogram, preceded by the sizes of the types
+	/// they are stored with so a checkpoint from an incompatible build is rejected.
+	/// </summary>
+	/// <param name="file">The file to write to</param>
+	void WriteHeader(ofstream& file) const
+	{
+		file.write(CHECKPOINT_MAGIC, 8);
+		WriteVal(file, uint(CHECKPOINT_VERSION));
+		WriteVal(file, uint(sizeof(size_t)));
+		WriteVal(file, uint(sizeof(bucket)));
+		WriteVal(file, uint(sizeof(QTIsaac<ISAAC_SIZE, ISAAC_INT>)));
+		WriteVal(file, m_Hash);
+		WriteVal(file, m_IndexHist);
+		WriteVal(file, m_Time);
+		WriteVal(file, m_SuperRasW);
+		WriteVal(file, m_SuperRasH);
+		WriteVal(file, m_LastTemporalSample);
+		WriteVal(file, m_LastIter);
+		WriteVal(file, m_VibGamCount);
+		WriteVal(file, m_Vibrancy);
+		WriteVal(file, m_Gamma);
+		WriteVal(file, m_Background);
+		WriteVal(file, m_Stats.m_Iters);
+		WriteVal(file, m_Stats.m_Badvals);
+		WriteVal(file, m_Stats.m_IterMs);
+		WriteVal(file, m_Stats.m_RenderMs);
+	}
+
+	/// <summary>
+	/// Read the values written by WriteHeader().
+	/// </summary>
+	/// <param name="file">The file to read from</param>
+	/// <param name="checkpoint">The checkpoint to store the values in</param>
+	/// <returns>True if the file is a checkpoint of this version written by a compatible build, else false.</returns>
+	static bool ReadHeader(ifstream& file, RenderCheckpoint& checkpoint)
+	{
+		char magic[8] = { 0 };
+		uint version = 0, sizeT = 0, bucketSize = 0, randSize = 0;
+		file.read(magic, 8);
+		ReadVal(file, version);
+		ReadVal(file, sizeT);
+		ReadVal(file, bucketSize);
+		ReadVal(file, randSize);
+
+		if (!file.good() ||
+				memcmp(magic, CHECKPOINT_MAGIC, 8) != 0 ||
+				version != CHECKPOINT_VERSION ||
+				sizeT != sizeof(size_t) ||
+				bucketSize != sizeof(bucket) ||
+				randSize != sizeof(QTIsaac<ISAAC_SIZE, ISAAC_INT>))
+			return false;
+
+		ReadVal(file, checkpoint.m_Hash);
+		ReadVal(file, checkpoint.m_IndexHist);
+		ReadVal(file, checkpoint.m_Time);
+		ReadVal(file, checkpoint.m_SuperRasW);
+		ReadVal(file, checkpoint.m_SuperRasH);
+		ReadVal(file, checkpoint.m_LastTemporalSample);
+		ReadVal(file, checkpoint.m_LastIter);
+		ReadVal(file, checkpoint.m_VibGamCount);
+		ReadVal(file, checkpoint.m_Vibrancy);
+		ReadVal(file, checkpoint.m_Gamma);
+		ReadVal(file, checkpoint.m_Background);
+		ReadVal(file, checkpoint.m_Stats.m_Iters);
+		ReadVal(file, checkpoint.m_Stats.m_Badvals);
+		ReadVal(file, checkpoint.m_Stats.m_IterMs);
+		ReadVal(file, checkpoint.m_Stats.m_RenderMs);
+		return file.good();
+	}
+
+	/// <summary>
+	/// Read the random contexts which follow the header.
+	/// </summary>
+	/// <param name="file">The file to read from</param>
+	/// <param name="rand">The vector to store them in, or nullptr to skip over them.</param>
+	/// <returns>True if success, else false.</returns>
+	static bool ReadRand(ifstream& file, vector<QTIsaac<ISAAC_SIZE, ISAAC_INT>>* rand)
+	{
+		size_t randCount = 0;
+		ReadVal(file, randCount);
+
+		if (!file.good() || randCount > 1024)
+			return false;
+
+		if (rand)
+		{
+			rand->resize(randCount);
+
+			if (randCount)
+				file.read(reinterpret_cast<char*>(rand->data()), randCount * sizeof((*rand)[0]));
+		}
+		else
+			file.seekg(randCount * sizeof(QTIsaac<ISAAC_SIZE, ISAAC_INT>), ios::cur);
+
+		return file.good();
+	}
+
+	/// <summary>
+	/// Read the runs of buckets written by Write() into the histogram.
+	/// When adding, the values are read in blocks which are added to the histogram in parallel.
+	/// The buckets of an index histogram are combined with AddIndexBucket() rather than summed.
+	/// </summary>
+	/// <param name="file">The file to read from</param>
+	/// <param name="add">True to add the values to the histogram, else false to resize the histogram and assign them.</param>
+	/// <returns>True if the histogram was the expected size and was read entirely, else false.</returns>
+	bool ReadHist(ifstream& file, bool add)
+	{
+		size_t histSize = 0;
+		const size_t maxBlockSize = 1024 * 64;//The number of buckets to read and add at a time.
+		vector<bucket> block;
+		ReadVal(file, histSize);
+
+		if (!file.good() || histSize != m_SuperRasW * m_SuperRasH || (add && histSize != m_Hist.size()))
+			return false;
+
+		if (!add)
+			m_Hist.resize(histSize);
+
+		for (size_t i = 0; i < histSize;)
+		{
+			size_t zeros = 0, count = 0;
+			ReadVal(file, zeros);
+			ReadVal(file, count);
+
+			if (!file.good() || (!zeros && !count) || zeros > histSize - i || count > histSize - i - zeros)
+				return false;
+
+			if (!add)
+				std::fill(m_Hist.data() + i, m_Hist.data() + i + zeros, bucket(0));
+
+			i += zeros;
+
+			if (!add)
+			{
+				if (count)
+					file.read(reinterpret_cast<char*>(m_Hist.data() + i), count * sizeof(bucket));
+
+				i += count;
+			}
+			else
+			{
+				while (count && file.good())
+				{
+					size_t blockSize = std::min(count, maxBlockSize);
+					block.resize(blockSize);
+					file.read(reinterpret_cast<char*>(block.data()), blockSize * sizeof(bucket));
+					if (m_IndexHist)
+						parallel_for(size_t(0), blockSize, [&](size_t j) { AddIndexBucket(m_Hist[i + j], block[j]); });
+					else
+						parallel_for(size_t(0), blockSize, [&](size_t j) { m_Hist[i + j] += block[j]; });
+
+					i += blockSize;
+					count -= blockSize;
+				}
+			}
+		}
+
+		return file.good();
+	}
+};
+
+/// <summary>
+/// Writes checkpoints to a file on a background thread, so a long render only pauses
+/// for as long as it takes to copy its state into memory.
+/// It's double buffered: a new checkpoint is copied into whichever buffer isn't being written.
+/// If a checkpoint is saved while the previous one is still waiting to be written, the waiting one is
+/// replaced, so the file always gets the most recent state and a slow disk never holds up rendering.
+/// Each buffer holds a full copy of the histogram, so they can be backed by files for renders whose
+/// histogram is too large to keep two more copies of in memory.
+/// Save() must only be called from one thread at a time.
+/// </summary>
+class EMBER_API CheckpointWriter
+{
+public:
+	/// <summary>
+	/// Constructor which starts the writing thread.
+	/// </summary>
+	/// <param name="filename">The full path and filename to write checkpoints to</param>
+	CheckpointWriter(const string& filename)
+		: m_Filename(filename)
+	{
+		m_Pending = NONE;
+		m_Writing = NONE;
+		m_Failures = 0;
+		m_Exit = false;
+		m_Thread = std::thread([&] { WriteLoop(); });
+	}
+
+	CheckpointWriter(const CheckpointWriter& writer) = delete;
+	CheckpointWriter& operator = (const CheckpointWriter& writer) = delete;
+
+	/// <summary>
+	/// Destructor which finishes writing any pending checkpoint and stops the writing thread.
+	/// </summary>
+	~CheckpointWriter()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Exit = true;
+		}
+
+		m_Cv.notify_all();
+
+		if (m_Thread.joinable())
+			m_Thread.join();
+	}
+
+	/// <summary>
+	/// Fill a free buffer with a new checkpoint on the calling thread, then hand it to the writing thread.
+	/// </summary>
+	/// <param name="snapshot">The function which fills in the checkpoint, returning false if it couldn't</param>
+	/// <returns>True if the checkpoint was filled in and queued for writing, else false.</returns>
+	bool Save(std::function<bool(RenderCheckpoint&)> snapshot)
+	{
+		size_t index;
+
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Pending = NONE;//Reuse the waiting buffer rather than letting the writer take it while it's filled.
+			index = m_Writing == 0 ? 1 : 0;
+		}
+
+		if (!snapshot(m_Buffers[index]))
+			return false;
+
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Pending = index;
+		}
+
+		m_Cv.notify_all();
+		return true;
+	}
+
+	/// <summary>
+	/// Set whether the histograms of the buffers are stored in temporary memory mapped files rather than on the heap.
+	/// Must be called before the first call to Save().
+	/// </summary>
+	/// <param name="fileBacked">True to store them in files, else false.</param>
+	/// <param name="path">The folder to create the files in. If empty, the system temporary folder is used.</param>
+	void Backing(bool fileBacked, const string& path)
+	{
+		for (auto& buffer : m_Buffers)
+			buffer.m_Hist.Backing(fileBacked, path);
+	}
+
+	/// <summary>
+	/// Wait until every saved checkpoint has been written.
+	/// </summary>
+	void Flush()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Cv.wait(lock, [&] { return m_Pending == NONE && m_Writing == NONE; });
+	}
+
+	/// <summary>
+	/// Wait for any writes in progress, then delete the checkpoint file.
+	/// Called once the render it holds has finished.
+	/// </summary>
+	void Remove()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Pending = NONE;
+		}
+
+		Flush();
+		remove(m_Filename.c_str());
+	}
+
+	/// <summary>
+	/// Accessors.
+	/// </summary>
+	const string& Filename() const { return m_Filename; }
+	size_t Failures() const { return m_Failures; }
+
+private:
+	/// <summary>
+	/// The body of the writing thread, which writes each pending checkpoint until told to exit.
+	/// </summary>
+	void WriteLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		while (true)
+		{
+			m_Cv.wait(lock, [&] { return m_Pending != NONE || m_Exit; });
+
+			if (m_Pending == NONE)
+				break;
+
+			size_t index = m_Writing = m_Pending;
+			m_Pending = NONE;
+			lock.unlock();
+			bool b = m_Buffers[index].Write(m_Filename);
+			lock.lock();
+			m_Writing = NONE;
+
+			if (!b)
+				m_Failures++;
+
+			m_Cv.notify_all();
+		}
+	}
+
+	static const size_t NONE = size_t(-1);
+	size_t m_Pending;//The index of the buffer waiting to be written, or NONE.
+	size_t m_Writing;//The index of the buffer being written, or NONE.
+	std::atomic<size_t> m_Failures;
+	bool m_Exit;
+	string m_Filename;
+	RenderCheckpoint m_Buffers[2];
+	std::mutex m_Mutex;
+	std::condition_variable m_Cv;
+	std::thread m_Thread;
+};
+}
@@ -11,8 +11,13 @@ template <typename T, typename bucketT>
 Renderer<T, bucketT>::Renderer()
 {
 	m_PixelAspectRatio = 1;
+	m_RunTime = 0;
+	m_IndexColorScalar = 1;
+	m_FinalRowStart = m_FinalRowEnd = 0;
+	m_AccumRowStart = m_AccumRowEnd = 0;
 	m_StandardIterator = unique_ptr<StandardIterator<T>>(new StandardIterator<T>());
 	m_XaosIterator = unique_ptr<XaosIterator<T>>(new XaosIterator<T>());
+	m_BatchIterator = unique_ptr<BatchIterator<T>>(new BatchIterator<T>());
 	m_Iterator = m_StandardIterator.get();
 }
 
@@ -39,6 +44,7 @@ void Renderer<T, bucketT>::AddEmber(Ember<T>& ember)
 	ChangeVal([&]
 	{
 		m_Embers.push_back(ember);
+		m_Interpolater.Reset();
 
 		if (m_Embers.size() == 1)
 			m_Ember = m_Embers[0];
@@ -48,7 +54,7 @@ void Renderer<T, bucketT>::AddEmber(Ember<T>& ember)
 /// <summary>
 /// Set the m_Iterator member to point to the appropriate
 /// iterator based on whether the ember currently being rendered
-/// contains xaos.
+/// contains xaos, and whether it qualifies for batched iteration.
 /// After assigning, initialize the xform selection buffer.
 /// </summary>
 /// <returns>True if assignment and distribution initialization succeeded, else false.</returns>
@@ -56,11 +62,13 @@ template <typename T, typename bucketT>
 bool Renderer<T, bucketT>::AssignIterator()
 {
 	//Setup iterator and distributions.
-	//Both iterator types were setup in the constructor (add more in the future if needed).
+	//All iterator types were setup in the constructor (add more in the future if needed).
 	//So simply assign the pointer to the correct type and re-initialize its distributions
 	//based on the current ember.
 	if (XaosPresent())
 		m_Iterator = m_XaosIterator.get();
+	else if (BatchIterator<T>::Qualifies(m_Ember, SubBatchSize(), FuseCount()))
+		m_Iterator = m_BatchIterator.get();
 	else
 		m_Iterator = m_StandardIterator.get();
 
@@ -101,6 +109,11 @@ void Renderer<T, bucketT>::ComputeBounds()
 	m_SuperRasW = (Supersample() * FinalRasW()) + (2 * m_GutterWidth);
 	m_SuperRasH = (Supersample() * FinalRasH()) + (2 * m_GutterWidth);
 	m_SuperSize = m_SuperRasW * m_SuperRasH;
+	//Default to a single tile covering the entire image. FilterAndAccumTiles() changes these for each tile it processes.
+	m_FinalRowStart = 0;
+	m_FinalRowEnd = FinalRasH();
+	m_AccumRowStart = 0;
+	m_AccumRowEnd = m_SuperRasH;
 }
 
 /// <summary>
@@ -163,6 +176,7 @@ void Renderer<T, bucketT>::SetEmber(Ember<T>& ember, eProcessAction action)
 		m_Embers.push_back(ember);
 		m_Embers[0].m_TemporalSamples = 1;//Set temporal samples here to 1 because using the real value only makes sense when using a vector of Embers for animation.
 		m_Ember = m_Embers[0];
+		m_Interpolater.Reset();
 	}, action);
 }
 
@@ -177,12 +191,162 @@ void Renderer<T, bucketT>::SetEmber(vector<Ember<T>>& embers)
 	ChangeVal([&]
 	{
 		m_Embers = embers;
+		m_Interpolater.Reset();
 
 		if (!m_Embers.empty())
 			m_Ember = m_Embers[0];
 	}, eProcessAction::FULL_RENDER);
 }
 
+/// <summary>
+/// Determine the least amount of processing needed to render the specified ember
+/// if it were to replace the single ember currently being rendered.
+/// Each field is classified by the earliest stage of the render it affects:
+///		Xforms, palette, camera, dimensions and anything else which changes where or with what color points land in the histogram: iterate again.
+///		An increase in quality: keep iterating.
+///		Brightness and density filter radii which don't change the gutter size: density filter again.
+///		Gamma, vibrancy, highlight power, background and curves: final accumulation only, or density filter again when clipping early.
+///		Names, edits and interpolation types: nothing.
+/// Filters whose parameters are unchanged are kept and reused when the render is resumed.
+/// The result is intended to be passed to SetEmber(), possibly combined with what the caller knows has changed.
+/// </summary>
+/// <param name="ember">The ember to compare against the current one</param>
+/// <returns>The process action the differences between the embers require</returns>
+template <typename T, typename bucketT>
+eProcessAction Renderer<T, bucketT>::RequiredProcessAction(const Ember<T>& ember) const
+{
+	auto action = eProcessAction::NOTHING;
+	auto require = [&](eProcessAction a) { if (a > action) action = a; };
+
+	//Animating, or nothing rendered yet to compare against.
+	if (m_Embers.size() != 1 || m_ProcessState == eProcessState::NONE)
+		return eProcessAction::FULL_RENDER;
+
+	const Ember<T>& current = m_Embers[0];
+	//Temporal samples are always forced to 1 for a single ember, and with more the color values are summed over every sample.
+	auto colorAction = ember.m_TemporalSamples > 1 ? eProcessAction::FULL_RENDER : (EarlyClip() ? eProcessAction::FILTER_AND_ACCUM : eProcessAction::ACCUM_ONLY);
+
+	//Anything which affects iteration or the dimensions of the histogram.
+	if (ember.m_FinalRasW != current.m_FinalRasW ||
+			ember.m_FinalRasH != current.m_FinalRasH ||
+			ember.m_SubBatchSize != current.m_SubBatchSize ||
+			ember.m_FuseCount != current.m_FuseCount ||
+			ember.m_Supersample != current.m_Supersample ||
+			ember.m_PixelsPerUnit != current.m_PixelsPerUnit ||
+			ember.m_Zoom != current.m_Zoom ||
+			ember.m_CamZPos != current.m_CamZPos ||
+			ember.m_CamPerspective != current.m_CamPerspective ||
+			ember.m_CamYaw != current.m_CamYaw ||
+			ember.m_CamPitch != current.m_CamPitch ||
+			ember.m_CamDepthBlur != current.m_CamDepthBlur ||
+			ember.m_CenterX != current.m_CenterX ||
+			ember.m_CenterY != current.m_CenterY ||
+			ember.m_RotCenterY != current.m_RotCenterY ||
+			ember.m_Rotate != current.m_Rotate ||
+			ember.m_SpatialFilterType != current.m_SpatialFilterType ||//Both affect the gutter.
+			ember.m_SpatialFilterRadius != current.m_SpatialFilterRadius ||
+			ember.m_TemporalFilterType != current.m_TemporalFilterType ||
+			ember.m_TemporalFilterWidth != current.m_TemporalFilterWidth ||
+			ember.m_TemporalFilterExp != current.m_TemporalFilterExp ||
+			ember.TotalXformCount() != current.TotalXformCount())
+		return eProcessAction::FULL_RENDER;
+
+	//Colors are looked up while iterating, so the histogram holds them, unless it holds palette indices.
+	if (ember.m_PaletteMode != current.m_PaletteMode ||
+			ember.m_Palette.m_Entries != current.m_Palette.m_Entries)
+	{
+		if (!IndexHist() || RendererType() != CPU_RENDERER)
+			return eProcessAction::FULL_RENDER;
+
+		require(eProcessAction::FILTER_AND_ACCUM);
+	}
+
+	for (size_t i = 0; i < ember.TotalXformCount(); i++)
+		if (!SameIteration(*ember.GetTotalXform(i), *current.GetTotalXform(i)))
+			return eProcessAction::FULL_RENDER;
+
+	if (ember.m_Quality < current.m_Quality)
+		return eProcessAction::FULL_RENDER;
+	else if (ember.m_Quality > current.m_Quality)
+		require(eProcessAction::KEEP_ITERATING);
+
+	//Density filtering can be redone on the existing histogram as long as the gutter, which depends on the max radius, stays the same size.
+	if (ember.m_MaxRadDE != current.m_MaxRadDE)
+	{
+		if ((ember.m_MaxRadDE > 0) != (current.m_MaxRadDE > 0) || std::ceil(ember.m_MaxRadDE) != std::ceil(current.m_MaxRadDE))
+			return eProcessAction::FULL_RENDER;
+
+		require(eProcessAction::FILTER_AND_ACCUM);
+	}
+
+	if (ember.m_MinRadDE != current.m_MinRadDE ||
+			ember.m_CurveDE != current.m_CurveDE ||
+			ember.m_Brightness != current.m_Brightness)//Used in k1.
+		require(eProcessAction::FILTER_AND_ACCUM);
+
+	if (ember.m_Gamma != current.m_Gamma ||
+			ember.m_Vibrancy != current.m_Vibrancy ||
+			ember.m_GammaThresh != current.m_GammaThresh ||
+			ember.m_HighlightPower != current.m_HighlightPower ||
+			ember.m_Background != current.m_Background ||
+			memcmp(&ember.m_Curves, &current.m_Curves, sizeof(Curves<T>)) != 0)
+		require(colorAction);
+
+	return action;
+}
+
+/// <summary>
+/// Determine whether two xforms produce the same iteration, ignoring values such as
+/// names, motion and animation which don't affect the rendering of a single ember.
+/// </summary>
+/// <param name="xform1">The first xform to compare</param>
+/// <param name="xform2">The second xform to compare</param>
+/// <returns>True if iterating with either xform gives the same histogram, else false.</returns>
+template <typename T, typename bucketT>
+bool Renderer<T, bucketT>::SameIteration(const Xform<T>& xform1, const Xform<T>& xform2)
+{
+	auto sameAffine = [&](const Affine2D<T>& a1, const Affine2D<T>& a2)
+	{
+		return a1.A() == a2.A() && a1.B() == a2.B() && a1.C() == a2.C() && a1.D() == a2.D() && a1.E() == a2.E() && a1.F() == a2.F();
+	};
+
+	if (xform1.m_Weight != xform2.m_Weight ||
+			xform1.m_ColorX != xform2.m_ColorX ||
+			xform1.m_ColorY != xform2.m_ColorY ||
+			xform1.m_ColorSpeed != xform2.m_ColorSpeed ||
+			xform1.m_Opacity != xform2.m_Opacity ||
+			xform1.m_DirectColor != xform2.m_DirectColor ||
+			!sameAffine(xform1.m_Affine, xform2.m_Affine) ||
+			!sameAffine(xform1.m_Post, xform2.m_Post) ||
+			xform1.XaosVec() != xform2.XaosVec() ||
+			xform1.TotalVariationCount() != xform2.TotalVariationCount())
+		return false;
+
+	for (size_t i = 0; i < xform1.TotalVariationCount(); i++)
+	{
+		auto var1 = xform1.GetVariation(i);
+		auto var2 = xform2.GetVariation(i);
+
+		if (var1->VariationId() != var2->VariationId() || var1->m_Weight != var2->m_Weight)
+			return false;
+
+		auto parVar1 = dynamic_cast<const ParametricVariation<T>*>(var1);
+		auto parVar2 = dynamic_cast<const ParametricVariation<T>*>(var2);
+
+		if (parVar1 && parVar2)
+		{
+			auto params1 = parVar1->Params();
+			auto params2 = parVar2->Params();
+
+			for (size_t j = 0; j < parVar1->ParamCount(); j++)
+				if (!params1[j].IsPrecalc() && params1[j].ParamVal() != params2[j].ParamVal())
+					return false;
+		}
+	}
+
+	return true;
+}
+
 /// <summary>
 /// Create the density filter if the current filter parameters differ
 /// from the last density filter created.
@@ -206,7 +370,11 @@ bool Renderer<T, bucketT>::CreateDEFilter(bool& newAlloc)
 				(m_Ember.m_CurveDE != m_DensityFilter->Curve()) ||
 				(m_Ember.m_Supersample != m_DensityFilter->Supersample()))
 		{
-			m_DensityFilter = unique_ptr<DensityFilter<bucketT>>(new DensityFilter<bucketT>(bucketT(m_Ember.m_MinRadDE), bucketT(m_Ember.m_MaxRadDE), bucketT(m_Ember.m_CurveDE), m_Ember.m_Supersample));
+			if (m_SharedFilters.get())
+				m_DensityFilter = m_SharedFilters->GetDensityFilter(bucketT(m_Ember.m_MinRadDE), bucketT(m_Ember.m_MaxRadDE), bucketT(m_Ember.m_CurveDE), m_Ember.m_Supersample);
+			else
+				m_DensityFilter = shared_ptr<DensityFilter<bucketT>>(new DensityFilter<bucketT>(bucketT(m_Ember.m_MinRadDE), bucketT(m_Ember.m_MaxRadDE), bucketT(m_Ember.m_CurveDE), m_Ember.m_Supersample));
+
 			newAlloc = true;
 		}
 
@@ -214,7 +382,7 @@ bool Renderer<T, bucketT>::CreateDEFilter(bool& newAlloc)
 		{
 			if (!m_DensityFilter.get()) { return false; }//Did object creation succeed?
 
-			if (!m_DensityFilter->Create()) { return false; }//Object creation succeeded, did filter creation succeed?
+			if (!m_SharedFilters.get() && !m_DensityFilter->Create()) { return false; }//Object creation succeeded, did filter creation succeed? Shared filters were created when first cached.
 
 			//cout << m_DensityFilter->ToString() << endl;
 		}
@@ -246,9 +414,15 @@ bool Renderer<T, bucketT>::CreateSpatialFilter(bool& newAlloc)
 			(m_Ember.m_Supersample != m_SpatialFilter->Supersample()) ||
 			(m_PixelAspectRatio != m_SpatialFilter->PixelAspectRatio()))
 	{
-		m_SpatialFilter = unique_ptr<SpatialFilter<bucketT>>(
-							  SpatialFilterCreator<bucketT>::Create(m_Ember.m_SpatialFilterType, bucketT(m_Ember.m_SpatialFilterRadius), m_Ember.m_Supersample, bucketT(m_PixelAspectRatio)));
-		m_Ember.m_SpatialFilterRadius = m_SpatialFilter->FilterRadius();//It may have been changed internally if it was too small, so ensure they're synced.
+		if (m_SharedFilters.get())
+			m_SpatialFilter = m_SharedFilters->GetSpatialFilter(m_Ember.m_SpatialFilterType, bucketT(m_Ember.m_SpatialFilterRadius), m_Ember.m_Supersample, bucketT(m_PixelAspectRatio));
+		else
+			m_SpatialFilter = shared_ptr<SpatialFilter<bucketT>>(
+								  SpatialFilterCreator<bucketT>::Create(m_Ember.m_SpatialFilterType, bucketT(m_Ember.m_SpatialFilterRadius), m_Ember.m_Supersample, bucketT(m_PixelAspectRatio)));
+
+		if (m_SpatialFilter.get())
+			m_Ember.m_SpatialFilterRadius = m_SpatialFilter->FilterRadius();//It may have been changed internally if it was too small, so ensure they're synced.
+
 		newAlloc = true;
 	}
 
@@ -329,6 +503,7 @@ eRenderStatus Renderer<T, bucketT>::Run(vector<byte>& finalImage, double time, s
 	bool filterAndAccumOnly = m_ProcessAction == eProcessAction::FILTER_AND_ACCUM;
 	bool accumOnly = m_ProcessAction == eProcessAction::ACCUM_ONLY;
 	bool resume = m_ProcessState != eProcessState::NONE;
+	bool restored = false;
 	bool newFilterAlloc;
 	size_t i, temporalSample = 0;
 	T deTime;
@@ -352,6 +527,7 @@ eRenderStatus Renderer<T, bucketT>::Run(vector<byte>& finalImage, double time, s
 		m_LastTemporalSample = 0;
 		m_LastIter = 0;
 		m_LastIterPercent = 0;
+		m_RunTime = time;
 		m_Stats.Clear();
 		m_Gamma = 0;
 		m_Vibrancy = 0;//Accumulate these after each temporal sample.
@@ -394,7 +570,7 @@ eRenderStatus Renderer<T, bucketT>::Run(vector<byte>& finalImage, double time, s
 	//it.Tic();
 	//Interpolate.
 	if (m_Embers.size() > 1)
-		Interpolater<T>::Interpolate(m_Embers, T(time), 0, m_Ember);
+		m_Interpolater.InterpolateInPlace(m_Embers, T(time), 0, m_Ember);
 
 	//it.Toc("Interp 1");
 
@@ -424,13 +600,27 @@ eRenderStatus Renderer<T, bucketT>::Run(vector<byte>& finalImage, double time, s
 	if (!resume)
 		ResetBuckets(true, false);//Only reset hist here and do accum when needed later on.
 
+	//Continue a render saved to a checkpoint by a previous process, rather than starting a new one.
+	if (!resume && m_ResumeCheckpoint)
+	{
+		restored = RestoreCheckpoint();
+		m_ResumeCheckpoint = nullptr;
+
+		if (!restored)
+		{
+			AddToReport("Checkpoint does not match the embers, time, dimensions or thread count being rendered, aborting.\n");
+			success = eRenderStatus::RENDER_ERROR;
+			goto Finish;
+		}
+	}
+
 	deTime = T(time) + m_TemporalFilter->Deltas()[0];
 
 	//Interpolate and get an ember for DE purposes.
 	//Additional interpolation will be done in the temporal samples loop.
 	//it.Tic();
 	if (m_Embers.size() > 1)
-		Interpolater<T>::Interpolate(m_Embers, deTime, 0, m_Ember);
+		m_Interpolater.InterpolateInPlace(m_Embers, deTime, 0, m_Ember);
 
 	//it.Toc("Interp 2");
 	ClampGteRef<T>(m_Ember.m_MinRadDE, 0);
@@ -445,7 +635,7 @@ eRenderStatus Renderer<T, bucketT>::Run(vector<byte>& finalImage, double time, s
 	}
 
 	//Temporal samples, loop 1.
-	temporalSample = resume ? m_LastTemporalSample : 0;
+	temporalSample = (resume || restored) ? m_LastTemporalSample : 0;
 
 	for (; (temporalSample < TemporalSamples()) && !m_Abort;)
 	{
@@ -455,7 +645,7 @@ eRenderStatus Renderer<T, bucketT>::Run(vector<byte>& finalImage, double time, s
 		//Interpolate again.
 		//it.Tic();
 		if (TemporalSamples() > 1 && m_Embers.size() > 1)
-			Interpolater<T>::Interpolate(m_Embers, temporalTime, 0, m_Ember);//This will perform all necessary precalcs via the ember/xform/variation assignment operators.
+			m_Interpolater.InterpolateInPlace(m_Embers, temporalTime, 0, m_Ember);//Only aligns when entering a new segment, and reuses the xforms of m_Ember. Precalcs are redone by Ember::Interpolate().
 
 		//it.Toc("Interp 3");
 
@@ -547,6 +737,21 @@ FilterAndAccum:
 	if (filterAndAccumOnly || temporalSample >= TemporalSamples() || forceOutput)
 	{
 		//t.Toc("Iterating and accumulating");
+		//The density filter radii may have changed without iterating again, so recreate the filter if they differ from the last one.
+		if (filterAndAccumOnly)
+		{
+			ClampGteRef<T>(m_Ember.m_MinRadDE, 0);
+			ClampGteRef<T>(m_Ember.m_MaxRadDE, 0);
+			ClampGteRef<T>(m_Ember.m_MaxRadDE, m_Ember.m_MinRadDE);
+
+			if (!CreateDEFilter(newFilterAlloc))
+			{
+				AddToReport("Density filter creation failed, aborting.\n");
+				success = eRenderStatus::RENDER_ERROR;
+				goto Finish;
+			}
+		}
+
 		//Compute k1 and k2.
 		auto fullRun = eRenderStatus::RENDER_OK;//Whether density filtering was run to completion without aborting prematurely or triggering an error.
 		T area = FinalRasW() * FinalRasH() / (m_PixelsPerUnitX * m_PixelsPerUnitY);//Need to use temps from field if ever implemented.
@@ -564,10 +769,21 @@ FilterAndAccum:
 			m_K2 = bucketT((Supersample() * Supersample()) / (area * m_ScaledQuality * m_TemporalFilter->SumFilt()));
 
 		ResetBuckets(false, true);//Only the histogram was reset above, now reset the density filtering buffer.
+		m_HistBuckets.Advise(eBufferAdvice::SEQUENTIAL);//Filtering reads the histogram in order. Only has an effect when out of core.
+		m_PackedHistBuckets.Advise(eBufferAdvice::SEQUENTIAL);
+
+		if (m_IndexHist)
+			MakeIndexPalette();//The palette may have changed since iterating.
+
 		//t.Tic();
 
 		//Apply appropriate filter if iterating is complete.
-		if (filterAndAccumOnly || temporalSample >= TemporalSamples())
+		//A tiled render filters each tile just before accumulating it below, since the accumulator only holds one tile.
+		if (TileCount() > 1)
+		{
+			fullRun = eRenderStatus::RENDER_OK;
+		}
+		else if (filterAndAccumOnly || temporalSample >= TemporalSamples())
 		{
 			fullRun = m_DensityFilter.get() ? GaussianDensityFilter() : LogScaleDensityFilter(forceOutput);
 		}
@@ -623,7 +839,9 @@ AccumOnly:
 			for (i = 0; i < COLORMAP_LENGTH; i++)
 				m_Csa[i] = m_Ember.m_Curves.BezierFunc(i / T(COLORMAP_LENGTH_MINUS_1)) * T(COLORMAP_LENGTH_MINUS_1);
 
-		if (AccumulatorToFinalImage(finalImage, finalOffset) == eRenderStatus::RENDER_OK)
+		auto accumStatus = TileCount() > 1 ? FilterAndAccumTiles(finalImage, finalOffset) : AccumulatorToFinalImage(finalImage, finalOffset);
+
+		if (accumStatus == eRenderStatus::RENDER_OK)
 		{
 			m_Stats.m_RenderMs = m_RenderTimer.Toc();//Record total time from the very beginning to the very end, including all intermediate calls.
 			//Even though the ember changes throughought the inner loops because of interpolation, it's probably ok to assign here.
@@ -644,7 +862,7 @@ AccumOnly:
 		}
 		else
 		{
-			success = eRenderStatus::RENDER_ERROR;
+			success = accumStatus == eRenderStatus::RENDER_ABORT ? accumStatus : eRenderStatus::RENDER_ERROR;
 		}
 	}
 
@@ -684,6 +902,110 @@ EmberImageComments Renderer<T, bucketT>::ImageComments(const EmberStats& stats,
 	return comments;
 }
 
+/// <summary>
+/// Copy the state of the render in progress into a checkpoint, so it can be written to disk and
+/// later passed to ResumeCheckpoint() to continue the render exactly where it left off.
+/// This must only be called between calls to Run(), usually ones made with a sub batch count override
+/// so that iteration is split into pieces.
+/// GPU renderers are not supported.
+/// </summary>
+/// <param name="checkpoint">The checkpoint to fill in</param>
+/// <returns>True if a render was in progress and its state was copied, else false.</returns>
+template <typename T, typename bucketT>
+bool Renderer<T, bucketT>::SaveCheckpoint(RenderCheckpoint& checkpoint)
+{
+	if (RendererType() != CPU_RENDERER)
+	{
+		AddToReport("Checkpoints are only supported by the CPU renderer.\n");
+		return false;
+	}
+
+	if (m_InRender || m_ProcessState == eProcessState::NONE || m_Embers.empty())
+		return false;
+
+	checkpoint.m_Hash = CheckpointHash();
+	checkpoint.m_IndexHist = m_IndexHist;
+	checkpoint.m_Time = m_RunTime;
+	checkpoint.m_SuperRasW = m_SuperRasW;
+	checkpoint.m_SuperRasH = m_SuperRasH;
+	checkpoint.m_LastTemporalSample = m_LastTemporalSample;
+	checkpoint.m_LastIter = m_LastIter;
+	checkpoint.m_VibGamCount = m_VibGamCount;
+	checkpoint.m_Vibrancy = float(m_Vibrancy);
+	checkpoint.m_Gamma = float(m_Gamma);
+	checkpoint.m_Background = m_Background;
+	checkpoint.m_Stats = m_Stats;
+	checkpoint.m_Rand = m_Rand;
+	checkpoint.m_Hist.resize(m_SuperSize);
+
+	if (m_PackedHistBuckets.empty())
+		std::copy(m_HistBuckets.data(), m_HistBuckets.data() + m_SuperSize, checkpoint.m_Hist.data());
+	else
+		parallel_for(size_t(0), m_SuperSize, [&](size_t i) { checkpoint.m_Hist[i] = m_PackedHistBuckets[i]; });
+
+	return true;
+}
+
+/// <summary>
+/// Restore the checkpoint passed to ResumeCheckpoint().
+/// Called by Run() after allocating and clearing the histogram for a new render.
+/// A packed histogram can't hold the exact values, so they are rounded the same way as hits are while iterating.
+/// </summary>
+/// <returns>True if the checkpoint was made from the same render and was restored, else false.</returns>
+template <typename T, typename bucketT>
+bool Renderer<T, bucketT>::RestoreCheckpoint()
+{
+	const RenderCheckpoint& checkpoint = *m_ResumeCheckpoint;
+
+	if (RendererType() != CPU_RENDERER ||
+			checkpoint.m_Hash != CheckpointHash() ||
+			checkpoint.m_Time != m_RunTime ||
+			checkpoint.m_SuperRasW != m_SuperRasW ||
+			checkpoint.m_SuperRasH != m_SuperRasH ||
+			checkpoint.m_Hist.size() != m_SuperSize ||
+			checkpoint.m_Rand.size() != m_Rand.size() ||
+			checkpoint.m_LastTemporalSample > TemporalSamples())
+		return false;
+
+	if (m_PackedHistBuckets.empty())
+	{
+		std::copy(checkpoint.m_Hist.data(), checkpoint.m_Hist.data() + m_SuperSize, m_HistBuckets.data());
+	}
+	else
+	{
+		for (size_t i = 0; i < m_SuperSize; i++)
+			if (checkpoint.m_Hist[i] != RenderCheckpoint::bucket(0))
+				m_PackedHistBuckets.Add(i, checkpoint.m_Hist[i], PackedHistogram<bucketT>::Dither(0, i));
+	}
+
+	m_Rand = checkpoint.m_Rand;
+	m_Stats = checkpoint.m_Stats;
+	m_LastTemporalSample = checkpoint.m_LastTemporalSample;
+	m_LastIter = checkpoint.m_LastIter;
+	m_VibGamCount = checkpoint.m_VibGamCount;
+	m_Vibrancy = bucketT(checkpoint.m_Vibrancy);
+	m_Gamma = bucketT(checkpoint.m_Gamma);
+	m_Background = checkpoint.m_Background;
+	return true;
+}
+
+/// <summary>
+/// Hash the content of the embers being rendered, to identify the render a checkpoint was made from.
+/// An index histogram does not depend on the palette, so it is left out of the hash when one is used,
+/// which allows a checkpoint to be resumed and filtered with a different palette.
+/// </summary>
+/// <returns>The hash</returns>
+template <typename T, typename bucketT>
+uint64_t Renderer<T, bucketT>::CheckpointHash()
+{
+	uint64_t hash = HashVal(m_IndexHist, HASH_SEED);
+
+	for (auto& ember : m_Embers)
+		hash = ember.Hash(hash, !m_IndexHist);
+
+	return hash;
+}
+
 /// <summary>
 /// New virtual functions to be overridden in derived renderers that use the GPU, but not accessed outside.
 /// </summary>
@@ -696,6 +1018,7 @@ template <typename T, typename bucketT>
 void Renderer<T, bucketT>::MakeDmap(T colorScalar)
 {
 	m_Ember.m_Palette.template MakeDmap<bucketT>(m_Dmap, colorScalar);
+	m_IndexColorScalar = bucketT(colorScalar);
 }
 
 /// <summary>
@@ -707,25 +1030,103 @@ template <typename T, typename bucketT>
 bool Renderer<T, bucketT>::Alloc(bool histOnly)
 {
 	bool b = true;
+	bool outOfCore = m_OutOfCore && RendererType() == CPU_RENDERER;
+	bool packed = m_PackedHist && !m_IndexHist && RendererType() == CPU_RENDERER;//The moments of an index histogram need more precision than 14-bit mantissas.
+	size_t histSize = packed ? 0 : m_SuperSize;
+	size_t packedSize = packed ? m_SuperSize : 0;
+	size_t threadHists = (m_PrivateHist && !outOfCore && !packed) ? m_ThreadsToUse : 0;//Full size private histograms would defeat the purpose of keeping the histogram out of core or packed.
+	size_t threadHits = outOfCore ? m_ThreadsToUse : 0;
+	size_t blockCount = (m_SuperSize + HIST_BLOCK_SIZE - 1) / HIST_BLOCK_SIZE;
+	size_t accumRows = 0, finalRowStart, finalRowEnd, accumRowStart, accumRowEnd;
+
+	//The accumulator only needs to be large enough to hold the largest tile.
+	for (size_t tile = 0; tile < TileCount(); tile++)
+	{
+		TileRows(tile, finalRowStart, finalRowEnd, accumRowStart, accumRowEnd);
+		accumRows = std::max(accumRows, accumRowEnd - accumRowStart);
+	}
+
+	size_t accumSize = accumRows * m_SuperRasW;
 	bool lock =
-		(m_SuperSize         != m_HistBuckets.size())        ||
-		(m_SuperSize         != m_AccumulatorBuckets.size()) ||
+		(histSize            != m_HistBuckets.size())        ||
+		(packedSize          != m_PackedHistBuckets.size())  ||
+		(accumSize           != m_AccumulatorBuckets.size()) ||
 		(m_ThreadsToUse      != m_Samples.size())            ||
+		(threadHists         != m_ThreadHistBuckets.size())  ||
+		(threadHits          != m_ThreadHits.size())         ||
+		(outOfCore           != m_HistBuckets.FileBacked())  ||
+		(outOfCore           != m_AccumulatorBuckets.FileBacked()) ||
 		(m_Samples[0].size() != SubBatchSize());
 
+	for (auto& threadHist : m_ThreadHistBuckets)
+		lock |= (m_SuperSize != threadHist.size());
+
 	if (lock)
 		EnterResize();
 
-	if (m_SuperSize != m_HistBuckets.size())
+	//Switching between memory and file backing releases the buffer, so it will be resized below.
+	m_HistBuckets.Backing(outOfCore, m_OutOfCorePath);
+	m_AccumulatorBuckets.Backing(outOfCore, m_OutOfCorePath);
+	m_PackedHistBuckets.Backing(outOfCore, m_OutOfCorePath);
+	m_DensitySAT.Backing(outOfCore, m_OutOfCorePath);//Built and released by density filtering, so only the backing is set here.
+
+	if (histSize != m_HistBuckets.size())
 	{
-		m_HistBuckets.resize(m_SuperSize);
+		m_HistBuckets.resize(histSize);
 
-		if (m_ReclaimOnResize)
+		if (m_ReclaimOnResize || !histSize)
 			m_HistBuckets.shrink_to_fit();
 
-		b &= (m_HistBuckets.size() == m_SuperSize);
+		b &= (m_HistBuckets.size() == histSize);
+	}
+
+	if (packedSize != m_PackedHistBuckets.size())
+	{
+		m_PackedHistBuckets.resize(packedSize);
+
+		if (m_ReclaimOnResize || !packedSize)
+			m_PackedHistBuckets.shrink_to_fit();
+
+		b &= (m_PackedHistBuckets.size() == packedSize);
+	}
+
+	//Per-thread histograms are only kept around while they are in use since each one is the full size of the main histogram.
+	if (threadHists != m_ThreadHistBuckets.size())
+	{
+		m_ThreadHistBuckets.resize(threadHists);
+		m_ThreadHistBlocksUsed.resize(threadHists);
+		m_ThreadHistBuckets.shrink_to_fit();
+		m_ThreadHistBlocksUsed.shrink_to_fit();
+		b &= (m_ThreadHistBuckets.size() == threadHists) && (m_ThreadHistBlocksUsed.size() == threadHists);
+	}
+
+	for (size_t i = 0; i < m_ThreadHistBuckets.size(); i++)
+	{
+		if (m_ThreadHistBuckets[i].size() != m_SuperSize)
+		{
+			m_ThreadHistBuckets[i].resize(m_SuperSize);
+			m_ThreadHistBlocksUsed[i].resize(blockCount);
+
+			if (m_ReclaimOnResize)
+			{
+				m_ThreadHistBuckets[i].shrink_to_fit();
+				m_ThreadHistBlocksUsed[i].shrink_to_fit();
+			}
+
+			b &= (m_ThreadHistBuckets[i].size() == m_SuperSize) && (m_ThreadHistBlocksUsed[i].size() == blockCount);
+		}
 	}
 
+	if (threadHits != m_ThreadHits.size())
+	{
+		m_ThreadHits.resize(threadHits);
+		m_ThreadHits.shrink_to_fit();
+		b &= (m_ThreadHits.size() == threadHits);
+	}
+
+	for (auto& hits : m_ThreadHits)
+		hits.reserve(HIST_HIT_BUFFER_SIZE + SubBatchSize());//A full sub batch can be added before the buffer is checked.
+
 	if (histOnly)
 	{
 		if (lock)
@@ -734,14 +1135,14 @@ bool Renderer<T, bucketT>::Alloc(bool histOnly)
 		return b;
 	}
 
-	if (m_SuperSize != m_AccumulatorBuckets.size())
+	if (accumSize != m_AccumulatorBuckets.size())
 	{
-		m_AccumulatorBuckets.resize(m_SuperSize);
+		m_AccumulatorBuckets.resize(accumSize);
 
-		if (m_ReclaimOnResize)
+		if (m_ReclaimOnResize || accumSize < m_SuperSize)
 			m_AccumulatorBuckets.shrink_to_fit();
 
-		b &= (m_AccumulatorBuckets.size() == m_SuperSize);
+		b &= (m_AccumulatorBuckets.size() == accumSize);
 	}
 
 	if (m_ThreadsToUse != m_Samples.size())
@@ -788,6 +1189,18 @@ bool Renderer<T, bucketT>::ResetBuckets(bool resetHist, bool resetAccum)
 	if (resetHist && !m_HistBuckets.empty())
 		Memset(m_HistBuckets);
 
+	if (resetHist && !m_PackedHistBuckets.empty())
+		m_PackedHistBuckets.Clear();
+
+	if (resetHist)
+	{
+		for (size_t i = 0; i < m_ThreadHistBuckets.size(); i++)
+		{
+			Memset(m_ThreadHistBuckets[i]);
+			Memset(m_ThreadHistBlocksUsed[i]);
+		}
+	}
+
 	//},
 	//[&]
 	//{
@@ -834,9 +1247,10 @@ void Renderer<T, bucketT>::VectorizedLogScale(size_t row, size_t rowEnd)
 template <typename T, typename bucketT>
 eRenderStatus Renderer<T, bucketT>::LogScaleDensityFilter(bool forceOutput)
 {
-	size_t startRow = 0;
-	size_t endRow = m_SuperRasH;
+	size_t startRow = m_AccumRowStart;
+	size_t endRow = m_AccumRowEnd;
 	size_t endCol = m_SuperRasW;
+	size_t accumOffset = m_AccumRowStart * m_SuperRasW;//The accumulator only holds the rows of the current tile.
 	//Timing t(4);
 	//if (forceOutput)//Assume interactive render, so speed up at the expense of slight quality.
 	//{
@@ -863,13 +1277,15 @@ eRenderStatus Renderer<T, bucketT>::LogScaleDensityFilter(bool forceOutput)
 			{
 				for (size_t i = row; i < rowEnd; i++)
 				{
+					auto bucket = HistBucket(i);
+
 					//Check for visibility first before doing anything else to avoid all possible unnecessary calculations.
-					if (m_HistBuckets[i].a != 0)
+					if (bucket.a != 0)
 					{
-						bucketT logScale = (m_K1 * std::log(1 + m_HistBuckets[i].a * m_K2)) / m_HistBuckets[i].a;
+						bucketT logScale = (m_K1 * std::log(1 + bucket.a * m_K2)) / bucket.a;
 						//Original did a temporary assignment, then *= logScale, then passed the result to bump_no_overflow().
 						//Combine here into one operation for a slight speedup.
-						m_AccumulatorBuckets[i] = m_HistBuckets[i] * logScale;
+						m_AccumulatorBuckets[i - accumOffset] = bucket * logScale;
 					}
 				}
 			}
@@ -889,16 +1305,26 @@ eRenderStatus Renderer<T, bucketT>::LogScaleDensityFilter(bool forceOutput)
 template <typename T, typename bucketT>
 eRenderStatus Renderer<T, bucketT>::GaussianDensityFilter()
 {
+	if (m_TiledDE)
+		return GaussianDensityFilterTiled();
+
 	Timing totalTime, localTime;
 	bool scf = !(Supersample() & 1);
 	intmax_t ss = Floor<T>(Supersample() / T(2));
 	T scfact = std::pow(Supersample() / (Supersample() + T(1)), T(2));
 	size_t threads = m_ThreadsToUse;
-	size_t startRow = Supersample() - 1;
-	size_t endRow = m_SuperRasH - (Supersample() - 1);//Original did + which is most likely wrong.
+	size_t deWidth = size_t(m_DensityFilter->FilterWidth());
+	//Only filter the rows close enough to scatter into the rows of the current tile.
+	size_t startRow = std::max<size_t>(Supersample() - 1, m_AccumRowStart - std::min(m_AccumRowStart, deWidth));
+	size_t endRow = std::min<size_t>(m_SuperRasH - (Supersample() - 1), m_AccumRowEnd + deWidth);//Original did + which is most likely wrong.
 	intmax_t startCol = Supersample() - 1;
 	intmax_t endCol = m_SuperRasW - (Supersample() - 1);
 	size_t chunkSize = size_t(ceil(double(endRow - startRow) / double(threads)));
+
+	//Build the table of hit counts up front, so the density box for each bucket is a constant time lookup rather than O(ss^2).
+	if (ss > 0)
+		BuildDensitySAT(intmax_t(startRow), intmax_t(endRow), ss, scf, scfact);
+
 	//parallel_for scales very well, dividing the work almost perfectly among all processors.
 	parallel_for(size_t(0), threads, [&] (size_t threadIndex)
 	{
@@ -912,8 +1338,8 @@ eRenderStatus Renderer<T, bucketT>::GaussianDensityFilter()
 		for (intmax_t j = localStartRow; (j < localEndRow) && !m_Abort; j++)
 		{
 			size_t bucketRowStart = j * m_SuperRasW;//Pull out of inner loop for optimization.
-			const tvec4<bucketT, glm::defaultp>* bucket;
-			const tvec4<bucketT, glm::defaultp>* buckets = m_HistBuckets.data();
+			tvec4<bucketT, glm::defaultp> bucketVal;
+			const tvec4<bucketT, glm::defaultp>* bucket = &bucketVal;
 			const bucketT* filterCoefs = m_DensityFilter->Coefs();
 			const bucketT* filterWidths = m_DensityFilter->Widths();
 
@@ -921,51 +1347,14 @@ eRenderStatus Renderer<T, bucketT>::GaussianDensityFilter()
 			{
 				intmax_t ii, jj, arrFilterWidth;
 				size_t filterSelectInt, filterCoefIndex;
-				T filterSelect = 0;
-				bucket = buckets + bucketRowStart + i;
+				bucketVal = HistBucket(bucketRowStart + i);
 
 				//Don't do anything if there's no hits here. Must also put this first to avoid dividing by zero below.
 				if (bucket->a == 0)
 					continue;
 
 				bucketT cacheLog = (m_K1 * std::log(1 + bucket->a * m_K2)) / bucket->a;//Caching this calculation gives a 30% speedup.
-
-				if (ss == 0)
-				{
-					filterSelect = bucket->a;
-				}
-				else
-				{
-					//The original contained a glaring flaw as it would run past the boundaries of the buffers
-					//when calculating the density for a box centered on the last row or column.
-					//Clamp here to not run over the edge.
-					intmax_t densityBoxLeftX = (i - std::min(i, ss));
-					intmax_t densityBoxRightX = (i + std::min(ss, intmax_t(m_SuperRasW) - i - 1));
-					intmax_t densityBoxTopY = (j - std::min(j, ss));
-					intmax_t densityBoxBottomY = (j + std::min(ss, intmax_t(m_SuperRasH) - j - 1));
-
-					//Count density in ssxss area.
-					//Original went one col at a time, which is cache inefficient. Go one row at at time here for a slight speedup.
-					for (jj = densityBoxTopY; jj <= densityBoxBottomY; jj++)
-						for (ii = densityBoxLeftX; ii <= densityBoxRightX; ii++)
-							filterSelect += buckets[ii + (jj * m_SuperRasW)].a;//Original divided by 255 in every iteration. Omit here because colors are already in the range of [0..1].
-				}
-
-				//Scale if supersample > 1 for equal iters.
-				if (scf)
-					filterSelect *= scfact;
-
-				if (filterSelect > m_DensityFilter->MaxFilteredCounts())
-					filterSelectInt = m_DensityFilter->MaxFilterIndex();
-				else if (filterSelect <= DE_THRESH)
-					filterSelectInt = size_t(ceil(filterSelect)) - 1;
-				else
-					filterSelectInt = DE_THRESH + size_t(Floor<T>(std::pow(filterSelect - DE_THRESH, m_DensityFilter->Curve())));
-
-				//If the filter selected below the min specified clamp it to the min.
-				if (filterSelectInt > m_DensityFilter->MaxFilterIndex())
-					filterSelectInt = m_DensityFilter->MaxFilterIndex();
-
+				filterSelectInt = DensityFilterIndex(bucket->a, i, j, ss, scf, scfact);
 				//Only have to calculate the values for ~1/8 of the square.
 				filterCoefIndex = filterSelectInt * m_DensityFilter->KernelSize();
 				arrFilterWidth = intmax_t(ceil(filterWidths[filterSelectInt])) - 1;
@@ -1037,6 +1426,8 @@ eRenderStatus Renderer<T, bucketT>::GaussianDensityFilter()
 		}
 	});
 
+	m_DensitySAT.Clear();
+
 	if (m_Callback && !m_Abort)
 		m_Callback->ProgressFunc(m_Ember, m_ProgressParameter, 100.0, 1, 0);
 
@@ -1044,6 +1435,308 @@ eRenderStatus Renderer<T, bucketT>::GaussianDensityFilter()
 	return m_Abort ? eRenderStatus::RENDER_ABORT : eRenderStatus::RENDER_OK;
 }
 
+/// <summary>
+/// Perform Gaussian density estimation filtering by scattering tiles of the histogram in parallel, rather than rows.
+/// The histogram is divided into square tiles at least twice as wide as the largest filter radius, so the region
+/// any tile writes to, including its halo, can only overlap the regions of its 8 neighbors.
+/// The tiles are processed in four passes, one for each combination of even/odd tile row and column, so no two
+/// tiles processed at the same time ever write to the same accumulator bucket. This removes the races at the
+/// chunk borders of the row based filter.
+/// A bucket whose kernel lies entirely within the accumulator has its kernel applied one full row at a time, with no
+/// bounds checks or branches, using a copy of the coefficients with everything outside of each kernel's width zeroed.
+/// Only buckets near the edges use the bounds checked AddToAccum().
+/// </summary>
+/// <returns>True if not prematurely aborted, else false.</returns>
+template <typename T, typename bucketT>
+eRenderStatus Renderer<T, bucketT>::GaussianDensityFilterTiled()
+{
+	Timing totalTime;
+	bool scf = !(Supersample() & 1);
+	intmax_t ss = Floor<T>(Supersample() / T(2));
+	T scfact = std::pow(Supersample() / (Supersample() + T(1)), T(2));
+	intmax_t filterWidth = m_DensityFilter->FilterWidth();
+	intmax_t accumRowStart = m_AccumRowStart;
+	intmax_t accumRowEnd = m_AccumRowEnd;
+	intmax_t startRow = std::max<intmax_t>(Supersample() - 1, accumRowStart - filterWidth);//Only the rows close enough to scatter into the current tile.
+	intmax_t endRow = std::min<intmax_t>(m_SuperRasH - (Supersample() - 1), accumRowEnd + filterWidth);
+	intmax_t startCol = Supersample() - 1;
+	intmax_t endCol = m_SuperRasW - (Supersample() - 1);
+	intmax_t w = filterWidth + 1;
+	intmax_t tileSize = std::max<intmax_t>(DE_TILE_SIZE, 2 * filterWidth);
+	size_t tilesX = size_t(ceil(double(endCol - startCol) / double(tileSize)));
+	size_t tilesY = size_t(ceil(double(endRow - startRow) / double(tileSize)));
+	size_t kernelSize = m_DensityFilter->KernelSize();
+	size_t filterCount = m_DensityFilter->BufferSize();
+	const bucketT* filterWidths = m_DensityFilter->Widths();
+	const uint* coefIndices = m_DensityFilter->CoefIndices();
+	vector<bucketT> filterCoefs(m_DensityFilter->Coefs(), m_DensityFilter->Coefs() + (filterCount * kernelSize));
+	vector<intmax_t> arrFilterWidths(filterCount);
+
+	if (ss > 0)
+		BuildDensitySAT(startRow, endRow, ss, scf, scfact);
+
+	//Zero the coefficients outside of each kernel's width so every kernel can be applied as a full square.
+	for (size_t f = 0; f < filterCount; f++)
+	{
+		size_t filterCoefIndex = f * kernelSize;
+		arrFilterWidths[f] = intmax_t(ceil(filterWidths[f])) - 1;
+
+		for (intmax_t jj = 0; jj <= filterWidth; jj++)
+			for (intmax_t ii = 0; ii <= jj; ii++, filterCoefIndex++)
+				if (jj > arrFilterWidths[f])
+					filterCoefs[filterCoefIndex] = 0;
+	}
+
+	for (size_t pass = 0; pass < 4 && !m_Abort; pass++)
+	{
+		parallel_for(size_t(0), tilesX * tilesY, [&] (size_t tile)
+		{
+			size_t tileX = tile % tilesX, tileY = tile / tilesX;
+
+			if ((((tileY & 1) << 1) | (tileX & 1)) != pass)
+				return;
+
+			intmax_t tileStartRow = startRow + intmax_t(tileY) * tileSize;
+			intmax_t tileEndRow = std::min(tileStartRow + tileSize, endRow);
+			intmax_t tileStartCol = startCol + intmax_t(tileX) * tileSize;
+			intmax_t tileEndCol = std::min(tileStartCol + tileSize, endCol);
+
+			for (intmax_t j = tileStartRow; (j < tileEndRow) && !m_Abort; j++)
+			{
+				for (intmax_t i = tileStartCol; i < tileEndCol; i++)
+				{
+					intmax_t ii, jj;
+					const tvec4<bucketT, glm::defaultp> bucketVal = HistBucket((j * m_SuperRasW) + i);
+					const tvec4<bucketT, glm::defaultp>* bucket = &bucketVal;
+
+					//Don't do anything if there's no hits here. Must also put this first to avoid dividing by zero below.
+					if (bucket->a == 0)
+						continue;
+
+					bucketT cacheLog = (m_K1 * std::log(1 + bucket->a * m_K2)) / bucket->a;
+					size_t filterSelectInt = DensityFilterIndex(bucket->a, i, j, ss, scf, scfact);
+					intmax_t arrFilterWidth = arrFilterWidths[filterSelectInt];
+					const bucketT* coefs = filterCoefs.data() + (filterSelectInt * kernelSize);
+
+					if (i >= arrFilterWidth && i + arrFilterWidth < intmax_t(m_SuperRasW) &&
+							j - arrFilterWidth >= accumRowStart && j + arrFilterWidth < accumRowEnd)
+					{
+						for (jj = -arrFilterWidth; jj <= arrFilterWidth; jj++)
+						{
+							tvec4<bucketT, glm::defaultp>* accum = m_AccumulatorBuckets.data() + ((j + jj - accumRowStart) * m_SuperRasW) + i;
+							const uint* rowCoefIndices = coefIndices + (std::abs(jj) * w);
+
+							for (ii = -arrFilterWidth; ii <= arrFilterWidth; ii++)
+								accum[ii] += *bucket * (coefs[rowCoefIndices[std::abs(ii)]] * cacheLog);
+						}
+					}
+					else
+					{
+						for (jj = -arrFilterWidth; jj <= arrFilterWidth; jj++)
+						{
+							const uint* rowCoefIndices = coefIndices + (std::abs(jj) * w);
+
+							for (ii = -arrFilterWidth; ii <= arrFilterWidth; ii++)
+								AddToAccum(*bucket * (coefs[rowCoefIndices[std::abs(ii)]] * cacheLog), i, ii, j, jj);
+						}
+					}
+				}
+			}
+		});
+
+		if (m_Callback && !m_Abort)
+		{
+			double percent = double(pass + 1) * 25.0;
+			double etaMs = ((100.0 - percent) / percent) * totalTime.Toc();
+
+			if (!m_Callback->ProgressFunc(m_Ember, m_ProgressParameter, percent, 1, etaMs))
+				Abort();
+		}
+	}
+
+	m_DensitySAT.Clear();
+	return m_Abort ? eRenderStatus::RENDER_ABORT : eRenderStatus::RENDER_OK;
+}
+
+/// <summary>
+/// Get the value of a histogram bucket, whether the histogram is packed or not.
+/// If the histogram holds palette indices, the bucket is converted to a color first.
+/// </summary>
+/// <param name="i">The index of the bucket</param>
+/// <returns>The bucket</returns>
+template <typename T, typename bucketT>
+tvec4<bucketT, glm::defaultp> Renderer<T, bucketT>::HistBucket(size_t i) const
+{
+	if (m_IndexHist)
+		return IndexBucketColor(m_HistBuckets[i]);
+
+	return m_PackedHistBuckets.empty() ? m_HistBuckets[i] : m_PackedHistBuckets[i];
+}
+
+/// <summary>
+/// Make the tables used to apply the palette to the buckets of an index histogram.
+/// The first holds the colors of the current palette, and the second holds the integral of the palette
+/// from index 0 up to each whole index, treating it as a step or piecewise linear function
+/// of the index depending on the palette mode, the same way Accumulate() looks up colors.
+/// Must be called before filtering whenever the palette or palette mode has changed.
+/// </summary>
+template <typename T, typename bucketT>
+void Renderer<T, bucketT>::MakeIndexPalette()
+{
+	bool linear = PaletteMode() == ePaletteMode::PALETTE_LINEAR;
+	m_IndexPalette.resize(COLORMAP_LENGTH);
+	m_IndexPaletteSums.resize(COLORMAP_LENGTH + 1);
+	m_IndexPaletteSums[0] = tvec4<bucketT, glm::defaultp>(0);
+
+	for (size_t i = 0; i < COLORMAP_LENGTH; i++)
+	{
+		auto& entry = m_Ember.m_Palette.m_Entries[std::min(i, m_Ember.m_Palette.m_Entries.size() - 1)];
+		m_IndexPalette[i] = tvec4<bucketT, glm::defaultp>(bucketT(entry.r), bucketT(entry.g), bucketT(entry.b), 0);
+	}
+
+	for (size_t i = 0; i < COLORMAP_LENGTH; i++)
+	{
+		if (linear && i < COLORMAP_LENGTH_MINUS_1)
+			m_IndexPaletteSums[i + 1] = m_IndexPaletteSums[i] + ((m_IndexPalette[i] + m_IndexPalette[i + 1]) * bucketT(0.5));
+		else
+			m_IndexPaletteSums[i + 1] = m_IndexPaletteSums[i] + m_IndexPalette[i];
+	}
+}
+
+/// <summary>
+/// Get the integral of the palette from index 0 up to a fractional index.
+/// MakeIndexPalette() must have been called first.
+/// </summary>
+/// <param name="index">The index to integrate up to, in the range [0, COLORMAP_LENGTH]</param>
+/// <returns>The integral of each color channel</returns>
+template <typename T, typename bucketT>
+tvec4<bucketT, glm::defaultp> Renderer<T, bucketT>::IndexPaletteSum(bucketT index) const
+{
+	size_t i = std::min<size_t>(size_t(index), COLORMAP_LENGTH_MINUS_1);
+	bucketT frac = index - bucketT(i);
+
+	if (PaletteMode() == ePaletteMode::PALETTE_LINEAR && i < COLORMAP_LENGTH_MINUS_1)
+		return m_IndexPaletteSums[i] + (m_IndexPalette[i] * frac) + ((m_IndexPalette[i + 1] - m_IndexPalette[i]) * (frac * frac * bucketT(0.5)));
+
+	return m_IndexPaletteSums[i] + (m_IndexPalette[i] * frac);
+}
+
+/// <summary>
+/// Convert a bucket of an index histogram to the color it would have had if the palette had been
+/// applied while iterating.
+/// The indices of the hits are assumed to be spread evenly over the range with the same mean and variance
+/// as the bucket holds, so the color is the average of the palette over that range, scaled by the total weight.
+/// MakeIndexPalette() must have been called first.
+/// </summary>
+/// <param name="bucket">The bucket, holding the weight, the weighted mean of the indices, the weighted sum of their squared distances from it, and the hit count</param>
+/// <returns>The bucket with the palette applied</returns>
+template <typename T, typename bucketT>
+tvec4<bucketT, glm::defaultp> Renderer<T, bucketT>::IndexBucketColor(const tvec4<bucketT, glm::defaultp>& bucket) const
+{
+	tvec4<bucketT, glm::defaultp> color(0);
+
+	if (bucket.r > 0)
+	{
+		bucketT mean = bucket.g;
+		bucketT halfWidth = std::sqrt(std::max<bucketT>(bucket.b / bucket.r, 0) * 3);//A uniform distribution with variance v spans sqrt(3 * v) each way.
+		bucketT lo = Clamp<bucketT>(mean - halfWidth, 0, COLORMAP_LENGTH);
+		bucketT hi = Clamp<bucketT>(mean + halfWidth, 0, COLORMAP_LENGTH);
+
+		if (hi - lo > bucketT(0.001))
+		{
+			color = (IndexPaletteSum(hi) - IndexPaletteSum(lo)) * (bucket.r / (hi - lo));
+		}
+		else//All hits had the same index, so just look up its color.
+		{
+			size_t i = std::min<size_t>(size_t(Clamp<bucketT>(mean, 0, COLORMAP_LENGTH)), COLORMAP_LENGTH_MINUS_1);
+
+			if (PaletteMode() == ePaletteMode::PALETTE_LINEAR && i < COLORMAP_LENGTH_MINUS_1)
+				color = ((m_IndexPalette[i] * (1 - (mean - bucketT(i)))) + (m_IndexPalette[i + 1] * (mean - bucketT(i)))) * bucket.r;
+			else
+				color = m_IndexPalette[i] * bucket.r;
+		}
+	}
+
+	color.a = bucket.a;
+	return color;
+}
+
+/// <summary>
+/// Build the summed-area table of hit counts used by DensityFilterIndex() for the rows density filtering is about to read,
+/// which are the rows being filtered plus the ss rows above and below them.
+/// Each bucket is clamped to the count above which any box containing it selects the last kernel anyway,
+/// and to what a full box of them can hold without overflowing the fixed point sums of the table.
+/// The table is released by the caller once filtering is done.
+/// </summary>
+/// <param name="startRow">The first row to be filtered</param>
+/// <param name="endRow">One past the last row to be filtered</param>
+/// <param name="ss">Half the supersample, which is the radius of the box to count hits in</param>
+/// <param name="scf">Whether the supersample is even, in which case the count is scaled by scfact</param>
+/// <param name="scfact">The scale factor to apply to the count for even supersample values</param>
+template <typename T, typename bucketT>
+void Renderer<T, bucketT>::BuildDensitySAT(intmax_t startRow, intmax_t endRow, intmax_t ss, bool scf, T scfact)
+{
+	double boxArea = double(SQR(2 * ss + 1));
+	double maxHits = std::min(double(m_DensityFilter->MaxFilteredCounts()) / (scf ? double(scfact) : 1.0) + 1, (double(1u << (32 - SAT_FRAC_BITS)) / boxArea) - 1);
+	size_t rowStart = size_t(std::max<intmax_t>(0, startRow - ss));
+	size_t rowEnd = size_t(std::min<intmax_t>(intmax_t(m_SuperRasH), endRow + ss));
+	m_DensitySAT.Build([&](size_t i) { return HistBucket(i).a; }, m_SuperRasW, rowStart, rowEnd, maxHits);
+}
+
+/// <summary>
+/// Select which density estimation kernel to use for a bucket, based on the number of hits
+/// in the supersample sized box around it.
+/// When ss is greater than 0, m_DensitySAT must have already been built by BuildDensitySAT() for the rows being filtered.
+/// </summary>
+/// <param name="hits">The hit count of the bucket, used when ss is 0</param>
+/// <param name="i">The column of the bucket</param>
+/// <param name="j">The row of the bucket</param>
+/// <param name="ss">Half the supersample, which is the radius of the box to count hits in</param>
+/// <param name="scf">Whether the supersample is even, in which case the count is scaled by scfact</param>
+/// <param name="scfact">The scale factor to apply to the count for even supersample values</param>
+/// <returns>The index of the kernel to use</returns>
+template <typename T, typename bucketT>
+size_t Renderer<T, bucketT>::DensityFilterIndex(bucketT hits, intmax_t i, intmax_t j, intmax_t ss, bool scf, T scfact)
+{
+	size_t filterSelectInt;
+	T filterSelect = 0;
+
+	if (ss == 0)
+	{
+		filterSelect = hits;
+	}
+	else
+	{
+		//The original contained a glaring flaw as it would run past the boundaries of the buffers
+		//when calculating the density for a box centered on the last row or column.
+		//Clamp here to not run over the edge.
+		intmax_t densityBoxLeftX = (i - std::min(i, ss));
+		intmax_t densityBoxRightX = (i + std::min(ss, intmax_t(m_SuperRasW) - i - 1));
+		intmax_t densityBoxTopY = (j - std::min(j, ss));
+		intmax_t densityBoxBottomY = (j + std::min(ss, intmax_t(m_SuperRasH) - j - 1));
+		//Count density in ssxss area with a constant time lookup in the summed-area table.
+		//Original divided by 255 for every bucket. Omit here because colors are already in the range of [0..1].
+		filterSelect = T(m_DensitySAT.Sum(densityBoxLeftX, densityBoxTopY, densityBoxRightX, densityBoxBottomY));
+	}
+
+	//Scale if supersample > 1 for equal iters.
+	if (scf)
+		filterSelect *= scfact;
+
+	if (filterSelect > m_DensityFilter->MaxFilteredCounts())
+		filterSelectInt = m_DensityFilter->MaxFilterIndex();
+	else if (filterSelect <= DE_THRESH)
+		filterSelectInt = size_t(ceil(filterSelect)) - 1;
+	else
+		filterSelectInt = DE_THRESH + size_t(Floor<T>(std::pow(filterSelect - DE_THRESH, m_DensityFilter->Curve())));
+
+	//If the filter selected below the min specified clamp it to the min.
+	if (filterSelectInt > m_DensityFilter->MaxFilterIndex())
+		filterSelectInt = m_DensityFilter->MaxFilterIndex();
+
+	return filterSelectInt;
+}
+
 /// <summary>
 /// Thin wrapper around AccumulatorToFinalImage().
 /// </summary>
@@ -1084,7 +1777,7 @@ eRenderStatus Renderer<T, bucketT>::AccumulatorToFinalImage(byte* pixels, size_t
 	//The original does it this way as well and it's roughly 11 times faster to do it this way than inline below with each pixel.
 	if (EarlyClip())
 	{
-		parallel_for(size_t(0), m_SuperRasH, [&] (size_t j)
+		parallel_for(size_t(0), m_AccumRowEnd - m_AccumRowStart, [&] (size_t j)
 		{
 			size_t rowStart = j * m_SuperRasW;//Pull out of inner loop for optimization.
 
@@ -1101,98 +1794,183 @@ eRenderStatus Renderer<T, bucketT>::AccumulatorToFinalImage(byte* pixels, size_t
 		return eRenderStatus::RENDER_ABORT;
 	}
 
-	//Note that abort is not checked here. The final accumulation must run to completion
-	//otherwise artifacts that resemble page tearing will occur in an interactive run. It's
-	//critical to never exit this loop prematurely.
-	//for (size_t j = 0; j < FinalRasH(); j++)//Keep around for debugging.
-	parallel_for(size_t(0), FinalRasH(), [&](size_t j)
+	size_t finalW = FinalRasW(), finalH = FinalRasH(), ss = Supersample();
+	size_t tileH = m_FinalRowEnd - m_FinalRowStart;//Only the rows of the current tile are accumulated, which is the whole image unless rendering in tiles.
+	size_t rowOffset = (m_DensityFilterOffset + (m_FinalRowStart * ss)) - m_AccumRowStart;//The accumulator row the first row of the tile starts on.
+
+	//Write a single spatially filtered bucket to the output image at final coordinates i, j.
+	auto writePixel = [&](tvec4<bucketT, glm::defaultp>& newBucket, size_t i, size_t j)
 	{
-		Color<bucketT> newBucket;
-		size_t pixelsRowStart = (m_YAxisUp ? ((FinalRasH() - j) - 1) : j) * FinalRowSize();//Pull out of inner loop for optimization.
-		size_t y = m_DensityFilterOffset + (j * Supersample());//Start at the beginning row of each super sample block.
-		glm::uint16* p16;
+		size_t pixelsRowStart = ((m_YAxisUp ? ((finalH - j) - 1) : j) * FinalRowSize()) + (i * PixelSize());
 
-		for (size_t i = 0; i < FinalRasW(); i++, pixelsRowStart += PixelSize())
+		if (BytesPerChannel() == 2)
 		{
-			size_t ii, jj;
-			size_t x = m_DensityFilterOffset + (i * Supersample());//Start at the beginning column of each super sample block.
-			newBucket.Clear();
+			glm::uint16* p16 = reinterpret_cast<glm::uint16*>(pixels + pixelsRowStart);
 
-			//Original was iterating column-wise, which is slow.
-			//Here, iterate one row at a time, giving a 10% speed increase.
-			for (jj = 0; jj < filterWidth; jj++)
+			if (EarlyClip())
 			{
-				size_t filterKRowIndex = jj * filterWidth;
-				size_t accumRowIndex = (y + jj) * m_SuperRasW;//Pull out of inner loop for optimization.
+				if (m_CurvesSet)
+				{
+					CurveAdjust(newBucket.r, 1);
+					CurveAdjust(newBucket.g, 2);
+					CurveAdjust(newBucket.b, 3);
+				}
+
+				p16[0] = glm::uint16(Clamp<bucketT>(newBucket.r, 0, 255) * bucketT(256));
+				p16[1] = glm::uint16(Clamp<bucketT>(newBucket.g, 0, 255) * bucketT(256));
+				p16[2] = glm::uint16(Clamp<bucketT>(newBucket.b, 0, 255) * bucketT(256));
 
-				for (ii = 0; ii < filterWidth; ii++)
+				if (NumChannels() > 3)
 				{
-					//Need to dereference the spatial filter pointer object to use the [] operator. Makes no speed difference.
-					bucketT k = ((*m_SpatialFilter)[ii + filterKRowIndex]);
-					newBucket += (m_AccumulatorBuckets[(x + ii) + accumRowIndex] * k);
+					if (Transparency())
+						p16[3] = byte(Clamp<bucketT>(newBucket.a, 0, 1) * bucketT(65535.0));
+					else
+						p16[3] = 65535;
 				}
 			}
-
-			if (BytesPerChannel() == 2)
+			else
 			{
-				p16 = reinterpret_cast<glm::uint16*>(pixels + pixelsRowStart);
-
-				if (EarlyClip())
+				GammaCorrection(newBucket, background, g, linRange, vibrancy, NumChannels() > 3, true, p16);
+			}
+		}
+		else
+		{
+			if (EarlyClip())
+			{
+				if (m_CurvesSet)
 				{
-					if (m_CurvesSet)
-					{
-						CurveAdjust(newBucket.r, 1);
-						CurveAdjust(newBucket.g, 2);
-						CurveAdjust(newBucket.b, 3);
-					}
+					CurveAdjust(newBucket.r, 1);
+					CurveAdjust(newBucket.g, 2);
+					CurveAdjust(newBucket.b, 3);
+				}
 
-					p16[0] = glm::uint16(Clamp<bucketT>(newBucket.r, 0, 255) * bucketT(256));
-					p16[1] = glm::uint16(Clamp<bucketT>(newBucket.g, 0, 255) * bucketT(256));
-					p16[2] = glm::uint16(Clamp<bucketT>(newBucket.b, 0, 255) * bucketT(256));
+				pixels[pixelsRowStart]     = byte(Clamp<bucketT>(newBucket.r, 0, 255));
+				pixels[pixelsRowStart + 1] = byte(Clamp<bucketT>(newBucket.g, 0, 255));
+				pixels[pixelsRowStart + 2] = byte(Clamp<bucketT>(newBucket.b, 0, 255));
 
-					if (NumChannels() > 3)
-					{
-						if (Transparency())
-							p16[3] = byte(Clamp<bucketT>(newBucket.a, 0, 1) * bucketT(65535.0));
-						else
-							p16[3] = 65535;
-					}
-				}
-				else
+				if (NumChannels() > 3)
 				{
-					GammaCorrection(*(reinterpret_cast<tvec4<bucketT, glm::defaultp>*>(&newBucket)), background, g, linRange, vibrancy, NumChannels() > 3, true, p16);
+					if (Transparency())
+						pixels[pixelsRowStart + 3] = byte(Clamp<bucketT>(newBucket.a, 0, 1) * bucketT(255.0));
+					else
+						pixels[pixelsRowStart + 3] = 255;
 				}
 			}
 			else
 			{
-				if (EarlyClip())
+				GammaCorrection(newBucket, background, g, linRange, vibrancy, NumChannels() > 3, true, pixels + pixelsRowStart);
+			}
+		}
+	};
+
+	//Note that abort is not checked here. The final accumulation must run to completion
+	//otherwise artifacts that resemble page tearing will occur in an interactive run. It's
+	//critical to never exit these loops prematurely.
+	if (m_SpatialFilter->Separable())
+	{
+		//The kernel is the outer product of two 1D kernels, so apply it as a horizontal pass
+		//followed by a vertical pass. This reduces the work per output pixel from filterWidth^2 to 2 * filterWidth.
+		//The output rows are resolved in bands, so the horizontally filtered rows only need to be held for one band at a time.
+		//Adjacent bands share filterWidth - ss accumulator rows, which are filtered horizontally once for each.
+		const bucketT* filterX = m_SpatialFilter->FilterX();
+		const bucketT* filterY = m_SpatialFilter->FilterY();
+		size_t bandH = std::min(tileH, SpatialBandRows());
+		m_SpatialRowBuckets.resize((((bandH - 1) * ss) + filterWidth) * finalW);
+
+		for (size_t bandStart = m_FinalRowStart; bandStart < m_FinalRowEnd; bandStart += bandH)
+		{
+			size_t bandEnd = std::min(bandStart + bandH, m_FinalRowEnd);
+			size_t rows = ((bandEnd - bandStart - 1) * ss) + filterWidth;//Every accumulator row touched by the kernel, starting at the first row of the band.
+			size_t bandRowOffset = rowOffset + ((bandStart - m_FinalRowStart) * ss);
+
+			//Horizontal pass: filter each accumulator row down to the final width.
+			parallel_for(size_t(0), rows, [&](size_t r)
+			{
+				const tvec4<bucketT, glm::defaultp>* accumRow = m_AccumulatorBuckets.data() + ((bandRowOffset + r) * m_SuperRasW) + m_DensityFilterOffset;
+				tvec4<bucketT, glm::defaultp>* rowBuckets = m_SpatialRowBuckets.data() + (r * finalW);
+
+				for (size_t i = 0; i < finalW; i++)
 				{
-					if (m_CurvesSet)
-					{
-						CurveAdjust(newBucket.r, 1);
-						CurveAdjust(newBucket.g, 2);
-						CurveAdjust(newBucket.b, 3);
-					}
+					const tvec4<bucketT, glm::defaultp>* accum = accumRow + (i * ss);
+					tvec4<bucketT, glm::defaultp> sum(0);
+
+					for (size_t ii = 0; ii < filterWidth; ii++)
+						sum += accum[ii] * filterX[ii];
+
+					rowBuckets[i] = sum;
+				}
+			});
+
+			//Vertical pass: combine filterWidth horizontally filtered rows for each output row.
+			//Columns are processed in blocks so the inner loop streams contiguously through each row.
+			parallel_for(bandStart, bandEnd, [&](size_t j)
+			{
+				tvec4<bucketT, glm::defaultp> sums[SPATIAL_TILE_SIZE];
+				const tvec4<bucketT, glm::defaultp>* firstRow = m_SpatialRowBuckets.data() + ((j - bandStart) * ss * finalW);
+
+				for (size_t i = 0; i < finalW; i += SPATIAL_TILE_SIZE)
+				{
+					size_t count = std::min<size_t>(SPATIAL_TILE_SIZE, finalW - i);
 
-					pixels[pixelsRowStart]     = byte(Clamp<bucketT>(newBucket.r, 0, 255));
-					pixels[pixelsRowStart + 1] = byte(Clamp<bucketT>(newBucket.g, 0, 255));
-					pixels[pixelsRowStart + 2] = byte(Clamp<bucketT>(newBucket.b, 0, 255));
+					for (size_t k = 0; k < count; k++)
+						sums[k] = tvec4<bucketT, glm::defaultp>(0);
 
-					if (NumChannels() > 3)
+					for (size_t jj = 0; jj < filterWidth; jj++)
 					{
-						if (Transparency())
-							pixels[pixelsRowStart + 3] = byte(Clamp<bucketT>(newBucket.a, 0, 1) * bucketT(255.0));
-						else
-							pixels[pixelsRowStart + 3] = 255;
+						const tvec4<bucketT, glm::defaultp>* rowBuckets = firstRow + (jj * finalW) + i;
+						bucketT coef = filterY[jj];
+
+						for (size_t k = 0; k < count; k++)
+							sums[k] += rowBuckets[k] * coef;
 					}
+
+					for (size_t k = 0; k < count; k++)
+						writePixel(sums[k], i + k, j);
 				}
-				else
+			});
+		}
+
+		//Only needed during the resolve, so don't hold on to it between renders.
+		m_SpatialRowBuckets.clear();
+		m_SpatialRowBuckets.shrink_to_fit();
+	}
+	else
+	{
+		//Non-separable kernel: gather the full 2D kernel for each output pixel, processing the image in square tiles
+		//so the accumulator rows shared by vertically adjacent output pixels stay in cache.
+		size_t tilesX = (finalW + SPATIAL_TILE_SIZE - 1) / SPATIAL_TILE_SIZE;
+		size_t tilesY = (tileH + SPATIAL_TILE_SIZE - 1) / SPATIAL_TILE_SIZE;
+
+		parallel_for(size_t(0), tilesX * tilesY, [&](size_t tile)
+		{
+			size_t iStart = (tile % tilesX) * SPATIAL_TILE_SIZE, iEnd = std::min(iStart + SPATIAL_TILE_SIZE, finalW);
+			size_t jStart = m_FinalRowStart + ((tile / tilesX) * SPATIAL_TILE_SIZE), jEnd = std::min(jStart + SPATIAL_TILE_SIZE, m_FinalRowEnd);
+			const bucketT* filter = m_SpatialFilter->Filter();
+
+			for (size_t j = jStart; j < jEnd; j++)
+			{
+				size_t y = rowOffset + ((j - m_FinalRowStart) * ss);//Start at the beginning row of each super sample block.
+
+				for (size_t i = iStart; i < iEnd; i++)
 				{
-					GammaCorrection(*(reinterpret_cast<tvec4<bucketT, glm::defaultp>*>(&newBucket)), background, g, linRange, vibrancy, NumChannels() > 3, true, pixels + pixelsRowStart);
+					size_t x = m_DensityFilterOffset + (i * ss);//Start at the beginning column of each super sample block.
+					tvec4<bucketT, glm::defaultp> newBucket(0);
+
+					//Iterate one row at a time, accumulating all four channels of each bucket at once.
+					for (size_t jj = 0; jj < filterWidth; jj++)
+					{
+						const bucketT* filterRow = filter + (jj * filterWidth);
+						const tvec4<bucketT, glm::defaultp>* accumRow = m_AccumulatorBuckets.data() + ((y + jj) * m_SuperRasW) + x;
+
+						for (size_t ii = 0; ii < filterWidth; ii++)
+							newBucket += accumRow[ii] * filterRow[ii];
+					}
+
+					writePixel(newBucket, i, j);
 				}
 			}
-		}
-	});
+		});
+	}
 
 	//Insert the palette into the image for debugging purposes. Only works with 8bpc.
 	if (m_InsertPalette && BytesPerChannel() == 1)
@@ -1241,6 +2019,15 @@ EmberStats Renderer<T, bucketT>::Iterate(size_t iterCount, size_t temporalSample
 	size_t totalItersPerThread = size_t(ceil(double(iterCount) / double(m_ThreadsToUse)));
 	double percent, etaMs;
 	EmberStats stats;
+	bool privateHist = !m_ThreadHistBuckets.empty();
+	bool outOfCore = !m_ThreadHits.empty();
+
+	//Hits land all over the histogram, so reading ahead in its file would only waste IO.
+	if (outOfCore)
+	{
+		m_HistBuckets.Advise(eBufferAdvice::RANDOM);
+		m_PackedHistBuckets.Advise(eBufferAdvice::RANDOM);
+	}
 
 	//Do this every iteration for an animation, or else do it once for a single image. CPU only.
 	if (!m_LastIter)
@@ -1298,16 +2085,32 @@ EmberStats Renderer<T, bucketT>::Iterate(size_t iterCount, size_t temporalSample
 				//m_BadVals[threadIndex] += m_Iterator->Iterate(m_Ember, params, m_Samples[threadIndex].data(), m_Rand[threadIndex]);
 				//iterationTime += t.Toc();
 
-				if (m_LockAccum)
-					m_AccumCs.Enter();
-
 				//t.Tic();
 				//Map temp buffer samples into the histogram using the palette for color.
-				Accumulate(m_Rand[threadIndex], m_Samples[threadIndex].data(), params.m_Count, &m_Dmap);
+				//When using private histograms, each thread writes to its own so no locking is needed.
+				if (privateHist)
+				{
+					Accumulate(m_Rand[threadIndex], m_Samples[threadIndex].data(), params.m_Count, &m_Dmap, m_ThreadHistBuckets[threadIndex].data(), m_ThreadHistBlocksUsed[threadIndex].data(), nullptr);
+				}
+				else if (outOfCore)//Collect hits and only add them to the histogram once there are enough to sort.
+				{
+					Accumulate(m_Rand[threadIndex], m_Samples[threadIndex].data(), params.m_Count, &m_Dmap, m_HistBuckets.data(), nullptr, &m_ThreadHits[threadIndex]);
+
+					if (m_ThreadHits[threadIndex].size() >= HIST_HIT_BUFFER_SIZE)
+						FlushHits(m_Rand[threadIndex], m_ThreadHits[threadIndex]);
+				}
+				else
+				{
+					if (m_LockAccum)
+						m_AccumCs.Enter();
+
+					Accumulate(m_Rand[threadIndex], m_Samples[threadIndex].data(), params.m_Count, &m_Dmap, m_PackedHistBuckets.empty() ? m_HistBuckets.data() : nullptr, nullptr, nullptr);
+
+					if (m_LockAccum)
+						m_AccumCs.Leave();
+				}
 
 				//accumulationTime += t.Toc();
-				if (m_LockAccum)
-					m_AccumCs.Leave();
 
 				if (m_Callback && threadIndex == 0)
 				{
@@ -1339,6 +2142,10 @@ EmberStats Renderer<T, bucketT>::Iterate(size_t iterCount, size_t temporalSample
 					}
 				}
 			}
+
+			//Add whatever hits are left, even if aborted, since the iter counts below include them.
+			if (outOfCore)
+				FlushHits(m_Rand[threadIndex], m_ThreadHits[threadIndex]);
 		});
 #ifdef TG
 	}
@@ -1346,6 +2153,10 @@ EmberStats Renderer<T, bucketT>::Iterate(size_t iterCount, size_t temporalSample
 	m_TaskGroup.wait();
 #endif
 
+	//Sum whatever was accumulated into the per-thread histograms, even if aborted, since the iter counts below include it.
+	if (privateHist)
+		MergeThreadHists();
+
 	stats.m_Iters = std::accumulate(m_SubBatch.begin(), m_SubBatch.end(), 0ULL);//Sum of iter count of all threads.
 	stats.m_Badvals = std::accumulate(m_BadVals.begin(), m_BadVals.end(), 0ULL);
 	stats.m_IterMs = m_IterTimer.Toc();
@@ -1375,6 +2186,32 @@ void Renderer<T, bucketT>::PixelAspectRatio(T pixelAspectRatio)
 	ChangeVal([&] { m_PixelAspectRatio = pixelAspectRatio; }, eProcessAction::FULL_RENDER);
 }
 
+/// <summary>
+/// Get the cache of filters shared with other renderers.
+/// </summary>
+/// <returns>The shared cache if one was set, else nullptr.</returns>
+template <typename T, typename bucketT>
+shared_ptr<FilterCache<bucketT>> Renderer<T, bucketT>::SharedFilters() const { return m_SharedFilters; }
+
+/// <summary>
+/// Set a cache of spatial and density filters to share with other renderers.
+/// When set, filters are taken from the cache rather than created by this renderer,
+/// so renderers which render the same batch of embers only create each filter once between them.
+/// Pass nullptr to go back to creating filters privately.
+/// Reset the rendering process.
+/// </summary>
+/// <param name="filterCache">The cache to share</param>
+template <typename T, typename bucketT>
+void Renderer<T, bucketT>::SharedFilters(shared_ptr<FilterCache<bucketT>> filterCache)
+{
+	ChangeVal([&]
+	{
+		m_SharedFilters = filterCache;
+		m_SpatialFilter.reset();//Force the filters to be fetched again.
+		m_DensityFilter.reset();
+	}, eProcessAction::FULL_RENDER);
+}
+
 /// <summary>
 /// Non-virtual renderer properties, getters only.
 /// </summary>
@@ -1487,11 +2324,15 @@ void Renderer<T, bucketT>::PrepFinalAccumVals(Color<bucketT>& background, bucket
 /// <param name="samples">The samples to accumulate</param>
 /// <param name="sampleCount">The number of samples</param>
 /// <param name="palette">The palette to use</param>
+/// <param name="hist">The histogram to accumulate to. Either the main histogram, a per-thread histogram of the same size, or nullptr to accumulate to the packed histogram.</param>
+/// <param name="blocksUsed">If accumulating to a per-thread histogram, the flags marking which blocks of it were written to, else nullptr.</param>
 template <typename T, typename bucketT>
-void Renderer<T, bucketT>::Accumulate(QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand, Point<T>* samples, size_t sampleCount, const Palette<bucketT>* palette)
+void Renderer<T, bucketT>::Accumulate(QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand, Point<T>* samples, size_t sampleCount, const Palette<bucketT>* palette, tvec4<bucketT, glm::defaultp>* hist, byte* blocksUsed, vector<pair<size_t, tvec4<bucketT, glm::defaultp>>>* hits)
 {
-	size_t histIndex, intColorIndex, histSize = m_HistBuckets.size();
+	size_t histIndex, intColorIndex, histSize = m_PackedHistBuckets.empty() ? m_HistBuckets.size() : m_PackedHistBuckets.size();
+	uint ditherSeed = (!hits && !hist) ? uint(rand.Rand()) : 0;//One random draw per sub batch, rather than per hit, for rounding hits added to a packed histogram.
 	bucketT colorIndex, colorIndexFrac;
+	tvec4<bucketT, glm::defaultp> color;
 	auto dmap = palette->m_Entries.data();
 
 	//It's critical to understand what's going on here as it's one of the most important parts of the algorithm.
@@ -1530,13 +2371,24 @@ void Renderer<T, bucketT>::Accumulate(QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand, Poin
 				//This will result in a few points at the very edges getting discarded, but prevents a crash and doesn't seem to make a speed difference.
 				if (histIndex < histSize)
 				{
+					if (blocksUsed)
+						blocksUsed[histIndex / HIST_BLOCK_SIZE] = 1;
+
 					//Linear is a linear scale for when the color index is not a whole number, which is most of the time.
 					//It uses a portion of the value of the index, and the remainder of the next index.
 					//Example: index = 25.7
 					//Fraction = 0.7
 					//Color = (dmap[25] * 0.3) + (dmap[26] * 0.7)
 					//Use overloaded addition and multiplication operators in vec4 to perform the accumulation.
-					if (PaletteMode() == ePaletteMode::PALETTE_LINEAR)
+					if (m_IndexHist)
+					{
+						//Store the statistics of the color index rather than a color, and leave the palette to IndexBucketColor().
+						//The weight includes the color scalar the palette would have been multiplied by, while the hit count does not.
+						//A single hit has no spread, and RenderCheckpoint::AddIndexBucket() combines it with the bucket.
+						colorIndex = Clamp<bucketT>(bucketT(p.m_ColorX) * COLORMAP_LENGTH, 0, COLORMAP_LENGTH);
+						color = tvec4<bucketT, glm::defaultp>(bucketT(p.m_VizAdjusted) * m_IndexColorScalar, colorIndex, 0, bucketT(p.m_VizAdjusted));
+					}
+					else if (PaletteMode() == ePaletteMode::PALETTE_LINEAR)
 					{
 						colorIndex = bucketT(p.m_ColorX) * COLORMAP_LENGTH;
 						intColorIndex = size_t(colorIndex);
@@ -1557,27 +2409,209 @@ void Renderer<T, bucketT>::Accumulate(QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand, Poin
 						}
 
 						if (p.m_VizAdjusted == 1)
-							m_HistBuckets[histIndex] += ((dmap[intColorIndex] * (1 - colorIndexFrac)) + (dmap[intColorIndex + 1] * colorIndexFrac));
+							color = ((dmap[intColorIndex] * (1 - colorIndexFrac)) + (dmap[intColorIndex + 1] * colorIndexFrac));
 						else
-							m_HistBuckets[histIndex] += (((dmap[intColorIndex] * (1 - colorIndexFrac)) + (dmap[intColorIndex + 1] * colorIndexFrac)) * bucketT(p.m_VizAdjusted));
+							color = (((dmap[intColorIndex] * (1 - colorIndexFrac)) + (dmap[intColorIndex + 1] * colorIndexFrac)) * bucketT(p.m_VizAdjusted));
 					}
-					else if (PaletteMode() == ePaletteMode::PALETTE_STEP)
+					else
 					{
 						intColorIndex = Clamp<size_t>(size_t(p.m_ColorX * COLORMAP_LENGTH), 0, COLORMAP_LENGTH_MINUS_1);
 
 						if (p.m_VizAdjusted == 1)
-							m_HistBuckets[histIndex] += dmap[intColorIndex];
+							color = dmap[intColorIndex];
 						else
-							m_HistBuckets[histIndex] += (dmap[intColorIndex] * bucketT(p.m_VizAdjusted));
+							color = (dmap[intColorIndex] * bucketT(p.m_VizAdjusted));
 					}
+
+					if (hits)
+						hits->push_back(std::make_pair(histIndex, color));
+					else if (hist && m_IndexHist)
+						RenderCheckpoint::AddIndexBucket(hist[histIndex], color);
+					else if (hist)
+						hist[histIndex] += color;
+					else
+						m_PackedHistBuckets.Add(histIndex, color, PackedHistogram<bucketT>::Dither(ditherSeed, i));
+				}
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Add a thread's buffered hits to the out of core histogram and clear the buffer.
+/// The hits are sorted by histogram index first, so the pages of the file they land in are touched in order,
+/// and each page is only faulted in once per flush no matter how many hits it receives.
+/// </summary>
+/// <param name="rand">The random context to use for rounding hits added to a packed histogram</param>
+/// <param name="hits">The buffered hits to add</param>
+template <typename T, typename bucketT>
+void Renderer<T, bucketT>::FlushHits(QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand, vector<pair<size_t, tvec4<bucketT, glm::defaultp>>>& hits)
+{
+	std::sort(hits.begin(), hits.end(), [&](const pair<size_t, tvec4<bucketT, glm::defaultp>>& lhs, const pair<size_t, tvec4<bucketT, glm::defaultp>>& rhs)
+	{
+		return lhs.first < rhs.first;
+	});
+
+	if (m_LockAccum)
+		m_AccumCs.Enter();
+
+	if (m_IndexHist)
+	{
+		for (auto& hit : hits)
+			RenderCheckpoint::AddIndexBucket(m_HistBuckets[hit.first], hit.second);
+	}
+	else if (m_PackedHistBuckets.empty())
+	{
+		for (auto& hit : hits)
+			m_HistBuckets[hit.first] += hit.second;
+	}
+	else
+	{
+		uint ditherSeed = uint(rand.Rand());
+
+		for (size_t i = 0; i < hits.size(); i++)
+			m_PackedHistBuckets.Add(hits[i].first, hits[i].second, PackedHistogram<bucketT>::Dither(ditherSeed, i));
+	}
+
+	if (m_LockAccum)
+		m_AccumCs.Leave();
+
+	hits.clear();
+}
+
+/// <summary>
+/// Sum all per-thread histograms into the main histogram and clear them for the next use.
+/// The histogram is split into blocks of HIST_BLOCK_SIZE buckets and each block is reduced in parallel,
+/// so no two threads ever write to the same bucket. Blocks a thread never wrote to are skipped
+/// entirely, which makes this cheap for the sparse histograms typical of zoomed in or small attractors.
+/// </summary>
+template <typename T, typename bucketT>
+void Renderer<T, bucketT>::MergeThreadHists()
+{
+	size_t histSize = m_HistBuckets.size();
+	size_t blockCount = (histSize + HIST_BLOCK_SIZE - 1) / HIST_BLOCK_SIZE;
+
+	parallel_for(size_t(0), blockCount, [&](size_t block)
+	{
+		size_t start = block * HIST_BLOCK_SIZE;
+		size_t end = std::min(start + HIST_BLOCK_SIZE, histSize);
+		auto* __restrict hist = m_HistBuckets.data();
+
+		for (size_t thread = 0; thread < m_ThreadHistBuckets.size(); thread++)
+		{
+			if (m_ThreadHistBlocksUsed[thread][block])
+			{
+				auto* __restrict threadHist = m_ThreadHistBuckets[thread].data();
+
+				for (size_t i = start; i < end; i++)
+				{
+					if (m_IndexHist)
+						RenderCheckpoint::AddIndexBucket(hist[i], threadHist[i]);
+					else
+						hist[i] += threadHist[i];
+
+					threadHist[i] = tvec4<bucketT, glm::defaultp>(0);
 				}
+
+				m_ThreadHistBlocksUsed[thread][block] = 0;
 			}
 		}
+	});
+}
+
+/// <summary>
+/// Get the number of rows of the final image in each tile. The last tile may have fewer.
+/// </summary>
+/// <returns>The number of final rows per tile</returns>
+template <typename T, typename bucketT>
+size_t Renderer<T, bucketT>::TileRowCount() const
+{
+	size_t height = std::max<size_t>(FinalRasH(), 1);
+	size_t tiles = RendererType() == CPU_RENDERER ? Clamp<size_t>(m_Tiles, 1, height) : 1;
+	return (height + tiles - 1) / tiles;
+}
+
+/// <summary>
+/// Get the number of tiles the image will actually be filtered and accumulated in.
+/// This may be less than Tiles() when it does not divide evenly into the height, and is always 1 for GPU renderers.
+/// </summary>
+/// <returns>The number of tiles</returns>
+template <typename T, typename bucketT>
+size_t Renderer<T, bucketT>::TileCount() const
+{
+	size_t rows = TileRowCount();
+	return (std::max<size_t>(FinalRasH(), 1) + rows - 1) / rows;
+}
+
+/// <summary>
+/// Get the rows of the final image a tile covers, and the rows of the histogram which
+/// must be held in the accumulator to produce them.
+/// The accumulator rows include the halo read by the spatial filter. The first and last tiles
+/// also include the gutter, so a single tile covers the entire histogram.
+/// ComputeBounds() must have been called first.
+/// </summary>
+/// <param name="tile">The index of the tile</param>
+/// <param name="finalRowStart">The first row of the final image in the tile</param>
+/// <param name="finalRowEnd">One past the last row of the final image in the tile</param>
+/// <param name="accumRowStart">The first row of the histogram to hold in the accumulator</param>
+/// <param name="accumRowEnd">One past the last row of the histogram to hold in the accumulator</param>
+template <typename T, typename bucketT>
+void Renderer<T, bucketT>::TileRows(size_t tile, size_t& finalRowStart, size_t& finalRowEnd, size_t& accumRowStart, size_t& accumRowEnd) const
+{
+	size_t rows = TileRowCount();
+	finalRowStart = std::min(tile * rows, FinalRasH());
+	finalRowEnd = std::min(finalRowStart + rows, FinalRasH());
+	accumRowStart = finalRowStart == 0 ? 0 : m_DensityFilterOffset + (finalRowStart * Supersample());
+	accumRowEnd = finalRowEnd == FinalRasH() ? m_SuperRasH : m_DensityFilterOffset + ((finalRowEnd - 1) * Supersample()) + m_SpatialFilter->FinalFilterWidth();
+}
+
+/// <summary>
+/// Density filter and accumulate the final image one tile at a time, once iteration of the entire histogram is done.
+/// Each tile only filters the histogram rows close enough to scatter into the rows it holds, and discards anything
+/// scattered outside of them, so the accumulator need only be large enough for the largest tile.
+/// The tiles are processed in order, with each step using all threads.
+/// </summary>
+/// <param name="pixels">The pixel vector to allocate and store the final image in</param>
+/// <param name="finalOffset">Offset in the buffer to store the pixels to</param>
+/// <returns>True if not prematurely aborted, else false.</returns>
+template <typename T, typename bucketT>
+eRenderStatus Renderer<T, bucketT>::FilterAndAccumTiles(vector<byte>& pixels, size_t finalOffset)
+{
+	auto status = eRenderStatus::RENDER_OK;
+
+	if (!PrepFinalAccumVector(pixels))
+		return eRenderStatus::RENDER_ERROR;
+
+	for (size_t tile = 0; tile < TileCount() && status == eRenderStatus::RENDER_OK; tile++)
+	{
+		TileRows(tile, m_FinalRowStart, m_FinalRowEnd, m_AccumRowStart, m_AccumRowEnd);
+
+		//Start reading the histogram rows of the next tile in while this one is being processed. Only has an effect when out of core.
+		if (tile + 1 < TileCount())
+		{
+			size_t finalRowStart, finalRowEnd, accumRowStart, accumRowEnd;
+			TileRows(tile + 1, finalRowStart, finalRowEnd, accumRowStart, accumRowEnd);
+
+			if (accumRowEnd > m_AccumRowEnd)
+			{
+				m_HistBuckets.Prefetch(m_AccumRowEnd * m_SuperRasW, (accumRowEnd - m_AccumRowEnd) * m_SuperRasW);
+				m_PackedHistBuckets.Prefetch(m_AccumRowEnd * m_SuperRasW, (accumRowEnd - m_AccumRowEnd) * m_SuperRasW);
+			}
+		}
+
+		ResetBuckets(false, true);
+		status = m_DensityFilter.get() ? GaussianDensityFilter() : LogScaleDensityFilter();
+
+		if (status == eRenderStatus::RENDER_OK)
+			status = AccumulatorToFinalImage(pixels.data(), finalOffset);
 	}
+
+	return status;
 }
 
 /// <summary>
 /// Add a value to the density filtering buffer with a bounds check.
+/// Values falling outside of the rows of the current tile are discarded.
 /// </summary>
 /// <param name="bucket">The bucket being filtered</param>
 /// <param name="i">The column of the bucket</param>
@@ -1587,8 +2621,8 @@ void Renderer<T, bucketT>::Accumulate(QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand, Poin
 template <typename T, typename bucketT>
 void Renderer<T, bucketT>::AddToAccum(const tvec4<bucketT, glm::defaultp>& bucket, intmax_t i, intmax_t ii, intmax_t j, intmax_t jj)
 {
-	if (j + jj >= 0 && j + jj < intmax_t(m_SuperRasH) && i + ii >= 0 && i + ii < intmax_t(m_SuperRasW))
-		m_AccumulatorBuckets[(i + ii) + ((j + jj) * m_SuperRasW)] += bucket;
+	if (j + jj >= intmax_t(m_AccumRowStart) && j + jj < intmax_t(m_AccumRowEnd) && i + ii >= 0 && i + ii < intmax_t(m_SuperRasW))
+		m_AccumulatorBuckets[(i + ii) + ((j + jj - intmax_t(m_AccumRowStart)) * m_SuperRasW)] += bucket;
 }
 
 /// <summary>
@@ -7,6 +7,9 @@
 #include "Interpolate.h"
 #include "CarToRas.h"
 #include "EmberToXml.h"
+#include "PackedHistogram.h"
+#include "RenderCheckpoint.h"
+#include "FilterCache.h"
 
 /// <summary>
 /// Renderer.
@@ -58,12 +61,14 @@ public:
 	virtual void ComputeCamera() override;
 	virtual void SetEmber(Ember<T>& ember, eProcessAction action = eProcessAction::FULL_RENDER) override;
 	virtual void SetEmber(vector<Ember<T>>& embers) override;
+	virtual eProcessAction RequiredProcessAction(const Ember<T>& ember) const override;
 	virtual bool CreateDEFilter(bool& newAlloc) override;
 	virtual bool CreateSpatialFilter(bool& newAlloc) override;
 	virtual bool CreateTemporalFilter(bool& newAlloc) override;
 	virtual size_t HistBucketSize() const override { return sizeof(tvec4<bucketT, glm::defaultp>); }
 	virtual eRenderStatus Run(vector<byte>& finalImage, double time = 0, size_t subBatchCountOverride = 0, bool forceOutput = false, size_t finalOffset = 0) override;
 	virtual EmberImageComments ImageComments(const EmberStats& stats, size_t printEditDepth = 0, bool intPalette = false, bool hexPalette = true) override;
+	virtual bool SaveCheckpoint(RenderCheckpoint& checkpoint) override;
 
 protected:
 	//New virtual functions to be overridden in derived renderers that use the GPU, but not accessed outside.
@@ -80,6 +85,8 @@ public:
 	//Non-virtual render properties, getters and setters.
 	inline T PixelAspectRatio() const;
 	void PixelAspectRatio(T pixelAspectRatio);
+	shared_ptr<FilterCache<bucketT>> SharedFilters() const;
+	void SharedFilters(shared_ptr<FilterCache<bucketT>> filterCache);
 
 	//Non-virtual renderer properties, getters only.
 	inline T                              Scale()               const;
@@ -148,7 +155,23 @@ protected:
 
 private:
 	//Miscellaneous non-virtual functions used only in this class.
-	void Accumulate(QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand, Point<T>* samples, size_t sampleCount, const Palette<bucketT>* palette);
+	void Accumulate(QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand, Point<T>* samples, size_t sampleCount, const Palette<bucketT>* palette, tvec4<bucketT, glm::defaultp>* hist, byte* blocksUsed, vector<pair<size_t, tvec4<bucketT, glm::defaultp>>>* hits);
+	void FlushHits(QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand, vector<pair<size_t, tvec4<bucketT, glm::defaultp>>>& hits);
+	static bool SameIteration(const Xform<T>& xform1, const Xform<T>& xform2);
+	bool RestoreCheckpoint();
+	uint64_t CheckpointHash();
+	void MergeThreadHists();
+	size_t TileRowCount() const;
+	size_t TileCount() const;
+	void TileRows(size_t tile, size_t& finalRowStart, size_t& finalRowEnd, size_t& accumRowStart, size_t& accumRowEnd) const;
+	eRenderStatus FilterAndAccumTiles(vector<byte>& pixels, size_t finalOffset);
+	eRenderStatus GaussianDensityFilterTiled();
+	inline tvec4<bucketT, glm::defaultp> HistBucket(size_t i) const;
+	void MakeIndexPalette();
+	tvec4<bucketT, glm::defaultp> IndexPaletteSum(bucketT index) const;
+	tvec4<bucketT, glm::defaultp> IndexBucketColor(const tvec4<bucketT, glm::defaultp>& bucket) const;
+	void BuildDensitySAT(intmax_t startRow, intmax_t endRow, intmax_t ss, bool scf, T scfact);
+	size_t DensityFilterIndex(bucketT hits, intmax_t i, intmax_t j, intmax_t ss, bool scf, T scfact);
 	/*inline*/ void AddToAccum(const tvec4<bucketT, glm::defaultp>& bucket, intmax_t i, intmax_t ii, intmax_t j, intmax_t jj);
 	template <typename accumT> void GammaCorrection(tvec4<bucketT, glm::defaultp>& bucket, Color<bucketT>& background, bucketT g, bucketT linRange, bucketT vibrancy, bool doAlpha, bool scale, accumT* correctedChannels);
 	void CurveAdjust(bucketT& a, const glm::length_t& index);
@@ -163,11 +186,17 @@ protected:
 	T m_LowerLeftY;
 	T m_UpperRightX;
 	T m_UpperRightY;
+	double m_RunTime;//The time passed to Run() when the render was started, saved in checkpoints.
 	bucketT m_K1;
 	bucketT m_K2;
 	bucketT m_Vibrancy;//Accumulate these after each temporal sample.
 	bucketT m_Gamma;
+	bucketT m_IndexColorScalar;//The color scalar of the temporal sample being iterated, applied to the weight of hits when IndexHist() is true.
 	T m_ScaledQuality;
+	size_t m_FinalRowStart;//The rows of the final image covered by the tile currently being filtered and accumulated.
+	size_t m_FinalRowEnd;
+	size_t m_AccumRowStart;//The rows of the histogram held in the accumulator for that tile. Accumulator row 0 is histogram row m_AccumRowStart.
+	size_t m_AccumRowEnd;
 	Color<bucketT> m_Background;//This is a scaled copy of the m_Background member of m_Ember, but with a type of bucketT.
 	Affine2D<T> m_RotMat;
 	Ember<T> m_Ember;
@@ -175,18 +204,28 @@ protected:
 	Ember<T> m_LastEmber;
 	vector<Ember<T>> m_Embers;
 	vector<Ember<T>> m_ThreadEmbers;
+	SummedAreaTable m_DensitySAT;
 	CarToRas<T> m_CarToRas;
 	Iterator<T>* m_Iterator;
 	unique_ptr<StandardIterator<T>> m_StandardIterator;
 	unique_ptr<XaosIterator<T>> m_XaosIterator;
+	unique_ptr<BatchIterator<T>> m_BatchIterator;
 	Palette<bucketT> m_Dmap, m_Csa;
-	vector<tvec4<bucketT, glm::defaultp>> m_HistBuckets;
-	vector<tvec4<bucketT, glm::defaultp>> m_AccumulatorBuckets;
-	unique_ptr<SpatialFilter<bucketT>> m_SpatialFilter;
+	vector<tvec4<bucketT, glm::defaultp>> m_IndexPalette, m_IndexPaletteSums;//The palette and its running integral, used to color the buckets when IndexHist() is true.
+	MappedBuffer<tvec4<bucketT, glm::defaultp>> m_HistBuckets;
+	MappedBuffer<tvec4<bucketT, glm::defaultp>> m_AccumulatorBuckets;
+	PackedHistogram<bucketT> m_PackedHistBuckets;//Used in place of m_HistBuckets, which is then empty, when PackedHist() is true.
+	vector<vector<tvec4<bucketT, glm::defaultp>>> m_ThreadHistBuckets;
+	vector<vector<pair<size_t, tvec4<bucketT, glm::defaultp>>>> m_ThreadHits;//Per-thread hits waiting to be sorted and added to an out of core histogram.
+	vector<vector<byte>> m_ThreadHistBlocksUsed;
+	vector<tvec4<bucketT, glm::defaultp>> m_SpatialRowBuckets;//Horizontally filtered accumulator rows for one band of the separable spatial filter resolve, only allocated during it.
+	shared_ptr<SpatialFilter<bucketT>> m_SpatialFilter;//Shared because they may come from m_SharedFilters.
 	unique_ptr<TemporalFilter<T>> m_TemporalFilter;
-	unique_ptr<DensityFilter<bucketT>> m_DensityFilter;
+	shared_ptr<DensityFilter<bucketT>> m_DensityFilter;
+	shared_ptr<FilterCache<bucketT>> m_SharedFilters;//Optional cache of filters shared with other renderers.
 	vector<vector<Point<T>>> m_Samples;
 	EmberToXml<T> m_EmberToXml;
+	Interpolater<T> m_Interpolater;//Keeps the aligned embers of the current segment of m_Embers between temporal samples.
 };
 
 //This class had to be implemented in a cpp file because the compiler was breaking.
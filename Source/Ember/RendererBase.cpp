@@ -1,5 +1,6 @@
 #include "EmberPch.h"
 #include "RendererBase.h"
+#include "RenderCheckpoint.h"
 
 namespace EmberNs
 {
@@ -12,6 +13,13 @@ RendererBase::RendererBase()
 {
 	m_Abort = false;
 	m_LockAccum = false;
+	m_PrivateHist = false;
+	m_TiledDE = false;
+	m_Tiles = 1;
+	m_CheckpointSnapshots = 0;
+	m_OutOfCore = false;
+	m_PackedHist = false;
+	m_IndexHist = false;
 	m_EarlyClip = false;
 	m_YAxisUp = false;
 	m_InsertPalette = false;
@@ -23,6 +31,7 @@ RendererBase::RendererBase()
 	m_Transparency = false;
 	ThreadCount(Timing::ProcessorCount());
 	m_Callback = nullptr;
+	m_ResumeCheckpoint = nullptr;
 	m_ProgressParameter = nullptr;
 	m_LastTemporalSample = 0;
 	m_LastIter = 0;
@@ -148,8 +157,39 @@ pair<size_t, size_t> RendererBase::MemoryRequired(size_t strips, bool includeFin
 	pair<size_t, size_t> p;
 	size_t outSize = includeFinal ? FinalBufferSize() : 0;
 	outSize *= (threadedWrite ? 2 : 1);
-	p.first = HistMemoryRequired(strips);
-	p.second = (p.first * 2) + outSize;//Multiply hist by 2 to account for the density filtering buffer which is the same size as the histogram.
+	size_t histSize = HistMemoryRequired(strips);
+	size_t ss = FinalRasW() ? (m_SuperRasW - (2 * m_GutterWidth)) / FinalRasW() : 1;//HistMemoryRequired() computed the bounds.
+	size_t accumSize = histSize;//The density filtering buffer is the same size as a floating point histogram.
+	bool outOfCore = m_OutOfCore && RendererType() == CPU_RENDERER;
+	bool packed = m_PackedHist && !m_IndexHist && RendererType() == CPU_RENDERER;
+	p.first = packed ? (histSize / HistBucketSize()) * sizeof(uint64_t) : histSize;//A packed bucket is always 8 bytes, no matter how many hits it gets.
+
+	if (m_Tiles > 1 && RendererType() == CPU_RENDERER)//Unless it only holds one tile plus the rows of the spatial filter halo.
+		accumSize = std::min(histSize, (histSize / m_Tiles) + (2 * m_GutterWidth * m_SuperRasW * HistBucketSize()));
+
+	if (outOfCore)//Both buffers live in files, so only the buffers each thread collects its hits in take memory.
+		p.second = (ThreadCount() * (HIST_HIT_BUFFER_SIZE + DEFAULT_SBS) * (HistBucketSize() + sizeof(size_t))) + outSize;
+	else
+		p.second = p.first + accumSize + outSize;
+
+	if (m_PrivateHist && !outOfCore && !packed && RendererType() == CPU_RENDERER)//Each thread gets its own full size histogram which is merged into the main one.
+		p.second += histSize * ThreadCount();
+
+	//The summed-area table of hit counts used by density filtering when supersampling, one uint per bucket of the rows of a tile.
+	//It's only allocated while density filtering, but that overlaps with the histogram and accumulator. Out of core, it lives in a file too.
+	if (RendererType() == CPU_RENDERER && ss > 1 && !outOfCore)
+		p.second += (accumSize / HistBucketSize()) * sizeof(uint);
+
+	//The horizontally filtered rows used by the separable spatial filter for one band of output rows.
+	//The spatial filter is at most twice the gutter plus a supersample block wide. This is small, so it stays on the heap even when out of core.
+	if (RendererType() == CPU_RENDERER)
+		p.second += ((std::min(SpatialBandRows(), FinalRasH()) * ss) + (2 * m_GutterWidth) + 1) * FinalRasW() * HistBucketSize();
+
+	//Each checkpoint snapshot held by the caller is a full copy of the histogram as float buckets.
+	//Out of core, the caller stores them in files too.
+	if (RendererType() == CPU_RENDERER && !outOfCore)
+		p.second += m_CheckpointSnapshots * (histSize / HistBucketSize()) * sizeof(RenderCheckpoint::bucket);
+
 	return p;
 }
 
@@ -287,6 +327,7 @@ size_t		   RendererBase::FinalBufferSize()			   const { return FinalRowSize() *
 size_t		   RendererBase::PixelSize()				   const { return NumChannels() * BytesPerChannel(); }
 size_t		   RendererBase::GutterWidth()				   const { return m_GutterWidth; }
 size_t		   RendererBase::DensityFilterOffset()		   const { return m_DensityFilterOffset; }
+size_t		   RendererBase::SpatialBandRows()			   const { return std::max<size_t>(SPATIAL_BAND_ROWS, m_ThreadsToUse * 2); }//Enough rows per band to keep every thread busy.
 size_t         RendererBase::TotalIterCount(size_t strips) const { return size_t(size_t(Round(ScaledQuality())) * FinalRasW() * FinalRasH() * strips); }//Use Round() because there can be some roundoff error when interpolating.
 size_t         RendererBase::ItersPerTemporalSample()	   const { return size_t(ceil(double(TotalIterCount(1)) / double(TemporalSamples()))); }//Temporal samples is used with animation, which doesn't support strips, so pass 1.
 eProcessState  RendererBase::ProcessState()				   const { return m_ProcessState; }
@@ -324,6 +365,169 @@ void RendererBase::LockAccum(bool lockAccum)
 	ChangeVal([&] { m_LockAccum = lockAccum; }, eProcessAction::FULL_RENDER);
 }
 
+/// <summary>
+/// Get whether each thread accumulates into its own private histogram.
+/// The private histograms are summed into the main histogram with a parallel
+/// reduction at the end of each call to Iterate(). This avoids both the lost hits
+/// of unsynchronized accumulation and the contention of LockAccum(), at the cost of
+/// one additional histogram worth of memory per thread.
+/// This takes precedence over LockAccum() and is ignored by GPU renderers.
+/// Default: false.
+/// </summary>
+/// <returns>True if each thread accumulates into its own histogram, else false.</returns>
+bool RendererBase::PrivateHist() const { return m_PrivateHist; }
+
+/// <summary>
+/// Set whether each thread accumulates into its own private histogram.
+/// Reset the rendering process.
+/// </summary>
+/// <param name="privateHist">True if each thread should accumulate into its own histogram, else false</param>
+void RendererBase::PrivateHist(bool privateHist)
+{
+	ChangeVal([&] { m_PrivateHist = privateHist; }, eProcessAction::FULL_RENDER);
+}
+
+/// <summary>
+/// Get whether density filtering is done with the tiled, race free filter rather than the row based one.
+/// Default: false.
+/// </summary>
+/// <returns>True if tiled, else false.</returns>
+bool RendererBase::TiledDE() const { return m_TiledDE; }
+
+/// <summary>
+/// Set whether density filtering is done with the tiled, race free filter rather than the row based one.
+/// Set the render state to FILTER_AND_ACCUM.
+/// </summary>
+/// <param name="tiledDE">True if tiled, else false.</param>
+void RendererBase::TiledDE(bool tiledDE)
+{
+	ChangeVal([&] { m_TiledDE = tiledDE; }, eProcessAction::FILTER_AND_ACCUM);
+}
+
+/// <summary>
+/// Get the number of row tiles that density filtering and final accumulation are split into.
+/// Unlike strips, the histogram is iterated once for the entire image, then each tile is density
+/// filtered and accumulated in turn into an accumulator only large enough to hold one tile plus the
+/// halo rows the spatial filter reads. This roughly halves the memory needed for a large render without
+/// multiplying the number of iterations.
+/// Values greater than 1 are ignored by GPU renderers.
+/// Default: 1.
+/// </summary>
+/// <returns>The number of tiles</returns>
+size_t RendererBase::Tiles() const { return m_Tiles; }
+
+/// <summary>
+/// Set the number of row tiles that density filtering and final accumulation are split into.
+/// Reset the rendering process.
+/// </summary>
+/// <param name="tiles">The number of tiles. A value of 0 is treated as 1.</param>
+void RendererBase::Tiles(size_t tiles)
+{
+	ChangeVal([&] { m_Tiles = std::max<size_t>(tiles, 1); }, eProcessAction::FULL_RENDER);
+}
+
+/// <summary>
+/// Get whether the histogram and density filtering buffer are stored in temporary memory mapped files
+/// rather than in memory, which allows rendering images whose buffers are larger than physical memory
+/// without resorting to strips. Each thread collects its hits in a small buffer which is sorted
+/// by histogram index before being added, so the pages of the file are touched in order rather than at random.
+/// The summed-area table used by density filtering is file backed as well, and the separable spatial filter
+/// only holds one band of rows, so the memory used doesn't grow with the size of the image.
+/// This takes precedence over PrivateHist() and is ignored by GPU renderers.
+/// Default: false.
+/// </summary>
+/// <returns>True if the buffers are file backed, else false.</returns>
+bool RendererBase::OutOfCore() const { return m_OutOfCore; }
+
+/// <summary>
+/// Set whether the histogram and density filtering buffer are stored in temporary memory mapped files.
+/// Reset the rendering process.
+/// </summary>
+/// <param name="outOfCore">True to store the buffers in files, else false.</param>
+void RendererBase::OutOfCore(bool outOfCore)
+{
+	ChangeVal([&] { m_OutOfCore = outOfCore; }, eProcessAction::FULL_RENDER);
+}
+
+/// <summary>
+/// Get the folder the files used for out of core rendering are created in.
+/// Default: empty, meaning the system temporary folder.
+/// </summary>
+/// <returns>The folder path</returns>
+const string& RendererBase::OutOfCorePath() const { return m_OutOfCorePath; }
+
+/// <summary>
+/// Set the folder the files used for out of core rendering are created in.
+/// Reset the rendering process.
+/// </summary>
+/// <param name="path">The folder path. Empty to use the system temporary folder.</param>
+void RendererBase::OutOfCorePath(const string& path)
+{
+	ChangeVal([&] { m_OutOfCorePath = path; }, eProcessAction::FULL_RENDER);
+}
+
+/// <summary>
+/// Get the number of in memory copies of the histogram the caller keeps for checkpoints, which MemoryRequired() includes.
+/// CheckpointRun() keeps two while writing checkpoints, and one while resuming from one.
+/// They are not included when out of core, since they should then be backed by files like the histogram is.
+/// Default: 0.
+/// </summary>
+/// <returns>The number of histogram snapshots</returns>
+size_t RendererBase::CheckpointSnapshots() const { return m_CheckpointSnapshots; }
+
+/// <summary>
+/// Set the number of in memory copies of the histogram the caller keeps for checkpoints.
+/// This only affects MemoryRequired(), so it doesn't reset the rendering process.
+/// </summary>
+/// <param name="snapshots">The number of histogram snapshots</param>
+void RendererBase::CheckpointSnapshots(size_t snapshots)
+{
+	m_CheckpointSnapshots = snapshots;
+}
+
+/// <summary>
+/// Get whether the histogram is stored in 64 bits per bucket rather than as a vec4 of bucketT.
+/// The channels of a packed bucket are 14-bit mantissas which share an exponent, so the memory saved
+/// is the same for every image, at the cost of a small amount of rounding noise in dense buckets.
+/// This takes precedence over PrivateHist() and is ignored by GPU renderers.
+/// Default: false.
+/// </summary>
+/// <returns>True if the histogram is packed, else false.</returns>
+bool RendererBase::PackedHist() const { return m_PackedHist; }
+
+/// <summary>
+/// Set whether the histogram is stored in 64 bits per bucket.
+/// Reset the rendering process.
+/// </summary>
+/// <param name="packedHist">True to pack the histogram, else false.</param>
+void RendererBase::PackedHist(bool packedHist)
+{
+	ChangeVal([&] { m_PackedHist = packedHist; }, eProcessAction::FULL_RENDER);
+}
+
+/// <summary>
+/// Get whether the histogram stores the distribution of palette indices of the hits in each bucket
+/// rather than their colors.
+/// Each bucket holds the hit count, and the total weight, mean and spread of the palette index of its hits weighted by color scale.
+/// The palette is only applied when filtering, by averaging it over the range of indices each bucket received,
+/// so changing the palette or palette mode only requires filtering and accumulating again rather than iterating.
+/// This is an approximation which slightly blurs buckets whose hits come from distant parts of the palette.
+/// This takes precedence over PackedHist() and is ignored by GPU renderers.
+/// Default: false.
+/// </summary>
+/// <returns>True if the histogram holds palette indices, else false.</returns>
+bool RendererBase::IndexHist() const { return m_IndexHist; }
+
+/// <summary>
+/// Set whether the histogram stores the distribution of palette indices of the hits in each bucket.
+/// Reset the rendering process.
+/// </summary>
+/// <param name="indexHist">True to store palette indices, else false.</param>
+void RendererBase::IndexHist(bool indexHist)
+{
+	ChangeVal([&] { m_IndexHist = indexHist; }, eProcessAction::FULL_RENDER);
+}
+
 /// <summary>
 /// Get whether color clipping and gamma correction is done before
 /// or after spatial filtering.
@@ -427,6 +631,18 @@ void RendererBase::Callback(RenderCallback* callback)
 	m_Callback = callback;
 }
 
+/// <summary>
+/// Set a checkpoint to restore at the start of the next call to Run(), which then continues the render
+/// it was saved from rather than starting a new one.
+/// The embers, time and dimensions must match those it was saved with, and the thread count must equal the number of
+/// random contexts it holds, else Run() fails. The checkpoint is only used once, and must remain valid until Run() returns.
+/// </summary>
+/// <param name="checkpoint">The checkpoint to resume from, or nullptr to start a new render.</param>
+void RendererBase::ResumeCheckpoint(const RenderCheckpoint* checkpoint)
+{
+	m_ResumeCheckpoint = checkpoint;
+}
+
 /// <summary>
 /// Set the number of threads to use when rendering.
 /// This will also reset the vector of random contexts to be the same size
@@ -77,6 +77,8 @@ public:
 	double m_IterMs, m_RenderMs;
 };
 
+class RenderCheckpoint;
+
 /// <summary>
 /// The types of available renderers.
 /// Add more in the future as different rendering methods are experimented with.
@@ -110,6 +112,8 @@ public:
 	virtual void SetEmber(vector<Ember<float>>& embers) { }
 	virtual void SetEmber(Ember<double>& ember, eProcessAction action = eProcessAction::FULL_RENDER) { }
 	virtual void SetEmber(vector<Ember<double>>& embers) { }
+	virtual eProcessAction RequiredProcessAction(const Ember<float>& ember) const { return eProcessAction::FULL_RENDER; }
+	virtual eProcessAction RequiredProcessAction(const Ember<double>& ember) const { return eProcessAction::FULL_RENDER; }
 	virtual bool RandVec(vector<QTIsaac<ISAAC_SIZE, ISAAC_INT>>& randVec);
 
 	//Abstract processing functions.
@@ -122,6 +126,7 @@ public:
 	virtual eRenderStatus Run(vector<byte>& finalImage, double time = 0, size_t subBatchCountOverride = 0, bool forceOutput = false, size_t finalOffset = 0) = 0;
 	virtual EmberImageComments ImageComments(const EmberStats& stats, size_t printEditDepth = 0, bool intPalette = false, bool hexPalette = true) = 0;
 	virtual DensityFilterBase* GetDensityFilter() = 0;
+	virtual bool SaveCheckpoint(RenderCheckpoint& checkpoint) = 0;
 
 	//Non-virtual renderer properties, getters only.
 	size_t		   SuperRasW()					 const;
@@ -133,6 +138,7 @@ public:
 	size_t		   PixelSize()					 const;
 	size_t		   GutterWidth()				 const;
 	size_t		   DensityFilterOffset()		 const;
+	size_t		   SpatialBandRows()			 const;
 	size_t		   TotalIterCount(size_t strips) const;
 	size_t		   ItersPerTemporalSample()		 const;
 	eProcessState  ProcessState()				 const;
@@ -142,6 +148,22 @@ public:
 	//Non-virtual render getters and setters.
 	bool LockAccum() const;
 	void LockAccum(bool lockAccum);
+	bool PrivateHist() const;
+	void PrivateHist(bool privateHist);
+	bool TiledDE() const;
+	void TiledDE(bool tiledDE);
+	size_t Tiles() const;
+	void Tiles(size_t tiles);
+	bool OutOfCore() const;
+	void OutOfCore(bool outOfCore);
+	const string& OutOfCorePath() const;
+	void OutOfCorePath(const string& path);
+	size_t CheckpointSnapshots() const;
+	void CheckpointSnapshots(size_t snapshots);
+	bool PackedHist() const;
+	void PackedHist(bool packedHist);
+	bool IndexHist() const;
+	void IndexHist(bool indexHist);
 	bool EarlyClip() const;
 	void EarlyClip(bool earlyClip);
 	bool YAxisUp() const;
@@ -153,6 +175,7 @@ public:
 	bool Transparency() const;
 	void Transparency(bool transparency);
 	void Callback(RenderCallback* callback);
+	void ResumeCheckpoint(const RenderCheckpoint* checkpoint);
 	void ThreadCount(size_t threads, const char* seedString = nullptr);
 	size_t BytesPerChannel() const;
 	void BytesPerChannel(size_t bytesPerChannel);
@@ -200,6 +223,11 @@ protected:
 	bool m_YAxisUp;
 	bool m_Transparency;
 	bool m_LockAccum;
+	bool m_PrivateHist;
+	bool m_TiledDE;
+	bool m_OutOfCore;
+	bool m_PackedHist;
+	bool m_IndexHist;
 	bool m_InRender;
 	bool m_InFinalAccum;
 	bool m_InsertPalette;
@@ -211,6 +239,9 @@ protected:
 	size_t m_SuperSize;
 	size_t m_GutterWidth;
 	size_t m_DensityFilterOffset;
+	size_t m_Tiles;
+	size_t m_CheckpointSnapshots;
+	string m_OutOfCorePath;
 	size_t m_NumChannels;
 	size_t m_BytesPerChannel;
 	size_t m_ThreadsToUse;
@@ -224,6 +255,7 @@ protected:
 	eInteractiveFilter m_InteractiveFilter;
 	EmberStats m_Stats;
 	RenderCallback* m_Callback;
+	const RenderCheckpoint* m_ResumeCheckpoint;
 	vector<size_t> m_SubBatch;
 	vector<size_t> m_BadVals;
 	vector<QTIsaac<ISAAC_SIZE, ISAAC_INT>> m_Rand;
@@ -37,6 +37,36 @@ enum eCrossMode
 	CROSS_ALTERNATE     = 2
 };
 
+/// <summary>
+/// Statistics measured by SheepTools::PreScreen() from a short run of iterations of an ember.
+/// </summary>
+class EMBER_API PreScreenStats
+{
+public:
+	/// <summary>
+	/// Constructor which sets all values to 0.
+	/// </summary>
+	PreScreenStats()
+	{
+		Clear();
+	}
+
+	void Clear()
+	{
+		m_BadRate = 0;
+		m_InView = 0;
+		m_Spread = 0;
+		m_Occupancy = 0;
+		m_Entropy = 0;
+	}
+
+	double m_BadRate;//The number of bad values per iteration.
+	double m_InView;//The fraction of points which landed in the image.
+	double m_Spread;//The ratio of the minor to the major standard deviation of the points in the image. 0 for a line or a point, 1 for an even spread.
+	double m_Occupancy;//The fraction of the cells of a coarse grid over the image which were hit.
+	double m_Entropy;//The entropy of the palette indices of the points in the image, normalized to 0-1.
+};
+
 /// <summary>
 /// SheepTools contains miscellaneous functions for mutating, rotating
 /// crossing and randomizing embers. It is named so because these functions
@@ -790,6 +820,8 @@ public:
 
 	/// <summary>
 	/// Attempt to make colors better by doing some test renders.
+	/// If TestRenderers() was called with a count greater than one, the test renders are run that many at a time.
+	/// Each try still continues from the colors of the one before it, so the result is the same as running them one at a time.
 	/// </summary>
 	/// <param name="ember">The ember to render</param>
 	/// <param name="tries">The number of test renders to try before giving up</param>
@@ -797,8 +829,9 @@ public:
 	/// <param name="colorResolution">The resolution of the test histogram. This value ^ 3 will be used for the total size. Common value is 10.</param>
 	void ImproveColors(Ember<T>& ember, size_t tries, bool changePalette, size_t colorResolution)
 	{
-		size_t i;
-		T best, b;
+		size_t i, j, batch = std::max<size_t>(m_TestRenderers.size(), 1);
+		bool error = false;
+		T best;
 		Ember<T> bestEmber = ember;
 		best = TryColors(ember, colorResolution);
 
@@ -808,21 +841,32 @@ public:
 			return;
 		}
 
-		for (i = 0; i < tries; i++)
+		for (i = 0; i < tries && !error; i += batch)
 		{
-			ChangeColors(ember, changePalette);
-			b = TryColors(ember, colorResolution);
+			m_TestEmbers.clear();
 
-			if (b < 0)
+			for (j = i; j < std::min(tries, i + batch); j++)
 			{
-				cout << "Error in TryColors, aborting tries." << endl;
-				break;
+				ChangeColors(ember, changePalette);
+				m_TestEmbers.push_back(ember);
 			}
 
-			if (b > best)
+			TryColors(m_TestEmbers, colorResolution, m_TestScores);
+
+			for (j = 0; j < m_TestEmbers.size(); j++)
 			{
-				best = b;
-				bestEmber = ember;
+				if (m_TestScores[j] < 0)
+				{
+					cout << "Error in TryColors, aborting tries." << endl;
+					error = true;
+					break;
+				}
+
+				if (m_TestScores[j] > best)
+				{
+					best = m_TestScores[j];
+					bestEmber = m_TestEmbers[j];
+				}
 			}
 		}
 
@@ -837,53 +881,48 @@ public:
 	/// <returns>The number of histogram cells that weren't black</returns>
 	T TryColors(Ember<T>& ember, size_t colorResolution)
 	{
-		byte* p;
-		size_t i, hits = 0, res = colorResolution;
-		size_t pixTotal, res3 = res * res * res;
-		T scalar;
-		Ember<T> adjustedEmber = ember;
-		adjustedEmber.m_Quality = 1;
-		adjustedEmber.m_Supersample = 1;
-		adjustedEmber.m_MaxRadDE = 0;
-		//Scale the image so that the total number of pixels is ~10,000.
-		pixTotal = ember.m_FinalRasW * ember.m_FinalRasH;
-		scalar = std::sqrt(T(10000) / pixTotal);
-		adjustedEmber.m_FinalRasW = static_cast<size_t>(ember.m_FinalRasW  * scalar);
-		adjustedEmber.m_FinalRasH = static_cast<size_t>(ember.m_FinalRasH  * scalar);
-		adjustedEmber.m_PixelsPerUnit *= scalar;
-		adjustedEmber.m_TemporalSamples = 1;
-		m_Renderer->SetEmber(adjustedEmber);
-		m_Renderer->BytesPerChannel(1);
-		m_Renderer->EarlyClip(true);
-		m_Renderer->PixelAspectRatio(1);
 		m_Renderer->ThreadCount(Timing::ProcessorCount());
-		m_Renderer->Callback(nullptr);
-
-		if (m_Renderer->Run(m_FinalImage) != eRenderStatus::RENDER_OK)
-		{
-			cout << "Error rendering test image for TryColors().  Aborting." << endl;
-			return -1;
-		}
+		return TryColors(m_Renderer.get(), ember, colorResolution, m_FinalImage, m_Hist);
+	}
 
-		m_Hist.resize(res3);
-		memset(m_Hist.data(), 0, res3);
-		p = m_FinalImage.data();
+	/// <summary>
+	/// Run a test render for each of several embers to improve the colors.
+	/// If TestRenderers() was called with a count greater than one, that many are run at once on the test renderers.
+	/// Otherwise they are run one at a time.
+	/// </summary>
+	/// <param name="embers">The embers to render</param>
+	/// <param name="colorResolution">The resolution of the test histogram. This value ^ 3 will be used for the total size. Common value is 10.</param>
+	/// <param name="scores">The vector to store the result of TryColors() for each ember in. Will be resized to the number of embers.</param>
+	void TryColors(vector<Ember<T>>& embers, size_t colorResolution, vector<T>& scores)
+	{
+		size_t i, count = std::min(m_TestRenderers.size(), embers.size());
+		std::atomic<size_t> next(0);
+		vector<std::thread> threads;
+		scores.assign(embers.size(), T(-1));
 
-		for (i = 0; i < m_Renderer->FinalDimensions(); i++)
+		if (count < 2)
 		{
-			m_Hist[(p[0] * res / 256) +
-				   (p[1] * res / 256) * res +
-				   (p[2] * res / 256) * res * res]++;
-			p += m_Renderer->NumChannels();
+			for (i = 0; i < embers.size(); i++)
+				scores[i] = TryColors(embers[i], colorResolution);
+
+			return;
 		}
 
-		for (i = 0; i < res3; i++)
+		auto func = [&](size_t r)
 		{
-			if (m_Hist[i])
-				hits++;
-		}
+			size_t j;
+			vector<byte> finalImage;
+			vector<uint> hist;
+
+			while ((j = next.fetch_add(1)) < embers.size())
+				scores[j] = TryColors(m_TestRenderers[r].get(), embers[j], colorResolution, finalImage, hist);
+		};
+
+		for (i = 0; i < count; i++)
+			threads.push_back(std::thread(func, i));
 
-		return T(hits / res3);
+		for (auto& th : threads)
+			th.join();
 	}
 
 	/// <summary>
@@ -998,7 +1037,8 @@ public:
 	void Edge(Ember<T>* embers, Ember<T>& result, T blend, bool seqFlag)
 	{
 		size_t i, si;
-		Ember<T> spun[2], prealign[2];
+		Ember<T>* spun = m_EdgeSpun;//Members are reused between calls so their xforms and palettes are not reallocated each time.
+		Ember<T>* prealign = m_EdgePrealign;
 
 		//Insert motion magic here :
 		//If there are motion elements, modify the contents of
@@ -1033,7 +1073,8 @@ public:
 			//Rotate the aligned xforms.
 			spun[0].RotateAffines(-blend * 360);
 			spun[1].RotateAffines(-blend * 360);
-			Interpolater<T>::Interpolate(spun, 2, m_Smooth ? Interpolater<T>::Smoother(blend) : blend, m_Stagger, result);
+			m_EdgeInterpolater.Reset();//The contents of spun are different on every call.
+			m_EdgeInterpolater.InterpolateInPlace(spun, 2, m_Smooth ? Interpolater<T>::Smoother(blend) : blend, m_Stagger, result);
 		}
 
 		//Make sure there are no motion elements in the result.
@@ -1300,6 +1341,157 @@ public:
 		return bv;
 	}
 
+	/// <summary>
+	/// Cheaply decide whether an ember is too degenerate to pass the brightness tests of a test render, without rendering it.
+	/// A short run of points is iterated and mapped to the image the same way the renderer would, then measured.
+	/// All measurements are in pixels of the final image, so points which land in the gutter around it are out of view.
+	/// The ember is rejected if:
+	///		More than half of the iterations produce bad values, meaning the points escape.
+	///		The points in the image lie along a line or collapse to a point, and a line a few pixels thick couldn't reach avgThresh.
+	///		So few cells of a coarse grid over the image are hit that even if all of them were white, the average couldn't reach avgThresh.
+	/// The color entropy is measured but not used, since an image of a single color can still pass.
+	/// These are deliberately loose so that embers which would pass are rarely rejected.
+	/// </summary>
+	/// <param name="ember">The ember to test, with the size and camera it would be test rendered with</param>
+	/// <param name="avgThresh">The minimum average pixel channel value the test render needs, 0-255</param>
+	/// <param name="samples">The number of points to iterate. A few thousand is enough.</param>
+	/// <param name="stats">Stores the measurements the decision was made from</param>
+	/// <returns>True if the ember might pass, false if it was rejected.</returns>
+	bool PreScreen(Ember<T>& ember, T avgThresh, size_t samples, PreScreenStats& stats)
+	{
+		static const size_t gridSize = 16;
+		static const size_t colorBins = 32;
+		bool newAlloc = false;
+		size_t i, index, rasX, rasY, inView = 0, cells = 0, gutter, ss, finalW, finalH;
+		size_t grid[gridSize * gridSize] = { 0 };
+		size_t colors[colorBins] = { 0 };
+		double sumX = 0, sumY = 0, sumXX = 0, sumYY = 0, sumXY = 0;
+		T lineMax;
+		Affine2D<T> rotMat;
+		IterParams<T> params;
+		stats.Clear();
+
+		if (!samples)
+			return true;
+
+		m_Renderer->SetEmber(ember);
+		m_Renderer->CreateSpatialFilter(newAlloc);
+		m_Renderer->CreateDEFilter(newAlloc);
+		m_Renderer->ComputeBounds();
+		m_Renderer->ComputeQuality();
+		m_Renderer->ComputeCamera();
+		CarToRas<T> carToRas = m_Renderer->CoordMap();//Maps to the supersampled raster, including the gutter.
+		gutter = m_Renderer->GutterWidth();
+		finalW = std::max<size_t>(m_Renderer->FinalRasW(), 1);
+		finalH = std::max<size_t>(m_Renderer->FinalRasH(), 1);
+		ss = std::max<size_t>((carToRas.RasWidth() - std::min(carToRas.RasWidth(), 2 * gutter)) / finalW, 1);
+		rotMat.Rotate(-ember.m_Rotate);
+
+		if (ember.XaosPresent())
+			m_Iterator = m_XaosIterator.get();
+		else
+			m_Iterator = m_StandardIterator.get();
+
+		m_Iterator->InitDistributions(ember);
+		m_Samples.resize(samples);
+		m_Samples[0].m_X = m_Rand.Frand11<T>();//Start from a random point and color, the same way the renderer does.
+		m_Samples[0].m_Y = m_Rand.Frand11<T>();
+		m_Samples[0].m_Z = 0;
+		m_Samples[0].m_ColorX = m_Rand.Frand01<T>();
+		params.m_Count = samples;
+		params.m_Skip = 20;
+		stats.m_BadRate = m_Iterator->Iterate(ember, params, m_Samples.data(), m_Rand) / double(samples);
+
+		for (i = 0; i < samples; i++)
+		{
+			Point<T>& p = m_Samples[i];
+
+			if (ember.m_Rotate != 0)//Same as Renderer::Accumulate().
+			{
+				T p00 = p.m_X - ember.m_CenterX;
+				T p11 = p.m_Y - ember.m_RotCenterY;
+				p.m_X = (p00 * rotMat.A()) + (p11 * rotMat.B()) + ember.m_CenterX;
+				p.m_Y = (p00 * rotMat.D()) + (p11 * rotMat.E()) + ember.m_RotCenterY;
+			}
+
+			if (p.m_VizAdjusted == 0 || !carToRas.InBounds(p))
+				continue;
+
+			carToRas.Convert(p, index);
+
+			if (index >= carToRas.RasWidth() * carToRas.RasHeight())
+				continue;
+
+			rasX = index % carToRas.RasWidth();
+			rasY = index / carToRas.RasWidth();
+
+			if (rasX < gutter || rasY < gutter)
+				continue;
+
+			rasX = (rasX - gutter) / ss;//Convert to a pixel of the final image.
+			rasY = (rasY - gutter) / ss;
+
+			if (rasX >= finalW || rasY >= finalH)
+				continue;
+
+			grid[(rasY * gridSize / finalH) * gridSize + (rasX * gridSize / finalW)]++;
+			colors[Clamp<size_t>(size_t(p.m_ColorX * colorBins), 0, colorBins - 1)]++;
+			sumX += rasX;
+			sumY += rasY;
+			sumXX += double(rasX) * rasX;
+			sumYY += double(rasY) * rasY;
+			sumXY += double(rasX) * rasY;
+			inView++;
+		}
+
+		stats.m_InView = inView / double(samples);
+
+		for (i = 0; i < gridSize * gridSize; i++)
+			if (grid[i])
+				cells++;
+
+		stats.m_Occupancy = cells / double(gridSize * gridSize);
+
+		if (inView)
+		{
+			double n = double(inView);
+			double varX = sumXX / n - (sumX / n) * (sumX / n);
+			double varY = sumYY / n - (sumY / n) * (sumY / n);
+			double covXY = sumXY / n - (sumX / n) * (sumY / n);
+			double mid = (varX + varY) / 2;
+			double diff = std::sqrt(((varX - varY) / 2) * ((varX - varY) / 2) + covXY * covXY);
+
+			//The square roots of the eigenvalues of the covariance matrix are the standard deviations along the principal axes.
+			if (mid + diff > 0)
+				stats.m_Spread = std::sqrt(std::max(0.0, mid - diff) / (mid + diff));
+
+			for (i = 0; i < colorBins; i++)
+			{
+				if (colors[i])
+				{
+					double prob = colors[i] / n;
+					stats.m_Entropy -= prob * std::log2(prob);
+				}
+			}
+
+			stats.m_Entropy /= std::log2(double(colorBins));
+		}
+
+		//A line about 3 pixels thick across the whole image covers at most this fraction of it.
+		lineMax = T(255) * 3 * T(finalW + finalH) / T(finalW * finalH);
+
+		if (stats.m_BadRate > 0.5)
+			return false;
+
+		if (stats.m_Spread < 0.01 && lineMax < avgThresh)
+			return false;
+
+		if (stats.m_Occupancy * 255 < avgThresh)
+			return false;
+
+		return true;
+	}
+
 	/// <summary>
 	/// When doing spin or edge, an edit doc is made to record what was done.
 	/// Doing so takes many extra parameters such as name and url. Passing these every
@@ -1331,7 +1523,86 @@ public:
 		m_Comment = comment;
 	}
 
+	/// <summary>
+	/// Set the number of CPU renderers which ImproveColors() uses to run its test renders at once.
+	/// The cores are split evenly between them.
+	/// Pass 0 or 1 to run them one at a time on the renderer passed to the constructor, which is the default.
+	/// </summary>
+	/// <param name="count">The number of test renderers to create</param>
+	void TestRenderers(size_t count)
+	{
+		size_t threads = std::max<size_t>(1, Timing::ProcessorCount() / std::max<size_t>(count, 1));
+		m_TestRenderers.clear();
+
+		if (count < 2)
+			return;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			m_TestRenderers.push_back(unique_ptr<Renderer<T, bucketT>>(new Renderer<T, bucketT>()));
+			m_TestRenderers.back()->ThreadCount(threads);
+		}
+	}
+
 private:
+	/// <summary>
+	/// Run a test render on the specified renderer and return the number of color histogram cells that weren't black.
+	/// </summary>
+	/// <param name="renderer">The renderer to use</param>
+	/// <param name="ember">The ember to render</param>
+	/// <param name="colorResolution">The resolution of the test histogram. This value ^ 3 will be used for the total size.</param>
+	/// <param name="finalImage">The vector to render the test image to</param>
+	/// <param name="hist">The vector to store the color histogram in</param>
+	/// <returns>The number of histogram cells that weren't black if successful, else -1.</returns>
+	T TryColors(Renderer<T, bucketT>* renderer, Ember<T>& ember, size_t colorResolution, vector<byte>& finalImage, vector<uint>& hist)
+	{
+		byte* p;
+		size_t i, hits = 0, res = colorResolution;
+		size_t pixTotal, res3 = res * res * res;
+		T scalar;
+		Ember<T> adjustedEmber = ember;
+		adjustedEmber.m_Quality = 1;
+		adjustedEmber.m_Supersample = 1;
+		adjustedEmber.m_MaxRadDE = 0;
+		//Scale the image so that the total number of pixels is ~10,000.
+		pixTotal = ember.m_FinalRasW * ember.m_FinalRasH;
+		scalar = std::sqrt(T(10000) / pixTotal);
+		adjustedEmber.m_FinalRasW = static_cast<size_t>(ember.m_FinalRasW  * scalar);
+		adjustedEmber.m_FinalRasH = static_cast<size_t>(ember.m_FinalRasH  * scalar);
+		adjustedEmber.m_PixelsPerUnit *= scalar;
+		adjustedEmber.m_TemporalSamples = 1;
+		renderer->SetEmber(adjustedEmber);
+		renderer->BytesPerChannel(1);
+		renderer->EarlyClip(true);
+		renderer->PixelAspectRatio(1);
+		renderer->Callback(nullptr);
+
+		if (renderer->Run(finalImage) != eRenderStatus::RENDER_OK)
+		{
+			cout << "Error rendering test image for TryColors().  Aborting." << endl;
+			return -1;
+		}
+
+		hist.assign(res3, 0);
+		p = finalImage.data();
+
+		for (i = 0; i < renderer->FinalDimensions(); i++)
+		{
+			hist[(p[0] * res / 256) +
+				 (p[1] * res / 256) * res +
+				 (p[2] * res / 256) * res * res]++;
+			p += renderer->NumChannels();
+		}
+
+		for (i = 0; i < res3; i++)
+		{
+			if (hist[i])
+				hits++;
+		}
+
+		return T(hits) / T(res3);
+	}
+
 	bool m_Smooth;
 	intmax_t m_SheepGen;
 	intmax_t m_SheepId;
@@ -1346,13 +1617,19 @@ private:
 	vector<Point<T>> m_Samples;
 	vector<byte> m_FinalImage;
 	vector<uint> m_Hist;
+	vector<T> m_TestScores;
+	vector<Ember<T>> m_TestEmbers;
 	EmberToXml<T> m_EmberToXml;
 	Iterator<T>* m_Iterator;
 	unique_ptr<StandardIterator<T>> m_StandardIterator;
 	unique_ptr<XaosIterator<T>> m_XaosIterator;
 	unique_ptr<Renderer<T, bucketT>> m_Renderer;
+	vector<unique_ptr<Renderer<T, bucketT>>> m_TestRenderers;//Used by ImproveColors() to run test renders at once, empty to use m_Renderer.
 	QTIsaac<ISAAC_SIZE, ISAAC_INT> m_Rand;
 	PaletteList<T> m_PaletteList;
 	VariationList<T> m_VariationList;
+	Ember<T> m_EdgeSpun[2];
+	Ember<T> m_EdgePrealign[2];
+	Interpolater<T> m_EdgeInterpolater;
 };
 }
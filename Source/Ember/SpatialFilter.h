@@ -94,6 +94,8 @@ public:
 			m_PixelAspectRatio = filter.m_PixelAspectRatio;
 			m_FilterType = filter.m_FilterType;
 			m_Filter = filter.m_Filter;
+			m_FilterX = filter.m_FilterX;
+			m_FilterY = filter.m_FilterY;
 		}
 
 		return *this;
@@ -123,21 +125,25 @@ public:
 				adjust = T(1.0);
 
 			m_Filter.resize(fwidth * fwidth);
+			m_FilterX.resize(fwidth);
+			m_FilterY.resize(fwidth);
 
-			//Fill in the coefs.
+			//Fill in the 1D coefs for each axis first.
 			for (i = 0; i < fwidth; i++)
 			{
-				for (j = 0; j < fwidth; j++)
-				{
-					//Calculate the function inputs for the kernel function.
-					ii = ((T(2.0) * i + T(1.0)) / T(fwidth) - T(1.0)) * adjust;
-					jj = ((T(2.0) * j + T(1.0)) / T(fwidth) - T(1.0)) * adjust;
-					//Adjust for aspect ratio.
-					jj /= m_PixelAspectRatio;
-					m_Filter[i + j * fwidth] = Filter(ii) * Filter(jj);//Call virtual Filter(), implemented in specific derived filter classes.
-				}
+				//Calculate the function inputs for the kernel function.
+				ii = ((T(2.0) * i + T(1.0)) / T(fwidth) - T(1.0)) * adjust;
+				//Adjust for aspect ratio.
+				jj = ii / m_PixelAspectRatio;
+				m_FilterX[i] = Filter(ii);//Call virtual Filter(), implemented in specific derived filter classes.
+				m_FilterY[i] = Filter(jj);
 			}
 
+			//The 2D kernel is the outer product of the two axes.
+			for (j = 0; j < fwidth; j++)
+				for (i = 0; i < fwidth; i++)
+					m_Filter[i + j * fwidth] = m_FilterX[i] * m_FilterY[j];
+
 			//Attempt to normalize, and increase the filter width if the values were too small.
 			if (Normalize())
 			{
@@ -189,9 +195,20 @@ public:
 	inline T PixelAspectRatio() const { return m_PixelAspectRatio; }
 	inline eSpatialFilterType FilterType() const { return m_FilterType; }
 	inline T* Filter() { return m_Filter.data(); }
+	inline const T* FilterX() const { return m_FilterX.data(); }
+	inline const T* FilterY() const { return m_FilterY.data(); }
 	inline const T& operator[] (size_t index) const { return m_Filter[index]; }
 	virtual T Filter(T t) const = 0;
 
+	/// <summary>
+	/// Whether the 2D kernel can be applied as a horizontal pass using FilterX()
+	/// followed by a vertical pass using FilterY().
+	/// Every filter built by Create() is the outer product of Filter() along each axis, so this is true
+	/// by default. A derived class which fills in a non-separable kernel must override this to return false.
+	/// </summary>
+	/// <returns>True if separable, else false.</returns>
+	virtual bool Separable() const { return true; }
+
 protected:
 	/// <summary>
 	/// Calculation function used in Lanczos filters.
@@ -229,9 +246,33 @@ private:
 		for (i = 0; i < m_Filter.size(); i++)
 			m_Filter[i] *= t;
 
+		//Normalize each axis on its own so their outer product matches the normalized 2D kernel.
+		//Neither sum can be zero here since their product was non-zero.
+		NormalizeAxis(m_FilterX);
+		NormalizeAxis(m_FilterY);
 		return true;
 	}
 
+	/// <summary>
+	/// Normalize the values of a single axis of the filter so they sum to 1.
+	/// </summary>
+	/// <param name="axis">The 1D filter values to normalize</param>
+	static void NormalizeAxis(vector<T>& axis)
+	{
+		T t = T(0.0);
+
+		for (auto& v : axis)
+			t += v;
+
+		if (t != 0.0)
+		{
+			t = T(1.0) / t;
+
+			for (auto& v : axis)
+				v *= t;
+		}
+	}
+
 	int m_FinalFilterWidth;//The final width that the filter ends up being.
 	size_t m_Supersample;//The supersample value of the ember using this filter to render.
 	T m_Support;//Extra value.
@@ -239,6 +280,8 @@ private:
 	T m_PixelAspectRatio;//The aspect ratio of the ember using this filter to render, usually 1.
 	eSpatialFilterType m_FilterType;//The type of filter this is.
 	vector<T> m_Filter;//The vector holding the calculated filter values.
+	vector<T> m_FilterX;//The normalized 1D filter values along the x axis.
+	vector<T> m_FilterY;//The normalized 1D filter values along the y axis, adjusted for aspect ratio.
 };
 
 /// <summary>
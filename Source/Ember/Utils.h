@@ -908,6 +908,106 @@ static string ToUpper(const string& str)
 	return upper;
 }
 
+/// <summary>
+/// Hash functor for using strings as keys in unordered containers where they are
+/// matched without regard to case, the same way _stricmp() matches them.
+/// This is FNV-1a over the lower case characters, so no lower case copy of the key is made.
+/// </summary>
+struct CaseInsensitiveHash
+{
+	size_t operator()(const string& str) const
+	{
+		uint64_t hash = 14695981039346656037ULL;
+
+		for (auto c : str)
+		{
+			hash ^= uint64_t(::tolower(static_cast<unsigned char>(c)));
+			hash *= 1099511628211ULL;
+		}
+
+		return size_t(hash);
+	}
+};
+
+/// <summary>
+/// Equality functor to use with CaseInsensitiveHash.
+/// </summary>
+struct CaseInsensitiveEqual
+{
+	bool operator()(const string& lhs, const string& rhs) const
+	{
+		return lhs.size() == rhs.size() && !_stricmp(lhs.c_str(), rhs.c_str());
+	}
+};
+
+/// <summary>
+/// The offset basis which starts a 64-bit FNV-1a hash.
+/// </summary>
+static const uint64_t HASH_SEED = 14695981039346656037ULL;
+
+/// <summary>
+/// Continue a 64-bit FNV-1a hash with a block of bytes.
+/// This is the building block of the content hashes of embers and their members.
+/// </summary>
+/// <param name="data">The bytes to hash</param>
+/// <param name="size">The number of bytes to hash</param>
+/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+/// <returns>The hash</returns>
+static inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = HASH_SEED)
+{
+	auto p = static_cast<const byte*>(data);
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= uint64_t(p[i]);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+/// <summary>
+/// Continue a 64-bit FNV-1a hash with the bytes of an integral or enum value.
+/// </summary>
+/// <param name="val">The value to hash</param>
+/// <param name="hash">The hash of any preceding values to continue from</param>
+/// <returns>The hash</returns>
+template <typename T>
+static inline uint64_t HashVal(T val, uint64_t hash)
+{
+	return HashBytes(&val, sizeof(val), hash);
+}
+
+/// <summary>
+/// Continue a 64-bit FNV-1a hash with a floating point value.
+/// Negative zero is hashed as zero so that values which compare equal hash equal.
+/// </summary>
+/// <param name="val">The value to hash</param>
+/// <param name="hash">The hash of any preceding values to continue from</param>
+/// <returns>The hash</returns>
+static inline uint64_t HashVal(float val, uint64_t hash)
+{
+	if (val == 0)
+		val = 0;
+
+	return HashBytes(&val, sizeof(val), hash);
+}
+
+/// <summary>
+/// Continue a 64-bit FNV-1a hash with a double precision floating point value.
+/// Negative zero is hashed as zero so that values which compare equal hash equal.
+/// </summary>
+/// <param name="val">The value to hash</param>
+/// <param name="hash">The hash of any preceding values to continue from</param>
+/// <returns>The hash</returns>
+static inline uint64_t HashVal(double val, uint64_t hash)
+{
+	if (val == 0)
+		val = 0;
+
+	return HashBytes(&val, sizeof(val), hash);
+}
+
 /// <summary>
 /// Return a copy of a string with leading and trailing occurrences of a specified character removed.
 /// The default character is a space.
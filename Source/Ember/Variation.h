@@ -1026,6 +1026,67 @@ public:
 	v4T In, Out;
 };
 
+/// <summary>
+/// Structure of arrays version of IteratorHelper used when applying an xform to a batch of points at once.
+/// Each array element is a lane which corresponds to one independent trajectory, and only the first m_Count
+/// lanes are valid. The input points are stored in m_X, m_Y, m_Z and m_ColorX, and the output points in m_Points.
+/// Like IteratorHelper, this must not be a member because multiple threads will be calling the variation
+/// functions simultaneously. Each thread will get its own IteratorHelperBatch object.
+/// Template argument expected to be float or double.
+/// </summary>
+template <typename T>
+class EMBER_API IteratorHelperBatch
+{
+public:
+	/// <summary>
+	/// Copy the values of a single lane into m_Helper so a non-batched variation function can be called on it.
+	/// </summary>
+	/// <param name="i">The lane to copy</param>
+	inline void Load(size_t i)
+	{
+		m_Helper.m_Color.x = m_Color[i];
+		m_Helper.m_TransX = m_TransX[i];
+		m_Helper.m_TransY = m_TransY[i];
+		m_Helper.m_TransZ = m_TransZ[i];
+		m_Helper.m_PrecalcSumSquares = m_PrecalcSumSquares[i];
+		m_Helper.m_PrecalcSqrtSumSquares = m_PrecalcSqrtSumSquares[i];
+		m_Helper.m_PrecalcSina = m_PrecalcSina[i];
+		m_Helper.m_PrecalcCosa = m_PrecalcCosa[i];
+		m_Helper.m_PrecalcAtanxy = m_PrecalcAtanxy[i];
+		m_Helper.m_PrecalcAtanyx = m_PrecalcAtanyx[i];
+		m_Helper.In.x = m_InX[i];
+		m_Helper.In.y = m_InY[i];
+		m_Helper.In.z = m_InZ[i];
+	}
+
+	/// <summary>
+	/// Copy the output values in m_Helper back to a single lane after calling a non-batched variation function.
+	/// </summary>
+	/// <param name="i">The lane to copy to</param>
+	inline void Store(size_t i)
+	{
+		m_OutX[i] = m_Helper.Out.x;
+		m_OutY[i] = m_Helper.Out.y;
+		m_OutZ[i] = m_Helper.Out.z;
+	}
+
+	size_t m_Count;
+	T m_X[ITER_BATCH_SIZE], m_Y[ITER_BATCH_SIZE], m_Z[ITER_BATCH_SIZE], m_ColorX[ITER_BATCH_SIZE];//The input points.
+	T m_Color[ITER_BATCH_SIZE];
+	T m_TransX[ITER_BATCH_SIZE], m_TransY[ITER_BATCH_SIZE], m_TransZ[ITER_BATCH_SIZE];
+	T m_PrecalcSumSquares[ITER_BATCH_SIZE];
+	T m_PrecalcSqrtSumSquares[ITER_BATCH_SIZE];
+	T m_PrecalcSina[ITER_BATCH_SIZE];
+	T m_PrecalcCosa[ITER_BATCH_SIZE];
+	T m_PrecalcAtanxy[ITER_BATCH_SIZE];
+	T m_PrecalcAtanyx[ITER_BATCH_SIZE];
+	T m_InX[ITER_BATCH_SIZE], m_InY[ITER_BATCH_SIZE], m_InZ[ITER_BATCH_SIZE];
+	T m_OutX[ITER_BATCH_SIZE], m_OutY[ITER_BATCH_SIZE], m_OutZ[ITER_BATCH_SIZE];
+	bool m_Bad[ITER_BATCH_SIZE];//Whether the output point of each lane had bad values.
+	Point<T> m_Points[ITER_BATCH_SIZE];//The output points.
+	IteratorHelper<T> m_Helper;//Scratch helper used by the scalar fallback in Variation::FuncBatch().
+};
+
 /// <summary>
 /// The base variation class from which all variations will derive.
 /// Each has a unique ID, name and weight, as well as a virtual function Func() which
@@ -1200,6 +1261,49 @@ public:
 		}
 	}
 
+	/// <summary>
+	/// Batched version of PrecalcHelper() used for pre and post variations.
+	/// For pre variations, the input values are the translated points and for post variations
+	/// they are the output points, both of which have already been copied into In by the caller.
+	/// </summary>
+	/// <param name="helper">The batch helper to read the input values from and store the precalc values to</param>
+	void PrecalcHelperBatch(IteratorHelperBatch<T>& helper)
+	{
+		size_t i, count = helper.m_Count;
+
+		if (m_VarType == VARTYPE_PRE || m_VarType == VARTYPE_POST)
+		{
+			if (m_NeedPrecalcSumSquares)
+			{
+				for (i = 0; i < count; i++)
+					helper.m_PrecalcSumSquares[i] = SQR(helper.m_InX[i]) + SQR(helper.m_InY[i]);
+
+				if (m_NeedPrecalcSqrtSumSquares)
+				{
+					for (i = 0; i < count; i++)
+						helper.m_PrecalcSqrtSumSquares[i] = std::sqrt(helper.m_PrecalcSumSquares[i]);
+
+					if (m_NeedPrecalcAngles)
+					{
+						for (i = 0; i < count; i++)
+						{
+							helper.m_PrecalcSina[i] = helper.m_InX[i] / helper.m_PrecalcSqrtSumSquares[i];
+							helper.m_PrecalcCosa[i] = helper.m_InY[i] / helper.m_PrecalcSqrtSumSquares[i];
+						}
+					}
+				}
+			}
+
+			if (m_NeedPrecalcAtanXY)
+				for (i = 0; i < count; i++)
+					helper.m_PrecalcAtanxy[i] = atan2(helper.m_InX[i], helper.m_InY[i]);
+
+			if (m_NeedPrecalcAtanYX)
+				for (i = 0; i < count; i++)
+					helper.m_PrecalcAtanyx[i] = atan2(helper.m_InY[i], helper.m_InX[i]);
+		}
+	}
+
 	/// <summary>
 	/// Per-variation precalc OpenCL string used for pre and post variations.
 	/// </summary>
@@ -1298,6 +1402,18 @@ public:
 		return ss.str();
 	}
 
+	/// <summary>
+	/// Continue a content hash with the ID and weight of the variation.
+	/// Derived classes with parameters add them as well.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	virtual uint64_t Hash(uint64_t hash = HASH_SEED) const
+	{
+		hash = HashVal(m_VariationId, hash);
+		return HashVal(m_Weight, hash);
+	}
+
 	/// <summary>
 	/// Abstract copy function. Derived classes must implement.
 	/// </summary>
@@ -1337,6 +1453,24 @@ public:
 	/// <param name="rand">The random number generator to use.</param>
 	virtual void Func(IteratorHelper<T>& helper, Point<T>& outPoint, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) = 0;
 
+	/// <summary>
+	/// Apply this variation to every valid lane of a batch, storing the results in the Out arrays of the helper.
+	/// The default is a scalar fallback which copies each lane into a regular IteratorHelper and calls Func() on it.
+	/// Derived classes whose calculations are simple enough to be written as a straight loop over the lanes
+	/// can override this to avoid the per-point virtual call and let the compiler vectorize it.
+	/// </summary>
+	/// <param name="helper">The IteratorHelperBatch object which holds translated and precalculated values for each lane</param>
+	/// <param name="rand">The random number generator to use.</param>
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand)
+	{
+		for (size_t i = 0; i < helper.m_Count; i++)
+		{
+			helper.Load(i);
+			Func(helper.m_Helper, helper.m_Points[i], rand);
+			helper.Store(i);
+		}
+	}
+
 	/// <summary>
 	/// Return a string which performs the equivalent calculation in Func(), but on the GPU in OpenCL.
 	/// Derived classes will implement this.
@@ -1878,8 +2012,11 @@ public:
 	{
 		bool b = false;
 
-		if (index < m_Params.size())
+		if (index >= 0 && size_t(index) < m_Params.size())
+		{
 			m_Params[index].Set(val);
+			b = true;
+		}
 
 		if (b)
 			this->Precalc();
@@ -1973,6 +2110,23 @@ public:
 		return ss.str();
 	}
 
+	/// <summary>
+	/// Continue a content hash with the ID, weight and parameter values of the variation.
+	/// Precalculated and state parameters are excluded since they are derived from the others.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	virtual uint64_t Hash(uint64_t hash = HASH_SEED) const override
+	{
+		hash = Variation<T>::Hash(hash);
+
+		for (auto& param : m_Params)
+			if (!param.IsPrecalc())
+				hash = HashVal(param.ParamVal(), hash);
+
+		return hash;
+	}
+
 	/// <summary>
 	/// Accessors.
 	/// </summary>
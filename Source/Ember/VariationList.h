@@ -376,6 +376,21 @@ public:
 			if (ParametricVariation<T>* parVar = dynamic_cast<ParametricVariation<T>*>(m_Variations[i]))
 				m_ParametricVariations.push_back(parVar);
 		}
+
+		//Index the variations by ID, name and parameter name so looking them up doesn't require scanning the list.
+		m_IdIndices.resize(size_t(eVariationId::LAST_VAR) + 1, -1);
+		m_NameIndices.reserve(m_Variations.size());
+		m_ParamIndices.reserve(m_Variations.size() * 4);
+
+		for (size_t i = 0; i < m_Variations.size(); i++)
+		{
+			m_IdIndices[m_Variations[i]->VariationId()] = int(i);
+			m_NameIndices.emplace(m_Variations[i]->Name(), i);
+
+			if (ParametricVariation<T>* parVar = dynamic_cast<ParametricVariation<T>*>(m_Variations[i]))
+				for (size_t j = 0; j < parVar->ParamCount(); j++)
+					m_ParamIndices.emplace(parVar->Params()[j].Name(), std::make_pair(i, j));
+		}
 	}
 
 	/// <summary>
@@ -428,11 +443,7 @@ public:
 	/// <returns>A pointer to the variation if found, else nullptr.</returns>
 	const Variation<T>* GetVariation(eVariationId id) const
 	{
-		for (size_t i = 0; i < m_Variations.size() && m_Variations[i]; i++)
-			if (id == m_Variations[i]->VariationId())
-				return m_Variations[i];
-
-		return nullptr;
+		return size_t(id) < m_IdIndices.size() && m_IdIndices[id] != -1 ? m_Variations[m_IdIndices[id]] : nullptr;
 	}
 
 	/// <summary>
@@ -451,11 +462,8 @@ public:
 	/// <returns>A pointer to the variation if found, else nullptr.</returns>
 	const Variation<T>* GetVariation(const string& name) const
 	{
-		for (size_t i = 0; i < m_Variations.size() && m_Variations[i]; i++)
-			if (!_stricmp(name.c_str(), m_Variations[i]->Name().c_str()))
-				return m_Variations[i];
-
-		return nullptr;
+		auto it = m_NameIndices.find(name);
+		return it != m_NameIndices.end() ? m_Variations[it->second] : nullptr;
 	}
 
 	/// <summary>
@@ -482,11 +490,26 @@ public:
 	/// <returns>The parametric variation with a matching name, else nullptr.</returns>
 	const ParametricVariation<T>* GetParametricVariation(const string& name) const
 	{
-		for (size_t i = 0; i < m_ParametricVariations.size() && m_ParametricVariations[i]; i++)
-			if (!_stricmp(name.c_str(), m_ParametricVariations[i]->Name().c_str()))
-				return m_ParametricVariations[i];
+		return dynamic_cast<const ParametricVariation<T>*>(GetVariation(name));
+	}
 
-		return nullptr;
+	/// <summary>
+	/// Get the parametric variation which has a parameter with the specified name,
+	/// and the index of that parameter within the variation's parameters.
+	/// The index can be passed to SetParamVal() on any copy of the variation, which avoids searching its parameters by name.
+	/// </summary>
+	/// <param name="paramName">The name of the parameter to search for</param>
+	/// <param name="paramIndex">The index of the parameter within the variation if found, else unchanged.</param>
+	/// <returns>The parametric variation which has the parameter if found, else nullptr.</returns>
+	const ParametricVariation<T>* GetParametricVariationByParam(const string& paramName, size_t& paramIndex) const
+	{
+		auto it = m_ParamIndices.find(paramName);
+
+		if (it == m_ParamIndices.end())
+			return nullptr;
+
+		paramIndex = it->second.second;
+		return static_cast<const ParametricVariation<T>*>(m_Variations[it->second.first]);
 	}
 
 	/// <summary>
@@ -494,13 +517,10 @@ public:
 	/// </summary>
 	/// <param name="name">The name of the variation whose index is returned</param>
 	/// <returns>The index of the variation with the matching name, else -1</returns>
-	int GetVariationIndex(const string& name)
+	int GetVariationIndex(const string& name) const
 	{
-		for (size_t i = 0; i < m_Variations.size() && m_Variations[i]; i++)
-			if (!_stricmp(name.c_str(), m_Variations[i]->Name().c_str()))
-				return int(i);
-
-		return -1;
+		auto it = m_NameIndices.find(name);
+		return it != m_NameIndices.end() ? int(it->second) : -1;
 	}
 
 	/// <summary>
@@ -548,5 +568,8 @@ private:
 	vector<Variation<T>*> m_PreVariations;
 	vector<Variation<T>*> m_PostVariations;
 	vector<ParametricVariation<T>*> m_ParametricVariations;//A list of pointers to elements in m_Variations which are derived from ParametricVariation.
+	vector<int> m_IdIndices;//The index in m_Variations of each variation ID, -1 for IDs not present.
+	unordered_map<string, size_t, CaseInsensitiveHash, CaseInsensitiveEqual> m_NameIndices;//The index in m_Variations of each variation name.
+	unordered_map<string, pair<size_t, size_t>, CaseInsensitiveHash, CaseInsensitiveEqual> m_ParamIndices;//The index in m_Variations of the variation with each parameter name, and the index of the parameter within it.
 };
 }
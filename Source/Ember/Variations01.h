@@ -26,6 +26,16 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		for (size_t i = 0; i < helper.m_Count; i++)
+		{
+			helper.m_OutX[i] = m_Weight * helper.m_InX[i];
+			helper.m_OutY[i] = m_Weight * helper.m_InY[i];
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -63,6 +73,16 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		for (size_t i = 0; i < helper.m_Count; i++)
+		{
+			helper.m_OutX[i] = m_Weight * std::sin(helper.m_InX[i]);
+			helper.m_OutY[i] = m_Weight * std::sin(helper.m_InY[i]);
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -103,6 +123,17 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		for (size_t i = 0; i < helper.m_Count; i++)
+		{
+			T r2 = m_Weight / Zeps(helper.m_PrecalcSumSquares[i]);
+			helper.m_OutX[i] = r2 * helper.m_InX[i];
+			helper.m_OutY[i] = r2 * helper.m_InY[i];
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -153,6 +184,18 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		for (size_t i = 0; i < helper.m_Count; i++)
+		{
+			T c1 = std::sin(helper.m_PrecalcSumSquares[i]);
+			T c2 = std::cos(helper.m_PrecalcSumSquares[i]);
+			helper.m_OutX[i] = m_Weight * (c1 * helper.m_InX[i] - c2 * helper.m_InY[i]);
+			helper.m_OutY[i] = m_Weight * (c2 * helper.m_InX[i] + c1 * helper.m_InY[i]);
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -198,6 +241,17 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		for (size_t i = 0; i < helper.m_Count; i++)
+		{
+			T r = m_Weight / Zeps(helper.m_PrecalcSqrtSumSquares[i]);
+			helper.m_OutX[i] = (helper.m_InX[i] - helper.m_InY[i]) * (helper.m_InX[i] + helper.m_InY[i]) * r;
+			helper.m_OutY[i] = 2 * helper.m_InX[i] * helper.m_InY[i] * r;
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -242,6 +296,16 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		for (size_t i = 0; i < helper.m_Count; i++)
+		{
+			helper.m_OutX[i] = m_Weight * (helper.m_PrecalcAtanxy[i] * T(M_1_PI));
+			helper.m_OutY[i] = m_Weight * (helper.m_PrecalcSqrtSumSquares[i] - 1);
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -623,6 +687,24 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		size_t i;
+		T offset[ITER_BATCH_SIZE];
+
+		for (i = 0; i < helper.m_Count; i++)//Draw the random values first, in lane order, so the loop below has no calls into the random context.
+			offset[i] = rand.RandBit() ? T(M_PI) : T(0);
+
+		for (i = 0; i < helper.m_Count; i++)
+		{
+			T r = m_Weight * std::sqrt(helper.m_PrecalcSqrtSumSquares[i]);
+			T a = T(0.5) * helper.m_PrecalcAtanxy[i] + offset[i];
+			helper.m_OutX[i] = r * std::cos(a);
+			helper.m_OutY[i] = r * std::sin(a);
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -1533,6 +1615,18 @@ public:
 		helper.Out.z = m_Weight * (2 / denom - 1);
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		for (size_t i = 0; i < helper.m_Count; i++)
+		{
+			T denom = T(0.25) * helper.m_PrecalcSumSquares[i] + 1;
+			T r = m_Weight / denom;
+			helper.m_OutX[i] = r * helper.m_InX[i];
+			helper.m_OutY[i] = r * helper.m_InY[i];
+			helper.m_OutZ[i] = m_Weight * (2 / denom - 1);
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -1932,6 +2026,27 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		size_t i;
+		T tempr[ITER_BATCH_SIZE], r[ITER_BATCH_SIZE];
+
+		for (i = 0; i < helper.m_Count; i++)//Draw the random values first, in lane order, so the loop below has no calls into the random context.
+		{
+			tempr[i] = rand.Frand01<T>();
+			r[i] = rand.Frand01<T>();
+		}
+
+		for (i = 0; i < helper.m_Count; i++)
+		{
+			T a = tempr[i] * M_2PI;
+			T rad = m_Weight * r[i];
+			helper.m_OutX[i] = rad * std::cos(a);
+			helper.m_OutY[i] = rad * std::sin(a);
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -1971,6 +2086,27 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		size_t i;
+		T angle[ITER_BATCH_SIZE], r[ITER_BATCH_SIZE];
+
+		for (i = 0; i < helper.m_Count; i++)//Draw the random values first, in lane order, so the loop below has no calls into the random context.
+		{
+			angle[i] = rand.Frand01<T>();
+			r[i] = rand.Frand01<T>() + rand.Frand01<T>() + rand.Frand01<T>() + rand.Frand01<T>();
+		}
+
+		for (i = 0; i < helper.m_Count; i++)
+		{
+			T a = angle[i] * M_2PI;
+			T rad = m_Weight * (r[i] - 2);
+			helper.m_OutX[i] = rad * std::cos(a);
+			helper.m_OutY[i] = rad * std::sin(a);
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss;
@@ -2281,6 +2417,20 @@ public:
 		helper.Out.z = m_Weight * helper.In.z;
 	}
 
+	virtual void FuncBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand) override
+	{
+		for (size_t i = 0; i < helper.m_Count; i++)
+		{
+			T x = helper.m_InX[i], y = helper.m_InY[i];
+			T re = 1 + m_C1 * x + m_C2 * (SQR(x) - SQR(y));
+			T im = m_C1 * y + m_C22 * x * y;
+			T r = m_Weight / Zeps(SQR(re) + SQR(im));
+			helper.m_OutX[i] = (x * re + y * im) * r;
+			helper.m_OutY[i] = (y * re - x * im) * r;
+			helper.m_OutZ[i] = m_Weight * helper.m_InZ[i];
+		}
+	}
+
 	virtual string OpenCLString() const override
 	{
 		ostringstream ss, ss2;
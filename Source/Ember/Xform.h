@@ -15,6 +15,39 @@ namespace EmberNs
 /// </summary>
 template <typename T> class Ember;
 
+#define FUSED_MAX_VARS 3//The maximum number of regular variations an xform can have and still use a fused Apply().
+
+/// <summary>
+/// Bit flags for the precalcs needed by a fused Apply(), known at compile time.
+/// </summary>
+enum ePrecalcFlags : uint
+{
+	PRECALC_NONE = 0,
+	PRECALC_SUMSQ = 1,
+	PRECALC_SQRT = 2,
+	PRECALC_ANGLES = 4,
+	PRECALC_ATANXY = 8,
+	PRECALC_ATANYX = 16
+};
+
+/// <summary>
+/// The precalcs each variation supported in a fused Apply() needs, which must agree with the flags its constructor
+/// passes to Variation. This is verified at runtime before a fused Apply() is selected.
+/// Only variations specialized here can be used in a fused Apply().
+/// </summary>
+template <typename V> struct FusedVarPrecalcs;
+template <typename T> struct FusedVarPrecalcs<LinearVariation<T>>     { static const uint Flags = PRECALC_NONE; };
+template <typename T> struct FusedVarPrecalcs<SinusoidalVariation<T>> { static const uint Flags = PRECALC_NONE; };
+template <typename T> struct FusedVarPrecalcs<SphericalVariation<T>>  { static const uint Flags = PRECALC_SUMSQ; };
+template <typename T> struct FusedVarPrecalcs<JuliaVariation<T>>      { static const uint Flags = PRECALC_SUMSQ | PRECALC_SQRT | PRECALC_ATANXY; };
+
+/// <summary>
+/// The union of the precalcs needed by all variations in a fused Apply().
+/// </summary>
+template <typename... Vars> struct FusedPrecalcs;
+template <> struct FusedPrecalcs<> { static const uint Flags = PRECALC_NONE; };
+template <typename V, typename... Rest> struct FusedPrecalcs<V, Rest...> { static const uint Flags = FusedVarPrecalcs<V>::Flags | FusedPrecalcs<Rest...>::Flags; };
+
 /// <summary>
 /// If both polymorphism and templating are needed, uncomment this, fill it out and derive from it.
 /// </summary>
@@ -264,6 +297,7 @@ public:
 		m_NeedPrecalcAtanYX = false;
 		m_HasPost = false;
 		m_HasPreOrRegularVars = false;
+		m_ApplyFunc = &Xform<T>::ApplyGeneric;
 		m_ParentEmber = nullptr;
 		m_PreVariations.reserve(MAX_VARS_PER_XFORM);
 		m_Variations.reserve(MAX_VARS_PER_XFORM);
@@ -579,16 +613,31 @@ public:
 		});
 	}
 
+	/// <summary>
+	/// Applies this xform to the point passed in and saves the result in the out point.
+	/// This calls through the function pointer selected in SetApplyFunc(), which is either
+	/// a fused pipeline specialized for this xform's variations, or ApplyGeneric().
+	/// </summary>
+	/// <param name="inPoint">The initial point from the previous iteration</param>
+	/// <param name="outPoint">The output point</param>
+	/// <param name="rand">The random context to use</param>
+	/// <returns>True if a bad value was calculated, else false.</returns>
+	inline bool Apply(Point<T>* inPoint, Point<T>* outPoint, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand)
+	{
+		return (this->*m_ApplyFunc)(inPoint, outPoint, rand);
+	}
+
 	/// <summary>
 	/// Applies this xform to the point passed in and saves the result in the out point.
 	/// It's important to understand what happens here since it's the inner core of the algorithm.
 	/// See the internal comments for step by step details.
+	/// This handles every combination of variations and is used whenever a fused pipeline is not available.
 	/// </summary>
 	/// <param name="inPoint">The initial point from the previous iteration</param>
 	/// <param name="outPoint">The output point</param>
 	/// <param name="rand">The random context to use</param>
 	/// <returns>True if a bad value was calculated, else false.</returns>
-	bool Apply(Point<T>* inPoint, Point<T>* outPoint, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand)
+	bool ApplyGeneric(Point<T>* inPoint, Point<T>* outPoint, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand)
 	{
 		size_t i;
 		//This must be local, rather than a member, because this function can be called
@@ -686,6 +735,167 @@ public:
 		return BadVal(outPoint->m_X) || BadVal(outPoint->m_Y)/* || BadVal(outPoint->m_Z)*/;
 	}
 
+	/// <summary>
+	/// Fused version of ApplyGeneric() for an xform with only regular variations, whose types are known at compile time.
+	/// The variation functions are called directly rather than virtually so they can be inlined, and the checks for
+	/// pre and post variations, the post affine transform and the precalcs are all resolved at compile time.
+	/// Selected by SetApplyFunc().
+	/// </summary>
+	/// <param name="inPoint">The initial point from the previous iteration</param>
+	/// <param name="outPoint">The output point</param>
+	/// <param name="rand">The random context to use</param>
+	/// <returns>True if a bad value was calculated, else false.</returns>
+	template <bool HasPost, typename... Vars>
+	bool ApplyFused(Point<T>* inPoint, Point<T>* outPoint, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand)
+	{
+		size_t i = 0;
+		IteratorHelper<T> iterHelper;
+		outPoint->m_VizAdjusted = m_VizAdjusted;
+		iterHelper.m_Color.x = outPoint->m_ColorX = m_ColorSpeedCache + (m_OneMinusColorCache * inPoint->m_ColorX);
+		iterHelper.In.x = iterHelper.m_TransX = (m_Affine.A() * inPoint->m_X) + (m_Affine.B() * inPoint->m_Y) + m_Affine.C();
+		iterHelper.In.y = iterHelper.m_TransY = (m_Affine.D() * inPoint->m_X) + (m_Affine.E() * inPoint->m_Y) + m_Affine.F();
+		iterHelper.In.z = iterHelper.m_TransZ = inPoint->m_Z;
+		PrecalcFused<FusedPrecalcs<Vars...>::Flags>(iterHelper);
+		outPoint->m_X = outPoint->m_Y = outPoint->m_Z = 0;
+		int dummy[] = { 0, (ApplyFusedVar<Vars>(i++, iterHelper, outPoint, rand), 0)... };//Braced initializers are evaluated in order.
+		(void)dummy;
+
+		if (HasPost)
+		{
+			T postX = outPoint->m_X;
+			outPoint->m_X = (m_Post.A() * postX) + (m_Post.B() * outPoint->m_Y) + m_Post.C();
+			outPoint->m_Y = (m_Post.D() * postX) + (m_Post.E() * outPoint->m_Y) + m_Post.F();
+		}
+
+		outPoint->m_ColorX = iterHelper.m_Color.x + m_DirectColor * (outPoint->m_ColorX - iterHelper.m_Color.x);
+		return BadVal(outPoint->m_X) || BadVal(outPoint->m_Y);
+	}
+
+	/// <summary>
+	/// Batched version of Apply() which applies this xform to every valid lane of the passed in helper.
+	/// The input points are read from the m_X, m_Y, m_Z and m_ColorX arrays of the helper and the output points
+	/// are stored in m_Points, which the caller must have initialized to the input points.
+	/// The affine, precalc and color stages are simple loops over the lanes which the compiler can vectorize,
+	/// and each variation is called once for the whole batch via FuncBatch() instead of once per point.
+	/// </summary>
+	/// <param name="helper">The batch of points to apply this xform to</param>
+	/// <param name="rand">The random context to use</param>
+	/// <returns>The number of lanes whose output had bad values. Each is flagged in the m_Bad array of the helper.</returns>
+	size_t ApplyBatch(IteratorHelperBatch<T>& helper, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand)
+	{
+		size_t i, j, badCount = 0, count = helper.m_Count;
+		Point<T>* points = helper.m_Points;
+
+		for (j = 0; j < count; j++)
+		{
+			points[j].m_VizAdjusted = m_VizAdjusted;
+			helper.m_Color[j] = points[j].m_ColorX = m_ColorSpeedCache + (m_OneMinusColorCache * helper.m_ColorX[j]);
+		}
+
+		if (m_HasPreOrRegularVars)
+		{
+			T a = m_Affine.A(), b = m_Affine.B(), c = m_Affine.C();
+			T d = m_Affine.D(), e = m_Affine.E(), f = m_Affine.F();
+
+			for (j = 0; j < count; j++)
+			{
+				helper.m_TransX[j] = (a * helper.m_X[j]) + (b * helper.m_Y[j]) + c;
+				helper.m_TransY[j] = (d * helper.m_X[j]) + (e * helper.m_Y[j]) + f;
+				helper.m_TransZ[j] = helper.m_Z[j];
+			}
+
+			for (i = 0; i < PreVariationCount(); i++)
+			{
+				for (j = 0; j < count; j++)
+				{
+					helper.m_InX[j] = helper.m_TransX[j];
+					helper.m_InY[j] = helper.m_TransY[j];
+					helper.m_InZ[j] = helper.m_TransZ[j];
+				}
+
+				m_PreVariations[i]->PrecalcHelperBatch(helper);
+				m_PreVariations[i]->FuncBatch(helper, rand);
+				WritePreBatch(helper, m_PreVariations[i]->AssignType());
+			}
+
+			if (VariationCount() > 0)
+			{
+				PrecalcBatch(helper);
+
+				for (j = 0; j < count; j++)
+				{
+					helper.m_InX[j] = helper.m_TransX[j];
+					helper.m_InY[j] = helper.m_TransY[j];
+					helper.m_InZ[j] = helper.m_TransZ[j];
+					points[j].m_X = points[j].m_Y = points[j].m_Z = 0;
+				}
+
+				for (i = 0; i < VariationCount(); i++)
+				{
+					m_Variations[i]->FuncBatch(helper, rand);
+
+					for (j = 0; j < count; j++)
+					{
+						points[j].m_X += helper.m_OutX[j];
+						points[j].m_Y += helper.m_OutY[j];
+						points[j].m_Z += helper.m_OutZ[j];
+					}
+				}
+			}
+			else
+			{
+				for (j = 0; j < count; j++)
+				{
+					points[j].m_X = helper.m_TransX[j];
+					points[j].m_Y = helper.m_TransY[j];
+					points[j].m_Z = helper.m_TransZ[j];
+				}
+			}
+		}
+		else
+		{
+			for (j = 0; j < count; j++)
+			{
+				points[j].m_X = (m_Affine.A() * helper.m_X[j]) + (m_Affine.B() * helper.m_Y[j]) + m_Affine.C();
+				points[j].m_Y = (m_Affine.D() * helper.m_X[j]) + (m_Affine.E() * helper.m_Y[j]) + m_Affine.F();
+				points[j].m_Z = helper.m_Z[j];
+			}
+		}
+
+		for (i = 0; i < PostVariationCount(); i++)
+		{
+			for (j = 0; j < count; j++)
+			{
+				helper.m_InX[j] = points[j].m_X;
+				helper.m_InY[j] = points[j].m_Y;
+				helper.m_InZ[j] = points[j].m_Z;
+			}
+
+			m_PostVariations[i]->PrecalcHelperBatch(helper);
+			m_PostVariations[i]->FuncBatch(helper, rand);
+			WritePostBatch(helper, m_PostVariations[i]->AssignType());
+		}
+
+		if (m_HasPost)
+		{
+			for (j = 0; j < count; j++)
+			{
+				T postX = points[j].m_X;
+				points[j].m_X = (m_Post.A() * postX) + (m_Post.B() * points[j].m_Y) + m_Post.C();
+				points[j].m_Y = (m_Post.D() * postX) + (m_Post.E() * points[j].m_Y) + m_Post.F();
+			}
+		}
+
+		for (j = 0; j < count; j++)
+		{
+			points[j].m_ColorX = helper.m_Color[j] + m_DirectColor * (points[j].m_ColorX - helper.m_Color[j]);
+			helper.m_Bad[j] = BadVal(points[j].m_X) || BadVal(points[j].m_Y);
+			badCount += helper.m_Bad[j];
+		}
+
+		return badCount;
+	}
+
 //Why are we not using template with member var addr as arg here?//TODO
 #define APPMOT(x) \
 	do \
@@ -783,6 +993,7 @@ public:
 	inline bool NeedPrecalcAtanYX()         const { return m_NeedPrecalcAtanYX; }
 	inline bool NeedAnyPrecalc()            const { return NeedPrecalcSumSquares() || NeedPrecalcSqrtSumSquares() || NeedPrecalcAngles() || NeedPrecalcAtanXY() || NeedPrecalcAtanYX(); }
 	bool HasPost() const { return m_HasPost; }
+	bool Fused() const { return m_ApplyFunc != &Xform<T>::ApplyGeneric; }//Whether Apply() calls a fused pipeline rather than ApplyGeneric().
 	size_t PreVariationCount()   const { return m_PreVariations.size(); }
 	size_t VariationCount()      const { return m_Variations.size(); }
 	size_t PostVariationCount()  const { return m_PostVariations.size(); }
@@ -839,6 +1050,27 @@ public:
 				var->Precalc();
 			}
 		});
+		SetApplyFunc();
+	}
+
+	/// <summary>
+	/// Set the function pointer called by Apply().
+	/// If this xform has between 1 and FUSED_MAX_VARS regular variations, no pre or post variations, and every
+	/// regular variation is one which has a FusedVarPrecalcs specialization, a fused pipeline instantiated for
+	/// exactly those variations in that order is used. Otherwise, ApplyGeneric() is used.
+	/// Called by SetPrecalcFlags() so that it's always up to date with the variations present.
+	/// </summary>
+	void SetApplyFunc()
+	{
+		m_ApplyFunc = &Xform<T>::ApplyGeneric;
+
+		if (PreVariationCount() == 0 && PostVariationCount() == 0 && VariationCount() > 0 && VariationCount() <= FUSED_MAX_VARS)
+		{
+			ApplyFuncPtr func = m_HasPost ? SelectFused<true>(0, std::true_type()) : SelectFused<false>(0, std::true_type());
+
+			if (func)
+				m_ApplyFunc = func;
+		}
 	}
 
 	/// <summary>
@@ -870,6 +1102,70 @@ public:
 			helper.m_PrecalcAtanyx = atan2(helper.m_TransY, helper.m_TransX);
 	}
 
+	/// <summary>
+	/// Compile time version of Precalc() used by ApplyFused().
+	/// </summary>
+	/// <param name="helper">The helper to store the precalculated values in</param>
+	template <uint Flags>
+	inline void PrecalcFused(IteratorHelper<T>& helper)
+	{
+		if (Flags & PRECALC_SUMSQ)
+			helper.m_PrecalcSumSquares = SQR(helper.m_TransX) + SQR(helper.m_TransY);
+
+		if (Flags & PRECALC_SQRT)
+			helper.m_PrecalcSqrtSumSquares = std::sqrt(helper.m_PrecalcSumSquares);
+
+		if (Flags & PRECALC_ANGLES)
+		{
+			helper.m_PrecalcSina = helper.m_TransX / Zeps(helper.m_PrecalcSqrtSumSquares);
+			helper.m_PrecalcCosa = helper.m_TransY / Zeps(helper.m_PrecalcSqrtSumSquares);
+		}
+
+		if (Flags & PRECALC_ATANXY)
+			helper.m_PrecalcAtanxy = atan2(helper.m_TransX, helper.m_TransY);
+
+		if (Flags & PRECALC_ATANYX)
+			helper.m_PrecalcAtanyx = atan2(helper.m_TransY, helper.m_TransX);
+	}
+
+	/// <summary>
+	/// Batched version of Precalc() which performs the same precalculations on every valid lane of the helper.
+	/// </summary>
+	/// <param name="helper">The batch helper to store the precalculated values in</param>
+	void PrecalcBatch(IteratorHelperBatch<T>& helper)
+	{
+		size_t i, count = helper.m_Count;
+
+		if (m_NeedPrecalcSumSquares)
+		{
+			for (i = 0; i < count; i++)
+				helper.m_PrecalcSumSquares[i] = SQR(helper.m_TransX[i]) + SQR(helper.m_TransY[i]);
+
+			if (m_NeedPrecalcSqrtSumSquares)
+			{
+				for (i = 0; i < count; i++)
+					helper.m_PrecalcSqrtSumSquares[i] = std::sqrt(helper.m_PrecalcSumSquares[i]);
+
+				if (m_NeedPrecalcAngles)
+				{
+					for (i = 0; i < count; i++)
+					{
+						helper.m_PrecalcSina[i] = helper.m_TransX[i] / Zeps(helper.m_PrecalcSqrtSumSquares[i]);
+						helper.m_PrecalcCosa[i] = helper.m_TransY[i] / Zeps(helper.m_PrecalcSqrtSumSquares[i]);
+					}
+				}
+			}
+		}
+
+		if (m_NeedPrecalcAtanXY)
+			for (i = 0; i < count; i++)
+				helper.m_PrecalcAtanxy[i] = atan2(helper.m_TransX[i], helper.m_TransY[i]);
+
+		if (m_NeedPrecalcAtanYX)
+			for (i = 0; i < count; i++)
+				helper.m_PrecalcAtanyx[i] = atan2(helper.m_TransY[i], helper.m_TransX[i]);
+	}
+
 	/// <summary>
 	/// Flatten this xform by adding a flatten variation if none is present, and if none of the
 	/// variations or parameters in the vector are present.
@@ -1019,6 +1315,65 @@ public:
 		}
 	}
 
+	/// <summary>
+	/// Batched version of WritePre().
+	/// </summary>
+	/// <param name="helper">The batch helper to store the output values in</param>
+	/// <param name="assignType">The type of assignment this variation uses, assign or sum.</param>
+	inline void WritePreBatch(IteratorHelperBatch<T>& helper, eVariationAssignType assignType)
+	{
+		size_t i, count = helper.m_Count;
+
+		if (assignType == ASSIGNTYPE_SET)
+		{
+			for (i = 0; i < count; i++)
+			{
+				helper.m_TransX[i] = helper.m_OutX[i];
+				helper.m_TransY[i] = helper.m_OutY[i];
+				helper.m_TransZ[i] = helper.m_OutZ[i];
+			}
+		}
+		else
+		{
+			for (i = 0; i < count; i++)
+			{
+				helper.m_TransX[i] += helper.m_OutX[i];
+				helper.m_TransY[i] += helper.m_OutY[i];
+				helper.m_TransZ[i] += helper.m_OutZ[i];
+			}
+		}
+	}
+
+	/// <summary>
+	/// Batched version of WritePost().
+	/// </summary>
+	/// <param name="helper">The batch helper whose output points will store the output values</param>
+	/// <param name="assignType">The type of assignment this variation uses, assign or sum.</param>
+	inline void WritePostBatch(IteratorHelperBatch<T>& helper, eVariationAssignType assignType)
+	{
+		size_t i, count = helper.m_Count;
+		Point<T>* points = helper.m_Points;
+
+		if (assignType == ASSIGNTYPE_SET)
+		{
+			for (i = 0; i < count; i++)
+			{
+				points[i].m_X = helper.m_OutX[i];
+				points[i].m_Y = helper.m_OutY[i];
+				points[i].m_Z = helper.m_OutZ[i];
+			}
+		}
+		else
+		{
+			for (i = 0; i < count; i++)
+			{
+				points[i].m_X += helper.m_OutX[i];
+				points[i].m_Y += helper.m_OutY[i];
+				points[i].m_Z += helper.m_OutZ[i];
+			}
+		}
+	}
+
 	/// <summary>
 	/// Generate the OpenCL string for writing output values from a call to a variation.
 	/// </summary>
@@ -1099,6 +1454,69 @@ public:
 		return s;
 	}
 
+	/// <summary>
+	/// Continue a content hash with everything in this xform which affects where points land:
+	/// the weight, both affines, all variations and their parameters, the xaos values and motion elements.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	uint64_t GeometryHash(uint64_t hash = HASH_SEED) const
+	{
+		hash = HashVal(m_Weight, hash);
+		hash = m_Affine.Hash(hash);
+		hash = m_Post.Hash(hash);
+
+		//Include the count of each list so a variation moving between them changes the hash.
+		for (auto vars : { &m_PreVariations, &m_Variations, &m_PostVariations })
+		{
+			hash = HashVal(vars->size(), hash);
+
+			for (auto var : *vars)
+				hash = var->Hash(hash);
+		}
+
+		hash = HashVal(m_Xaos.size(), hash);
+
+		for (auto xaos : m_Xaos)
+			hash = HashVal(xaos, hash);
+
+		hash = HashVal(m_Animate, hash);
+		hash = HashVal(m_MotionFunc, hash);
+		hash = HashVal(m_MotionFreq, hash);
+		hash = HashVal(m_MotionOffset, hash);
+		hash = HashVal(m_Motion.size(), hash);
+
+		for (auto& motion : m_Motion)
+			hash = motion.Hash(hash);
+
+		return hash;
+	}
+
+	/// <summary>
+	/// Continue a content hash with everything in this xform which affects the color of the points it produces.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	uint64_t ColorHash(uint64_t hash = HASH_SEED) const
+	{
+		hash = HashVal(m_ColorX, hash);
+		hash = HashVal(m_ColorY, hash);
+		hash = HashVal(m_ColorSpeed, hash);
+		hash = HashVal(m_Opacity, hash);
+		return HashVal(m_DirectColor, hash);
+	}
+
+	/// <summary>
+	/// Continue a content hash with everything in this xform which affects rendering.
+	/// The name is not included.
+	/// </summary>
+	/// <param name="hash">The hash of any preceding values to continue from. Default: HASH_SEED.</param>
+	/// <returns>The hash</returns>
+	uint64_t Hash(uint64_t hash = HASH_SEED) const
+	{
+		return ColorHash(GeometryHash(hash));
+	}
+
 	/// <summary>
 	/// Return a string representation of this xform.
 	/// It will include all pre affine values, and optionally post affine values if present.
@@ -1156,6 +1574,90 @@ public:
 		return ss.str();
 	}
 
+private:
+	typedef bool (Xform<T>::*ApplyFuncPtr)(Point<T>*, Point<T>*, QTIsaac<ISAAC_SIZE, ISAAC_INT>&);
+
+	/// <summary>
+	/// Call a single variation in ApplyFused() and add its output to the output point.
+	/// The qualified call bypasses virtual dispatch.
+	/// </summary>
+	/// <param name="i">The index of the variation in m_Variations</param>
+	/// <param name="helper">The helper holding the translated and precalculated values</param>
+	/// <param name="outPoint">The output point to sum into</param>
+	/// <param name="rand">The random context to use</param>
+	template <typename V>
+	inline void ApplyFusedVar(size_t i, IteratorHelper<T>& helper, Point<T>* outPoint, QTIsaac<ISAAC_SIZE, ISAAC_INT>& rand)
+	{
+		static_cast<V*>(m_Variations[i])->V::Func(helper, *outPoint, rand);
+		outPoint->m_X += helper.Out.x;
+		outPoint->m_Y += helper.Out.y;
+		outPoint->m_Z += helper.Out.z;
+	}
+
+	/// <summary>
+	/// Recursively look up the fused pipeline for the regular variations starting at index i,
+	/// given the types of the variations before it. This overload is used once FUSED_MAX_VARS types have been collected.
+	/// </summary>
+	/// <param name="i">The index of the next variation to examine</param>
+	/// <returns>The fused function if all variations were matched, else nullptr.</returns>
+	template <bool HasPost, typename... Vars>
+	ApplyFuncPtr SelectFused(size_t i, std::false_type)
+	{
+		return i == VariationCount() ? &Xform<T>::template ApplyFused<HasPost, Vars...> : nullptr;
+	}
+
+	/// <summary>
+	/// Recursively look up the fused pipeline for the regular variations starting at index i,
+	/// given the types of the variations before it.
+	/// A variation is only matched if its precalc flags agree with its FusedVarPrecalcs specialization.
+	/// </summary>
+	/// <param name="i">The index of the next variation to examine</param>
+	/// <returns>The fused function if all variations were matched, else nullptr.</returns>
+	template <bool HasPost, typename... Vars>
+	ApplyFuncPtr SelectFused(size_t i, std::true_type)
+	{
+		typedef std::integral_constant<bool, (sizeof...(Vars) + 1 < FUSED_MAX_VARS)> more;
+
+		if (i == VariationCount())
+			return &Xform<T>::template ApplyFused<HasPost, Vars...>;
+
+		switch (m_Variations[i]->VariationId())
+		{
+			case VAR_LINEAR:
+				return FusedVarMatches<LinearVariation<T>>(i) ? SelectFused<HasPost, Vars..., LinearVariation<T>>(i + 1, more()) : nullptr;
+
+			case VAR_SINUSOIDAL:
+				return FusedVarMatches<SinusoidalVariation<T>>(i) ? SelectFused<HasPost, Vars..., SinusoidalVariation<T>>(i + 1, more()) : nullptr;
+
+			case VAR_SPHERICAL:
+				return FusedVarMatches<SphericalVariation<T>>(i) ? SelectFused<HasPost, Vars..., SphericalVariation<T>>(i + 1, more()) : nullptr;
+
+			case VAR_JULIA:
+				return FusedVarMatches<JuliaVariation<T>>(i) ? SelectFused<HasPost, Vars..., JuliaVariation<T>>(i + 1, more()) : nullptr;
+
+			default:
+				return nullptr;
+		}
+	}
+
+	/// <summary>
+	/// Determine whether the precalc flags of the regular variation at index i match
+	/// the ones ApplyFused() will compute for it.
+	/// </summary>
+	/// <param name="i">The index of the variation in m_Variations</param>
+	/// <returns>True if they match, else false.</returns>
+	template <typename V>
+	bool FusedVarMatches(size_t i) const
+	{
+		const Variation<T>* var = m_Variations[i];
+		uint flags = (var->NeedPrecalcSumSquares() ? PRECALC_SUMSQ : 0) |
+					 (var->NeedPrecalcSqrtSumSquares() ? PRECALC_SQRT : 0) |
+					 (var->NeedPrecalcAngles() ? PRECALC_ANGLES : 0) |
+					 (var->NeedPrecalcAtanXY() ? PRECALC_ATANXY : 0) |
+					 (var->NeedPrecalcAtanYX() ? PRECALC_ATANYX : 0);
+		return flags == FusedVarPrecalcs<V>::Flags;
+	}
+
 	/// <summary>
 	/// Members are listed in the exact order they are used in Apply() to make them
 	/// as cache efficient as possible. Not all are public, so there is repeated public/private
@@ -1163,6 +1665,7 @@ public:
 	/// </summary>
 
 private:
+	ApplyFuncPtr m_ApplyFunc;//The function called by Apply(), set in SetApplyFunc().
 	bool m_HasPreOrRegularVars;//Whethere there are any pre or regular variations present.
 	T m_VizAdjusted;//Adjusted visibility for better transitions.
 
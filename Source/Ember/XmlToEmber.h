@@ -262,77 +262,20 @@ public:
 	/// <returns>True if there were no errors, else false.</returns>
 	bool Parse(byte* buf, const char* filename, vector<Ember<T>>& embers, bool useDefaults = true)
 	{
-		char* bn;
-		const char* xmlPtr;
 		const char* loc = __FUNCTION__;
-		size_t emberSize;
-		size_t bufSize;
-		xmlDocPtr doc;//Parsed XML document tree.
-		xmlNodePtr rootnode;
-		Locale locale;//Sets and restores on exit.
-		//Timing t;
-		ClearErrorReport();
-		//Parse XML string into internal document.
-		xmlPtr = CX(&buf[0]);
-		bufSize = strlen(xmlPtr);
+		const char* xmlPtr = CX(&buf[0]);
+		size_t bufSize = strlen(xmlPtr);
 		embers.reserve(bufSize / 2500);//The Xml text for an ember is around 2500 bytes, but can be much more. Pre-allocate to aovid unnecessary resizing.
-		doc = xmlReadMemory(xmlPtr, int(bufSize), filename, "ISO-8859-1", XML_PARSE_NONET);//Forbid network access during read.
-		//t.Toc("xmlReadMemory");
+		xmlTextReaderPtr reader = xmlReaderForMemory(xmlPtr, int(bufSize), filename, "ISO-8859-1", XML_PARSE_NONET);//Forbid network access during read.
 
-		if (doc == nullptr)
+		if (reader == nullptr)
 		{
+			ClearErrorReport();
 			AddToReport(string(loc) + " : Error parsing xml file " + string(filename));
 			return false;
 		}
 
-		//What is the root node of the document?
-		rootnode = xmlDocGetRootElement(doc);
-		//Scan for <flame> nodes, starting with this node.
-		//t.Tic();
-		bn = basename(const_cast<char*>(filename));
-		ScanForEmberNodes(rootnode, bn, embers, useDefaults);
-		xmlFreeDoc(doc);
-		emberSize = embers.size();
-		//t.Toc("ScanForEmberNodes");
-
-		//Check to see if the first control point or the second-to-last
-		//control point has interpolation="smooth".  This is invalid
-		//and should be reset to linear (with a warning).
-		if (emberSize > 0)
-		{
-			if (embers[0].m_Interp == eInterp::EMBER_INTERP_SMOOTH)
-			{
-				cout << "Warning: smooth interpolation cannot be used for first segment.\n         switching to linear.\n" << endl;
-				embers[0].m_Interp = eInterp::EMBER_INTERP_LINEAR;
-			}
-
-			if (emberSize >= 2 && embers[emberSize - 2].m_Interp == eInterp::EMBER_INTERP_SMOOTH)
-			{
-				cout << "Warning: smooth interpolation cannot be used for last segment.\n         switching to linear.\n" << endl;
-				embers[emberSize - 2].m_Interp = eInterp::EMBER_INTERP_LINEAR;
-			}
-		}
-
-		//Finally, ensure that consecutive 'rotate' parameters never exceed
-		//a difference of more than 180 degrees (+/-) for interpolation.
-		//An adjustment of +/- 360 degrees is made until this is true.
-		if (emberSize > 1)
-		{
-			for (size_t i = 1; i < emberSize; i++)
-			{
-				//Only do this adjustment if not in compat mode.
-				if (embers[i - 1].m_AffineInterp != eAffineInterp::AFFINE_INTERP_COMPAT && embers[i - 1].m_AffineInterp != eAffineInterp::AFFINE_INTERP_OLDER)
-				{
-					while (embers[i].m_Rotate < embers[i - 1].m_Rotate - 180)
-						embers[i].m_Rotate += 360;
-
-					while (embers[i].m_Rotate > embers[i - 1].m_Rotate + 180)
-						embers[i].m_Rotate -= 360;
-				}
-			}
-		}
-
-		return true;
+		return ParseReader(reader, filename, [&](Ember<T>& ember) { embers.push_back(ember); return true; }, useDefaults);
 	}
 
 	/// <summary>
@@ -345,8 +288,28 @@ public:
 	/// <returns>True if there were no errors, else false.</returns>
 	bool Parse(const char* filename, vector<Ember<T>>& embers, bool useDefaults = true)
 	{
+		return Parse(filename, [&](Ember<T>& ember) { embers.push_back(ember); return true; }, useDefaults);
+	}
+
+	/// <summary>
+	/// Parse the specified file, passing each ember to the callback as soon as it has been parsed.
+	/// The file is streamed in small blocks and only the Xml of the ember currently being parsed is held in memory,
+	/// so very large files of many embers can be processed in constant memory and work can start on the first
+	/// embers before the rest of the file is read.
+	/// The fixups which depend on neighboring embers are applied before they reach the callback, which means the
+	/// last two embers are held back until the end of the file is reached.
+	/// This will strip out ampersands because the Xml parser can't handle them.
+	/// </summary>
+	/// <param name="filename">Full path and filename</param>
+	/// <param name="callback">Function called with each ember, in file order. Return false from it to stop parsing.</param>
+	/// <param name="useDefaults">True to use defaults if they are not present in the file, else false to use invalid values as placeholders to indicate the values were not present. Default: true.</param>
+	/// <returns>True if there were no errors, else false.</returns>
+	bool Parse(const char* filename, std::function<bool(Ember<T>& ember)> callback, bool useDefaults = true)
+	{
+		bool b = false;
 		const char* loc = __FUNCTION__;
-		string buf;
+		FILE* f = nullptr;
+		ClearErrorReport();
 
 		//Ensure palette list is setup first.
 		if (!m_PaletteList.Size())
@@ -355,13 +318,21 @@ public:
 			return false;
 		}
 
-		if (ReadFile(filename, buf))
+		fopen_s(&f, filename, "rb");
+
+		if (f == nullptr)
 		{
-			std::replace(buf.begin(), buf.end(), '&', '+');
-			return Parse(reinterpret_cast<byte*>(const_cast<char*>(buf.data())), filename, embers, useDefaults);
+			AddToReport(string(loc) + " : Error opening file " + string(filename));
+			return false;
 		}
+
+		if (xmlTextReaderPtr reader = xmlReaderForIO(ReadStream, nullptr, f, filename, "ISO-8859-1", XML_PARSE_NONET))//Forbid network access during read.
+			b = ParseReader(reader, filename, callback, useDefaults);
 		else
-			return false;
+			AddToReport(string(loc) + " : Error parsing xml file " + string(filename));
+
+		fclose(f);
+		return b;
 	}
 
 	/// <summary>
@@ -429,39 +400,63 @@ public:
 
 private:
 	/// <summary>
-	/// Scan the file for ember nodes, and parse them out into the vector of embers.
+	/// Read block callback for streaming a file into the Xml reader, replacing ampersands
+	/// because the Xml parser can't handle them.
 	/// </summary>
-	/// <param name="curNode">The current node to parse</param>
-	/// <param name="parentFile">The full path and filename</param>
-	/// <param name="embers">The newly constructed embers based on what was parsed</param>
+	/// <param name="context">The FILE* to read from</param>
+	/// <param name="buffer">The buffer to read into</param>
+	/// <param name="len">The maximum number of bytes to read</param>
+	/// <returns>The number of bytes read, 0 at the end of the file, or -1 on error.</returns>
+	static int ReadStream(void* context, char* buffer, int len)
+	{
+		FILE* f = static_cast<FILE*>(context);
+		size_t bytesRead = fread(buffer, 1, size_t(len), f);
+
+		if (bytesRead == 0 && ferror(f))
+			return -1;
+
+		std::replace(buffer, buffer + bytesRead, '&', '+');
+		return int(bytesRead);
+	}
+
+	/// <summary>
+	/// Stream through the Xml with the reader, parsing each ember node and passing it to the callback.
+	/// Only the subtree of the current ember node is expanded into memory, and it is freed when moving on to the next.
+	/// The reader is freed when finished.
+	/// </summary>
+	/// <param name="reader">The reader to parse with</param>
+	/// <param name="filename">Full path and filename, optionally empty</param>
+	/// <param name="callback">Function called with each ember, in document order. Return false from it to stop parsing.</param>
 	/// <param name="useDefaults">True to use defaults if they are not present in the file, else false to use invalid values as placeholders to indicate the values were not present.</param>
-	void ScanForEmberNodes(xmlNode* curNode, char* parentFile, vector<Ember<T>>& embers, bool useDefaults)
+	/// <returns>True if the Xml was read without errors, else false.</returns>
+	bool ParseReader(xmlTextReaderPtr reader, const char* filename, std::function<bool(Ember<T>& ember)> callback, bool useDefaults)
 	{
-		bool parseEmberSuccess;
-		xmlNodePtr thisNode = nullptr;
+		int ret;
+		bool keepGoing = true;
+		size_t index = 0;
 		const char* loc = __FUNCTION__;
-		string parentFileString = string(parentFile);
+		string parentFileString = string(basename(const_cast<char*>(filename)));
+		deque<Ember<T>> pending;//Fixups need the previous ember, and the second to last one can't be known until the end, so hold back two.
+		Locale locale;//Sets and restores on exit.
+		ClearErrorReport();
+		ret = xmlTextReaderRead(reader);
 
-		//Original memset to 0, but the constructors should handle that.
-		//Loop over this level of elements.
-		for (thisNode = curNode; thisNode; thisNode = thisNode->next)
+		while (ret == 1 && keepGoing)
 		{
-			//Check to see if this element is a <ember> element.
-			if (thisNode->type == XML_ELEMENT_NODE && !Compare(thisNode->name, "flame"))
+			//Check to see if this element is a <ember> element, skipping its children once parsed.
+			if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT && !Compare(xmlTextReaderConstName(reader), "flame"))
 			{
 				Ember<T> currentEmber;//Place this inside here so its constructor is called each time.
+				xmlNodePtr emberNode = xmlTextReaderExpand(reader);
 
 				//Useful for parsing templates when not every member should be set.
 				if (!useDefaults)
 					currentEmber.Clear(false);
 
-				parseEmberSuccess = ParseEmberElement(thisNode, currentEmber);
-
-				if (!parseEmberSuccess)
+				if (emberNode == nullptr || !ParseEmberElement(emberNode, currentEmber))
 				{
-					//Original leaked memory here, ours doesn't.
 					AddToReport(string(loc) + " : Error parsing ember element");
-					return;
+					break;
 				}
 
 				if (currentEmber.PaletteIndex() != -1)
@@ -472,19 +467,70 @@ private:
 						AddToReport(string(loc) + " : Error assigning palette with index " + Itos(currentEmber.PaletteIndex()));
 				}
 
-				//if (!Interpolater<T>::InterpMissingColors(currentEmber.m_Palette.m_Entries))
-				//	AddToReport(string(loc) + " : Error interpolating missing palette colors");
 				currentEmber.CacheXforms();
-				currentEmber.m_Index = embers.size();
+				currentEmber.m_Index = index;
 				currentEmber.m_ParentFilename = parentFileString;
-				embers.push_back(currentEmber);
+
+				//Check to see if the first control point has interpolation="smooth".
+				//This is invalid and should be reset to linear (with a warning).
+				if (index == 0 && currentEmber.m_Interp == eInterp::EMBER_INTERP_SMOOTH)
+				{
+					cout << "Warning: smooth interpolation cannot be used for first segment.\n         switching to linear.\n" << endl;
+					currentEmber.m_Interp = eInterp::EMBER_INTERP_LINEAR;
+				}
+
+				//Ensure that consecutive 'rotate' parameters never exceed
+				//a difference of more than 180 degrees (+/-) for interpolation.
+				//An adjustment of +/- 360 degrees is made until this is true.
+				//Only do this adjustment if not in compat mode.
+				if (!pending.empty())
+				{
+					auto& prev = pending.back();
+
+					if (prev.m_AffineInterp != eAffineInterp::AFFINE_INTERP_COMPAT && prev.m_AffineInterp != eAffineInterp::AFFINE_INTERP_OLDER)
+					{
+						while (currentEmber.m_Rotate < prev.m_Rotate - 180)
+							currentEmber.m_Rotate += 360;
+
+						while (currentEmber.m_Rotate > prev.m_Rotate + 180)
+							currentEmber.m_Rotate -= 360;
+					}
+				}
+
+				index++;
+				pending.push_back(currentEmber);
+
+				if (pending.size() > 2)
+				{
+					keepGoing = callback(pending.front());
+					pending.pop_front();
+				}
+
+				ret = xmlTextReaderNext(reader);
 			}
 			else
-			{
-				//Check all of the children of this element.
-				ScanForEmberNodes(thisNode->children, parentFile, embers, useDefaults);
-			}
+				ret = xmlTextReaderRead(reader);
+		}
+
+		xmlFreeTextReader(reader);
+
+		if (ret < 0)
+			AddToReport(string(loc) + " : Error parsing xml file " + string(filename));
+
+		//The second-to-last control point can't have interpolation="smooth" either.
+		if (keepGoing && pending.size() == 2 && pending.front().m_Interp == eInterp::EMBER_INTERP_SMOOTH)
+		{
+			cout << "Warning: smooth interpolation cannot be used for last segment.\n         switching to linear.\n" << endl;
+			pending.front().m_Interp = eInterp::EMBER_INTERP_LINEAR;
+		}
+
+		while (keepGoing && !pending.empty())
+		{
+			keepGoing = callback(pending.front());
+			pending.pop_front();
 		}
+
+		return ret >= 0;
 	}
 
 	/// <summary>
@@ -1292,24 +1338,25 @@ private:
 		}
 
 		//Now that all xforms have been parsed, go through and try to find params for the parametric variations.
-		for (size_t i = 0; i < xform.TotalVariationCount(); i++)
+		//Look up which variation each attribute is a param of, rather than searching every parametric variation for every attribute.
+		if (xform.TotalVariationCount())
 		{
-			if (ParametricVariation<T>* parVar = dynamic_cast<ParametricVariation<T>*>(xform.GetVariation(i)))
+			for (curAtt = attPtr; curAtt; curAtt = curAtt->next)
 			{
-				for (curAtt = attPtr; curAtt; curAtt = curAtt->next)
-				{
-					//Only correct names if it came from an outside source. Names originating from this library are always considered correct.
-					string s = fromEmber ? string(CCX(curAtt->name)) : GetCorrectedParamName(m_BadParamNames, CCX(curAtt->name));
-					const char* name = s.c_str();
+				size_t paramIndex = 0;
+				//Only correct names if it came from an outside source. Names originating from this library are always considered correct.
+				string s = fromEmber ? string(CCX(curAtt->name)) : GetCorrectedParamName(m_BadParamNames, CCX(curAtt->name));
 
-					if (parVar->ContainsParam(name))
+				if (auto var = m_VariationList.GetParametricVariationByParam(s, paramIndex))
+				{
+					if (ParametricVariation<T>* parVar = dynamic_cast<ParametricVariation<T>*>(xform.GetVariationById(var->VariationId())))
 					{
 						T val = 0;
 						attStr = CX(xmlGetProp(childNode, curAtt->name));
 
 						if (Aton(attStr, val))
 						{
-							parVar->SetParamVal(name, val);
+							parVar->SetParamVal(s.c_str(), val);//By name, so overrides which normalize the value are called.
 						}
 						else
 						{
@@ -288,12 +288,17 @@ bool EmberAnimate(EmberOptions& opt)
 	//Final setup steps before running.
 	padding = uint(std::log10(double(embers.size()))) + 1;
 
+	if ((opt.Checkpoint() > 0 || opt.Resume()) && opt.EmberCL())
+		cout << "Checkpoints are only supported by the CPU renderer, disabling." << endl;
+
 	for (auto& r : renderers)
 	{
 		r->SetEmber(embers);
 		r->EarlyClip(opt.EarlyClip());
 		r->YAxisUp(opt.YAxisUp());
 		r->LockAccum(opt.LockAccum());
+		r->PrivateHist(opt.PrivateHist());
+		r->TiledDE(opt.TiledDE());
 		r->InsertPalette(opt.InsertPalette());
 		r->PixelAspectRatio(T(opt.AspectRatio()));
 		r->Transparency(opt.Transparency());
@@ -331,12 +336,14 @@ bool EmberAnimate(EmberOptions& opt)
 	std::function<void(size_t)> iterFunc = [&](size_t index)
 	{
 		size_t ftime, finalImageIndex = 0;
-		string filename, flameName;
+		string filename, flameName, checkpointFilename;
 		RendererBase* renderer = renderers[index].get();
+		bool checkpoint = (opt.Checkpoint() > 0 || opt.Resume()) && renderer->RendererType() == CPU_RENDERER;
 		ostringstream fnstream, os;
 		EmberStats stats;
 		EmberImageComments comments;
 		Ember<T> centerEmber;
+		Interpolater<T> interpolater;//Reuses the aligned embers and the xforms of centerEmber between frames.
 		vector<byte> finalImages[2];
 		std::thread writeThread;
 		os.imbue(std::locale(""));
@@ -352,9 +359,30 @@ bool EmberAnimate(EmberOptions& opt)
 				verboseCs.Leave();
 			}
 
+			fnstream << inputPath << opt.Prefix() << setfill('0') << setw(padding) << ftime << opt.Suffix() << "." << opt.Format();
+			filename = fnstream.str();
+			fnstream.str("");
+			checkpointFilename = filename + ".checkpoint";
+
+			//When resuming, frames which were written by a previous process and have no checkpoint left over were finished.
+			if (opt.Resume() && ifstream(filename).good() && !ifstream(checkpointFilename).good())
+			{
+				if (opt.Verbose())
+				{
+					verboseCs.Enter();
+					cout << "Skipping finished frame " << filename << endl;
+					verboseCs.Leave();
+				}
+
+				continue;
+			}
+
 			renderer->Reset();
+			auto status = checkpoint ?
+						  CheckpointRun(renderer, finalImages[finalImageIndex], localTime, opt.Checkpoint(), opt.Resume(), checkpointFilename) :
+						  renderer->Run(finalImages[finalImageIndex], localTime);
 
-			if ((renderer->Run(finalImages[finalImageIndex], localTime) != eRenderStatus::RENDER_OK) || renderer->Aborted() || finalImages[finalImageIndex].empty())
+			if ((status != eRenderStatus::RENDER_OK) || renderer->Aborted() || finalImages[finalImageIndex].empty())
 			{
 				cout << "Error: image rendering failed, skipping to next image." << endl;
 				renderer->DumpErrorReport();//Something went wrong, print errors.
@@ -362,10 +390,6 @@ bool EmberAnimate(EmberOptions& opt)
 				break;
 			}
 
-			fnstream << inputPath << opt.Prefix() << setfill('0') << setw(padding) << ftime << opt.Suffix() << "." << opt.Format();
-			filename = fnstream.str();
-			fnstream.str("");
-
 			if (opt.WriteGenome())
 			{
 				flameName = filename.substr(0, filename.find_last_of('.')) + ".flam3";
@@ -377,9 +401,8 @@ bool EmberAnimate(EmberOptions& opt)
 					verboseCs.Leave();
 				}
 
-				Interpolater<T>::Interpolate(embers, localTime, 0, centerEmber);//Get center flame.
+				interpolater.InterpolateInPlace(embers, localTime, 0, centerEmber);//Get center flame.
 				emberToXml.Save(flameName, centerEmber, opt.PrintEditDepth(), true, opt.IntPalette(), opt.HexPalette(), true, false, false);
-				centerEmber.Clear();
 			}
 
 			stats = renderer->Stats();
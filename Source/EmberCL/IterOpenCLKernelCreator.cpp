@@ -235,7 +235,7 @@ string IterOpenCLKernelCreator<T>::CreateIterKernelString(const Ember<T>& ember,
 	   "	__constant XformCL* xforms,\n"
 	   "	__constant real_t* parVars,\n"
 	   "	__global real_t* globalShared,\n"
-	   "	__global uchar* xformDistributions,\n"//Using uchar is quicker than uint. Can't be constant because the size can be too large to fit when using xaos.
+	   "	__global uint2* xformDistributions,\n"//Alias tables of threshold, alias pairs. Can't be constant because the size can be too large to fit when using xaos.
 	   "	__constant CarToRasCL* carToRas,\n"
 	   "	__global real4reals_bucket* histogram,\n"
 	   "	uint histSize,\n"
@@ -251,6 +251,8 @@ string IterOpenCLKernelCreator<T>::CreateIterKernelString(const Ember<T>& ember,
 	   "	uint consec = 0;\n"
 	   //"	int badvals = 0;\n"
 	   "	uint histIndex;\n"
+	   "	ulong xfScaled;\n"
+	   "	uint2 xfAlias;\n"
 	   "	real_t p00, p01;\n"
 	   "	Point firstPoint, secondPoint, tempPoint;\n"
 	   "	uint2 mwc = seeds[pointsIndex];\n"
@@ -305,7 +307,7 @@ string IterOpenCLKernelCreator<T>::CreateIterKernelString(const Ember<T>& ember,
 	os <<
 #ifndef STRAIGHT_RAND
 	   "	if (THREAD_ID_Y == 0 && THREAD_ID_X < NWARPS)\n"
-	   "		xfsel[THREAD_ID_X] = MwcNext(&mwc) & " << CHOOSE_XFORM_GRAIN_M1 << ";\n"//It's faster to do the & here ahead of time than every time an xform is looked up to use inside the loop.
+	   "		xfsel[THREAD_ID_X] = MwcNext(&mwc);\n"
 	   "\n"
 #endif
 	   "	barrier(CLK_LOCAL_MEM_FENCE);\n"
@@ -318,27 +320,24 @@ string IterOpenCLKernelCreator<T>::CreateIterKernelString(const Ember<T>& ember,
 	   "		do\n"
 	   "		{\n";
 
+	//Select the next xform from an alias table the same way Iterator::NextXformFromIndex() does.
 	//If xaos is present, the a hybrid of the cuburn method is used.
-	//This makes each thread in a row pick the same offset into a distribution, using xfsel.
-	//However, the distribution the offset is in, is determined by firstPoint.m_LastXfUsed.
-	if (ember.XaosPresent())
-	{
-		os <<
+	//This makes each thread in a row pick the same random number, using xfsel.
+	//However, the alias table it selects from is determined by firstPoint.m_LastXfUsed.
+	os <<
 #ifdef STRAIGHT_RAND
-		   "			secondPoint.m_LastXfUsed = xformDistributions[MwcNext(&mwc) & " << CHOOSE_XFORM_GRAIN_M1 << " + (" << CHOOSE_XFORM_GRAIN << " * (firstPoint.m_LastXfUsed + 1u))];\n\n";
+	   "			xfScaled = (ulong)MwcNext(&mwc) * " << ember.XformCount() << "ul;\n";//For testing, using straight rand flam4/fractron style instead of cuburn.
 #else
-		   "			secondPoint.m_LastXfUsed = xformDistributions[xfsel[THREAD_ID_Y] + (" << CHOOSE_XFORM_GRAIN << " * (firstPoint.m_LastXfUsed + 1u))];\n\n";//Partial cuburn hybrid.
+	   "			xfScaled = (ulong)xfsel[THREAD_ID_Y] * " << ember.XformCount() << "ul;\n";
 #endif
-	}
+
+	if (ember.XaosPresent())
+		os << "			xfAlias = xformDistributions[(uint)(xfScaled >> 32) + (" << ember.XformCount() << " * (firstPoint.m_LastXfUsed + 1u))];\n";//Partial cuburn hybrid.
 	else
-	{
-		os <<
-#ifdef STRAIGHT_RAND
-		   "			secondPoint.m_LastXfUsed = xformDistributions[MwcNext(&mwc) & " << CHOOSE_XFORM_GRAIN_M1 << "];\n\n";//For testing, using straight rand flam4/fractron style instead of cuburn.
-#else
-		   "			secondPoint.m_LastXfUsed = xformDistributions[xfsel[THREAD_ID_Y]];\n\n";
-#endif
-	}
+		os << "			xfAlias = xformDistributions[(uint)(xfScaled >> 32)];\n";
+
+	os <<
+	   "			secondPoint.m_LastXfUsed = (uint)xfScaled < xfAlias.x ? (uint)(xfScaled >> 32) : xfAlias.y;\n\n";
 
 	for (i = 0; i < ember.XformCount(); i++)
 	{
@@ -396,7 +395,7 @@ string IterOpenCLKernelCreator<T>::CreateIterKernelString(const Ember<T>& ember,
 	   "\n"
 	   //Populate randomized xform index buffer with new random values.
 	   "		if (THREAD_ID_Y == 0 && THREAD_ID_X < NWARPS)\n"
-	   "			xfsel[THREAD_ID_X] = MwcNext(&mwc) & " << CHOOSE_XFORM_GRAIN_M1 << ";\n"
+	   "			xfsel[THREAD_ID_X] = MwcNext(&mwc);\n"
 	   "\n"
 	   "		barrier(CLK_LOCAL_MEM_FENCE);\n"
 	   //Another thread will have written to this thread's location, so read the new value and use it for accumulation below.
@@ -86,7 +86,18 @@ private:
 template <typename T>
 static bool ParseEmberFile(XmlToEmber<T>& parser, const string& filename, vector<Ember<T>>& embers, bool useDefaults = true)
 {
-	if (!parser.Parse(filename.c_str(), embers, useDefaults))
+	if (EmberToBinary<T>::IsBinaryFilename(filename))
+	{
+		BinaryToEmber<T> binaryParser;
+
+		if (!binaryParser.Parse(filename.c_str(), embers))
+		{
+			cout << "Error parsing binary flame file " << filename << ", returning without executing." << endl;
+			cout << binaryParser.ErrorReportString() << endl;
+			return false;
+		}
+	}
+	else if (!parser.Parse(filename.c_str(), embers, useDefaults))
 	{
 		cout << "Error parsing flame file " << filename << ", returning without executing." << endl;
 		return false;
@@ -101,6 +112,40 @@ static bool ParseEmberFile(XmlToEmber<T>& parser, const string& filename, vector
 	return true;
 }
 
+/// <summary>
+/// Wrapper for saving a vector of embers to a file, in the binary format if the filename has
+/// the binary flame extension, else in Xml.
+/// Template argument expected to be float or double.
+/// </summary>
+/// <param name="filename">The full path and name of the file</param>
+/// <param name="embers">The embers to save</param>
+/// <param name="printEditDepth">How deep the edit depth goes when saving Xml</param>
+/// <param name="doEdits">If true included edit tags, else don't.</param>
+/// <param name="extraAttributes">Any extra attributes to add to each ember's Xml tag</param>
+/// <param name="hexPalette">If true, embed a hexadecimal palette in Xml instead of Xml color tags, else use Xml color tags.</param>
+/// <returns>True if success, else false.</returns>
+template <typename T>
+static bool SaveEmberFile(const string& filename, vector<Ember<T>>& embers, size_t printEditDepth, bool doEdits, const string& extraAttributes, bool hexPalette)
+{
+	bool b;
+
+	if (EmberToBinary<T>::IsBinaryFilename(filename))
+	{
+		EmberToBinary<T> binaryWriter;
+		b = binaryWriter.Save(filename, embers, doEdits);
+	}
+	else
+	{
+		EmberToXml<T> emberToXml;
+		b = emberToXml.Save(filename, embers, printEditDepth, doEdits, false, hexPalette, false, false, false, extraAttributes);
+	}
+
+	if (!b)
+		cout << "Error saving flame file " << filename << "." << endl;
+
+	return b;
+}
+
 /// <summary>
 /// Wrapper for parsing palette Xml file and initializing it's private static members,
 /// and printing any errors that occurred.
@@ -148,6 +193,7 @@ static void RgbaToRgb(vector<byte>& rgba, vector<byte>& rgb, size_t width, size_
 /// <summary>
 /// Calculate the number of strips required if the needed amount of memory
 /// is greater than the system memory, or greater than what the user wants to allow.
+/// The renderer does not include buffers stored out of core in its reported requirement, so they never add strips.
 /// </summary>
 /// <param name="mem">Amount of memory required</param>
 /// <param name="memAvailable">Amount of memory available on the system</param>
@@ -380,6 +426,167 @@ static vector<unique_ptr<Renderer<T, float>>> CreateRenderers(eRendererType rend
 	return v;
 }
 
+/// <summary>
+/// Perform a render in pieces of iterations, saving its state to a checkpoint file every so often
+/// so it can be continued by a later process if this one is stopped.
+/// If resuming and the checkpoint file exists, the render continues from it rather than starting over.
+/// A checkpoint which doesn't match the render, such as one left by a different flame, is ignored.
+/// The checkpoint file is deleted once the render finishes. Only supported by the CPU renderer.
+/// Two copies of the histogram are kept for writing checkpoints, and one while resuming, which is freed once it's restored.
+/// They are stored in files when rendering out of core or when requested, and the caller should
+/// otherwise include them in the memory required with RendererBase::CheckpointSnapshots().
+/// </summary>
+/// <param name="renderer">The renderer to use, with the ember(s) already set</param>
+/// <param name="finalImage">The vector to place the final output in</param>
+/// <param name="time">The time position to use, only valid for animation</param>
+/// <param name="interval">The number of seconds between checkpoints, 0 to only resume.</param>
+/// <param name="resume">True to continue from the checkpoint file if it exists, else false.</param>
+/// <param name="filename">The full path and filename of the checkpoint file</param>
+/// <param name="fileBacked">True to store the copies of the histogram in files even when not rendering out of core. Default: false.</param>
+/// <returns>The status of the last call to Run()</returns>
+static eRenderStatus CheckpointRun(RendererBase* renderer, vector<byte>& finalImage, double time, size_t interval, bool resume, const string& filename, bool fileBacked = false)
+{
+	RenderCheckpoint checkpoint;
+	CheckpointWriter writer(filename);
+	Timing checkpointTime;
+	size_t subBatches = 1;
+	fileBacked = fileBacked || renderer->OutOfCore();
+	checkpoint.m_Hist.Backing(fileBacked, renderer->OutOfCorePath());
+	writer.Backing(fileBacked, renderer->OutOfCorePath());
+	bool resuming = resume && checkpoint.Read(filename);
+	auto status = eRenderStatus::RENDER_OK;
+
+	if (resuming)
+	{
+		if (checkpoint.m_Rand.size() != renderer->ThreadCount())
+			renderer->ThreadCount(checkpoint.m_Rand.size());//Each thread continues its own random sequence.
+
+		renderer->ResumeCheckpoint(&checkpoint);
+	}
+
+	//Run a few sub batches at a time, doubling them until each run takes long enough that the overhead of starting one is negligible.
+	while (status == eRenderStatus::RENDER_OK && renderer->ProcessState() != eProcessState::ACCUM_DONE)
+	{
+		Timing runTime;
+		status = renderer->Run(finalImage, time, subBatches);
+
+		if (status != eRenderStatus::RENDER_OK && resuming)//The checkpoint was from a different render, so start over.
+		{
+			cout << "Checkpoint " << filename << " does not match the render, starting over." << endl;
+			renderer->ClearErrorReport();
+			renderer->Reset();
+			status = eRenderStatus::RENDER_OK;
+		}
+		else if (runTime.Toc() < 500)
+			subBatches *= 2;
+
+		if (resuming)
+			checkpoint.Clear();//It's been copied into the histogram, so free it before any more are saved.
+
+		resuming = false;
+
+		if (interval && status == eRenderStatus::RENDER_OK && renderer->ProcessState() == eProcessState::ITER_STARTED && checkpointTime.Toc() >= interval * 1000.0)
+		{
+			writer.Save([&](RenderCheckpoint & c) { return renderer->SaveCheckpoint(c); });
+			checkpointTime.Tic();
+		}
+	}
+
+	if (status == eRenderStatus::RENDER_OK)
+		writer.Remove();
+
+	return status;
+}
+
+/// <summary>
+/// Iterate one shard of a render and write its histogram to a file, without filtering or producing an image.
+/// A shard runs its share of the iterations of the whole render, so the shards of a render
+/// can be iterated on separate machines, then summed with MergeShards() and filtered as if they were one render.
+/// Each shard must be seeded differently, else they all iterate the same points.
+/// Only supported by the CPU renderer.
+/// </summary>
+/// <param name="renderer">The renderer to use, with the ember already set</param>
+/// <param name="finalImage">The vector to pass to Run(), it is not written to</param>
+/// <param name="shards">The number of shards the render is split into</param>
+/// <param name="filename">The full path and filename of the shard file to write</param>
+/// <returns>True if iterating and writing the file succeeded, else false.</returns>
+static bool ShardRun(RendererBase* renderer, vector<byte>& finalImage, size_t shards, const string& filename)
+{
+	RenderCheckpoint shard;
+	size_t subBatches = 1, itersToDo = 0;
+	auto status = eRenderStatus::RENDER_OK;
+
+	renderer->Reset();
+
+	do
+	{
+		Timing runTime;
+		status = renderer->Run(finalImage, 0, subBatches);
+		itersToDo = renderer->ItersPerTemporalSample() / std::max<size_t>(shards, 1);//Only valid once the first run has computed the quality.
+
+		if (runTime.Toc() < 500)
+			subBatches *= 2;
+
+		//Don't let the last run overshoot this shard's share by more than a sub batch.
+		size_t itersDone = renderer->Stats().m_Iters;
+		size_t itersPerSubBatch = std::max<size_t>(renderer->SubBatchSize() * renderer->ThreadCount(), 1);
+		subBatches = Clamp<size_t>(subBatches, 1, itersToDo > itersDone ? (itersToDo - itersDone + itersPerSubBatch - 1) / itersPerSubBatch : 1);
+	}
+	while (status == eRenderStatus::RENDER_OK && renderer->ProcessState() == eProcessState::ITER_STARTED && renderer->Stats().m_Iters < itersToDo);
+
+	return status == eRenderStatus::RENDER_OK &&
+		   renderer->ProcessState() == eProcessState::ITER_STARTED &&
+		   renderer->SaveCheckpoint(shard) &&
+		   shard.Write(filename);
+}
+
+/// <summary>
+/// Combine the histograms of the shard files written by ShardRun() into a checkpoint, and pass it to the renderer
+/// so that the next render of the ember skips iterating and goes straight to density filtering and final accumulation.
+/// The shards must all be of the same ember, rendered at the same size.
+/// The checkpoint must stay alive until that render finishes.
+/// </summary>
+/// <param name="renderer">The renderer to use, with the ember already set</param>
+/// <param name="ember">The ember being rendered</param>
+/// <param name="filenames">The full paths and filenames of the shard files</param>
+/// <param name="checkpoint">The checkpoint to sum the shards into. Its histogram can be backed by a file before calling to save memory.</param>
+/// <returns>True if all shards were read and matched, else false.</returns>
+template <typename T>
+static bool MergeShards(RendererBase* renderer, Ember<T>& ember, const vector<string>& filenames, RenderCheckpoint& checkpoint)
+{
+	if (filenames.empty() || !checkpoint.Read(filenames[0]))
+	{
+		cout << "Error reading shard " << (filenames.empty() ? string("") : filenames[0]) << "." << endl;
+		return false;
+	}
+
+	for (size_t i = 1; i < filenames.size(); i++)
+	{
+		if (!checkpoint.Merge(filenames[i]))
+		{
+			cout << "Error merging shard " << filenames[i] << ", it is missing or is of a different render." << endl;
+			return false;
+		}
+	}
+
+	//The single temporal sample is fully iterated, so store what Run() keeps at the end of it.
+	checkpoint.m_LastTemporalSample = 1;
+	checkpoint.m_LastIter = 0;
+	checkpoint.m_VibGamCount = 1;
+	checkpoint.m_Vibrancy = float(ember.m_Vibrancy);
+	checkpoint.m_Gamma = float(ember.m_Gamma);
+	checkpoint.m_Background.r = float(ember.m_Background.r);
+	checkpoint.m_Background.g = float(ember.m_Background.g);
+	checkpoint.m_Background.b = float(ember.m_Background.b);
+
+	if (checkpoint.m_Rand.size() != renderer->ThreadCount())
+		renderer->ThreadCount(checkpoint.m_Rand.size());
+
+	renderer->Reset();
+	renderer->ResumeCheckpoint(&checkpoint);
+	return true;
+}
+
 /// <summary>
 /// Perform a render which allows for using strips or not.
 /// If an error occurs while rendering any strip, the rendering process stops.
@@ -394,13 +601,18 @@ static vector<unique_ptr<Renderer<T, float>>> CreateRenderers(eRendererType rend
 /// <param name="perStripFinish">Function called after the end of the rendering of each strip</param>
 /// <param name="perStripError">Function called if there is an error rendering a strip</param>
 /// <param name="allStripsFinished">Function called when all strips successfully finish rendering</param>
+/// <param name="checkpointFilename">If not empty and not using strips, render with CheckpointRun() using this checkpoint file. Default: empty.</param>
+/// <param name="checkpointInterval">The number of seconds between checkpoints. Default: 0.</param>
+/// <param name="resume">True to continue from the checkpoint file if it exists. Default: false.</param>
+/// <param name="checkpointFileBacked">True to store the copies of the histogram used for checkpoints in files. Default: false.</param>
 /// <returns>True if all rendering was successful, else false.</returns>
 template <typename T>
 static bool StripsRender(RendererBase* renderer, Ember<T>& ember, vector<byte>& finalImage, double time, size_t strips, bool yAxisUp,
 						 std::function<void(size_t strip)> perStripStart,
 						 std::function<void(size_t strip)> perStripFinish,
 						 std::function<void(size_t strip)> perStripError,
-						 std::function<void(Ember<T>& finalEmber)> allStripsFinished)
+						 std::function<void(Ember<T>& finalEmber)> allStripsFinished,
+						 const string& checkpointFilename = "", size_t checkpointInterval = 0, bool resume = false, bool checkpointFileBacked = false)
 {
 	bool success = false;
 	size_t origHeight, realHeight = ember.m_FinalRasH;
@@ -441,7 +653,11 @@ static bool StripsRender(RendererBase* renderer, Ember<T>& ember, vector<byte>&
 			renderer->SetEmber(ember);//Set one final time after modifications for strips.
 		}
 
-		if ((renderer->Run(finalImage, time, 0, false, stripOffset) == eRenderStatus::RENDER_OK) && !renderer->Aborted() && !finalImage.empty())
+		auto status = (strips == 1 && !checkpointFilename.empty()) ?
+					  CheckpointRun(renderer, finalImage, time, checkpointInterval, resume, checkpointFilename, checkpointFileBacked) :
+					  renderer->Run(finalImage, time, 0, false, stripOffset);
+
+		if ((status == eRenderStatus::RENDER_OK) && !renderer->Aborted() && !finalImage.empty())
 		{
 			perStripFinish(strip);
 		}
@@ -49,6 +49,8 @@
 #include "Variation.h"
 #include "EmberToXml.h"
 #include "XmlToEmber.h"
+#include "EmberToBinary.h"
+#include "BinaryToEmber.h"
 #include "PaletteList.h"
 #include "Iterator.h"
 #include "Renderer.h"
@@ -52,13 +52,27 @@ enum eOptionIDs
 	OPT_ENCLOSED,
 	OPT_NO_EDITS,
 	OPT_UNSMOOTH_EDGE,
+	OPT_PRESCREEN,
+	OPT_PRESCREEN_BENCH,
 	OPT_LOCK_ACCUM,
+	OPT_PRIVATE_HIST,
+	OPT_TILED_DE,
+	OPT_OUT_OF_CORE,
+	OPT_PACKED_HIST,
+	OPT_INDEX_HIST,
+	OPT_RESUME,
+	OPT_MERGE,
 	OPT_DUMP_KERNEL,
 
 	//Value args.
 	OPT_SEED,//Int value args.
 	OPT_NTHREADS,
 	OPT_STRIPS,
+	OPT_TILES,
+	OPT_CHECKPOINT,
+	OPT_SHARDS,
+	OPT_SHARD,
+	OPT_BATCH,
 	OPT_SUPERSAMPLE,
 	OPT_BITS,
 	OPT_BPC,
@@ -76,6 +90,7 @@ enum eOptionIDs
 	OPT_SHEEP_ID,
 	OPT_REPEAT,
 	OPT_TRIES,
+	OPT_CANDIDATES,
 	OPT_MAX_XFORMS,
 	OPT_PRIORITY,
 
@@ -94,6 +109,7 @@ enum eOptionIDs
 
 	OPT_OPENCL_DEVICE,//String value args.
 	OPT_ISAAC_SEED,
+	OPT_OUT_OF_CORE_PATH,
 	OPT_IN,
 	OPT_OUT,
 	OPT_PREFIX,
@@ -120,7 +136,8 @@ enum eOptionIDs
 	OPT_SEQUENCE,
 	OPT_USE_VARS,
 	OPT_DONT_USE_VARS,
-	OPT_EXTRAS
+	OPT_EXTRAS,
+	OPT_GENOME_OUT
 };
 
 class EmberOptions;
@@ -321,7 +338,16 @@ public:
 		INITBOOLOPTION(Enclosed,	   Eob(OPT_USE_GENOME,  OPT_ENCLOSED,		  _T("--enclosed"),				true,				  SO_OPT,	  "\t--enclosed               Use enclosing XML tags [default: true].\n"));
 		INITBOOLOPTION(NoEdits,        Eob(OPT_USE_GENOME,  OPT_NO_EDITS,         _T("--noedits"),              false,                SO_NONE,    "\t--noedits                Exclude edit tags when writing Xml [default: false].\n"));
 		INITBOOLOPTION(UnsmoothEdge,   Eob(OPT_USE_GENOME,  OPT_UNSMOOTH_EDGE,    _T("--unsmoother"),           false,                SO_NONE,    "\t--unsmoother             Do not use smooth blending for sheep edges [default: false].\n"));
+		INITBOOLOPTION(PreScreen,      Eob(OPT_USE_GENOME,  OPT_PRESCREEN,        _T("--prescreen"),            true,                 SO_OPT,     "\t--prescreen              Reject degenerate candidate flames with a short run of iterations before test rendering them [default: true].\n"));
+		INITBOOLOPTION(PreScreenBench, Eob(OPT_USE_GENOME,  OPT_PRESCREEN_BENCH,  _T("--prescreen_bench"),      false,                SO_NONE,    "\t--prescreen_bench        Test render every candidate, including those the pre-screen rejects, and report how often the two agreed [default: false].\n"));
 		INITBOOLOPTION(LockAccum,	   Eob(OPT_USE_ALL,		OPT_LOCK_ACCUM,       _T("--lock_accum"),           false,                SO_NONE,    "\t--lock_accum             Lock threads when accumulating to the histogram using the CPU. This will drop performance to that of single threading [default: false].\n"));
+		INITBOOLOPTION(PrivateHist,	   Eob(OPT_USE_ALL,		OPT_PRIVATE_HIST,     _T("--private_hist"),         false,                SO_NONE,    "\t--private_hist           Give each CPU thread its own histogram, summing them after each temporal sample. Avoids lost hits and lock contention at the cost of one histogram of memory per thread [default: false].\n"));
+		INITBOOLOPTION(TiledDE,	       Eob(OPT_USE_ALL,		OPT_TILED_DE,         _T("--tiled_de"),             false,                SO_NONE,    "\t--tiled_de               Use the tiled, race free CPU density filter instead of the row based one [default: false].\n"));
+		INITBOOLOPTION(OutOfCore,      Eob(OPT_USE_RENDER,	OPT_OUT_OF_CORE,      _T("--out_of_core"),          false,                SO_NONE,    "\t--out_of_core            Store the histogram and density filtering buffer in temporary memory mapped files so renders larger than memory need no strips. CPU only [default: false].\n"));
+		INITBOOLOPTION(PackedHist,     Eob(OPT_USE_RENDER,	OPT_PACKED_HIST,      _T("--packed_hist"),          false,                SO_NONE,    "\t--packed_hist            Store each histogram bucket in 64 bits, as four 14-bit mantissas sharing an exponent. CPU only [default: false].\n"));
+		INITBOOLOPTION(IndexHist,      Eob(OPT_USE_RENDER,	OPT_INDEX_HIST,       _T("--index_hist"),           false,                SO_NONE,    "\t--index_hist             Store the distribution of palette indices in each histogram bucket and apply the palette when filtering. CPU only [default: false].\n"));
+		INITBOOLOPTION(Resume,         Eob(OPT_RENDER_ANIM,	OPT_RESUME,           _T("--resume"),               false,                SO_NONE,    "\t--resume                 Continue renders from the checkpoint files written by --checkpoint, and skip animation frames which were already written [default: false].\n"));
+		INITBOOLOPTION(Merge,          Eob(OPT_USE_RENDER,	OPT_MERGE,            _T("--merge"),                false,                SO_NONE,    "\t--merge                  Sum the shard files written by --shards into one histogram and render the final image from it [default: false].\n"));
 		INITBOOLOPTION(DumpKernel,	   Eob(OPT_USE_RENDER,	OPT_DUMP_KERNEL,      _T("--dump_kernel"),          false,                SO_NONE,    "\t--dump_kernel            Print the iteration kernel string when using OpenCL (ignored for CPU) [default: false].\n"));
 
 		//Int.
@@ -338,6 +364,11 @@ public:
 		INITUINTOPTION(Seed,           Eou(OPT_USE_ALL,     OPT_SEED,             _T("--seed"),                 0,                    SO_REQ_SEP, "\t--seed=<val>             Integer seed to use for the random number generator [default: random].\n"));
 		INITUINTOPTION(ThreadCount,    Eou(OPT_USE_ALL,     OPT_NTHREADS,         _T("--nthreads"),             0,                    SO_REQ_SEP, "\t--nthreads=<val>         The number of threads to use [default: use all available cores].\n"));
 		INITUINTOPTION(Strips,		   Eou(OPT_USE_RENDER,  OPT_STRIPS,           _T("--nstrips"),              1,                    SO_REQ_SEP, "\t--nstrips=<val>          The number of fractions to split a single render frame into. Useful for print size renders or low memory systems [default: 1].\n"));
+		INITUINTOPTION(Tiles,		   Eou(OPT_USE_RENDER,  OPT_TILES,            _T("--ntiles"),               1,                    SO_REQ_SEP, "\t--ntiles=<val>           Iterate once, then density filter and accumulate the frame in this many row tiles to reduce memory use without the extra iterations of strips. CPU only [default: 1].\n"));
+		INITUINTOPTION(Checkpoint,	   Eou(OPT_RENDER_ANIM, OPT_CHECKPOINT,       _T("--checkpoint"),           0,                    SO_REQ_SEP, "\t--checkpoint=<val>       Write the state of each render in progress to a checkpoint file next to its output file every this many seconds, so it can be continued with --resume. 0 to disable. CPU only [default: 0].\n"));
+		INITUINTOPTION(Shards,		   Eou(OPT_USE_RENDER,  OPT_SHARDS,           _T("--shards"),               1,                    SO_REQ_SEP, "\t--shards=<val>           Split the iterations of each render into this many independent shards which can be iterated on separate machines and summed with --merge. CPU only [default: 1].\n"));
+		INITUINTOPTION(Shard,		   Eou(OPT_USE_RENDER,  OPT_SHARD,            _T("--shard"),                0,                    SO_REQ_SEP, "\t--shard=<val>            The zero based index of the shard to iterate and write when --shards is greater than 1 [default: 0].\n"));
+		INITUINTOPTION(Batch,		   Eou(OPT_USE_RENDER,  OPT_BATCH,            _T("--batch"),                1,                    SO_REQ_SEP, "\t--batch=<val>            Render this many flames from the input file at once, each with its own renderer and a share of the threads sized by its image area and quality. Best for many small images. CPU only [default: 1].\n"));
 		INITUINTOPTION(Supersample,    Eou(OPT_RENDER_ANIM, OPT_SUPERSAMPLE,      _T("--supersample"),          0,                    SO_REQ_SEP, "\t--supersample=<val>      The supersample value used to override the one specified in the file [default: 0 (use value from file)].\n"));
 		INITUINTOPTION(BitsPerChannel, Eou(OPT_RENDER_ANIM, OPT_BPC,              _T("--bpc"),                  8,                    SO_REQ_SEP, "\t--bpc=<val>              Bits per channel. 8 or 16 for PNG, 8 for all others [default: 8].\n"));
 		INITUINTOPTION(SubBatchSize,   Eou(OPT_USE_ALL,		OPT_SBS,			  _T("--sub_batch_size"),		DEFAULT_SBS,		  SO_REQ_SEP, "\t--sub_batch_size=<val>   The chunk size that iterating will be broken into [default: 10k].\n"));
@@ -356,6 +387,7 @@ public:
 		INITUINTOPTION(Frames,         Eou(OPT_USE_GENOME,  OPT_NFRAMES,          _T("--nframes"),          20,                      SO_REQ_SEP, "\t--nframes=<val>          Number of frames for each stage of the animation [default: 20].\n"));
 		INITUINTOPTION(Repeat,         Eou(OPT_USE_GENOME,  OPT_REPEAT,           _T("--repeat"),           1,                       SO_REQ_SEP, "\t--repeat=<val>           Number of new flames to create. Ignored if sequence, inter or rotate were specified [default: 1].\n"));
 		INITUINTOPTION(Tries,          Eou(OPT_USE_GENOME,  OPT_TRIES,            _T("--tries"),            10,                      SO_REQ_SEP, "\t--tries=<val>            Number times to try creating a flame that meets the specified constraints. Ignored if sequence, inter or rotate were specified [default: 10].\n"));
+		INITUINTOPTION(Candidates,     Eou(OPT_USE_GENOME,  OPT_CANDIDATES,       _T("--candidates"),       0,                       SO_REQ_SEP, "\t--candidates=<val>       Number of flames to create and test render at once when searching for one that meets the specified constraints, each on its own CPU renderer with a share of the threads. The first which passes is kept. CPU only [default: 0, one per thread up to tries].\n"));
 		INITUINTOPTION(MaxXforms,      Eou(OPT_USE_GENOME,  OPT_MAX_XFORMS,       _T("--maxxforms"),        UINT_MAX,                SO_REQ_SEP, "\t--maxxforms=<val>        The maximum number of xforms allowed in the final output.\n"));
 
 		//Double.
@@ -377,6 +409,7 @@ public:
 		//String.
 		INITSTRINGOPTION(Device,	   Eos(OPT_USE_ALL,		OPT_OPENCL_DEVICE,	  _T("--device"),				"0",				  SO_REQ_SEP, "\t--device                 The comma-separated OpenCL device indices to use. Single device: 0 Multi device: 0,1,3,4 [default: 0].\n"));
 		INITSTRINGOPTION(IsaacSeed,    Eos(OPT_USE_ALL,     OPT_ISAAC_SEED,       _T("--isaac_seed"),           "",                   SO_REQ_SEP, "\t--isaac_seed=<val>       Character-based seed for the random number generator [default: random].\n"));
+		INITSTRINGOPTION(OutOfCorePath, Eos(OPT_USE_RENDER,  OPT_OUT_OF_CORE_PATH, _T("--out_of_core_path"),     "",                   SO_REQ_SEP, "\t--out_of_core_path=<val> Folder to create the files used by --out_of_core in [default: system temporary folder].\n"));
 		INITSTRINGOPTION(Input,        Eos(OPT_RENDER_ANIM, OPT_IN,               _T("--in"),                   "",                   SO_REQ_SEP, "\t--in=<val>               Name of the input file.\n"));
 		INITSTRINGOPTION(Out,          Eos(OPT_USE_RENDER,	OPT_OUT,              _T("--out"),                  "",                   SO_REQ_SEP, "\t--out=<val>              Name of a single output file. Not recommended when rendering more than one image.\n"));
 		INITSTRINGOPTION(Prefix,       Eos(OPT_RENDER_ANIM, OPT_PREFIX,           _T("--prefix"),               "",                   SO_REQ_SEP, "\t--prefix=<val>           Prefix to prepend to all output files.\n"));
@@ -405,6 +438,7 @@ public:
 		INITSTRINGOPTION(UseVars,      Eos(OPT_USE_GENOME,  OPT_USE_VARS,         _T("--use_vars"),             "",                   SO_REQ_SEP, "\t--use_vars=<val>         Comma separated list of variation #'s to use when generating a random flame.\n"));
 		INITSTRINGOPTION(DontUseVars,  Eos(OPT_USE_GENOME,  OPT_DONT_USE_VARS,    _T("--dont_use_vars"),        "",                   SO_REQ_SEP, "\t--dont_use_vars=<val>    Comma separated list of variation #'s to NOT use when generating a random flame.\n"));
 		INITSTRINGOPTION(Extras,       Eos(OPT_USE_GENOME,  OPT_EXTRAS,           _T("--extras"),               "",                   SO_REQ_SEP, "\t--extras=<val>           Extra attributes to place in the flame section of the Xml.\n"));
+		INITSTRINGOPTION(GenomeOut,    Eos(OPT_USE_GENOME,  OPT_GENOME_OUT,       _T("--genome_out"),           "",                   SO_REQ_SEP, "\t--genome_out=<val>       Write the flames produced by clone_all, animate and sequence to this file instead of the console. Written in the binary format if the extension is .bflame, else Xml.\n"));
 	}
 
 	/// <summary>
@@ -461,7 +495,16 @@ public:
 					PARSEBOOLOPTION(OPT_ENCLOSED, Enclosed);
 					PARSEBOOLOPTION(OPT_NO_EDITS, NoEdits);
 					PARSEBOOLOPTION(OPT_UNSMOOTH_EDGE, UnsmoothEdge);
+					PARSEBOOLOPTION(OPT_PRESCREEN, PreScreen);
+					PARSEBOOLOPTION(OPT_PRESCREEN_BENCH, PreScreenBench);
 					PARSEBOOLOPTION(OPT_LOCK_ACCUM, LockAccum);
+					PARSEBOOLOPTION(OPT_PRIVATE_HIST, PrivateHist);
+					PARSEBOOLOPTION(OPT_TILED_DE, TiledDE);
+					PARSEBOOLOPTION(OPT_OUT_OF_CORE, OutOfCore);
+					PARSEBOOLOPTION(OPT_PACKED_HIST, PackedHist);
+					PARSEBOOLOPTION(OPT_INDEX_HIST, IndexHist);
+					PARSEBOOLOPTION(OPT_RESUME, Resume);
+					PARSEBOOLOPTION(OPT_MERGE, Merge);
 					PARSEBOOLOPTION(OPT_DUMP_KERNEL, DumpKernel);
 
 					PARSEINTOPTION(OPT_SYMMETRY, Symmetry);//Int args
@@ -471,6 +514,11 @@ public:
 					PARSEUINTOPTION(OPT_SEED, Seed);//uint args.
 					PARSEUINTOPTION(OPT_NTHREADS, ThreadCount);
 					PARSEUINTOPTION(OPT_STRIPS, Strips);
+					PARSEUINTOPTION(OPT_TILES, Tiles);
+					PARSEUINTOPTION(OPT_CHECKPOINT, Checkpoint);
+					PARSEUINTOPTION(OPT_SHARDS, Shards);
+					PARSEUINTOPTION(OPT_SHARD, Shard);
+					PARSEUINTOPTION(OPT_BATCH, Batch);
 					PARSEUINTOPTION(OPT_SUPERSAMPLE, Supersample);
 					PARSEUINTOPTION(OPT_BITS, Bits);
 					PARSEUINTOPTION(OPT_BPC, BitsPerChannel);
@@ -485,6 +533,7 @@ public:
 					PARSEUINTOPTION(OPT_NFRAMES, Frames);
 					PARSEUINTOPTION(OPT_REPEAT, Repeat);
 					PARSEUINTOPTION(OPT_TRIES, Tries);
+					PARSEUINTOPTION(OPT_CANDIDATES, Candidates);
 					PARSEUINTOPTION(OPT_MAX_XFORMS, MaxXforms);
 
 					PARSEDOUBLEOPTION(OPT_SS, SizeScale);//Float args.
@@ -502,6 +551,7 @@ public:
 
 					PARSESTRINGOPTION(OPT_OPENCL_DEVICE, Device);//String args.
 					PARSESTRINGOPTION(OPT_ISAAC_SEED, IsaacSeed);
+					PARSESTRINGOPTION(OPT_OUT_OF_CORE_PATH, OutOfCorePath);
 					PARSESTRINGOPTION(OPT_IN, Input);
 					PARSESTRINGOPTION(OPT_OUT, Out);
 					PARSESTRINGOPTION(OPT_PREFIX, Prefix);
@@ -529,6 +579,7 @@ public:
 					PARSESTRINGOPTION(OPT_USE_VARS, UseVars);
 					PARSESTRINGOPTION(OPT_DONT_USE_VARS, DontUseVars);
 					PARSESTRINGOPTION(OPT_EXTRAS, Extras);
+					PARSESTRINGOPTION(OPT_GENOME_OUT, GenomeOut);
 					default:
 					{
 						break;//Do nothing.
@@ -703,7 +754,16 @@ public:
 	Eob Enclosed;
 	Eob NoEdits;
 	Eob UnsmoothEdge;
+	Eob PreScreen;
+	Eob PreScreenBench;
 	Eob LockAccum;
+	Eob PrivateHist;
+	Eob TiledDE;
+	Eob OutOfCore;
+	Eob PackedHist;
+	Eob IndexHist;
+	Eob Resume;
+	Eob Merge;
 	Eob DumpKernel;
 
 	Eoi Symmetry;//Value int.
@@ -713,6 +773,11 @@ public:
 	Eou Seed;//Value uint.
 	Eou ThreadCount;
 	Eou Strips;
+	Eou Tiles;
+	Eou Checkpoint;
+	Eou Shards;
+	Eou Shard;
+	Eou Batch;
 	Eou Supersample;
 	Eou BitsPerChannel;
 	Eou SubBatchSize;
@@ -727,6 +792,7 @@ public:
 	Eou Frames;
 	Eou Repeat;
 	Eou Tries;
+	Eou Candidates;
 	Eou MaxXforms;
 
 	Eod SizeScale;//Value double.
@@ -744,6 +810,7 @@ public:
 
 	Eos Device;//Value string.
 	Eos IsaacSeed;
+	Eos OutOfCorePath;
 	Eos Input;
 	Eos Out;
 	Eos Prefix;
@@ -771,6 +838,7 @@ public:
 	Eos UseVars;
 	Eos DontUseVars;
 	Eos Extras;
+	Eos GenomeOut;
 
 private:
 	vector<size_t> m_Devices;
@@ -34,6 +34,118 @@ void SetDefaultTestValues(Ember<T>& ember)
 	ember.m_CurveDE = T(0.6);
 }
 
+/// <summary>
+/// Test render several candidate flames at once, each on its own renderer, to find the first which meets the
+/// brightness constraints in the program options.
+/// The renderers take candidates in order from a shared counter. Once a candidate passes, the renderers still working on
+/// candidates after it are aborted and no more are started, since only the first which passes is kept.
+/// All candidates before the one found were rendered and failed, or were already rejected,
+/// so the result is the same as testing them one at a time.
+/// Template argument expected to be float or double.
+/// </summary>
+/// <param name="opt">The program options which contain the constraints</param>
+/// <param name="renderers">The renderers to use, one per candidate rendered at once</param>
+/// <param name="candidates">The candidates to test, with the default test values already applied</param>
+/// <param name="results">On entry, 0 for each candidate which was already rejected and won't be rendered, else -1.
+/// On exit, 1 for each candidate which was rendered and passed, 0 for each which failed or was rejected, and -1 for each which wasn't tested.</param>
+/// <param name="all">Test every candidate rather than stopping at the first which passes. Used to measure the pre-screen against full renders.</param>
+/// <param name="passed">Stores the index of the first candidate which passed, or the number of candidates if none did</param>
+/// <returns>True if no test render before the one which passed failed, else false.</returns>
+template <typename T>
+static bool TestCandidates(EmberOptions& opt, vector<Renderer<T, float>*>& renderers, vector<Ember<T>>& candidates, vector<int>& results, bool all, size_t& passed)
+{
+	size_t failed = candidates.size();
+	vector<size_t> rendering(renderers.size(), SIZE_MAX);//The candidate each renderer is working on, SIZE_MAX if none.
+	vector<std::thread> threadVec;
+	std::atomic<size_t> next(0);
+	std::mutex cs;
+	passed = candidates.size();
+	auto decided = [&](size_t index) { return index > failed || (!all && index > passed); };//Assumes cs is locked.
+	auto abortAfter = [&](size_t index)//Assumes cs is locked.
+	{
+		for (size_t r = 0; r < renderers.size(); r++)
+			if (rendering[r] != SIZE_MAX && decided(rendering[r]))
+				renderers[r]->Abort();
+	};
+	auto iterFunc = [&](size_t r)
+	{
+		size_t i, j, n, tot, totb, totw;
+		T avgPix = 0, fractionBlack = 0, fractionWhite = 0;
+		vector<byte> finalImage;
+
+		while ((i = next.fetch_add(1)) < candidates.size())
+		{
+			{
+				std::lock_guard<std::mutex> lock(cs);
+
+				if (decided(i))
+					break;
+
+				if (results[i] == 0)//Rejected by the pre-screen.
+					continue;
+
+				rendering[r] = i;
+			}
+
+			renderers[r]->SetEmber(candidates[i]);
+			bool ok = renderers[r]->Run(finalImage) == eRenderStatus::RENDER_OK;
+
+			if (ok)
+			{
+				tot = totb = totw = 0;
+				n = candidates[i].m_FinalRasW * candidates[i].m_FinalRasH;
+
+				for (j = 0; j < 3 * n; j += 3)
+				{
+					tot += (finalImage[j] + finalImage[j + 1] + finalImage[j + 2]);
+
+					if (0   == finalImage[j] && 0   == finalImage[j + 1] && 0   == finalImage[j + 2]) totb++;
+
+					if (255 == finalImage[j] && 255 == finalImage[j + 1] && 255 == finalImage[j + 2]) totw++;
+				}
+
+				avgPix = (tot / T(3 * n));
+				fractionBlack = totb / T(n);
+				fractionWhite = totw / T(n);
+			}
+
+			std::lock_guard<std::mutex> lock(cs);
+			rendering[r] = SIZE_MAX;
+
+			if (decided(i))//An earlier candidate already decided the outcome, so this one may have been aborted.
+				break;
+
+			if (!ok)
+			{
+				failed = i;
+				abortAfter(i);
+				break;
+			}
+
+			if (opt.Debug())
+				cerr << "avgPix = " << avgPix << " fractionBlack = " << fractionBlack << " fractionWhite = " << fractionWhite << " n = " << n << endl;
+
+			results[i] = avgPix >= opt.AvgThresh() && fractionBlack >= opt.BlackThresh() && fractionWhite <= opt.WhiteLimit() ? 1 : 0;
+
+			if (results[i] == 1 && i < passed)
+			{
+				passed = i;
+				abortAfter(i);
+			}
+		}
+	};
+	threadVec.reserve(renderers.size());
+
+	for (size_t r = 0; r < renderers.size(); r++)
+		threadVec.push_back(std::thread(iterFunc, r));
+
+	for (auto& th : threadVec)
+		if (th.joinable())
+			th.join();
+
+	return passed <= failed;//Equal only when neither happened.
+}
+
 /// <summary>
 /// The core of the EmberGenome.exe program.
 /// Template argument expected to be float or double.
@@ -61,17 +173,23 @@ bool EmberGenome(EmberOptions& opt)
 	bool exactTimeMatch, randomMode, didColor, seqFlag;
 	size_t i, j, i0, i1, rep, val, frame, frameCount, count = 0;
 	size_t ftime, firstFrame, lastFrame;
-	size_t n, tot, totb, totw;
-	T avgPix, fractionBlack, fractionWhite, blend, spread, mix0, mix1;
+	size_t batch, passed, threadCount, candidateCount;
+	size_t screenCounts[2][2] = { { 0, 0 }, { 0, 0 } };//Indexed by whether the pre-screen accepted, then whether the test render passed.
+	double screenMs = 0, testMs = 0;
+	T blend, spread, mix0, mix1;
 	string token, filename;
 	ostringstream os, os2;
-	vector<Ember<T>> embers, embers2, templateEmbers;
+	vector<Ember<T>> embers, embers2, templateEmbers, candidates, saves;
+	vector<string> actions;
+	vector<bool> screened;
+	vector<int> results;
+	PreScreenStats screenStats;
 	vector<eVariationId> vars, noVars;
-	vector<byte> finalImage;
 	eCrossMode crossMeth;
 	eMutateMode mutMeth;
 	Ember<T> orig, save, selp0, selp1, parent0, parent1;
 	Ember<T> result, result1, result2, result3, interpolated;
+	Interpolater<T> interpolater;
 	Ember<T>* aselp0, *aselp1, *pTemplate = nullptr;
 	XmlToEmber<T> parser;
 	EmberToXml<T> emberToXml;
@@ -80,6 +198,8 @@ bool EmberGenome(EmberOptions& opt)
 	const vector<pair<size_t, size_t>> devices = Devices(opt.Devices());
 	unique_ptr<RenderProgress<T>> progress(new RenderProgress<T>());
 	unique_ptr<Renderer<T, float>> renderer(CreateRenderer<T>(opt.EmberCL() ? OPENCL_RENDERER : CPU_RENDERER, devices, false, 0, emberReport));
+	vector<unique_ptr<Renderer<T, float>>> candidateRenderers;
+	vector<Renderer<T, float>*> testRenderers;
 	QTIsaac<ISAAC_SIZE, ISAAC_INT> rand(ISAAC_INT(t.Tic()), ISAAC_INT(t.Tic() * 2), ISAAC_INT(t.Tic() * 3));
 	vector<string> errorReport = emberReport.ErrorReport();
 	os.imbue(std::locale(""));
@@ -287,9 +407,21 @@ bool EmberGenome(EmberOptions& opt)
 			return false;
 	}
 
+	//Clone all, animate and sequence either print their flames as they go, or collect them to be saved to a file at the end.
+	vector<Ember<T>> outEmbers;
+	bool toFile = opt.GenomeOut() != "";
+	auto emit = [&](Ember<T>& ember)
+	{
+		if (toFile)
+			outEmbers.push_back(ember);
+		else
+			cout << emberToXml.ToString(ember, opt.Extras(), opt.PrintEditDepth(), !opt.NoEdits(), false, opt.HexPalette());
+	};
+
 	if (opt.CloneAll() != "")
 	{
-		cout << "<clone_all version=\"Ember-" << EmberVersion() << "\">" << endl;
+		if (!toFile)
+			cout << "<clone_all version=\"Ember-" << EmberVersion() << "\">" << endl;
 
 		for (i = 0; i < embers.size(); i++)
 		{
@@ -297,9 +429,12 @@ bool EmberGenome(EmberOptions& opt)
 				tools.ApplyTemplate(embers[i], *pTemplate);
 
 			tools.Offset(embers[i], T(opt.OffsetX()), T(opt.OffsetY()));
-			cout << emberToXml.ToString(embers[i], opt.Extras(), opt.PrintEditDepth(), !opt.NoEdits(), false, opt.HexPalette());
+			emit(embers[i]);
 		}
 
+		if (toFile)
+			return SaveEmberFile(opt.GenomeOut(), outEmbers, opt.PrintEditDepth(), !opt.NoEdits(), opt.Extras(), opt.HexPalette());
+
 		cout << "</clone_all>" << endl;
 		return true;
 	}
@@ -323,7 +458,8 @@ bool EmberGenome(EmberOptions& opt)
 		if (lastFrame < firstFrame)
 			lastFrame = firstFrame;
 
-		cout << "<animate version=\"EMBER-" << EmberVersion() << "\">" << endl;
+		if (!toFile)
+			cout << "<animate version=\"EMBER-" << EmberVersion() << "\">" << endl;
 
 		for (ftime = firstFrame; ftime <= lastFrame; ftime++)
 		{
@@ -341,7 +477,7 @@ bool EmberGenome(EmberOptions& opt)
 
 			if (!exactTimeMatch)
 			{
-				Interpolater<T>::Interpolate(embers, T(ftime), T(opt.Stagger()), interpolated);
+				interpolater.InterpolateInPlace(embers, T(ftime), T(opt.Stagger()), interpolated);
 
 				for (i = 0; i < embers.size(); i++)
 				{
@@ -359,9 +495,12 @@ bool EmberGenome(EmberOptions& opt)
 			if (pTemplate)
 				tools.ApplyTemplate(interpolated, *pTemplate);
 
-			cout << emberToXml.ToString(interpolated, opt.Extras(), opt.PrintEditDepth(), !opt.NoEdits(), false, opt.HexPalette());
+			emit(interpolated);
 		}
 
+		if (toFile)
+			return SaveEmberFile(opt.GenomeOut(), outEmbers, opt.PrintEditDepth(), !opt.NoEdits(), opt.Extras(), opt.HexPalette());
+
 		cout << "</animate>" << endl;
 		return true;
 	}
@@ -376,7 +515,7 @@ bool EmberGenome(EmberOptions& opt)
 			return false;
 		}
 
-		if (opt.Enclosed())
+		if (opt.Enclosed() && !toFile)
 			cout << "<sequence version=\"EMBER-" << EmberVersion() << "\">" << endl;
 
 		spread = 1 / T(opt.Frames());
@@ -390,7 +529,7 @@ bool EmberGenome(EmberOptions& opt)
 				{
 					blend = T(frame) / T(opt.Frames());
 					tools.Spin(embers[i], pTemplate, result, frameCount++, blend);//Result is cleared and reassigned each time inside of Spin().
-					cout << emberToXml.ToString(result, opt.Extras(), opt.PrintEditDepth(), !opt.NoEdits(), false, opt.HexPalette());
+					emit(result);
 				}
 			}
 
@@ -402,14 +541,17 @@ bool EmberGenome(EmberOptions& opt)
 					blend = frame / T(opt.Frames());
 					result.Clear();
 					tools.SpinInter(&embers[i], pTemplate, result, frameCount++, seqFlag, blend);
-					cout << emberToXml.ToString(result, opt.Extras(), opt.PrintEditDepth(), !opt.NoEdits(), false, opt.HexPalette());
+					emit(result);
 				}
 			}
 		}
 
 		result = embers.back();
 		tools.Spin(embers.back(), pTemplate, result, frameCount, 0);
-		cout << emberToXml.ToString(result, opt.Extras(), opt.PrintEditDepth(), !opt.NoEdits(), false, opt.HexPalette());
+		emit(result);
+
+		if (toFile)
+			return SaveEmberFile(opt.GenomeOut(), outEmbers, opt.PrintEditDepth(), !opt.NoEdits(), opt.Extras(), opt.HexPalette());
 
 		if (opt.Enclosed())
 			cout << "</sequence>" << endl;
@@ -501,11 +643,17 @@ bool EmberGenome(EmberOptions& opt)
 	}
 
 	//Repeat.
-	renderer->EarlyClip(opt.EarlyClip());
-	renderer->YAxisUp(opt.YAxisUp());
-	renderer->LockAccum(opt.LockAccum());
-	renderer->PixelAspectRatio(T(opt.AspectRatio()));
-	renderer->Transparency(opt.Transparency());
+	auto setup = [&](Renderer<T, float>* r)//Also used for the candidate renderers.
+	{
+		r->EarlyClip(opt.EarlyClip());
+		r->YAxisUp(opt.YAxisUp());
+		r->LockAccum(opt.LockAccum());
+		r->PrivateHist(opt.PrivateHist());
+		r->TiledDE(opt.TiledDE());
+		r->PixelAspectRatio(T(opt.AspectRatio()));
+		r->Transparency(opt.Transparency());
+	};
+	setup(renderer.get());
 
 	if (opt.Repeat() == 0)
 	{
@@ -513,6 +661,35 @@ bool EmberGenome(EmberOptions& opt)
 		return false;
 	}
 
+	//Test render several candidates at once on the CPU, each on its own renderer with a share of the threads.
+	//The GPU is already kept busy by one, so OpenCL always tests one at a time.
+	threadCount = opt.ThreadCount() != 0 ? opt.ThreadCount() : Timing::ProcessorCount();
+	candidateCount = opt.EmberCL() ? 1 : Clamp<size_t>(opt.Candidates() != 0 ? opt.Candidates() : threadCount, 1, std::max<size_t>(opt.Tries(), 1));
+
+	if (candidateCount > 1)
+	{
+		for (i = 0; i < candidateCount; i++)
+		{
+			unique_ptr<Renderer<T, float>> candidateRenderer(CreateRenderer<T>(CPU_RENDERER, devices, false, 0, emberReport));
+
+			if (!candidateRenderer.get())
+			{
+				cerr << "Candidate renderer creation failed, exiting." << endl;
+				return false;
+			}
+
+			setup(candidateRenderer.get());
+			candidateRenderer->ThreadCount(std::max<size_t>(1, threadCount / candidateCount), opt.IsaacSeed() != "" ? opt.IsaacSeed().c_str() : nullptr);
+			testRenderers.push_back(candidateRenderer.get());
+			candidateRenderers.push_back(std::move(candidateRenderer));
+		}
+
+		tools.TestRenderers(candidateCount);
+		VerbosePrint("Testing " << candidateCount << " candidates at a time.");
+	}
+	else
+		testRenderers.push_back(renderer.get());
+
 	if (opt.Enclosed())
 		cout << "<pick version=\"EMBER-" << EmberVersion() << "\">" << endl;
 
@@ -541,182 +718,200 @@ bool EmberGenome(EmberOptions& opt)
 		{
 			do
 			{
-				randomMode = false;
-				didColor = false;
-				os.str("");
-				VerbosePrint(".");
-
-				if (doMutate)
+				batch = std::max<size_t>(1, std::min(testRenderers.size(), opt.Tries() - count));
+				candidates.clear();
+				saves.clear();
+				actions.clear();
+				screened.clear();
+				results.clear();
+
+				for (j = 0; j < batch; j++)
 				{
-					selp0 = embers[rand.Rand() % embers.size()];
-					orig = selp0;
-					aselp0 = &selp0;
-					aselp1 = nullptr;
-
-					if (opt.Method() == "")
-						mutMeth = MUTATE_NOT_SPECIFIED;
-					else if (opt.Method() == "all_vars")
-						mutMeth = MUTATE_ALL_VARIATIONS;
-					else if (opt.Method() == "one_xform")
-						mutMeth = MUTATE_ONE_XFORM_COEFS;
-					else if (opt.Method() == "add_symmetry")
-						mutMeth = MUTATE_ADD_SYMMETRY;
-					else if (opt.Method() == "post_xforms")
-						mutMeth = MUTATE_POST_XFORMS;
-					else if (opt.Method() == "color_palette")
-						mutMeth = MUTATE_COLOR_PALETTE;
-					else if (opt.Method() == "delete_xform")
-						mutMeth = MUTATE_DELETE_XFORM;
-					else if (opt.Method() == "all_coefs")
-						mutMeth = MUTATE_ALL_COEFS;
-					else
+					randomMode = false;
+					didColor = false;
+					os.str("");
+					VerbosePrint(".");
+
+					if (doMutate)
 					{
-						cerr << "method " << opt.Method() << " not defined for mutate. Defaulting to random." << endl;
-						mutMeth = MUTATE_NOT_SPECIFIED;
-					}
+						selp0 = embers[rand.Rand() % embers.size()];
+						orig = selp0;
+						aselp0 = &selp0;
+						aselp1 = nullptr;
+
+						if (opt.Method() == "")
+							mutMeth = MUTATE_NOT_SPECIFIED;
+						else if (opt.Method() == "all_vars")
+							mutMeth = MUTATE_ALL_VARIATIONS;
+						else if (opt.Method() == "one_xform")
+							mutMeth = MUTATE_ONE_XFORM_COEFS;
+						else if (opt.Method() == "add_symmetry")
+							mutMeth = MUTATE_ADD_SYMMETRY;
+						else if (opt.Method() == "post_xforms")
+							mutMeth = MUTATE_POST_XFORMS;
+						else if (opt.Method() == "color_palette")
+							mutMeth = MUTATE_COLOR_PALETTE;
+						else if (opt.Method() == "delete_xform")
+							mutMeth = MUTATE_DELETE_XFORM;
+						else if (opt.Method() == "all_coefs")
+							mutMeth = MUTATE_ALL_COEFS;
+						else
+						{
+							cerr << "method " << opt.Method() << " not defined for mutate. Defaulting to random." << endl;
+							mutMeth = MUTATE_NOT_SPECIFIED;
+						}
 
-					os << tools.Mutate(orig, mutMeth, vars, opt.Symmetry(), T(opt.Speed()), MAX_CL_VARS);
+						os << tools.Mutate(orig, mutMeth, vars, opt.Symmetry(), T(opt.Speed()), MAX_CL_VARS);
 
-					//Scan string returned for 'mutate color'.
-					if (strstr(os.str().c_str(), "mutate color"))
-						didColor = true;
+						//Scan string returned for 'mutate color'.
+						if (strstr(os.str().c_str(), "mutate color"))
+							didColor = true;
 
-					if (orig.m_Name != "")
-					{
-						os2.str("");
-						os2 << "mutation " << rep << " of " << orig.m_Name;
-						orig.m_Name = os2.str();
+						if (orig.m_Name != "")
+						{
+							os2.str("");
+							os2 << "mutation " << rep << " of " << orig.m_Name;
+							orig.m_Name = os2.str();
+						}
 					}
-				}
-				else if (doCross0)
-				{
-					i0 = rand.Rand() % embers.size();
-					i1 = rand.Rand() % embers2.size();
-					selp0 = embers[i0];
-					selp1 = embers2[i1];
-					aselp0 = &selp0;
-					aselp1 = &selp1;
-
-					if (opt.Method() == "")
-						crossMeth = CROSS_NOT_SPECIFIED;
-					else if (opt.Method() == "union")
-						crossMeth = CROSS_UNION;
-					else if (opt.Method() == "interpolate")
-						crossMeth = CROSS_INTERPOLATE;
-					else if (opt.Method() == "alternate")
-						crossMeth = CROSS_ALTERNATE;
-					else
+					else if (doCross0)
 					{
-						cerr << "method '" << opt.Method() << "' not defined for cross. Defaulting to random." << endl;
-						crossMeth = CROSS_NOT_SPECIFIED;
-					}
+						i0 = rand.Rand() % embers.size();
+						i1 = rand.Rand() % embers2.size();
+						selp0 = embers[i0];
+						selp1 = embers2[i1];
+						aselp0 = &selp0;
+						aselp1 = &selp1;
+
+						if (opt.Method() == "")
+							crossMeth = CROSS_NOT_SPECIFIED;
+						else if (opt.Method() == "union")
+							crossMeth = CROSS_UNION;
+						else if (opt.Method() == "interpolate")
+							crossMeth = CROSS_INTERPOLATE;
+						else if (opt.Method() == "alternate")
+							crossMeth = CROSS_ALTERNATE;
+						else
+						{
+							cerr << "method '" << opt.Method() << "' not defined for cross. Defaulting to random." << endl;
+							crossMeth = CROSS_NOT_SPECIFIED;
+						}
 
-					tools.Cross(embers[i0], embers2[i1], orig, crossMeth);
+						tools.Cross(embers[i0], embers2[i1], orig, crossMeth);
 
-					if (embers[i0].m_Name != "" || embers2[i1].m_Name != "")
-					{
-						os2.str("");
-						os2 << rep << " of " << embers[i0].m_Name << " x " << embers2[i1].m_Name;
-						orig.m_Name = os2.str();
+						if (embers[i0].m_Name != "" || embers2[i1].m_Name != "")
+						{
+							os2.str("");
+							os2 << rep << " of " << embers[i0].m_Name << " x " << embers2[i1].m_Name;
+							orig.m_Name = os2.str();
+						}
 					}
-				}
-				else
-				{
-					os << "random";
-					randomMode = true;
-					tools.Random(orig, vars, opt.Symmetry(), 0, MAX_CL_VARS);
-					aselp0 = nullptr;
-					aselp1 = nullptr;
-				}
-
-				//Adjust bounding box half the time.
-				if (rand.RandBit() || randomMode)
-				{
-					T bmin[2], bmax[2];
-					tools.EstimateBoundingBox(orig, T(0.01), 100000, bmin, bmax);
-
-					if (rand.Frand01<T>() < T(0.3))
+					else
 					{
-						orig.m_CenterX = (bmin[0] + bmax[0]) / 2;
-						orig.m_CenterY = (bmin[1] + bmax[1]) / 2;
-						os << " recentered";
+						os << "random";
+						randomMode = true;
+						tools.Random(orig, vars, opt.Symmetry(), 0, MAX_CL_VARS);
+						aselp0 = nullptr;
+						aselp1 = nullptr;
 					}
-					else
+
+					//Adjust bounding box half the time.
+					if (rand.RandBit() || randomMode)
 					{
-						if (rand.RandBit())
-						{
-							mix0 = rand.GoldenBit<T>() + rand.Frand11<T>() / 5;
-							mix1 = rand.GoldenBit<T>();
-							os << " reframed0";
-						}
-						else if (rand.RandBit())
+						T bmin[2], bmax[2];
+						tools.EstimateBoundingBox(orig, T(0.01), 100000, bmin, bmax);
+
+						if (rand.Frand01<T>() < T(0.3))
 						{
-							mix0 = rand.GoldenBit<T>();
-							mix1 = rand.GoldenBit<T>() + rand.Frand11<T>() / 5;
-							os << " reframed1";
+							orig.m_CenterX = (bmin[0] + bmax[0]) / 2;
+							orig.m_CenterY = (bmin[1] + bmax[1]) / 2;
+							os << " recentered";
 						}
 						else
 						{
-							mix0 = rand.GoldenBit<T>() + rand.Frand11<T>() / 5;
-							mix1 = rand.GoldenBit<T>() + rand.Frand11<T>() / 5;
-							os << " reframed2";
+							if (rand.RandBit())
+							{
+								mix0 = rand.GoldenBit<T>() + rand.Frand11<T>() / 5;
+								mix1 = rand.GoldenBit<T>();
+								os << " reframed0";
+							}
+							else if (rand.RandBit())
+							{
+								mix0 = rand.GoldenBit<T>();
+								mix1 = rand.GoldenBit<T>() + rand.Frand11<T>() / 5;
+								os << " reframed1";
+							}
+							else
+							{
+								mix0 = rand.GoldenBit<T>() + rand.Frand11<T>() / 5;
+								mix1 = rand.GoldenBit<T>() + rand.Frand11<T>() / 5;
+								os << " reframed2";
+							}
+
+							orig.m_CenterX = mix0 * bmin[0] + (1 - mix0) * bmax[0];
+							orig.m_CenterY = mix1 * bmin[1] + (1 - mix1) * bmax[1];
 						}
 
-						orig.m_CenterX = mix0 * bmin[0] + (1 - mix0) * bmax[0];
-						orig.m_CenterY = mix1 * bmin[1] + (1 - mix1) * bmax[1];
+						orig.m_PixelsPerUnit = orig.m_FinalRasW / (bmax[0] - bmin[0]);
 					}
 
-					orig.m_PixelsPerUnit = orig.m_FinalRasW / (bmax[0] - bmin[0]);
-				}
+					os << tools.TruncateVariations(orig, 5);
 
-				os << tools.TruncateVariations(orig, 5);
+					if (!didColor && rand.RandBit())
+					{
+						if (opt.Debug())
+							cerr << "improving colors..." << endl;
 
-				if (!didColor && rand.RandBit())
-				{
-					if (opt.Debug())
-						cerr << "improving colors..." << endl;
+						tools.ImproveColors(orig, 100, false, 10);
+						os << " improved colors";
+					}
 
-					tools.ImproveColors(orig, 100, false, 10);
-					os << " improved colors";
+					orig.m_Edits = emberToXml.CreateNewEditdoc(aselp0, aselp1, os.str(), opt.Nick(), opt.Url(), opt.Id(), opt.Comment(), opt.SheepGen(), opt.SheepId());
+					saves.push_back(orig);
+					actions.push_back(os.str());
+					SetDefaultTestValues(orig);
+					candidates.push_back(orig);
+					orig.Clear();
 				}
 
-				orig.m_Edits = emberToXml.CreateNewEditdoc(aselp0, aselp1, os.str(), opt.Nick(), opt.Url(), opt.Id(), opt.Comment(), opt.SheepGen(), opt.SheepId());
-				save = orig;
-				SetDefaultTestValues(orig);
-				renderer->SetEmber(orig);
+				//Reject obviously degenerate candidates with a short run of iterations, rather than a test render.
+				//When benchmarking, render them anyway to see whether the pre-screen was right.
+				t.Tic();
 
-				if (renderer->Run(finalImage) != eRenderStatus::RENDER_OK)
+				for (auto& candidate : candidates)
 				{
-					cerr << "Error: test image rendering failed, aborting." << endl;
-					return false;
+					screened.push_back(!opt.PreScreen() && !opt.PreScreenBench() ? true : tools.PreScreen(candidate, T(opt.AvgThresh()), PRESCREEN_SAMPLES, screenStats));
+					results.push_back(screened.back() || opt.PreScreenBench() ? -1 : 0);
+
+					if (opt.Debug() && (opt.PreScreen() || opt.PreScreenBench()))
+						cerr << "prescreen " << (screened.back() ? "accepted" : "rejected") << ": badRate = " << screenStats.m_BadRate << " inView = " << screenStats.m_InView << " spread = " << screenStats.m_Spread
+							 << " occupancy = " << screenStats.m_Occupancy << " entropy = " << screenStats.m_Entropy << endl;
 				}
 
-				tot = totb = totw = 0;
-				n = orig.m_FinalRasW * orig.m_FinalRasH;
+				screenMs += t.Toc();
+				t.Tic();
 
-				for (i = 0; i < 3 * n; i += 3)
+				if (!TestCandidates(opt, testRenderers, candidates, results, opt.PreScreenBench(), passed))
 				{
-					tot += (finalImage[i] + finalImage[i + 1] + finalImage[i + 2]);
-
-					if (0   == finalImage[i] && 0   == finalImage[i + 1] && 0   == finalImage[i + 2]) totb++;
-
-					if (255 == finalImage[i] && 255 == finalImage[i + 1] && 255 == finalImage[i + 2]) totw++;
+					cerr << "Error: test image rendering failed, aborting." << endl;
+					return false;
 				}
 
-				avgPix = (tot / T(3 * n));
-				fractionBlack = totb / T(n);
-				fractionWhite = totw / T(n);
+				testMs += t.Toc();
 
-				if (opt.Debug())
-					cerr << "avgPix = " << avgPix << " fractionBlack = " << fractionBlack << " fractionWhite = " << fractionWhite << " n = " << n << endl;
+				if (opt.PreScreenBench())
+					for (j = 0; j < candidates.size(); j++)
+						if (results[j] != -1)
+							screenCounts[screened[j] ? 1 : 0][results[j]]++;
 
-				orig.Clear();
-				count++;
+				//Keep the one which passed, or the last one tried if none did.
+				i = std::min(passed, candidates.size() - 1);
+				save = saves[i];
+				os.str("");
+				os << actions[i];
+				count += i + 1;
 			}
-			while ((avgPix < opt.AvgThresh() ||
-					fractionBlack < opt.BlackThresh() ||
-					fractionWhite > opt.WhiteLimit()) &&
-					count < opt.Tries());
+			while (passed == candidates.size() && count < opt.Tries());
 
 			if (count == opt.Tries())
 				cerr << "Warning: reached maximum attempts, giving up." << endl;
@@ -744,6 +939,21 @@ bool EmberGenome(EmberOptions& opt)
 	if (opt.Enclosed())
 		cout << "</pick>\n";
 
+	if (opt.PreScreenBench())
+	{
+		size_t rejected = screenCounts[0][0] + screenCounts[0][1];
+		size_t tested = rejected + screenCounts[1][0] + screenCounts[1][1];
+
+		if (tested)
+		{
+			cerr << "Pre-screen benchmark: " << tested << " candidates test rendered, " << rejected << " would have been rejected by the pre-screen.\n";
+			cerr << "\tRejected and failed: " << screenCounts[0][0] << ", rejected but passed: " << screenCounts[0][1] << ".\n";
+			cerr << "\tAccepted and passed: " << screenCounts[1][1] << ", accepted but failed: " << screenCounts[1][0] << ".\n";
+			cerr << "\tAccuracy: " << 100.0 * (screenCounts[0][0] + screenCounts[1][1]) / tested << "%, test renders saved: " << 100.0 * rejected / tested << "%.\n";
+			cerr << "\tPre-screen time: " << t.Format(screenMs) << ", test render time: " << t.Format(testMs) << "." << endl;
+		}
+	}
+
 	return true;
 }
 
@@ -2,6 +2,8 @@
 
 #include "EmberOptions.h"
 
+#define PRESCREEN_SAMPLES 4096//The number of points iterated to pre-screen each candidate flame.
+
 /// <summary>
 /// Declaration for the EmberGenome() and SetDefaultTestValues() functions.
 /// </summary>
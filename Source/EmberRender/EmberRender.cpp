@@ -4,6 +4,201 @@
 
 //template <class OpenCLInfo> weak_ptr<OpenCLInfo> Singleton<OpenCLInfo>::m_Instance = weak_ptr<OpenCLInfo>();
 
+/// <summary>
+/// Find how many flames BatchRender() can render at once within the memory a single render is allowed.
+/// Strips are not used in a batch, so the largest flames must all fit in memory together, along with
+/// the finished images of each which can be waiting in the write queue.
+/// The batch is reduced until they do. If even two don't fit, 1 is returned and the flames should be
+/// rendered one at a time, which can use strips.
+/// Template argument expected to be float or double.
+/// </summary>
+/// <param name="opt">The program options</param>
+/// <param name="embers">The embers to render, already scaled and checked</param>
+/// <param name="renderer">A renderer set up with the program options, used to compute the memory each ember requires</param>
+/// <returns>The number of flames to render at once</returns>
+template <typename T>
+static size_t BatchSize(EmberOptions& opt, vector<Ember<T>>& embers, Renderer<T, float>* renderer)
+{
+	size_t batch = std::min<size_t>(opt.Batch(), embers.size());
+	vector<double> mem;
+	mem.reserve(embers.size());
+
+	for (auto& ember : embers)
+	{
+		renderer->SetEmber(ember);
+		mem.push_back(double(renderer->MemoryRequired(1, true, false).second) + double(renderer->FinalBufferSize() * 2));
+	}
+
+	std::sort(mem.begin(), mem.end(), std::greater<double>());
+
+	while (batch > 1 && CalcStrips(std::accumulate(mem.begin(), mem.begin() + batch, 0.0), double(renderer->MemoryAvailable()), opt.UseMem()) > 1)
+		batch--;
+
+	return batch;
+}
+
+/// <summary>
+/// Render many flames at once, each with its own CPU renderer, for when there are so many small images that the setup
+/// of each render and the poor use of threads on a small image take longer than the iterating.
+/// opt.Batch() renderers each take the next flame from a shared queue, starting with the largest so the smallest
+/// fill in at the end. Each render is given a share of the threads proportional to its iteration count, up to an even share
+/// of opt.ThreadCount() between the renderers. The renderers draw their spatial and density filters from one shared cache,
+/// so each distinct filter is only created once. Images are handed to a writer thread through a bounded queue,
+/// so encoding overlaps with rendering without holding more than a few finished images in memory.
+/// Strips are not used, so the batch size must come from BatchSize(), which ensures the images fit in memory together.
+/// Template argument expected to be float or double.
+/// </summary>
+/// <param name="opt">The program options</param>
+/// <param name="embers">The embers to render, already scaled and checked</param>
+/// <param name="batch">The number of flames to render at once, from BatchSize()</param>
+/// <param name="seed">The seed for the random number generators, optionally empty</param>
+/// <param name="setup">Function which applies the program options to each new renderer</param>
+/// <param name="outputFilename">Function which returns the output filename for the ember at an index</param>
+/// <param name="save">Function which writes an image to disk</param>
+/// <returns>The number of flames which were not rendered successfully.</returns>
+template <typename T>
+static size_t BatchRender(EmberOptions& opt, vector<Ember<T>>& embers, size_t batch, const string& seed,
+						  std::function<void(Renderer<T, float>* r)> setup,
+						  std::function<string(size_t index)> outputFilename,
+						  std::function<bool(vector<byte>& image, const string& filename, const EmberImageComments& comments, size_t w, size_t h, size_t chan)> save)
+{
+	struct ImageWrite
+	{
+		vector<byte> m_Image;
+		string m_Filename;
+		EmberImageComments m_Comments;
+		size_t m_W, m_H, m_Channels;
+	};
+
+	const double itersPerThread = double(1 << 22);//Roughly the number of iterations needed to make starting another thread worthwhile.
+	size_t maxThreads = std::max<size_t>(1, opt.ThreadCount() / batch);
+	size_t maxQueued = batch * 2;
+	bool rendering = true;
+	vector<size_t> order(embers.size());
+	vector<unique_ptr<Renderer<T, float>>> renderers;
+	vector<std::thread> threadVec;
+	std::deque<ImageWrite> writeQueue;
+	std::mutex writeMutex;
+	std::condition_variable writeCv;
+	std::atomic<size_t> next(0), failures(0);
+	Timing t;
+	CriticalSection verboseCs;
+	EmberReport emberReport;
+	auto filters = std::make_shared<FilterCache<float>>();
+	auto iters = [&](size_t index) { return double(embers[index].m_FinalRasW) * double(embers[index].m_FinalRasH) * double(embers[index].m_Quality); };
+
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return iters(a) > iters(b); });
+	cout << "Rendering " << embers.size() << " flames " << batch << " at a time with up to " << maxThreads << " threads each." << endl;
+
+	for (size_t i = 0; i < batch; i++)
+	{
+		unique_ptr<Renderer<T, float>> renderer(CreateRenderer<T>(CPU_RENDERER, vector<pair<size_t, size_t>>(), false, 0, emberReport));
+
+		if (!renderer.get())
+		{
+			cout << "Renderer creation failed, exiting." << endl;
+			return embers.size();
+		}
+
+		setup(renderer.get());
+		renderer->Callback(nullptr);//Progress from several renders at once would be unreadable.
+		renderer->SharedFilters(filters);
+		renderers.push_back(std::move(renderer));
+	}
+
+	std::thread writeThread([&]
+	{
+		std::unique_lock<std::mutex> lock(writeMutex);
+
+		while (true)
+		{
+			writeCv.wait(lock, [&] { return !writeQueue.empty() || !rendering; });
+
+			if (writeQueue.empty())
+				break;
+
+			ImageWrite write = std::move(writeQueue.front());
+			writeQueue.pop_front();
+			writeCv.notify_all();//Wake any renderer waiting for room in the queue.
+			lock.unlock();
+
+			if (!save(write.m_Image, write.m_Filename, write.m_Comments, write.m_W, write.m_H, write.m_Channels))
+				failures++;
+
+			lock.lock();
+		}
+	});
+	auto iterFunc = [&](size_t index)
+	{
+		size_t i;
+		Renderer<T, float>* renderer = renderers[index].get();
+		vector<byte> finalImage;
+
+		while ((i = next.fetch_add(1)) < order.size())
+		{
+			size_t emberIndex = order[i];
+			size_t threads = Clamp<size_t>(size_t(iters(emberIndex) / itersPerThread) + 1, 1, maxThreads);
+			string filename = outputFilename(emberIndex);
+
+			if (renderer->ThreadCount() != threads)
+				renderer->ThreadCount(threads, seed != "" ? seed.c_str() : nullptr);
+
+			renderer->SetEmber(embers[emberIndex]);
+			renderer->PrepFinalAccumVector(finalImage);
+			auto status = renderer->Run(finalImage);
+
+			if ((status != eRenderStatus::RENDER_OK) || renderer->Aborted() || finalImage.empty())
+			{
+				verboseCs.Enter();
+				cout << "Error: rendering " << filename << " failed, skipping to next image." << endl;
+				renderer->DumpErrorReport();
+				verboseCs.Leave();
+				failures++;
+				continue;
+			}
+
+			auto stats = renderer->Stats();
+
+			if (opt.Verbose())
+			{
+				verboseCs.Enter();
+				cout << "Flame " << (i + 1) << "/" << order.size() << ": " << filename << ", " << threads << " threads, render time: " << t.Format(stats.m_RenderMs) << endl;
+				verboseCs.Leave();
+			}
+
+			ImageWrite write = { std::move(finalImage), filename, renderer->ImageComments(stats, opt.PrintEditDepth(), opt.IntPalette(), opt.HexPalette()),
+								 renderer->FinalRasW(), renderer->FinalRasH(), renderer->NumChannels()
+							   };
+			std::unique_lock<std::mutex> lock(writeMutex);
+			writeCv.wait(lock, [&] { return writeQueue.size() < maxQueued; });
+			writeQueue.push_back(std::move(write));
+			writeCv.notify_all();
+			finalImage.clear();//Moved from, so make it valid to reuse.
+		}
+	};
+	threadVec.reserve(renderers.size());
+
+	for (size_t r = 0; r < renderers.size(); r++)
+		threadVec.push_back(std::thread(iterFunc, r));
+
+	for (auto& th : threadVec)
+		if (th.joinable())
+			th.join();
+
+	{
+		std::lock_guard<std::mutex> lock(writeMutex);
+		rendering = false;
+	}
+
+	writeCv.notify_all();
+	writeThread.join();
+	VerbosePrint("Created " << filters->Size() << " filters for " << embers.size() << " flames.");
+	return failures;
+}
+
 /// <summary>
 /// The core of the EmberRender.exe program.
 /// Template argument expected to be float or double.
@@ -27,18 +222,20 @@ bool EmberRender(EmberOptions& opt)
 	}
 
 	Timing t;
-	bool writeSuccess = false;
-	byte* finalImagep;
 	uint padding;
 	size_t i, channels;
 	size_t strips;
 	size_t iterCount;
 	string filename;
+	string checkpointFilename;
+	bool checkpointFileBacked;
+	string seed = opt.IsaacSeed();
 	string inputPath = GetPath(opt.Input());
 	ostringstream os;
 	pair<size_t, size_t> p;
 	vector<Ember<T>> embers;
 	vector<byte> finalImage;
+	vector<string> shardFilenames;
 	EmberStats stats;
 	EmberReport emberReport;
 	EmberImageComments comments;
@@ -68,6 +265,18 @@ bool EmberRender(EmberOptions& opt)
 	if (!ParseEmberFile(parser, opt.Input(), embers))
 		return false;
 
+	if (opt.Shards() > 1)
+	{
+		if (opt.Shard() >= opt.Shards())
+		{
+			cout << "Shard " << opt.Shard() << " must be less than the number of shards " << opt.Shards() << ", exiting." << endl;
+			return false;
+		}
+
+		if (!opt.Merge())//Each shard must iterate different points, so put its index at the front of the seed where it can't be truncated.
+			seed = "shard" + std::to_string(opt.Shard()) + ":" + (seed.empty() ? std::to_string(NowMs()) : seed);
+	}
+
 	if (!opt.EmberCL())
 	{
 		if (opt.ThreadCount() == 0)
@@ -80,7 +289,7 @@ bool EmberRender(EmberOptions& opt)
 			cout << "Using " << opt.ThreadCount() << " manually specified threads." << endl;
 		}
 
-		renderer->ThreadCount(opt.ThreadCount(), opt.IsaacSeed() != "" ? opt.IsaacSeed().c_str() : nullptr);
+		renderer->ThreadCount(opt.ThreadCount(), seed != "" ? seed.c_str() : nullptr);
 	}
 	else
 	{
@@ -151,24 +360,62 @@ bool EmberRender(EmberOptions& opt)
 	//Final setup steps before running.
 	os.imbue(std::locale(""));
 	padding = uint(std::log10(double(embers.size()))) + 1;
-	renderer->EarlyClip(opt.EarlyClip());
-	renderer->YAxisUp(opt.YAxisUp());
-	renderer->LockAccum(opt.LockAccum());
-	renderer->InsertPalette(opt.InsertPalette());
-	renderer->PixelAspectRatio(T(opt.AspectRatio()));
-	renderer->Transparency(opt.Transparency());
-	renderer->NumChannels(channels);
-	renderer->BytesPerChannel(opt.BitsPerChannel() / 8);
-	renderer->Priority(eThreadPriority(Clamp<intmax_t>(intmax_t(opt.Priority()), intmax_t(eThreadPriority::LOWEST), intmax_t(eThreadPriority::HIGHEST))));
-	renderer->Callback(opt.DoProgress() ? progress.get() : nullptr);
+	auto setup = [&](Renderer<T, float>* r)//Also used for the renderers of a batch render.
+	{
+		r->EarlyClip(opt.EarlyClip());
+		r->YAxisUp(opt.YAxisUp());
+		r->LockAccum(opt.LockAccum());
+		r->PrivateHist(opt.PrivateHist());
+		r->TiledDE(opt.TiledDE());
+		r->Tiles(opt.Tiles());
+		r->OutOfCore(opt.OutOfCore());
+		r->OutOfCorePath(opt.OutOfCorePath());
+		r->PackedHist(opt.PackedHist());
+		r->IndexHist(opt.IndexHist());
+		r->InsertPalette(opt.InsertPalette());
+		r->PixelAspectRatio(T(opt.AspectRatio()));
+		r->Transparency(opt.Transparency());
+		r->NumChannels(channels);
+		r->BytesPerChannel(opt.BitsPerChannel() / 8);
+		r->Priority(eThreadPriority(Clamp<intmax_t>(intmax_t(opt.Priority()), intmax_t(eThreadPriority::LOWEST), intmax_t(eThreadPriority::HIGHEST))));
+		r->Callback(opt.DoProgress() ? progress.get() : nullptr);
+	};
+	auto outputFilename = [&](size_t index) -> string
+	{
+		if (!opt.Out().empty())
+			return opt.Out();
+		else if (opt.NameEnable() && !embers[index].m_Name.empty())
+			return inputPath + opt.Prefix() + embers[index].m_Name + opt.Suffix() + "." + opt.Format();
+
+		ostringstream fnstream;
+		fnstream << inputPath << opt.Prefix() << setfill('0') << setw(padding) << index << opt.Suffix() << "." << opt.Format();
+		return fnstream.str();
+	};
+	auto save = [&](vector<byte>& image, const string & imageFilename, const EmberImageComments & imageComments, size_t w, size_t h, size_t chan) -> bool
+	{
+		bool b = false;
+
+		if ((opt.Format() == "jpg" || opt.Format() == "bmp") && chan == 4)
+			RgbaToRgb(image, image, w, h);
+
+		if (opt.Format() == "png")
+			b = WritePng(imageFilename.c_str(), image.data(), w, h, opt.BitsPerChannel() / 8, opt.PngComments(), imageComments, opt.Id(), opt.Url(), opt.Nick());
+		else if (opt.Format() == "jpg")
+			b = WriteJpeg(imageFilename.c_str(), image.data(), w, h, int(opt.JpegQuality()), opt.JpegComments(), imageComments, opt.Id(), opt.Url(), opt.Nick());
+		else if (opt.Format() == "ppm")
+			b = WritePpm(imageFilename.c_str(), image.data(), w, h);
+		else if (opt.Format() == "bmp")
+			b = WriteBmp(imageFilename.c_str(), image.data(), w, h);
+
+		if (!b)
+			cout << "Error writing " << imageFilename << endl;
+
+		return b;
+	};
+	setup(renderer.get());
 
 	for (i = 0; i < embers.size(); i++)
 	{
-		if (opt.Verbose() && embers.size() > 1)
-			cout << "\nFlame = " << i + 1 << "/" << embers.size() << endl;
-		else if (embers.size() > 1)
-			VerbosePrint(endl);
-
 		if (opt.Supersample() > 0)
 			embers[i].m_Supersample = opt.Supersample();
 
@@ -199,11 +446,47 @@ bool EmberRender(EmberOptions& opt)
 			embers[i].m_FinalRasW = 1920;
 			embers[i].m_FinalRasH = 1080;
 		}
+	}
+
+	if (opt.Batch() > 1)
+	{
+		if (!opt.EmberCL() && opt.Shards() <= 1 && opt.Strips() <= 1 && opt.Checkpoint() == 0 && !opt.Resume())
+		{
+			size_t batch = BatchSize<T>(opt, embers, renderer.get());
+
+			if (batch > 1)
+			{
+				if (batch < std::min<size_t>(opt.Batch(), embers.size()))
+					cout << "Reducing the batch to " << batch << " flames so they fit in memory together." << endl;
+
+				if (size_t failed = BatchRender<T>(opt, embers, batch, seed, setup, outputFilename, save))
+					cout << "Error: " << failed << " of " << embers.size() << " flames failed to render or write." << endl;
+
+				t.Toc("\nFinished in: ", true);
+				return true;
+			}
+
+			cout << "The largest flames don't fit in memory together. Rendering one flame at a time." << endl;
+		}
+		else
+			cout << "Batches are only supported by the CPU renderer without strips, shards or checkpoints. Rendering one flame at a time." << endl;
+	}
+
+	for (i = 0; i < embers.size(); i++)
+	{
+		if (opt.Verbose() && embers.size() > 1)
+			cout << "\nFlame = " << i + 1 << "/" << embers.size() << endl;
+		else if (embers.size() > 1)
+			VerbosePrint(endl);
 
 		stats.Clear();
 		renderer->SetEmber(embers[i]);
 		renderer->PrepFinalAccumVector(finalImage);//Must manually call this first because it could be erroneously made smaller due to strips if called inside Renderer::Run().
 
+		//Checkpointing keeps copies of the histogram: two while writing checkpoints, and one while resuming.
+		checkpointFileBacked = false;
+		renderer->CheckpointSnapshots((opt.Checkpoint() > 0 || opt.Resume()) && renderer->RendererType() == CPU_RENDERER ? (opt.Checkpoint() > 0 ? 2 : 1) : 0);
+
 		if (opt.Strips() > 1)
 		{
 			strips = opt.Strips();
@@ -213,6 +496,20 @@ bool EmberRender(EmberOptions& opt)
 			p = renderer->MemoryRequired(1, true, false);//No threaded write for render, only for animate.
 			strips = CalcStrips(double(p.second), double(renderer->MemoryAvailable()), opt.UseMem());
 
+			//Checkpoints aren't supported with strips, so if the copies are what would require them, store the copies in files instead.
+			if (strips > 1 && renderer->CheckpointSnapshots())
+			{
+				renderer->CheckpointSnapshots(0);
+				p = renderer->MemoryRequired(1, true, false);
+
+				if (CalcStrips(double(p.second), double(renderer->MemoryAvailable()), opt.UseMem()) == 1)
+				{
+					strips = 1;
+					checkpointFileBacked = true;
+					VerbosePrint("Storing the histogram copies used for checkpoints in files with specified memory usage of " << opt.UseMem());
+				}
+			}
+
 			if (strips > 1)
 				VerbosePrint("Setting strips to " << strips << " with specified memory usage of " << opt.UseMem());
 		}
@@ -221,6 +518,65 @@ bool EmberRender(EmberOptions& opt)
 		[&](const string & s) { cout << s << endl; }, //Greater than height.
 		[&](const string & s) { cout << s << endl; }, //Mod height != 0.
 		[&](const string & s) { cout << s << endl; }); //Final strips value to be set.
+
+		filename = outputFilename(i);
+
+		//Checkpoints are written next to the output file. They only hold one strip, so aren't used with strips.
+		checkpointFilename = "";
+
+		if (opt.Checkpoint() > 0 || opt.Resume())
+		{
+			if (renderer->RendererType() != CPU_RENDERER)
+				cout << "Checkpoints are only supported by the CPU renderer, disabling." << endl;
+			else if (strips > 1)
+				cout << "Checkpoints are not supported when rendering with strips, disabling." << endl;
+			else
+				checkpointFilename = filename + ".checkpoint";
+		}
+
+		//Shards are written next to the output file too, and must be iterated by the CPU renderer without strips for the same reason.
+		RenderCheckpoint merged;
+
+		if (opt.Shards() > 1)
+		{
+			if (renderer->RendererType() != CPU_RENDERER || strips > 1)
+			{
+				cout << "Shards are only supported by the CPU renderer without strips, skipping." << endl;
+				continue;
+			}
+
+			shardFilenames.clear();
+
+			for (size_t shard = 0; shard < opt.Shards(); shard++)
+				shardFilenames.push_back(filename + ".shard" + std::to_string(shard));
+
+			if (!opt.Merge())
+			{
+				VerbosePrint("Iterating shard " << (opt.Shard() + 1) << "/" << opt.Shards());
+
+				if (ShardRun(renderer.get(), finalImage, opt.Shards(), shardFilenames[opt.Shard()]))
+				{
+					VerbosePrint("Wrote " + shardFilenames[opt.Shard()]);
+				}
+				else
+				{
+					cout << "Error: shard iteration failed, skipping to next image." << endl;
+					renderer->DumpErrorReport();
+				}
+
+				progress->Clear();
+				continue;
+			}
+
+			VerbosePrint("Merging " << opt.Shards() << " shards");
+			merged.m_Hist.Backing(opt.OutOfCore(), opt.OutOfCorePath());
+
+			if (!MergeShards(renderer.get(), embers[i], shardFilenames, merged))
+				continue;
+
+			checkpointFilename = "";//The merged histogram is already complete.
+		}
+
 		//For testing incremental renderer.
 		//int sb = 1;
 		//bool resume = false, success = false;
@@ -255,21 +611,6 @@ bool EmberRender(EmberOptions& opt)
 		//Only write once all strips for this image are finished.
 		[&](Ember<T>& finalEmber)
 		{
-			if (!opt.Out().empty())
-			{
-				filename = opt.Out();
-			}
-			else if (opt.NameEnable() && !finalEmber.m_Name.empty())
-			{
-				filename = inputPath + opt.Prefix() + finalEmber.m_Name + opt.Suffix() + "." + opt.Format();
-			}
-			else
-			{
-				ostringstream fnstream;
-				fnstream << inputPath << opt.Prefix() << setfill('0') << setw(padding) << i << opt.Suffix() << "." << opt.Format();
-				filename = fnstream.str();
-			}
-
 			//TotalIterCount() is actually using ScaledQuality() which does not get reset upon ember assignment,
 			//so it ends up using the correct value for quality * strips.
 			iterCount = renderer->TotalIterCount(1);
@@ -284,25 +625,8 @@ bool EmberRender(EmberOptions& opt)
 			VerbosePrint("Pure iter time: " + t.Format(stats.m_IterMs));
 			VerbosePrint("Iters/sec: " << size_t(stats.m_Iters / (stats.m_IterMs / 1000.0)) << endl);
 			VerbosePrint("Writing " + filename);
-
-			if ((opt.Format() == "jpg" || opt.Format() == "bmp") && renderer->NumChannels() == 4)
-				RgbaToRgb(finalImage, finalImage, renderer->FinalRasW(), renderer->FinalRasH());
-
-			finalImagep = finalImage.data();
-			writeSuccess = false;
-
-			if (opt.Format() == "png")
-				writeSuccess = WritePng(filename.c_str(), finalImagep, finalEmber.m_FinalRasW, finalEmber.m_FinalRasH, opt.BitsPerChannel() / 8, opt.PngComments(), comments, opt.Id(), opt.Url(), opt.Nick());
-			else if (opt.Format() == "jpg")
-				writeSuccess = WriteJpeg(filename.c_str(), finalImagep, finalEmber.m_FinalRasW, finalEmber.m_FinalRasH, int(opt.JpegQuality()), opt.JpegComments(), comments, opt.Id(), opt.Url(), opt.Nick());
-			else if (opt.Format() == "ppm")
-				writeSuccess = WritePpm(filename.c_str(), finalImagep, finalEmber.m_FinalRasW, finalEmber.m_FinalRasH);
-			else if (opt.Format() == "bmp")
-				writeSuccess = WriteBmp(filename.c_str(), finalImagep, finalEmber.m_FinalRasW, finalEmber.m_FinalRasH);
-
-			if (!writeSuccess)
-				cout << "Error writing " << filename << endl;
-		});
+			save(finalImage, filename, comments, finalEmber.m_FinalRasW, finalEmber.m_FinalRasH, renderer->NumChannels());
+		}, checkpointFilename, opt.Checkpoint(), opt.Resume(), checkpointFileBacked);
 
 		if (opt.EmberCL() && opt.DumpKernel())
 		{
@@ -5,6 +5,9 @@
 #include <list>
 #include <deque>
 
+#define CHOOSE_XFORM_GRAIN 16384//The size of the lookup table previously used to select xforms, kept for comparison.
+#define CHOOSE_XFORM_GRAIN_M1 16383//All 1s, so it's logically and-able.
+
 /// <summary>
 /// EmberTester is a scratch area used for on the fly testing.
 /// It may become a more formalized automated testing system
@@ -1303,6 +1306,441 @@ void TestVarTime()
 	//forr (auto& p : times) cout << p.first << "\t" << p.second << "" << endl;
 }
 
+template <typename T>
+bool TestVarsBatch()
+{
+	bool success = true;
+	T tol = T(1e-4);
+	VariationList<T> vl;
+	QTIsaac<ISAAC_SIZE, ISAAC_INT> rand;
+	IteratorHelper<T> helper;
+	IteratorHelperBatch<T> batchHelper;
+	Point<T> points[ITER_BATCH_SIZE];
+	auto close = [&](T a, T b) { return (a != a && b != b) || std::abs(a - b) <= tol * std::max(T(1), std::abs(a)); };
+	batchHelper.m_Count = ITER_BATCH_SIZE;
+
+	for (size_t v = 0; v < vl.RegSize(); v++)
+	{
+		unique_ptr<Variation<T>> var(vl.GetVariationCopy(v, VARTYPE_REG));
+		var->Random(rand);
+		unique_ptr<Variation<T>> batchVar(var->Copy());
+
+		for (size_t i = 0; i < ITER_BATCH_SIZE; i++)
+		{
+			batchHelper.m_InX[i] = batchHelper.m_TransX[i] = rand.Frand<T>(-5, 5);
+			batchHelper.m_InY[i] = batchHelper.m_TransY[i] = rand.Frand<T>(-5, 5);
+			batchHelper.m_InZ[i] = batchHelper.m_TransZ[i] = rand.Frand<T>(-5, 5);
+			batchHelper.m_Color[i] = rand.Frand01<T>();
+			batchHelper.m_PrecalcSumSquares[i] = SQR(batchHelper.m_TransX[i]) + SQR(batchHelper.m_TransY[i]);
+			batchHelper.m_PrecalcSqrtSumSquares[i] = std::sqrt(batchHelper.m_PrecalcSumSquares[i]);
+			batchHelper.m_PrecalcSina[i] = batchHelper.m_TransX[i] / batchHelper.m_PrecalcSqrtSumSquares[i];
+			batchHelper.m_PrecalcCosa[i] = batchHelper.m_TransY[i] / batchHelper.m_PrecalcSqrtSumSquares[i];
+			batchHelper.m_PrecalcAtanxy[i] = atan2(batchHelper.m_TransX[i], batchHelper.m_TransY[i]);
+			batchHelper.m_PrecalcAtanyx[i] = atan2(batchHelper.m_TransY[i], batchHelper.m_TransX[i]);
+			points[i].m_X = batchHelper.m_Points[i].m_X = rand.Frand<T>(-5, 5);
+			points[i].m_Y = batchHelper.m_Points[i].m_Y = rand.Frand<T>(-5, 5);
+			points[i].m_Z = batchHelper.m_Points[i].m_Z = rand.Frand<T>(-5, 5);
+			points[i].m_ColorX = batchHelper.m_Points[i].m_ColorX = batchHelper.m_Color[i];
+		}
+
+		//Both paths must consume the same random values in the same order, so give each an identically seeded context.
+		QTIsaac<ISAAC_SIZE, ISAAC_INT> rand1(ISAAC_INT(v), 2, 3), rand2(ISAAC_INT(v), 2, 3);
+		batchVar->FuncBatch(batchHelper, rand2);
+
+		for (size_t i = 0; i < ITER_BATCH_SIZE; i++)
+		{
+			batchHelper.Load(i);
+			helper = batchHelper.m_Helper;
+			var->Func(helper, points[i], rand1);
+
+			if (!close(helper.Out.x, batchHelper.m_OutX[i]) || !close(helper.Out.y, batchHelper.m_OutY[i]) || !close(helper.Out.z, batchHelper.m_OutZ[i]) ||
+					!close(points[i].m_ColorX, batchHelper.m_Points[i].m_ColorX))
+			{
+				cout << "Variation " << var->Name() << ": lane " << i << " batch result (" << batchHelper.m_OutX[i] << ", " << batchHelper.m_OutY[i] << ", " << batchHelper.m_OutZ[i] <<
+					 ") != scalar result (" << helper.Out.x << ", " << helper.Out.y << ", " << helper.Out.z << ")" << endl;
+				success = false;
+				break;
+			}
+		}
+	}
+
+	return success;
+}
+
+template <typename T>
+bool TestInterpolateInPlace()
+{
+	bool success = true;
+	QTIsaac<ISAAC_SIZE, ISAAC_INT> rand(1, 2, 3);
+	vector<Ember<T>> embers;
+	Interpolater<T> interpolater;
+	Ember<T> inPlaceResult, result;
+
+	//Differing xform counts, a final xform in only some of the embers, and differing palettes,
+	//so alignment has to add xforms and the reused result has to change shape between segments.
+	for (size_t i = 0; i < 5; i++)
+	{
+		Ember<T> ember = CreateBasicEmber<T>(640, 480, 1, T(100), rand.Frand11<T>(), rand.Frand11<T>(), T(i * 30));
+		ember.m_Time = T(i);
+		ember.m_Interp = (i & 1) ? eInterp::EMBER_INTERP_LINEAR : eInterp::EMBER_INTERP_SMOOTH;
+
+		for (size_t x = 0; x < i % 3; x++)
+			ember.DeleteXform(0);
+
+		if (i == 1 || i == 2)
+			ember.SetFinalXform(*ember.GetXform(0));
+
+		for (auto& entry : ember.m_Palette.m_Entries)
+			entry = v4T(rand.Frand01<T>(), rand.Frand01<T>(), rand.Frand01<T>(), 1);
+
+		embers.push_back(ember);
+	}
+
+	//Forward through every segment, then back again, so the kept aligned embers are replaced in both directions.
+	for (size_t pass = 0; pass < 2; pass++)
+	{
+		for (size_t step = 0; step <= 40; step++)
+		{
+			T time = T(pass ? (40 - step) : step) / T(10);
+			interpolater.InterpolateInPlace(embers, time, 0, inPlaceResult);
+			Interpolater<T>::Interpolate(embers, time, 0, result);
+
+			if (inPlaceResult.XformCount() != result.XformCount() ||
+					inPlaceResult.UseFinalXform() != result.UseFinalXform() ||
+					inPlaceResult.m_Palette.Hash() != result.m_Palette.Hash() ||
+					inPlaceResult.Hash() != result.Hash())
+			{
+				cout << "InterpolateInPlace() at time " << time << " differed from Interpolate(): xforms " << inPlaceResult.XformCount() << " vs " << result.XformCount() <<
+					 ", final " << inPlaceResult.UseFinalXform() << " vs " << result.UseFinalXform() <<
+					 ", palette hash " << inPlaceResult.m_Palette.Hash() << " vs " << result.m_Palette.Hash() << endl;
+				success = false;
+			}
+		}
+	}
+
+	return success;
+}
+
+template <typename T>
+bool TestXformsFused()
+{
+	bool success = true;
+	T tol = T(1e-5);
+	VariationList<T> vl;
+	QTIsaac<ISAAC_SIZE, ISAAC_INT> rand(1, 2, 3);
+	eVariationId ids[] = { VAR_LINEAR, VAR_SINUSOIDAL, VAR_SPHERICAL, VAR_JULIA };
+	size_t idCount = sizeof(ids) / sizeof(ids[0]);
+	auto close = [&](T a, T b) { return (a != a && b != b) || std::abs(a - b) <= tol * std::max(T(1), std::abs(a)); };
+
+	//Every ordered combination of one to three distinct variations from the fused list, with and without a post affine.
+	for (size_t combo = 0; combo < idCount * idCount * idCount; combo++)
+	{
+		vector<eVariationId> varIds;
+
+		for (size_t c = combo, n = 0; n < 3; c /= idCount, n++)
+			if ((n == 0 || c) && std::find(varIds.begin(), varIds.end(), ids[c % idCount]) == varIds.end())
+				varIds.push_back(ids[c % idCount]);
+
+		for (size_t post = 0; post < 2; post++)
+		{
+			Xform<T> xform;
+			string names;
+			xform.m_Affine = Affine2D<T>(rand.Frand11<T>(), rand.Frand11<T>(), rand.Frand11<T>(), rand.Frand11<T>(), rand.Frand11<T>(), rand.Frand11<T>());
+
+			if (post)
+				xform.m_Post = Affine2D<T>(rand.Frand11<T>(), rand.Frand11<T>(), rand.Frand11<T>(), rand.Frand11<T>(), rand.Frand11<T>(), rand.Frand11<T>());
+
+			for (auto id : varIds)
+			{
+				xform.AddVariation(vl.GetVariationCopy(id, rand.Frand<T>(T(0.1), T(1))));
+				names += vl.GetVariation(id)->Name() + " ";
+			}
+
+			xform.SetPrecalcFlags();
+
+			if (!xform.Fused())
+			{
+				cout << "Xform with variations " << names << (post ? "and a post affine " : "") << "did not get a fused pipeline." << endl;
+				success = false;
+				continue;
+			}
+
+			for (size_t i = 0; i < 1000; i++)
+			{
+				Point<T> in, out1, out2;
+				in.m_X = rand.Frand<T>(-5, 5);
+				in.m_Y = rand.Frand<T>(-5, 5);
+				in.m_Z = rand.Frand<T>(-5, 5);
+				in.m_ColorX = rand.Frand01<T>();
+				//Julia draws random values, so both paths need identically seeded contexts.
+				QTIsaac<ISAAC_SIZE, ISAAC_INT> rand1(ISAAC_INT(i), 2, 3), rand2(ISAAC_INT(i), 2, 3);
+				bool bad1 = xform.Apply(&in, &out1, rand1);
+				bool bad2 = xform.ApplyGeneric(&in, &out2, rand2);
+
+				if (bad1 != bad2 || !close(out1.m_X, out2.m_X) || !close(out1.m_Y, out2.m_Y) || !close(out1.m_Z, out2.m_Z) ||
+						!close(out1.m_ColorX, out2.m_ColorX) || out1.m_VizAdjusted != out2.m_VizAdjusted)
+				{
+					cout << "Xform with variations " << names << (post ? "and a post affine " : "") << "fused result (" << out1.m_X << ", " << out1.m_Y << ", " << out1.m_Z <<
+						 ") != generic result (" << out2.m_X << ", " << out2.m_Y << ", " << out2.m_Z << ")" << endl;
+					success = false;
+					break;
+				}
+			}
+		}
+	}
+
+	return success;
+}
+
+template <typename T>
+bool TestTiledDE()
+{
+	bool success = true;
+	size_t diffs = 0;
+	int tolerance = 2, maxDiff = 0;
+	vector<byte> rowPixels, tiledPixels;
+	Ember<T> ember = CreateBasicEmber<T>(640, 480, 3, T(50), T(0), T(0), T(0));
+	unique_ptr<Renderer<T, float>> renderer(new Renderer<T, float>());
+	renderer->SetEmber(ember);
+
+	if (renderer->Run(rowPixels) != eRenderStatus::RENDER_OK)
+	{
+		cout << "Rendering with the row based density filter failed." << endl;
+		return false;
+	}
+
+	//Only filtering and final accumulation will be redone, so both images come from the same histogram.
+	renderer->TiledDE(true);
+
+	if (renderer->Run(tiledPixels) != eRenderStatus::RENDER_OK || tiledPixels.size() != rowPixels.size())
+	{
+		cout << "Rendering with the tiled density filter failed." << endl;
+		return false;
+	}
+
+	for (size_t i = 0; i < rowPixels.size(); i++)
+	{
+		int diff = std::abs(int(rowPixels[i]) - int(tiledPixels[i]));
+		maxDiff = std::max(maxDiff, diff);
+
+		if (diff > tolerance)
+			diffs++;
+	}
+
+	if (diffs)
+	{
+		cout << "Tiled density filter differed from the row based one by more than " << tolerance << " in " << diffs << " channels, max diff: " << maxDiff << endl;
+		success = false;
+	}
+
+	return success;
+}
+
+/// <summary>
+/// A Gaussian filter which reports that it's not separable, so final accumulation
+/// resolves it with the tiled 2D gather rather than the two 1D passes.
+/// </summary>
+template <typename T>
+class NonSeparableFilter : public GaussianFilter<T>
+{
+public:
+	NonSeparableFilter(T filterRadius, size_t superSample, T pixelAspectRatio)
+		: GaussianFilter<T>(filterRadius, superSample, pixelAspectRatio) { }
+
+	virtual bool Separable() const override { return false; }
+};
+
+/// <summary>
+/// A renderer which can swap its spatial filter for a NonSeparableFilter with the same parameters.
+/// </summary>
+template <typename T>
+class NonSeparableRenderer : public Renderer<T, float>
+{
+public:
+	void ForceNonSeparable(bool forceNonSeparable)
+	{
+		this->ChangeVal([&]
+		{
+			m_ForceNonSeparable = forceNonSeparable;
+			this->m_SpatialFilter.reset();
+		}, eProcessAction::FILTER_AND_ACCUM);
+	}
+
+	virtual bool CreateSpatialFilter(bool& newAlloc) override
+	{
+		bool b = Renderer<T, float>::CreateSpatialFilter(newAlloc);
+
+		if (b && newAlloc && m_ForceNonSeparable)
+		{
+			auto filter = this->m_SpatialFilter;
+			this->m_SpatialFilter = make_shared<NonSeparableFilter<float>>(filter->FilterRadius(), filter->Supersample(), filter->PixelAspectRatio());
+			this->m_SpatialFilter->Create();
+		}
+
+		return b;
+	}
+
+private:
+	bool m_ForceNonSeparable = false;
+};
+
+template <typename T>
+bool TestNonSeparableFilter()
+{
+	bool success = true;
+	size_t diffs = 0;
+	int tolerance = 1, maxDiff = 0;
+	vector<byte> separablePixels, gatherPixels;
+	Ember<T> ember = CreateBasicEmber<T>(640, 480, 3, T(50), T(0), T(0), T(0));
+	unique_ptr<NonSeparableRenderer<T>> renderer(new NonSeparableRenderer<T>());
+	ember.m_SpatialFilterType = eSpatialFilterType::GAUSSIAN_SPATIAL_FILTER;
+	ember.m_SpatialFilterRadius = T(1.5);
+	renderer->SetEmber(ember);
+
+	if (renderer->Run(separablePixels) != eRenderStatus::RENDER_OK)
+	{
+		cout << "Rendering with the separable spatial filter failed." << endl;
+		return false;
+	}
+
+	//Only filtering and final accumulation will be redone, so both images come from the same histogram.
+	renderer->ForceNonSeparable(true);
+
+	if (renderer->Run(gatherPixels) != eRenderStatus::RENDER_OK || gatherPixels.size() != separablePixels.size())
+	{
+		cout << "Rendering with the non-separable spatial filter failed." << endl;
+		return false;
+	}
+
+	for (size_t i = 0; i < separablePixels.size(); i++)
+	{
+		int diff = std::abs(int(separablePixels[i]) - int(gatherPixels[i]));
+		maxDiff = std::max(maxDiff, diff);
+
+		if (diff > tolerance)
+			diffs++;
+	}
+
+	if (diffs)
+	{
+		cout << "Tiled 2D spatial filter gather differed from the separable passes by more than " << tolerance << " in " << diffs << " channels, max diff: " << maxDiff << endl;
+		success = false;
+	}
+
+	return success;
+}
+
+template <typename T>
+bool TestPackedHist()
+{
+	bool success = true;
+	double floatDiff = 0, packedDiff = 0;
+	vector<byte> floatPixels, floatPixels2, packedPixels;
+	Ember<T> ember = CreateBasicEmber<T>(640, 480, 3, T(100), T(0), T(0), T(0));
+	unique_ptr<Renderer<T, float>> renderer(new Renderer<T, float>());
+	renderer->SetEmber(ember);
+
+	//Each full render continues on from the random state of the previous one, so the difference between two
+	//renders of the floating point histogram gives the amount of noise the packed one is allowed to differ by.
+	if (renderer->Run(floatPixels) != eRenderStatus::RENDER_OK)
+	{
+		cout << "Rendering with the floating point histogram failed." << endl;
+		return false;
+	}
+
+	renderer->PackedHist(false);
+
+	if (renderer->Run(floatPixels2) != eRenderStatus::RENDER_OK || floatPixels2.size() != floatPixels.size())
+	{
+		cout << "Rendering with the floating point histogram a second time failed." << endl;
+		return false;
+	}
+
+	renderer->PackedHist(true);
+
+	if (renderer->Run(packedPixels) != eRenderStatus::RENDER_OK || packedPixels.size() != floatPixels.size())
+	{
+		cout << "Rendering with the packed histogram failed." << endl;
+		return false;
+	}
+
+	for (size_t i = 0; i < floatPixels.size(); i++)
+	{
+		floatDiff += std::abs(int(floatPixels[i]) - int(floatPixels2[i]));
+		packedDiff += std::abs(int(floatPixels[i]) - int(packedPixels[i]));
+	}
+
+	floatDiff /= floatPixels.size();
+	packedDiff /= floatPixels.size();
+
+	if (packedDiff > (floatDiff * 1.5) + 0.1)
+	{
+		cout << "Packed histogram mean channel diff " << packedDiff << " was much larger than the noise between two floating point renders " << floatDiff << endl;
+		success = false;
+	}
+
+	return success;
+}
+
+template <typename T>
+void BenchDensitySAT()
+{
+	Timing t;
+	QTIsaac<ISAAC_SIZE, ISAAC_INT> rand;
+	SummedAreaTable sat;
+
+	for (intmax_t supersample = 2; supersample <= 5; supersample++)
+	{
+		intmax_t ss = supersample / 2;
+		intmax_t width = 1280 * supersample, height = 720 * supersample;
+		vector<tvec4<T, glm::defaultp>> buckets(width * height);
+		double loopSum = 0, satSum = 0, loopTime, satTime;
+
+		for (auto& bucket : buckets)
+			bucket.a = rand.Frand01<T>() < T(0.3) ? T(rand.Rand(100)) : T(0);
+
+		t.Tic();
+
+		for (intmax_t j = 0; j < height; j++)
+		{
+			for (intmax_t i = 0; i < width; i++)
+			{
+				if (buckets[i + (j * width)].a == 0)
+					continue;
+
+				T filterSelect = 0;
+
+				for (intmax_t jj = j - std::min(j, ss); jj <= j + std::min(ss, height - j - 1); jj++)
+					for (intmax_t ii = i - std::min(i, ss); ii <= i + std::min(ss, width - i - 1); ii++)
+						filterSelect += buckets[ii + (jj * width)].a;
+
+				loopSum += filterSelect;
+			}
+		}
+
+		loopTime = t.Toc();
+		t.Tic();
+		sat.Build([&](size_t i) { return buckets[i].a; }, width, 0, height, 1e6);
+
+		for (intmax_t j = 0; j < height; j++)
+		{
+			for (intmax_t i = 0; i < width; i++)
+			{
+				if (buckets[i + (j * width)].a == 0)
+					continue;
+
+				satSum += sat.Sum(i - std::min(i, ss), j - std::min(j, ss), i + std::min(ss, width - i - 1), j + std::min(ss, height - j - 1));
+			}
+		}
+
+		satTime = t.Toc();
+		cout << "Supersample " << supersample << " (" << width << "x" << height << "): box loop " << loopTime << "ms, summed-area table " << satTime << "ms, speedup " << (loopTime / satTime) << "x" << endl;
+
+		if (std::abs(loopSum - satSum) > 1e-6 * loopSum)
+			cout << "Supersample " << supersample << ": box loop total " << loopSum << " != summed-area table total " << satSum << endl;
+	}
+}
+
 void TestCasting()
 {
 	vector<string> stringVec;
@@ -1864,6 +2302,292 @@ void TestThreadedKernel()
 	}
 }
 
+/// <summary>
+/// Exposes the alias table lookup of the iterator for benchmarking.
+/// </summary>
+template <typename T>
+class XformSelectIterator : public StandardIterator<T>
+{
+public:
+	using Iterator<T>::NextXformFromIndex;
+};
+
+template <typename T>
+void BenchXformSelection()
+{
+	Timing t;
+	QTIsaac<ISAAC_SIZE, ISAAC_INT> rand(1, 2, 3);
+	size_t iters = 1024 * 1024 * 64;
+
+	for (size_t xformCount : { 4, 32, 200 })
+	{
+		for (bool xaos : { false, true })
+		{
+			Ember<T> ember;
+			XformSelectIterator<T> iterator;
+			size_t distribCount = xaos ? xformCount + 1 : 1, last = 0, checksum = 0;
+			vector<byte> table(CHOOSE_XFORM_GRAIN * distribCount);
+			vector<size_t> tableCounts(xformCount), aliasCounts(xformCount);
+			double tableTime, aliasTime, tableError = 0, aliasError = 0, totalWeight = 0;
+
+			for (size_t i = 0; i < xformCount; i++)
+			{
+				Xform<T> xform;
+				xform.m_Weight = rand.Frand01<T>() + T(0.01);
+				totalWeight += xform.m_Weight;
+				ember.AddXform(xform);
+			}
+
+			if (xaos)
+				for (size_t i = 0; i < xformCount; i++)
+					for (size_t j = 0; j < xformCount; j++)
+						ember.GetXform(i)->SetXaos(j, rand.Frand01<T>() < T(0.25) ? T(0) : rand.Frand01<T>());
+
+			//The lookup table previously used, where each xform is assigned a number of elements proportional to its weight.
+			for (size_t distrib = 0; distrib < distribCount; distrib++)
+			{
+				double total = 0, running = 0;
+				vector<double> weights(xformCount);
+
+				for (size_t i = 0; i < xformCount; i++)
+					total += (weights[i] = ember.GetXform(i)->m_Weight * (distrib > 0 ? ember.GetXform(distrib - 1)->Xaos(i) : T(1)));
+
+				for (size_t i = 0, j = 0; j < CHOOSE_XFORM_GRAIN; j++)
+				{
+					while (i < xformCount - 1 && running + weights[i] <= (j + 0.5) * total / CHOOSE_XFORM_GRAIN)
+						running += weights[i++];
+
+					table[(distrib * CHOOSE_XFORM_GRAIN) + j] = byte(i);
+				}
+			}
+
+			iterator.InitDistributions(ember);
+			t.Tic();
+
+			for (size_t i = 0; i < iters; i++)
+			{
+				last = table[(rand.Rand() & CHOOSE_XFORM_GRAIN_M1) + (xaos ? CHOOSE_XFORM_GRAIN * (last + 1) : 0)];
+				tableCounts[last]++;
+			}
+
+			tableTime = t.Toc();
+			last = 0;
+			t.Tic();
+
+			for (size_t i = 0; i < iters; i++)
+			{
+				last = iterator.NextXformFromIndex(rand.Rand(), xaos ? last + 1 : 0);
+				aliasCounts[last]++;
+			}
+
+			aliasTime = t.Toc();
+
+			//Without xaos, the frequency each xform was selected with should match its normalized weight.
+			for (size_t i = 0; i < xformCount; i++)
+			{
+				double expected = xaos ? 0 : ember.GetXform(i)->m_Weight / totalWeight;
+				tableError = std::max(tableError, std::abs((double(tableCounts[i]) / iters) - expected));
+				aliasError = std::max(aliasError, std::abs((double(aliasCounts[i]) / iters) - expected));
+				checksum += tableCounts[i] + aliasCounts[i];
+			}
+
+			cout << xformCount << " xforms" << (xaos ? " with xaos" : "") << ": table " << tableTime << "ms (" << table.size() << " bytes), alias " << aliasTime << "ms (" << iterator.XformDistributionsSize() << " bytes), speedup " << (tableTime / aliasTime) << "x";
+
+			if (!xaos)
+				cout << ", max frequency error table " << tableError << " alias " << aliasError;
+
+			cout << " (" << checksum << ")" << endl;
+		}
+	}
+}
+
+template <typename T>
+void BenchVariationLookup()
+{
+	Timing t;
+	VariationList<T> varList;
+	size_t rounds = 200, linearFound = 0, indexFound = 0;
+	vector<string> names, paramNames;
+	vector<eVariationId> ids;
+	double linearTime, indexTime;
+
+	for (size_t i = 0; i < varList.Size(); i++)
+	{
+		auto var = varList.GetVariation(i);
+		names.push_back(ToUpper(var->Name()));//Upper case to ensure the lookups ignore case.
+		ids.push_back(var->VariationId());
+
+		if (auto parVar = dynamic_cast<const ParametricVariation<T>*>(var))
+			for (size_t j = 0; j < parVar->ParamCount(); j++)
+				paramNames.push_back(parVar->Params()[j].Name());
+	}
+
+	//Names.
+	t.Tic();
+
+	for (size_t r = 0; r < rounds; r++)
+		for (auto& name : names)
+			for (size_t i = 0; i < varList.Size(); i++)
+				if (!_stricmp(name.c_str(), varList.GetVariation(i)->Name().c_str()))
+				{
+					linearFound += i;
+					break;
+				}
+
+	linearTime = t.Toc();
+	t.Tic();
+
+	for (size_t r = 0; r < rounds; r++)
+		for (auto& name : names)
+			indexFound += size_t(varList.GetVariationIndex(name));
+
+	indexTime = t.Toc();
+	cout << names.size() << " variation names: scan " << linearTime << "ms, index " << indexTime << "ms, speedup " << (linearTime / indexTime) << "x" << (linearFound == indexFound ? "" : " MISMATCH") << endl;
+	//IDs.
+	linearFound = indexFound = 0;
+	t.Tic();
+
+	for (size_t r = 0; r < rounds; r++)
+		for (auto id : ids)
+			for (size_t i = 0; i < varList.Size(); i++)
+				if (varList.GetVariation(i)->VariationId() == id)
+				{
+					linearFound += i;
+					break;
+				}
+
+	linearTime = t.Toc();
+	t.Tic();
+
+	for (size_t r = 0; r < rounds; r++)
+		for (auto id : ids)
+			indexFound += size_t(varList.GetVariation(id)->VariationId());
+
+	indexTime = t.Toc();
+	cout << ids.size() << " variation IDs: scan " << linearTime << "ms, index " << indexTime << "ms, speedup " << (linearTime / indexTime) << "x" << (linearFound == indexFound ? "" : " MISMATCH") << endl;
+	//Params, searching each parametric variation for the name the way the Xml parser did.
+	linearFound = indexFound = 0;
+	t.Tic();
+
+	for (size_t r = 0; r < rounds; r++)
+		for (auto& paramName : paramNames)
+			for (size_t i = 0; i < varList.ParametricSize(); i++)
+				if (varList.GetParametricVariation(i)->GetParam(paramName.c_str()))
+				{
+					linearFound += size_t(varList.GetParametricVariation(i)->VariationId());
+					break;
+				}
+
+	linearTime = t.Toc();
+	t.Tic();
+
+	for (size_t r = 0; r < rounds; r++)
+	{
+		for (auto& paramName : paramNames)
+		{
+			size_t paramIndex = 0;
+
+			if (auto parVar = varList.GetParametricVariationByParam(paramName, paramIndex))
+				indexFound += size_t(parVar->VariationId());
+		}
+	}
+
+	indexTime = t.Toc();
+	cout << paramNames.size() << " param names: scan " << linearTime << "ms, index " << indexTime << "ms, speedup " << (linearTime / indexTime) << "x" << (linearFound == indexFound ? "" : " MISMATCH") << endl;
+}
+
+template <typename T>
+void BenchBinaryEmbers()
+{
+	Timing t;
+	QTIsaac<ISAAC_SIZE, ISAAC_INT> rand(1, 2, 3);
+	VariationList<T> varList;
+	EmberToXml<T> xmlWriter;
+	XmlToEmber<T> xmlParser;
+	EmberToBinary<T> binaryWriter;
+	BinaryToEmber<T> binaryParser;
+	PaletteList<T> paletteList;
+	vector<Ember<T>> embers, xmlEmbers, binaryEmbers;
+	string xmlFilename = "./bench.flame", binaryFilename = string("./bench") + BINARY_EMBER_EXTENSION;
+	size_t count = 10000;
+	double xmlSaveTime, xmlParseTime, binarySaveTime, binaryParseTime;
+	auto checksum = [&](vector<Ember<T>>& v)
+	{
+		double sum = 0;
+
+		for (auto& ember : v)
+		{
+			sum += ember.m_CenterX + ember.m_PixelsPerUnit + ember.m_Palette.m_Entries[1].r;
+
+			for (size_t i = 0; i < ember.TotalXformCount(); i++)
+			{
+				auto xform = ember.GetTotalXform(i);
+				sum += xform->m_Weight + xform->m_Affine.A() + xform->m_Post.F() + xform->TotalVariationCount();
+
+				for (size_t j = 0; j < xform->TotalVariationCount(); j++)
+					if (auto parVar = dynamic_cast<ParametricVariation<T>*>(xform->GetVariation(j)))
+						for (size_t k = 0; k < parVar->ParamCount(); k++)
+							if (!parVar->Params()[k].IsPrecalc())
+								sum += parVar->Params()[k].ParamVal();
+			}
+		}
+
+		return sum;
+	};
+
+	paletteList.Add("flam3-palettes.xml");//The Xml parser requires the palettes to be loaded.
+
+	for (size_t e = 0; e < count; e++)
+	{
+		Ember<T> ember;
+		ember.m_Name = "bench" + std::to_string(e);
+		ember.m_Time = T(e);
+		ember.m_CenterX = rand.Frand11<T>();
+		ember.m_PixelsPerUnit = rand.Frand<T>(100, 300);
+
+		for (size_t i = 0, xformCount = 2 + rand.Rand(6); i < xformCount; i++)
+		{
+			Xform<T> xform;
+			xform.m_Weight = rand.Frand01<T>() + T(0.01);
+			xform.m_Affine.A(rand.Frand11<T>());
+			xform.m_Post.F(rand.Frand11<T>());
+
+			for (size_t j = 0; j < 2; j++)
+			{
+				Variation<T>* var = varList.GetVariationCopy(rand.Rand(varList.RegSize()), VARTYPE_REG, rand.Frand01<T>());
+				var->Random(rand);
+
+				if (!xform.AddVariation(var))
+					delete var;
+			}
+
+			ember.AddXform(xform);
+		}
+
+		for (auto& entry : ember.m_Palette.m_Entries)
+			entry = v4T(rand.Frand01<T>(), rand.Frand01<T>(), rand.Frand01<T>(), 1);
+
+		embers.push_back(ember);
+	}
+
+	t.Tic();
+	xmlWriter.Save(xmlFilename, embers, 0, false, false, true);
+	xmlSaveTime = t.Toc();
+	t.Tic();
+	xmlParser.Parse(xmlFilename.c_str(), xmlEmbers);
+	xmlParseTime = t.Toc();
+	t.Tic();
+	binaryWriter.Save(binaryFilename, embers, false);
+	binarySaveTime = t.Toc();
+	t.Tic();
+	binaryParser.Parse(binaryFilename.c_str(), binaryEmbers);
+	binaryParseTime = t.Toc();
+	cout << count << " flames: xml save " << xmlSaveTime << "ms parse " << xmlParseTime << "ms, binary save " << binarySaveTime << "ms parse " << binaryParseTime << "ms, parse speedup " << (xmlParseTime / binaryParseTime) << "x" << endl;
+	cout << "Checksums: original " << checksum(embers) << ", xml " << checksum(xmlEmbers) << ", binary " << checksum(binaryEmbers) << (binaryEmbers.size() == count && checksum(binaryEmbers) == checksum(embers) ? "" : " MISMATCH") << endl;
+	remove(xmlFilename.c_str());
+	remove(binaryFilename.c_str());
+}
+
 template <typename T>
 void DistribTester()
 {
@@ -2143,6 +2867,51 @@ int _tmain(int argc, _TCHAR* argv[])
 	    t.Toc("TestVarTime()");
 	*/
 	t.Tic();
+	TestVarsBatch<float>();
+	t.Toc("TestVarsBatch<float>()");
+#ifdef DO_DOUBLE
+	t.Tic();
+	TestVarsBatch<double>();
+	t.Toc("TestVarsBatch<double>()");
+#endif
+	t.Tic();
+	TestInterpolateInPlace<float>();
+	t.Toc("TestInterpolateInPlace<float>()");
+#ifdef DO_DOUBLE
+	t.Tic();
+	TestInterpolateInPlace<double>();
+	t.Toc("TestInterpolateInPlace<double>()");
+#endif
+	t.Tic();
+	TestXformsFused<float>();
+	t.Toc("TestXformsFused<float>()");
+#ifdef DO_DOUBLE
+	t.Tic();
+	TestXformsFused<double>();
+	t.Toc("TestXformsFused<double>()");
+#endif
+	t.Tic();
+	TestTiledDE<float>();
+	t.Toc("TestTiledDE<float>()");
+	t.Tic();
+	TestNonSeparableFilter<float>();
+	t.Toc("TestNonSeparableFilter<float>()");
+	t.Tic();
+	TestPackedHist<float>();
+	t.Toc("TestPackedHist<float>()");
+	//t.Tic();
+	//BenchDensitySAT<float>();
+	//t.Toc("BenchDensitySAT<float>()");
+	//t.Tic();
+	//BenchXformSelection<float>();
+	//t.Toc("BenchXformSelection<float>()");
+	//t.Tic();
+	//BenchVariationLookup<float>();
+	//t.Toc("BenchVariationLookup<float>()");
+	//t.Tic();
+	//BenchBinaryEmbers<float>();
+	//t.Toc("BenchBinaryEmbers<float>()");
+	t.Tic();
 	TestOperations<float>();
 	t.Toc("TestOperations()");
 	//t.Tic();
@@ -22,6 +22,7 @@ public:
 	explicit EmberTreeWidgetItemBase(QTreeWidget* p = 0)
 		: QTreeWidgetItem(p)
 	{
+		m_HasPreview = false;
 	}
 
 	/// <summary>
@@ -32,6 +33,7 @@ public:
 	explicit EmberTreeWidgetItemBase(QTreeWidgetItem* p = 0)
 		: QTreeWidgetItem(p)
 	{
+		m_HasPreview = false;
 	}
 	
 	/// <summary>
@@ -40,7 +42,8 @@ public:
 	/// <param name="v">The vector containing the RGB pixels [0..255] which will make up the preview image</param>
 	/// <param name="width">The width of the image in pixels</param>
 	/// <param name="height">The height of the image in pixels</param>
-	void SetImage(vector<byte>& v, uint width, uint height)
+	/// <param name="preview">True if the image is a rendered preview, false if it's a placeholder. Default: true.</param>
+	void SetImage(vector<byte>& v, uint width, uint height, bool preview = true)
 	{
 		int size = 64;
 
@@ -48,9 +51,16 @@ public:
 		memcpy(m_Image.scanLine(0), v.data(), v.size() * sizeof(v[0]));//Memcpy the data in.
 		m_Pixmap = QPixmap::fromImage(m_Image).scaled(QSize(size, size), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);//Create a QPixmap out of the QImage, scaled to size.
 		setData(0, Qt::DecorationRole, m_Pixmap);
+		m_HasPreview = preview;
 	}
 
+	/// <summary>
+	/// Whether the image currently shown is a rendered preview, rather than a placeholder.
+	/// </summary>
+	bool HasPreview() const { return m_HasPreview; }
+
 protected:
+	bool m_HasPreview;
 	QImage m_Image;
 	QPixmap m_Pixmap;
 };
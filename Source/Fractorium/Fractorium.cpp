@@ -46,6 +46,7 @@ Fractorium::Fractorium(QWidget* p)
 	m_PaletteSortMode = 0;//Sort by palette ascending by default.
 	m_ColorDialog = new QColorDialog(this);
 	m_Settings = new FractoriumSettings(this);
+	m_ThumbnailCache = unique_ptr<ThumbnailCache>(new ThumbnailCache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails.pack"));
 	m_QssDialog = new QssDialog(this);
 	m_FileDialog = nullptr;//Use lazy instantiation upon first use.
 	m_FolderDialog = nullptr;
@@ -4,6 +4,7 @@
 #include "FractoriumCommon.h"
 #include "GLWidget.h"
 #include "EmberTreeWidgetItem.h"
+#include "ThumbnailCache.h"
 #include "VariationTreeWidgetItem.h"
 #include "StealthComboBox.h"
 #include "TableWidget.h"
@@ -154,6 +155,7 @@ public slots:
 	void OnEmberTreeItemChanged(QTreeWidgetItem* item, int col);
 	void OnEmberTreeItemDoubleClicked(QTreeWidgetItem* item, int col);
 	void OnDelete(const pair<size_t, QTreeWidgetItem*>& p);
+	void OnLibraryTreeScrolled(int value);
 
 	//Params.
 	void OnBrightnessChanged(double d);//Color.
@@ -290,7 +292,7 @@ public slots:
 	void ShowCritical(const QString& title, const QString& text, bool invokeRequired = false);
 
 	//Can't have a template function be a slot.
-	void SetLibraryTreeItemData(EmberTreeWidgetItemBase* item, vector<byte>& v, uint w, uint h);
+	void SetLibraryTreeItemData();
 
 public:
 	//template<typename spinType, typename valType>//See below.
@@ -500,6 +502,7 @@ private:
 	int m_PaletteSortMode;
 	int m_PreviousPaletteRow;
 	shared_ptr<OpenCLInfo> m_Info;
+	unique_ptr<ThumbnailCache> m_ThumbnailCache;//Must be declared before the controller so it outlives it.
 	unique_ptr<FractoriumEmberControllerBase> m_Controller;
 	Ui::FractoriumClass ui;
 };
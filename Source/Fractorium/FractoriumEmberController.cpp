@@ -13,6 +13,7 @@ FractoriumEmberControllerBase::FractoriumEmberControllerBase(Fractorium* fractor
 	Timing t;
 	m_Rendering = false;
 	m_Shared = true;
+	m_ForceProcessAction = false;
 	m_FailedRenders = 0;
 	m_UndoIndex = 0;
 	m_RenderType = CPU_RENDERER;
@@ -65,11 +66,25 @@ FractoriumEmberController<T>::FractoriumEmberController(Fractorium* fractorium)
 {
 	m_PreviewRun = false;
 	m_PreviewRunning = false;
+	m_PreviewAccepting = false;
+	m_PreviewWorkersActive = 0;
+	m_PreviewVisibleStart = 0;
+	m_PreviewVisibleEnd = 0;
 	m_SheepTools = unique_ptr<SheepTools<T, float>>(new SheepTools<T, float>(
 					   QString(QApplication::applicationDirPath() + "flam3-palettes.xml").toLocal8Bit().data(),
 					   new EmberNs::Renderer<T, float>()));
 	m_GLController = unique_ptr<GLEmberController<T>>(new GLEmberController<T>(fractorium, fractorium->ui.GLDisplay, this));
-	m_PreviewRenderer = unique_ptr<EmberNs::Renderer<T, float>>(new EmberNs::Renderer<T, float>());
+	//Previews are small and low quality, so most of the time spent rendering one is in setup which doesn't benefit from more threads.
+	//Instead, render several at once with a few threads each. Leave one processor free so the GUI can breathe.
+	size_t cpus = std::max(1u, Timing::ProcessorCount() - 1);
+	size_t rendererCount = std::min<size_t>(cpus, MAX_PREVIEW_RENDERERS);
+	uint threadsPerRenderer = uint(std::min<size_t>(2, std::max<size_t>(1, cpus / rendererCount)));
+
+	for (size_t i = 0; i < rendererCount; i++)
+		m_PreviewRenderers.push_back(unique_ptr<EmberNs::Renderer<T, float>>(new EmberNs::Renderer<T, float>()));
+
+	m_PreviewWorkerIndex.resize(rendererCount, SIZE_MAX);
+	m_PreviewWorkerCanceled.resize(rendererCount, false);
 
 	//Initial combo change event to fill the palette table will be called automatically later.
 
@@ -85,63 +100,59 @@ FractoriumEmberController<T>::FractoriumEmberController(Fractorium* fractorium)
 
 	BackgroundChanged(QColor(0, 0, 0));//Default to black.
 	ClearUndo();
-	m_PreviewRenderer->Callback(nullptr);
-	m_PreviewRenderer->NumChannels(4);
-	m_PreviewRenderer->EarlyClip(m_Fractorium->m_Settings->EarlyClip());
-	m_PreviewRenderer->YAxisUp(m_Fractorium->m_Settings->YAxisUp());
-	m_PreviewRenderer->SetEmber(m_Ember);//Give it an initial ember, will be updated many times later.
-	//m_PreviewRenderer->ThreadCount(1);//For debugging.
-	m_PreviewRenderFunc = [&](uint start, uint end)
+
+	for (auto& renderer : m_PreviewRenderers)
 	{
-		while (m_PreviewRun || m_PreviewRunning)
-		{
-		}
+		renderer->Callback(nullptr);
+		renderer->NumChannels(4);
+		renderer->EarlyClip(m_Fractorium->m_Settings->EarlyClip());
+		renderer->YAxisUp(m_Fractorium->m_Settings->YAxisUp());
+		renderer->ThreadCount(threadsPerRenderer);
+		renderer->SetEmber(m_Ember);//Give it an initial ember, will be updated many times later.
+	}
+
+	m_PreviewRenderFunc = [&]()
+	{
+		vector<std::thread> threadVec;
+		bool done = false;
 
-		m_PreviewRun = true;
-		m_PreviewRunning = true;
-		m_PreviewRenderer->ThreadCount(std::max(1u, Timing::ProcessorCount() - 1));//Leave one processor free so the GUI can breathe.
-		QTreeWidget* tree = m_Fractorium->ui.LibraryTree;
+		for (size_t i = 0; i < m_PreviewRenderers.size(); i++)
+			threadVec.push_back(std::thread([&, i]() { PreviewWorker(i); }));
 
-		if (QTreeWidgetItem* top = tree->topLevelItem(0))
+		//Post the finished previews to the tree in batches, rather than sending an event for each one.
+		while (!done)
 		{
-			for (size_t i = start; m_PreviewRun && i < end && i < m_EmberFile.Size(); i++)
+			bool ready;
+
 			{
-				Ember<T> ember = m_EmberFile.m_Embers[i];
-				ember.SyncSize();
-				ember.SetSizeAndAdjustScale(PREVIEW_SIZE, PREVIEW_SIZE, false, eScaleType::SCALE_WIDTH);
-				ember.m_TemporalSamples = 1;
-				ember.m_Quality = 25;
-				ember.m_Supersample = 1;
-				m_PreviewRenderer->SetEmber(ember);
-
-				if (m_PreviewRenderer->Run(m_PreviewFinalImage) == eRenderStatus::RENDER_OK)
-				{
-					if (EmberTreeWidgetItem<T>* treeItem = dynamic_cast<EmberTreeWidgetItem<T>*>(top->child(i)))
-					{
-						//It is critical that Qt::BlockingQueuedConnection is passed because this is running on a different thread than the UI.
-						//This ensures the events are processed in order as each preview is updated, and that control does not return here
-						//until the update is complete.
-						QMetaObject::invokeMethod(m_Fractorium, "SetLibraryTreeItemData", Qt::BlockingQueuedConnection,
-												  Q_ARG(EmberTreeWidgetItemBase*, dynamic_cast<EmberTreeWidgetItemBase*>(treeItem)),
-												  Q_ARG(vector<byte>&, m_PreviewFinalImage),
-												  Q_ARG(uint, PREVIEW_SIZE),
-												  Q_ARG(uint, PREVIEW_SIZE));
-						//treeItem->SetImage(m_PreviewFinalImage, PREVIEW_SIZE, PREVIEW_SIZE);
-					}
-				}
+				std::unique_lock<std::mutex> lock(m_PreviewCs);
+				m_PreviewCv.wait_for(lock, std::chrono::milliseconds(PREVIEW_BATCH_MS), [&]() { return m_PreviewDoneIndices.size() >= PREVIEW_BATCH_SIZE || !m_PreviewWorkersActive; });
+				ready = !m_PreviewDoneIndices.empty();
+				done = !m_PreviewWorkersActive && (!ready || !m_PreviewRun);
 			}
+
+			//It is critical that Qt::BlockingQueuedConnection is passed because this is running on a different thread than the UI.
+			//This ensures the events are processed in order as each batch of previews is updated, and that control does not return here
+			//until the update is complete.
+			//The GUI thread takes the batch itself, so the indices can't be changed by a deletion while the event is queued.
+			if (ready)
+				QMetaObject::invokeMethod(m_Fractorium, "SetLibraryTreeItemData", Qt::BlockingQueuedConnection);
 		}
 
+		for (auto& th : threadVec)
+			th.join();
+
+		m_Fractorium->m_ThumbnailCache->Flush();//Persist whatever was rendered, even if stopped early.
 		m_PreviewRun = false;
 		m_PreviewRunning = false;
 	};
 }
 
 /// <summary>
-/// Empty destructor that does nothing.
+/// Destructor which stops the preview workers, since they reference this object.
 /// </summary>
 template <typename T>
-FractoriumEmberController<T>::~FractoriumEmberController() { }
+FractoriumEmberController<T>::~FractoriumEmberController() { StopPreviewRender(); }
 
 /// <summary>
 /// Setters for embers, ember files and palettes which convert between float and double types.
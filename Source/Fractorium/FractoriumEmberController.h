@@ -24,6 +24,9 @@ enum eXformUpdate : uint { UPDATE_CURRENT, UPDATE_SELECTED, UPDATE_SELECTED_EXCE
 /// </summary>
 class Fractorium;
 #define PREVIEW_SIZE 256
+#define MAX_PREVIEW_RENDERERS 8
+#define PREVIEW_BATCH_SIZE 16
+#define PREVIEW_BATCH_MS 100
 #define UNDO_SIZE 128
 
 /// <summary>
@@ -115,6 +118,8 @@ public:
 	virtual void EmberTreeItemDoubleClicked(QTreeWidgetItem* item, int col) { }
 	virtual void RenderPreviews(uint start = UINT_MAX, uint end = UINT_MAX) { }
 	virtual void StopPreviewRender() { }
+	virtual void LoadVisiblePreviews() { }
+	virtual void SetFinishedPreviews() { }
 	virtual void Delete(const pair<size_t, QTreeWidgetItem*>& p) { }
 
 	//Params.
@@ -219,7 +224,7 @@ public:
 	void StopRenderTimer(bool wait);
 	void ClearFinalImages();
 	void Shutdown();
-	void UpdateRender(eProcessAction action = eProcessAction::FULL_RENDER);
+	void UpdateRender(eProcessAction action = eProcessAction::FULL_RENDER, bool force = false);
 	void DeleteRenderer();
 	void SaveCurrentRender(const QString& filename, const EmberImageComments& comments, vector<byte>& pixels, size_t width, size_t height, size_t channels, size_t bpc);
 	RendererBase* Renderer() { return m_Renderer.get(); }
@@ -229,14 +234,15 @@ public:
 
 protected:
 	//Rendering/progress.
-	void AddProcessAction(eProcessAction action);
-	eProcessAction CondenseAndClearProcessActions();
+	void AddProcessAction(eProcessAction action, bool force = false);
+	eProcessAction CondenseAndClearProcessActions(bool& force);
 	eProcessState ProcessState() { return m_Renderer.get() ? m_Renderer->ProcessState() : eProcessState::NONE; }
 
 	//Non-templated members.
 	bool m_Rendering;
 	bool m_Shared;
 	bool m_LastEditWasUndoRedo;
+	bool m_ForceProcessAction;
 	vector<pair<size_t, size_t>> m_Devices;
 	uint m_SubBatchCount;
 	uint m_FailedRenders;
@@ -352,6 +358,8 @@ public:
 	virtual void EmberTreeItemDoubleClicked(QTreeWidgetItem* item, int col) override;
 	virtual void RenderPreviews(uint start = UINT_MAX, uint end = UINT_MAX) override;
 	virtual void StopPreviewRender() override;
+	virtual void LoadVisiblePreviews() override;
+	virtual void SetFinishedPreviews() override;
 
 	//Params.
 	virtual void SetCenter(double x, double y) override;
@@ -475,6 +483,12 @@ private:
 	bool XformCheckboxAt(Xform<T>* xform, std::function<void(QCheckBox*)> func);
 	void UpdateXform(std::function<void(Xform<T>*)> func, eXformUpdate updateType = eXformUpdate::UPDATE_CURRENT, bool updateRender = true, eProcessAction action = eProcessAction::FULL_RENDER);
 
+	//Library.
+	Ember<T> PreviewEmber(size_t index);
+	uint64_t PreviewKey(const Ember<T>& ember);
+	void PreviewWorker(size_t worker);
+	bool CancelPreviews(size_t start, size_t end);
+
 	//Palette.
 	void UpdateAdjustedPaletteGUI(Palette<T>& palette);
 
@@ -485,6 +499,17 @@ private:
 	//Templated members.
 	bool m_PreviewRun;
 	bool m_PreviewRunning;
+	bool m_PreviewAccepting;//Whether the running preview workers will still pick up newly queued embers.
+	size_t m_PreviewWorkersActive;
+	std::atomic<size_t> m_PreviewVisibleStart;//The range of embers whose rows are visible in the library tree, rendered first.
+	std::atomic<size_t> m_PreviewVisibleEnd;
+	std::mutex m_PreviewCs;//Protects all of the preview queue members below.
+	std::condition_variable m_PreviewCv;
+	std::set<size_t> m_PreviewPending;//Indices of the embers waiting for a preview.
+	vector<size_t> m_PreviewWorkerIndex;//The index each worker is rendering, or SIZE_MAX if idle.
+	vector<bool> m_PreviewWorkerCanceled;//Whether the preview each worker is rendering has been canceled.
+	vector<size_t> m_PreviewDoneIndices;//Finished previews waiting to be posted to the tree.
+	vector<vector<byte>> m_PreviewDoneImages;
 	vector<T> m_TempOpacities;
 	vector<T> m_NormalizedWeights;
 	Ember<T> m_Ember;
@@ -497,8 +522,8 @@ private:
 	VariationList<T> m_VariationList;
 	unique_ptr<SheepTools<T, float>> m_SheepTools;
 	unique_ptr<GLEmberController<T>> m_GLController;
-	unique_ptr<EmberNs::Renderer<T, float>> m_PreviewRenderer;
+	vector<unique_ptr<EmberNs::Renderer<T, float>>> m_PreviewRenderers;
 	QFuture<void> m_PreviewResult;
-	std::function<void (uint, uint)> m_PreviewRenderFunc;
+	std::function<void (void)> m_PreviewRenderFunc;
 };
 
@@ -9,6 +9,8 @@ void Fractorium::InitLibraryUI()
 	connect(ui.LibraryTree, SIGNAL(itemChanged(QTreeWidgetItem*, int)),		  this, SLOT(OnEmberTreeItemChanged(QTreeWidgetItem*, int)),	   Qt::QueuedConnection);
 	connect(ui.LibraryTree, SIGNAL(itemDoubleClicked(QTreeWidgetItem*, int)), this, SLOT(OnEmberTreeItemDoubleClicked(QTreeWidgetItem*, int)), Qt::QueuedConnection);
 	connect(ui.LibraryTree, SIGNAL(itemActivated(QTreeWidgetItem*, int)),	  this, SLOT(OnEmberTreeItemDoubleClicked(QTreeWidgetItem*, int)), Qt::QueuedConnection);
+	connect(ui.LibraryTree->verticalScrollBar(), SIGNAL(valueChanged(int)),	  this, SLOT(OnLibraryTreeScrolled(int)),						   Qt::QueuedConnection);
+	connect(ui.LibraryTree->verticalScrollBar(), SIGNAL(rangeChanged(int, int)), this, SLOT(OnLibraryTreeScrolled(int)),					   Qt::QueuedConnection);
 }
 
 
@@ -39,15 +41,12 @@ pair<size_t, QTreeWidgetItem*> Fractorium::GetCurrentEmberIndex()
 }
 
 /// <summary>
-/// Slot function to be called via QMetaObject::invokeMethod() to update preview images in the preview thread.
+/// Slot function to be called via QMetaObject::invokeMethod() from the preview thread
+/// when a batch of preview images is ready to be set on the library tree items.
 /// </summary>
-/// <param name="item">The item double clicked on</param>
-/// <param name="v">The vector holding the RGBA bitmap</param>
-/// <param name="w">The width of the bitmap</param>
-/// <param name="h">The height of the bitmap</param>
-void Fractorium::SetLibraryTreeItemData(EmberTreeWidgetItemBase* item, vector<byte>& v, uint w, uint h)
+void Fractorium::SetLibraryTreeItemData()
 {
-	item->SetImage(v, w, h);
+	m_Controller->SetFinishedPreviews();
 }
 
 /// <summary>
@@ -137,7 +136,7 @@ void FractoriumEmberController<T>::FillLibraryTree(int selectIndex)
 			emberItem->setText(0, ember->m_Name.c_str());
 
 		emberItem->setToolTip(0, emberItem->text(0));
-		emberItem->SetImage(v, size, size);
+		emberItem->SetImage(v, size, size, false);
 	}
 
 	tree->blockSignals(false);
@@ -148,8 +147,9 @@ void FractoriumEmberController<T>::FillLibraryTree(int selectIndex)
 				emberItem->setSelected(true);
 
 	QCoreApplication::flush();
+	tree->expandAll();
+	LoadVisiblePreviews();
 	RenderPreviews(0, m_EmberFile.Size());
-	tree->expandAll();	
 }
 
 /// <summary>
@@ -182,13 +182,14 @@ void FractoriumEmberController<T>::UpdateLibraryTree()
 				emberItem->setText(0, ember->m_Name.c_str());
 
 			emberItem->setToolTip(0, emberItem->text(0));
-			emberItem->SetImage(v, size, size);
+			emberItem->SetImage(v, size, size, false);
 		}
 
 		//When adding elements to the vector, they may have been reshuffled which will have invalidated
 		//the pointers contained in the EmberTreeWidgetItems. So reassign all pointers here.
 		SyncPointers();
 		tree->blockSignals(false);
+		LoadVisiblePreviews();
 		RenderPreviews(childCount, m_EmberFile.Size());
 	}
 }
@@ -285,11 +286,19 @@ void Fractorium::OnEmberTreeItemDoubleClicked(QTreeWidgetItem* item, int col) {
 template <typename T>
 void FractoriumEmberController<T>::Delete(const pair<size_t, QTreeWidgetItem*>& p)
 {
+	bool deleted, requeue;
 	QTreeWidget* tree = m_Fractorium->ui.LibraryTree;
 
 	tree->blockSignals(true);
 
-	if (m_EmberFile.Delete(p.first))
+	{
+		//The embers after the deleted one will shift down an index, so cancel their previews and queue them again afterward.
+		std::lock_guard<std::mutex> lock(m_PreviewCs);
+		requeue = CancelPreviews(p.first, SIZE_MAX);
+		deleted = m_EmberFile.Delete(p.first);
+	}
+
+	if (deleted)
 	{
 		delete p.second;
 		SyncPointers();
@@ -297,6 +306,9 @@ void FractoriumEmberController<T>::Delete(const pair<size_t, QTreeWidgetItem*>&
 
 	tree->blockSignals(false);
 
+	if (requeue)
+		RenderPreviews(uint(p.first), uint(m_EmberFile.Size()));
+
 	//If there is now only one item left and it wasn't selected, select it.
 	if (QTreeWidgetItem* top = tree->topLevelItem(0))
 	{
@@ -318,47 +330,93 @@ void Fractorium::OnDelete(const pair<size_t, QTreeWidgetItem*>& p)
 }
 
 /// <summary>
-/// Stop the preview renderer if it's already running.
-/// Clear all of the existing preview images, then start the preview rendering thread.
-/// Optionally only render previews for a subset of all open embers.
+/// Render previews for the embers in the specified range.
+/// If all previews are requested, clear all of the existing preview images, stop the preview workers if they're running,
+/// and start them again for all open embers.
+/// Otherwise, if the preview workers are running, cancel any queued or in progress previews in the range and queue them again,
+/// since they were most likely changed. The rest of the queue is left as is. If they're not running, start them for the range.
+/// Previews which are in the thumbnail cache are not rendered again, and the embers whose rows are
+/// visible in the tree are rendered before the rest.
 /// </summary>
 /// <param name="start">The 0-based index to start rendering previews for</param>
 /// <param name="end">The 0-based index which is one beyond the last ember to render a preview for</param>
 template <typename T>
 void FractoriumEmberController<T>::RenderPreviews(uint start, uint end)
 {
-	StopPreviewRender();
-
 	if (start == UINT_MAX && end == UINT_MAX)
 	{
 		QTreeWidget* tree = m_Fractorium->ui.LibraryTree;
 
+		StopPreviewRender();
 		tree->blockSignals(true);
 
 		if (QTreeWidgetItem* top = tree->topLevelItem(0))
 		{
 			int childCount = top->childCount();
-			vector<byte> emptyPreview(PREVIEW_SIZE * PREVIEW_SIZE * 3);
+			vector<byte> emptyPreview(PREVIEW_SIZE * PREVIEW_SIZE * 4);
 
 			for (int i = 0; i < childCount; i++)
 				if (EmberTreeWidgetItem<T>* treeItem = dynamic_cast<EmberTreeWidgetItem<T>*>(top->child(i)))
-					treeItem->SetImage(emptyPreview, PREVIEW_SIZE, PREVIEW_SIZE);
+					treeItem->SetImage(emptyPreview, PREVIEW_SIZE, PREVIEW_SIZE, false);
 		}
 
 		tree->blockSignals(false);
-		m_PreviewResult = QtConcurrent::run(m_PreviewRenderFunc, 0, m_EmberFile.Size());
+		LoadVisiblePreviews();
+		start = 0;
+		end = uint(m_EmberFile.Size());
 	}
 	else
-		m_PreviewResult = QtConcurrent::run(m_PreviewRenderFunc, start, end);
+	{
+		std::lock_guard<std::mutex> lock(m_PreviewCs);
+
+		if (m_PreviewAccepting)
+		{
+			CancelPreviews(start, end);
+
+			for (size_t i = start; i < end && i < m_EmberFile.Size(); i++)
+				m_PreviewPending.insert(i);
+
+			m_PreviewCv.notify_all();
+			return;
+		}
+	}
+
+	StopPreviewRender();//The previous workers may still be finishing up after running out of work.
+
+	{
+		std::lock_guard<std::mutex> lock(m_PreviewCs);
+
+		for (size_t i = start; i < end && i < m_EmberFile.Size(); i++)
+			m_PreviewPending.insert(i);
+
+		m_PreviewRun = true;
+		m_PreviewRunning = true;
+		m_PreviewAccepting = true;
+		m_PreviewWorkersActive = m_PreviewRenderers.size();
+	}
+
+	m_PreviewResult = QtConcurrent::run(m_PreviewRenderFunc);
 }
 
 /// <summary>
 /// Stop the preview rendering thread.
+/// Anything still queued is discarded, and any previews being rendered are aborted.
 /// </summary>
 template <typename T>
 void FractoriumEmberController<T>::StopPreviewRender()
 {
-	m_PreviewRun = false;
+	{
+		std::lock_guard<std::mutex> lock(m_PreviewCs);
+		m_PreviewRun = false;
+		m_PreviewPending.clear();
+		m_PreviewDoneIndices.clear();
+		m_PreviewDoneImages.clear();
+	}
+
+	m_PreviewCv.notify_all();
+
+	for (auto& renderer : m_PreviewRenderers)
+		renderer->Abort();
 
 	while (m_PreviewRunning)
 		QApplication::processEvents();
@@ -372,6 +430,252 @@ void FractoriumEmberController<T>::StopPreviewRender()
 	QCoreApplication::flush();
 }
 
+/// <summary>
+/// Remove the embers in the specified range from the preview queue.
+/// Any of them which are being rendered are aborted and their results discarded,
+/// as are any which are finished but not yet set on the tree.
+/// Assumes m_PreviewCs is locked.
+/// </summary>
+/// <param name="start">The 0-based index of the first ember to cancel</param>
+/// <param name="end">The 0-based index which is one beyond the last ember to cancel</param>
+/// <returns>True if any previews were canceled, else false.</returns>
+template <typename T>
+bool FractoriumEmberController<T>::CancelPreviews(size_t start, size_t end)
+{
+	bool canceled = false;
+	auto first = m_PreviewPending.lower_bound(start);
+	auto last = m_PreviewPending.lower_bound(end);
+
+	if (first != last)
+	{
+		m_PreviewPending.erase(first, last);
+		canceled = true;
+	}
+
+	for (size_t i = 0; i < m_PreviewWorkerIndex.size(); i++)
+	{
+		if (m_PreviewWorkerIndex[i] >= start && m_PreviewWorkerIndex[i] < end)
+		{
+			m_PreviewWorkerCanceled[i] = true;
+			m_PreviewRenderers[i]->Abort();
+			canceled = true;
+		}
+	}
+
+	for (size_t i = 0; i < m_PreviewDoneIndices.size();)
+	{
+		if (m_PreviewDoneIndices[i] >= start && m_PreviewDoneIndices[i] < end)
+		{
+			m_PreviewDoneIndices.erase(m_PreviewDoneIndices.begin() + i);
+			m_PreviewDoneImages.erase(m_PreviewDoneImages.begin() + i);
+			canceled = true;
+		}
+		else
+			i++;
+	}
+
+	return canceled;
+}
+
+/// <summary>
+/// The function run by each preview worker thread, using the preview renderer at the same index.
+/// Repeatedly takes the next queued ember, preferring ones whose rows are visible, and either
+/// gets its thumbnail from the cache or renders it and adds it to the cache.
+/// Finished thumbnails are added to the list of previews to be set on the tree in the next batch.
+/// Returns once the queue is empty and no other worker is busy, or when stopped.
+/// </summary>
+/// <param name="worker">The index of the worker</param>
+template <typename T>
+void FractoriumEmberController<T>::PreviewWorker(size_t worker)
+{
+	auto renderer = m_PreviewRenderers[worker].get();
+	ThumbnailCache* cache = m_Fractorium->m_ThumbnailCache.get();
+	uint thumbnailSize = ThumbnailCache::THUMBNAIL_SIZE;
+	vector<byte> finalImage, thumbnail;
+
+	while (true)
+	{
+		size_t i;
+		Ember<T> ember;
+
+		{
+			std::unique_lock<std::mutex> lock(m_PreviewCs);
+
+			//While other workers are busy, stay around in case more previews are queued.
+			m_PreviewCv.wait(lock, [&]()
+			{
+				return !m_PreviewRun || !m_PreviewPending.empty() ||
+					   std::all_of(m_PreviewWorkerIndex.begin(), m_PreviewWorkerIndex.end(), [&](size_t index) { return index == SIZE_MAX; });
+			});
+
+			if (!m_PreviewRun || m_PreviewPending.empty())
+			{
+				m_PreviewAccepting = false;//Anything queued after this will start new workers.
+				m_PreviewWorkersActive--;
+				m_PreviewCv.notify_all();
+				return;
+			}
+
+			//Take the first queued ember whose row is visible, else the first queued one.
+			//The visible range is updated by the GUI thread as the tree scrolls.
+			auto it = m_PreviewPending.lower_bound(m_PreviewVisibleStart);
+
+			if (it == m_PreviewPending.end() || *it >= m_PreviewVisibleEnd)
+				it = m_PreviewPending.begin();
+
+			i = *it;
+			m_PreviewPending.erase(it);
+
+			if (i >= m_EmberFile.Size())
+				continue;
+
+			ember = PreviewEmber(i);//Copy while locked, since the file can be modified on the GUI thread.
+			m_PreviewWorkerIndex[worker] = i;
+			m_PreviewWorkerCanceled[worker] = false;
+		}
+
+		bool post = false;
+		uint64_t key = PreviewKey(ember);
+
+		if (cache->Get(key, thumbnail))
+		{
+			//Cached thumbnails are loaded by LoadVisiblePreviews() as their rows scroll into view, so only post the visible ones here.
+			post = i >= m_PreviewVisibleStart && i < m_PreviewVisibleEnd;
+		}
+		else
+		{
+			renderer->SetEmber(ember);
+
+			if (renderer->Run(finalImage) == eRenderStatus::RENDER_OK)
+			{
+				QImage image(finalImage.data(), PREVIEW_SIZE, PREVIEW_SIZE, QImage::Format_RGBA8888);
+				QImage scaled = image.scaled(thumbnailSize, thumbnailSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+				thumbnail.resize(ThumbnailCache::THUMBNAIL_BYTES);
+				memcpy(thumbnail.data(), scaled.constBits(), thumbnail.size());
+				cache->Add(key, thumbnail);//Valid even if canceled, since the key was made from the ember as it was rendered.
+				post = true;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_PreviewCs);
+
+			if (post && m_PreviewRun && !m_PreviewWorkerCanceled[worker])
+			{
+				m_PreviewDoneIndices.push_back(i);
+				m_PreviewDoneImages.push_back(thumbnail);
+			}
+
+			m_PreviewWorkerIndex[worker] = SIZE_MAX;
+		}
+
+		m_PreviewCv.notify_all();
+	}
+}
+
+/// <summary>
+/// Set the finished preview images on their library tree items.
+/// Called on the GUI thread when the preview thread signals a batch is ready.
+/// </summary>
+template <typename T>
+void FractoriumEmberController<T>::SetFinishedPreviews()
+{
+	vector<size_t> indices;
+	vector<vector<byte>> images;
+	uint size = ThumbnailCache::THUMBNAIL_SIZE;
+	QTreeWidget* tree = m_Fractorium->ui.LibraryTree;
+
+	{
+		std::lock_guard<std::mutex> lock(m_PreviewCs);
+		indices.swap(m_PreviewDoneIndices);
+		images.swap(m_PreviewDoneImages);
+	}
+
+	if (QTreeWidgetItem* top = tree->topLevelItem(0))
+	{
+		for (size_t i = 0; i < indices.size(); i++)
+			if (EmberTreeWidgetItem<T>* treeItem = dynamic_cast<EmberTreeWidgetItem<T>*>(top->child(int(indices[i]))))
+				treeItem->SetImage(images[i], size, size);
+	}
+}
+
+/// <summary>
+/// Load the cached thumbnails of the embers whose rows are visible in the library tree,
+/// and store the visible range so the preview thread can render the rest of them first.
+/// Only items which don't already show a preview are loaded.
+/// Called whenever the tree is filled, scrolled or resized.
+/// </summary>
+template <typename T>
+void FractoriumEmberController<T>::LoadVisiblePreviews()
+{
+	QTreeWidget* tree = m_Fractorium->ui.LibraryTree;
+
+	if (QTreeWidgetItem* top = tree->topLevelItem(0))
+	{
+		QRect rect = tree->viewport()->rect();
+		int childCount = top->childCount();
+		int first = top->indexOfChild(tree->itemAt(rect.topLeft()));//Returns -1 if it's the file item, or there is no item there.
+		int last = top->indexOfChild(tree->itemAt(rect.bottomLeft()));
+		uint size = ThumbnailCache::THUMBNAIL_SIZE;
+		vector<byte> thumbnail;
+
+		if (first < 0)
+			first = 0;
+
+		if (last < 0)//There is no ember at the bottom, so the last one is visible.
+			last = childCount - 1;
+
+		m_PreviewVisibleStart = first;
+		m_PreviewVisibleEnd = last + 1;
+		tree->blockSignals(true);
+
+		for (int i = first; i <= last && i < m_EmberFile.Size(); i++)
+		{
+			if (EmberTreeWidgetItem<T>* treeItem = dynamic_cast<EmberTreeWidgetItem<T>*>(top->child(i)))
+				if (!treeItem->HasPreview() && m_Fractorium->m_ThumbnailCache->Get(PreviewKey(PreviewEmber(i)), thumbnail))
+					treeItem->SetImage(thumbnail, size, size);
+		}
+
+		tree->blockSignals(false);
+	}
+}
+
+void Fractorium::OnLibraryTreeScrolled(int value) { m_Controller->LoadVisiblePreviews(); }
+
+/// <summary>
+/// Make a copy of the ember at the specified index in the file, prepared for rendering a preview.
+/// </summary>
+/// <param name="index">The index of the ember in the file</param>
+/// <returns>The ember, resized to PREVIEW_SIZE with low quality settings</returns>
+template <typename T>
+Ember<T> FractoriumEmberController<T>::PreviewEmber(size_t index)
+{
+	Ember<T> ember = m_EmberFile.m_Embers[index];
+	ember.SyncSize();
+	ember.SetSizeAndAdjustScale(PREVIEW_SIZE, PREVIEW_SIZE, false, eScaleType::SCALE_WIDTH);
+	ember.m_TemporalSamples = 1;
+	ember.m_Quality = 25;
+	ember.m_Supersample = 1;
+	return ember;
+}
+
+/// <summary>
+/// Compute the thumbnail cache key of a preview ember.
+/// This is the content hash of the ember, continued with the version of the renderer,
+/// the settings of the preview renderer and the thumbnail size.
+/// </summary>
+/// <param name="ember">The ember as returned by PreviewEmber()</param>
+/// <returns>The key</returns>
+template <typename T>
+uint64_t FractoriumEmberController<T>::PreviewKey(const Ember<T>& ember)
+{
+	uint64_t hash = RenderCheckpoint::Hash(EmberVersion(), ember.Hash());
+	hash = HashVal(sizeof(T), hash);
+	hash = HashVal(m_PreviewRenderers[0]->EarlyClip(), hash);
+	hash = HashVal(m_PreviewRenderers[0]->YAxisUp(), hash);
+	return HashVal(uint(ThumbnailCache::THUMBNAIL_SIZE), hash);
+}
+
 template class FractoriumEmberController<float>;
 
 #ifdef DO_DOUBLE
@@ -386,6 +386,7 @@ void FractoriumEmberController<T>::SaveCurrentToOpenedFile()
 		if ((m_Ember.m_Name == m_EmberFile.m_Embers[i].m_Name) &&//Check both to be extra sure.
 			(m_Ember.m_Index == m_EmberFile.m_Embers[i].m_Index))
 		{
+			std::lock_guard<std::mutex> lock(m_PreviewCs);//The preview workers may be copying it.
 			m_EmberFile.m_Embers[i] = m_Ember;
 			fileFound = true;
 			break;
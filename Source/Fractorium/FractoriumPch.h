@@ -23,6 +23,7 @@
 #endif
 
 #include <deque>
+#include <set>
 #include "qfunctions.h"
 #include <QApplication>
 #include <QBrush>
@@ -41,6 +42,7 @@
 #include <QImageReader>
 #include <QItemDelegate>
 #include <QLineEdit>
+#include <QLockFile>
 #include <QMenu>
 #include <QModelIndex>
 #include <qopenglfunctions_2_0.h>
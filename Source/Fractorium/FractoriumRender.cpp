@@ -18,7 +18,7 @@ void FractoriumEmberControllerBase::StartRenderTimer()
 {
 	if (m_RenderTimer)
 	{
-		UpdateRender();
+		UpdateRender(eProcessAction::FULL_RENDER, true);//The renderer or its options may have changed, so the ember comparison can't be trusted.
 		m_RenderTimer->start();
 		m_RenderElapsedTimer.Tic();
 	}
@@ -91,11 +91,13 @@ void FractoriumEmberControllerBase::ClearFinalImages()
 /// 2) Log/density filter, then final accum.
 /// 3) Final accum only.
 /// 4) Continue iterating.
+/// Unless forced, the action may be reduced to what the changes to the ember actually require when the render is restarted.
 /// </summary>
 /// <param name="action">The action to take</param>
-void FractoriumEmberControllerBase::UpdateRender(eProcessAction action)
+/// <param name="force">True to take the action as is, such as when something outside of the ember requires a full render, else false.</param>
+void FractoriumEmberControllerBase::UpdateRender(eProcessAction action, bool force)
 {
-	AddProcessAction(action);
+	AddProcessAction(action, force);
 	m_RenderElapsedTimer.Tic();
 }
 
@@ -181,10 +183,12 @@ void FractoriumEmberControllerBase::SaveCurrentRender(const QString& filename, c
 /// Called in response to the user changing something on the GUI.
 /// </summary>
 /// <param name="action">The action for the renderer to take</param>
-void FractoriumEmberControllerBase::AddProcessAction(eProcessAction action)
+/// <param name="force">True to take the action as is, rather than reducing it to what the changes to the ember require, else false.</param>
+void FractoriumEmberControllerBase::AddProcessAction(eProcessAction action, bool force)
 {
 	m_Cs.Enter();
 	m_ProcessActions.push_back(action);
+	m_ForceProcessAction |= force;
 
 	if (m_Renderer.get())
 		m_Renderer->Abort();
@@ -197,8 +201,9 @@ void FractoriumEmberControllerBase::AddProcessAction(eProcessAction action)
 /// Many actions may be specified, but only the one requiring the greatest amount
 /// of processing matters. Extract and return the greatest and clear the vector.
 /// </summary>
+/// <param name="force">Set to whether any of the actions was forced</param>
 /// <returns>The most significant processing action desired</returns>
-eProcessAction FractoriumEmberControllerBase::CondenseAndClearProcessActions()
+eProcessAction FractoriumEmberControllerBase::CondenseAndClearProcessActions(bool& force)
 {
 	m_Cs.Enter();
 	auto action = eProcessAction::NOTHING;
@@ -207,6 +212,8 @@ eProcessAction FractoriumEmberControllerBase::CondenseAndClearProcessActions()
 		if (a > action)
 			action = a;
 
+	force = m_ForceProcessAction;
+	m_ForceProcessAction = false;
 	m_ProcessActions.clear();
 	m_Cs.Leave();
 	return action;
@@ -298,6 +305,7 @@ bool FractoriumEmberController<T>::Render()
 	bool success = true;
 	GLWidget* gl = m_Fractorium->ui.GLDisplay;
 	RendererCL<T, float>* rendererCL = nullptr;
+	bool force = false;
 	eProcessAction qualityAction, action;
 	//Quality is the only parameter we update inside the timer.
 	//This is to allow the user to rapidly increase the quality spinner
@@ -323,7 +331,7 @@ bool FractoriumEmberController<T>::Render()
 	else if (qualityAction == eProcessAction::KEEP_ITERATING)
 		m_ProcessActions.push_back(qualityAction);//Special, direct call to avoid resetting the render inside Update() because only KEEP_ITERATING is needed.
 
-	action = CondenseAndClearProcessActions();//Combine with all other previously requested actions.
+	action = CondenseAndClearProcessActions(force);//Combine with all other previously requested actions.
 
 	if (m_Renderer->RendererType() == OPENCL_RENDERER)
 		rendererCL = dynamic_cast<RendererCL<T, float>*>(m_Renderer.get());
@@ -347,6 +355,10 @@ bool FractoriumEmberController<T>::Render()
 			}
 		}
 
+		//Many edits request a full render to be safe, so only do as much as what actually changed in the ember requires.
+		//A forced action came from something the ember comparison can't see, so it's taken as is.
+		if (!force)
+			action = std::min(action, m_Renderer->RequiredProcessAction(m_Ember));
 		m_Renderer->SetEmber(m_Ember, action);
 
 		if (solo != -1)
@@ -577,18 +589,24 @@ bool FractoriumEmberController<T>::CreateRenderer(eRendererType renderType, cons
 		m_Renderer->YAxisUp(s->YAxisUp());
 		m_Renderer->ThreadCount(s->ThreadCount());
 		m_Renderer->Transparency(s->Transparency());
+		m_Renderer->IndexHist(s->IndexHist());
 
 		if (m_Renderer->RendererType() == eRendererType::CPU_RENDERER)
 			m_Renderer->InteractiveFilter(s->CpuDEFilter() ? eInteractiveFilter::FILTER_DE : eInteractiveFilter::FILTER_LOG);
 		else
 			m_Renderer->InteractiveFilter(s->OpenCLDEFilter() ? eInteractiveFilter::FILTER_DE : eInteractiveFilter::FILTER_LOG);
 
-		if ((m_Renderer->EarlyClip() != m_PreviewRenderer->EarlyClip()) ||
-				(m_Renderer->YAxisUp() != m_PreviewRenderer->YAxisUp()))
+		if ((m_Renderer->EarlyClip() != m_PreviewRenderers[0]->EarlyClip()) ||
+				(m_Renderer->YAxisUp() != m_PreviewRenderers[0]->YAxisUp()))
 		{
 			StopPreviewRender();
-			m_PreviewRenderer->EarlyClip(m_Renderer->EarlyClip());
-			m_PreviewRenderer->YAxisUp(m_Renderer->YAxisUp());
+
+			for (auto& renderer : m_PreviewRenderers)
+			{
+				renderer->EarlyClip(m_Renderer->EarlyClip());
+				renderer->YAxisUp(m_Renderer->YAxisUp());
+			}
+
 			RenderPreviews();
 		}
 
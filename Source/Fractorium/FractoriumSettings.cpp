@@ -92,6 +92,9 @@ void FractoriumSettings::YAxisUp(bool b)						 { setValue(YAXISUP, b);				   }
 bool FractoriumSettings::Transparency()							 { return value(TRANSPARENCY).toBool();    }
 void FractoriumSettings::Transparency(bool b)					 { setValue(TRANSPARENCY, b);              }
 
+bool FractoriumSettings::IndexHist()							 { return value(INDEXHIST).toBool();       }
+void FractoriumSettings::IndexHist(bool b)						 { setValue(INDEXHIST, b);                 }
+
 bool FractoriumSettings::OpenCL()								 { return value(OPENCL).toBool();          }
 void FractoriumSettings::OpenCL(bool b)							 { setValue(OPENCL, b);                    }
 
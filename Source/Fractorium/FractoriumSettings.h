@@ -9,6 +9,7 @@
 #define EARLYCLIP            "render/earlyclip"
 #define YAXISUP				 "render/yaxisup"
 #define TRANSPARENCY         "render/transparency"
+#define INDEXHIST            "render/indexhist"
 #define OPENCL               "render/opencl"
 #define DOUBLEPRECISION		 "render/dp64"
 #define CONTUPDATE			 "render/continuousupdate"
@@ -83,6 +84,9 @@ public:
 
 	bool Transparency();
 	void Transparency(bool b);
+
+	bool IndexHist();
+	void IndexHist(bool b);
 	
 	bool OpenCL();
 	void OpenCL(bool b);
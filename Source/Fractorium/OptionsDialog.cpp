@@ -62,6 +62,7 @@ FractoriumOptionsDialog::FractoriumOptionsDialog(FractoriumSettings* settings, Q
 bool FractoriumOptionsDialog::EarlyClip() { return ui.EarlyClipCheckBox->isChecked(); }
 bool FractoriumOptionsDialog::YAxisUp() { return ui.YAxisUpCheckBox->isChecked(); }
 bool FractoriumOptionsDialog::Transparency() { return ui.TransparencyCheckBox->isChecked(); }
+bool FractoriumOptionsDialog::IndexHist() { return ui.IndexHistCheckBox->isChecked(); }
 bool FractoriumOptionsDialog::ContinuousUpdate() { return ui.ContinuousUpdateCheckBox->isChecked(); }
 bool FractoriumOptionsDialog::OpenCL() { return ui.OpenCLCheckBox->isChecked(); }
 bool FractoriumOptionsDialog::Double() { return ui.DoublePrecisionCheckBox->isChecked(); }
@@ -119,6 +120,7 @@ void FractoriumOptionsDialog::OnOpenCLCheckBoxStateChanged(int state)
 	ui.DeviceTable->setEnabled(checked);
 	ui.ThreadCountSpin->setEnabled(!checked);
 	ui.CpuSubBatchSpin->setEnabled(!checked);
+	ui.IndexHistCheckBox->setEnabled(!checked);
 	ui.OpenCLSubBatchSpin->setEnabled(checked);
 	ui.CpuFilteringDERadioButton->setEnabled(!checked);
 	ui.CpuFilteringLogRadioButton->setEnabled(!checked);
@@ -168,6 +170,7 @@ void FractoriumOptionsDialog::GuiToData()
 	m_Settings->EarlyClip(EarlyClip());
 	m_Settings->YAxisUp(YAxisUp());
 	m_Settings->Transparency(Transparency());
+	m_Settings->IndexHist(IndexHist());
 	m_Settings->ContinuousUpdate(ContinuousUpdate());
 	m_Settings->OpenCL(OpenCL());
 	m_Settings->Double(Double());
@@ -200,6 +203,7 @@ void FractoriumOptionsDialog::DataToGui()
 	ui.EarlyClipCheckBox->setChecked(m_Settings->EarlyClip());
 	ui.YAxisUpCheckBox->setChecked(m_Settings->YAxisUp());
 	ui.TransparencyCheckBox->setChecked(m_Settings->Transparency());
+	ui.IndexHistCheckBox->setChecked(m_Settings->IndexHist());
 	ui.ContinuousUpdateCheckBox->setChecked(m_Settings->ContinuousUpdate());
 	ui.OpenCLCheckBox->setChecked(m_Settings->OpenCL());
 	ui.DoublePrecisionCheckBox->setChecked(m_Settings->Double());
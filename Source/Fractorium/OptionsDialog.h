@@ -41,6 +41,7 @@ private:
 	bool YAxisUp();
 	bool AlphaChannel();
 	bool Transparency();
+	bool IndexHist();
 	bool ContinuousUpdate();
 	bool OpenCL();
 	bool Double();
@@ -0,0 +1,399 @@
+#pragma once
+
+#include "FractoriumPch.h"
+
+/// <summary>
+/// ThumbnailCache class.
+/// </summary>
+
+/// <summary>
+/// A persistent, content addressed cache of the preview thumbnails shown in the library tree.
+/// Each thumbnail is stored as a THUMBNAIL_SIZE x THUMBNAIL_SIZE RGBA image under a 64-bit key, which is
+/// a hash of everything that affects the way the preview renders. So an ember which was previewed in any
+/// previous session, in any file, will not be rendered again as long as its content is unchanged.
+/// The thumbnails are kept in a single pack file which is memory mapped on open,
+/// so startup only requires scanning the keys, and a thumbnail is only read once it's requested.
+/// File layout:
+///		Header: 8 byte magic, uint version, uint thumbnail size, 64-bit thumbnail count, 64-bit index of the next slot to write.
+///		Records: 64-bit key, followed by the RGBA bytes of the thumbnail, repeated count times.
+/// Newly added thumbnails are held in memory until Flush() is called, which writes them to the file.
+/// The file holds at most MAX_THUMBNAILS records. Once it's full, each new one overwrites the oldest,
+/// so the file never grows past about 64MB and is never discarded all at once.
+/// All functions are thread safe, so the cache can be read by the GUI thread while the preview thread adds to it.
+/// Several instances of the program can share the file. Writes are serialized with a lock file, and the header is
+/// read again from the file before each one. The file never shrinks while in use, so a mapping made by another
+/// instance always stays valid. Each record is checked to still hold the requested key before it's returned,
+/// since another instance may have overwritten it.
+/// </summary>
+class ThumbnailCache
+{
+public:
+	static const uint THUMBNAIL_SIZE = 64;
+	static const uint THUMBNAIL_BYTES = THUMBNAIL_SIZE * THUMBNAIL_SIZE * 4;
+	static const uint VERSION = 3;
+	static const size_t MAX_THUMBNAILS = 1 << 12;
+	static const int LOCK_TIMEOUT_MS = 5000;
+
+	/// <summary>
+	/// Constructor which opens the pack file, creating it and its folder if they don't exist.
+	/// If the file is not a valid pack file, it's started over.
+	/// </summary>
+	/// <param name="filename">The full path to the pack file</param>
+	ThumbnailCache(const QString& filename)
+		: m_File(filename),
+		  m_LockFilename(filename + ".lock")
+	{
+		m_Data = nullptr;
+		m_MappedSize = 0;
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		QDir().mkpath(QFileInfo(filename).absolutePath());
+
+		if (m_File.open(QIODevice::ReadWrite))
+		{
+			QLockFile fileLock(m_LockFilename);
+
+			if (!fileLock.tryLock(LOCK_TIMEOUT_MS))
+				qDebug() << "ThumbnailCache: Failed to lock " << m_LockFilename << ", opening without it.";
+
+			if (!Map())
+				Reset();
+		}
+		else
+			qDebug() << "ThumbnailCache: Failed to open " << filename << ", thumbnails will not persist.";
+	}
+
+	/// <summary>
+	/// Destructor which writes any pending thumbnails to the file and closes it.
+	/// </summary>
+	~ThumbnailCache()
+	{
+		Flush();
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		Unmap();
+		m_File.close();
+	}
+
+	/// <summary>
+	/// Determine whether a thumbnail with the specified key is present, either in the file or pending.
+	/// </summary>
+	/// <param name="key">The key of the thumbnail</param>
+	/// <returns>True if found, else false.</returns>
+	bool Contains(uint64_t key)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Pending.find(key) != m_Pending.end() || m_Offsets.find(key) != m_Offsets.end();
+	}
+
+	/// <summary>
+	/// Copy the thumbnail with the specified key into the passed in vector.
+	/// If it's not found and another instance has written to the file since it was mapped,
+	/// it's mapped again before giving up.
+	/// </summary>
+	/// <param name="key">The key of the thumbnail</param>
+	/// <param name="v">The vector to store the RGBA bytes in. Will be resized to THUMBNAIL_BYTES.</param>
+	/// <returns>True if found, else false.</returns>
+	bool Get(uint64_t key, vector<byte>& v)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto pending = m_Pending.find(key);
+
+		if (pending != m_Pending.end())
+		{
+			v = pending->second;
+			return true;
+		}
+
+		auto offset = m_Offsets.find(key);
+
+		if (offset == m_Offsets.end() && Stale())
+		{
+			Unmap();
+			Map();
+			offset = m_Offsets.find(key);
+		}
+
+		if (offset != m_Offsets.end() && m_Data && offset->second + RecordSize() <= m_MappedSize)
+		{
+			uint64_t recordKey;
+			memcpy(&recordKey, m_Data + offset->second, sizeof(recordKey));
+
+			if (recordKey == key)
+			{
+				v.resize(THUMBNAIL_BYTES);
+				memcpy(v.data(), m_Data + offset->second + sizeof(uint64_t), THUMBNAIL_BYTES);
+				return true;
+			}
+
+			m_Offsets.erase(offset);//Overwritten by another instance.
+		}
+
+		return false;
+	}
+
+	/// <summary>
+	/// Add a thumbnail to the cache. It will not be written to the file until the next call to Flush().
+	/// </summary>
+	/// <param name="key">The key of the thumbnail</param>
+	/// <param name="v">The RGBA bytes of the thumbnail. Must be THUMBNAIL_BYTES in size.</param>
+	/// <returns>True if the size was correct and the thumbnail was added, else false.</returns>
+	bool Add(uint64_t key, const vector<byte>& v)
+	{
+		if (v.size() != THUMBNAIL_BYTES)
+			return false;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (m_Offsets.find(key) == m_Offsets.end())
+			m_Pending[key] = v;
+
+		return true;
+	}
+
+	/// <summary>
+	/// Write all pending thumbnails to the file and map it again.
+	/// The header is read from the file rather than taken from the last mapping, so records written by other
+	/// instances since then are kept. Each thumbnail goes in the slot after the last one written,
+	/// wrapping around to overwrite the oldest once the file holds MAX_THUMBNAILS.
+	/// If the lock file can't be acquired, the thumbnails stay pending for the next call.
+	/// </summary>
+	/// <returns>True if there was nothing to write or all pending thumbnails were successfully written, else false.</returns>
+	bool Flush()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (m_Pending.empty() || !m_File.isOpen())
+			return true;
+
+		QLockFile fileLock(m_LockFilename);
+
+		if (!fileLock.tryLock(LOCK_TIMEOUT_MS))
+			return false;
+
+		bool b = true;
+		Header header;
+		Unmap();
+
+		if (!ReadHeader(header))
+		{
+			Reset();
+			header = MakeHeader(0, 0);
+		}
+
+		for (auto& pending : m_Pending)
+		{
+			if (!m_File.seek(sizeof(Header) + header.m_Next * RecordSize()) ||
+					m_File.write(reinterpret_cast<const char*>(&pending.first), sizeof(pending.first)) != sizeof(pending.first) ||
+					m_File.write(reinterpret_cast<const char*>(pending.second.data()), THUMBNAIL_BYTES) != THUMBNAIL_BYTES)
+			{
+				b = false;
+				break;
+			}
+
+			header.m_Next = (header.m_Next + 1) % MAX_THUMBNAILS;
+			header.m_Count = std::min<uint64_t>(header.m_Count + 1, MAX_THUMBNAILS);
+		}
+
+		//Only update the header once the records are written, so a failed write leaves the previous contents intact.
+		if (m_File.seek(0))
+			m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		m_File.flush();
+		m_Pending.clear();
+
+		if (!Map())
+			Reset();
+
+		return b;
+	}
+
+	/// <summary>
+	/// The number of thumbnails in the cache, including pending ones.
+	/// </summary>
+	/// <returns>The number of thumbnails</returns>
+	size_t Size()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Offsets.size() + m_Pending.size();
+	}
+
+private:
+	/// <summary>
+	/// The header at the start of the pack file.
+	/// </summary>
+	struct Header
+	{
+		char m_Magic[8];
+		uint m_Version;
+		uint m_Size;
+		uint64_t m_Count;
+		uint64_t m_Next;
+	};
+
+	/// <summary>
+	/// The size of a single record in the file: the key followed by the image.
+	/// </summary>
+	/// <returns>The size in bytes of a record</returns>
+	static size_t RecordSize() { return sizeof(uint64_t) + THUMBNAIL_BYTES; }
+
+	/// <summary>
+	/// The size of the file once it holds MAX_THUMBNAILS, which it never exceeds.
+	/// </summary>
+	/// <returns>The maximum size in bytes of the file</returns>
+	static size_t MaxFileSize() { return sizeof(Header) + MAX_THUMBNAILS * RecordSize(); }
+
+	/// <summary>
+	/// Make a header for the current version and thumbnail size.
+	/// </summary>
+	/// <param name="count">The number of thumbnails in the file</param>
+	/// <param name="next">The index of the slot the next thumbnail will be written to</param>
+	/// <returns>The header</returns>
+	static Header MakeHeader(uint64_t count, uint64_t next)
+	{
+		Header header;
+		memcpy(header.m_Magic, "FRTHUMB1", sizeof(header.m_Magic));
+		header.m_Version = VERSION;
+		header.m_Size = THUMBNAIL_SIZE;
+		header.m_Count = count;
+		header.m_Next = next;
+		return header;
+	}
+
+	/// <summary>
+	/// Check a header read from the file, and limit its count to the records the file actually holds.
+	/// </summary>
+	/// <param name="header">The header to check</param>
+	/// <param name="fileSize">The size of the file</param>
+	/// <returns>True if the header is from this version and thumbnail size, else false.</returns>
+	static bool ValidHeader(Header& header, qint64 fileSize)
+	{
+		Header expected = MakeHeader(0, 0);
+
+		if (memcmp(header.m_Magic, expected.m_Magic, sizeof(header.m_Magic)) || header.m_Version != VERSION || header.m_Size != THUMBNAIL_SIZE)
+			return false;
+
+		header.m_Count = std::min<uint64_t>(std::min<uint64_t>(header.m_Count, MAX_THUMBNAILS), (fileSize - sizeof(Header)) / RecordSize());
+		header.m_Next = header.m_Count < MAX_THUMBNAILS ? header.m_Count : header.m_Next % MAX_THUMBNAILS;
+		return true;
+	}
+
+	/// <summary>
+	/// Read the header directly from the file, which reflects writes made by other instances.
+	/// Assumes the mutex is locked.
+	/// </summary>
+	/// <param name="header">The header to read into</param>
+	/// <returns>True if the file had a valid header, else false.</returns>
+	bool ReadHeader(Header& header)
+	{
+		qint64 fileSize = m_File.size();
+		return fileSize >= qint64(sizeof(Header)) && m_File.seek(0) &&
+			   m_File.read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header) &&
+			   ValidHeader(header, fileSize);
+	}
+
+	/// <summary>
+	/// Map the file into memory and build the lookup of keys to record offsets.
+	/// Records beyond the end of a truncated file are ignored.
+	/// Assumes the mutex is locked.
+	/// </summary>
+	/// <returns>True if the file had a valid header and was successfully mapped, else false.</returns>
+	bool Map()
+	{
+		Header header;
+		qint64 fileSize = std::min<qint64>(m_File.size(), MaxFileSize());
+		m_Offsets.clear();
+
+		if (fileSize < qint64(sizeof(Header)))
+			return false;
+
+		if (!(m_Data = m_File.map(0, fileSize)))
+			return false;
+
+		m_MappedSize = size_t(fileSize);
+		memcpy(&header, m_Data, sizeof(header));
+		m_MappedHeader = header;
+
+		if (!ValidHeader(header, fileSize))
+		{
+			Unmap();
+			return false;
+		}
+
+		m_Offsets.reserve(header.m_Count);
+
+		for (uint64_t i = 0; i < header.m_Count; i++)
+		{
+			uint64_t key, offset = sizeof(Header) + i * RecordSize();
+			memcpy(&key, m_Data + offset, sizeof(key));
+			m_Offsets[key] = offset;
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Determine whether another instance has written to the file since it was mapped,
+	/// which either grows the file or changes the header once it's full.
+	/// Assumes the mutex is locked.
+	/// </summary>
+	/// <returns>True if the file should be mapped again, else false.</returns>
+	bool Stale()
+	{
+		Header header;
+
+		if (!m_File.isOpen())
+			return false;
+
+		if (std::min<qint64>(m_File.size(), MaxFileSize()) != qint64(m_MappedSize) || !m_Data)
+			return true;
+
+		memcpy(&header, m_Data, sizeof(header));
+		return header.m_Count != m_MappedHeader.m_Count || header.m_Next != m_MappedHeader.m_Next;
+	}
+
+	/// <summary>
+	/// Unmap the file if it's mapped.
+	/// Assumes the mutex is locked.
+	/// </summary>
+	void Unmap()
+	{
+		if (m_Data)
+		{
+			m_File.unmap(m_Data);
+			m_Data = nullptr;
+		}
+
+		m_MappedSize = 0;
+	}
+
+	/// <summary>
+	/// Discard the contents of the file by writing an empty header over it.
+	/// The file is not truncated, since other instances may have it mapped, unless it's larger
+	/// than this version ever makes it, which means it was written by an older one.
+	/// Pending thumbnails are kept.
+	/// Assumes the mutex and lock file are locked.
+	/// </summary>
+	void Reset()
+	{
+		Header header = MakeHeader(0, 0);
+		Unmap();
+		m_Offsets.clear();
+
+		if (m_File.isOpen() && m_File.seek(0))
+		{
+			if (m_File.size() > qint64(MaxFileSize()))
+				m_File.resize(MaxFileSize());
+
+			m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			m_File.flush();
+		}
+	}
+
+	std::mutex m_Mutex;
+	QFile m_File;
+	QString m_LockFilename;
+	uchar* m_Data;
+	size_t m_MappedSize;
+	Header m_MappedHeader;//As it was when the file was mapped, before being validated.
+	std::unordered_map<uint64_t, uint64_t> m_Offsets;//Key to the offset of its record in the file.
+	std::unordered_map<uint64_t, vector<byte>> m_Pending;//Added, but not yet written.
+};